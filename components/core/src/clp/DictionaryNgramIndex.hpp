@@ -0,0 +1,202 @@
+#ifndef CLP_DICTIONARYNGRAMINDEX_HPP
+#define CLP_DICTIONARYNGRAMINDEX_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+namespace clp {
+/**
+ * Template class of an index from each n-gram of a dictionary's (lowercased) values to the IDs of
+ * the entries containing it. It's used to narrow the entries that need to be checked against a
+ * wildcard string to those that contain every n-gram of the wildcard string's literal segments.
+ *
+ * Since n-grams are lowercased, the candidates are a superset of the matching entries for both
+ * case-sensitive and case-insensitive matches.
+ * @tparam DictionaryIdType
+ */
+template <typename DictionaryIdType>
+class DictionaryNgramIndex {
+public:
+    // Types
+    using ngram_t = uint32_t;
+
+    // Constants
+    static constexpr size_t cNgramLength{3};
+    static constexpr ngram_t cNgramMask{(ngram_t{1} << (8 * cNgramLength)) - 1};
+
+    // Methods
+    /**
+     * Builds the index over the given entries, replacing any previous contents
+     * @tparam EntryType
+     * @param entries
+     */
+    template <typename EntryType>
+    void build(std::vector<EntryType> const& entries);
+
+    /**
+     * Clears the index and releases its memory
+     */
+    void clear() { m_ngram_to_ids = ngram_to_ids_t{}; }
+
+    /**
+     * Gets the n-grams that any value matching the given wildcard string must contain, i.e., the
+     * n-grams of the wildcard string's literal segments.
+     * @param wildcard_string
+     * @return The sorted and deduplicated n-grams, or an empty vector if the wildcard string has no
+     * literal segment long enough to contain an n-gram
+     */
+    [[nodiscard]] static auto get_ngrams(std::string_view wildcard_string) -> std::vector<ngram_t>;
+
+    /**
+     * @param ngrams N-grams returned by `get_ngrams`, which must not be empty
+     * @return The sorted IDs of the entries that contain every given n-gram
+     */
+    [[nodiscard]] auto get_candidate_ids(std::vector<ngram_t> const& ngrams) const
+            -> std::vector<DictionaryIdType>;
+
+    /**
+     * @return The approximate number of bytes used by the index
+     */
+    [[nodiscard]] auto get_memory_usage() const -> size_t;
+
+private:
+    // Types
+    using ngram_to_ids_t = absl::flat_hash_map<ngram_t, std::vector<DictionaryIdType>>;
+
+    // Methods
+    /**
+     * Appends the n-grams of a literal string to the given vector
+     * @param literal
+     * @param ngrams
+     */
+    static void append_ngrams(std::string_view literal, std::vector<ngram_t>& ngrams);
+
+    // Variables
+    ngram_to_ids_t m_ngram_to_ids;
+};
+
+template <typename DictionaryIdType>
+template <typename EntryType>
+void DictionaryNgramIndex<DictionaryIdType>::build(std::vector<EntryType> const& entries) {
+    m_ngram_to_ids = ngram_to_ids_t{};
+
+    std::vector<ngram_t> ngrams;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        ngrams.clear();
+        append_ngrams(entries[i].get_value(), ngrams);
+        for (auto const ngram : ngrams) {
+            // IDs are added in increasing order, so a repeated n-gram within the same value can
+            // only match the last ID of the list
+            auto& ids = m_ngram_to_ids[ngram];
+            auto const id = static_cast<DictionaryIdType>(i);
+            if (ids.empty() || ids.back() != id) {
+                ids.push_back(id);
+            }
+        }
+    }
+}
+
+template <typename DictionaryIdType>
+auto DictionaryNgramIndex<DictionaryIdType>::get_ngrams(std::string_view wildcard_string)
+        -> std::vector<ngram_t> {
+    std::vector<ngram_t> ngrams;
+    std::string literal;
+    bool is_escaped{false};
+    for (auto const c : wildcard_string) {
+        if (is_escaped) {
+            literal.push_back(c);
+            is_escaped = false;
+        } else if ('\\' == c) {
+            is_escaped = true;
+        } else if ('*' == c || '?' == c) {
+            append_ngrams(literal, ngrams);
+            literal.clear();
+        } else {
+            literal.push_back(c);
+        }
+    }
+    append_ngrams(literal, ngrams);
+
+    std::sort(ngrams.begin(), ngrams.end());
+    ngrams.erase(std::unique(ngrams.begin(), ngrams.end()), ngrams.end());
+    return ngrams;
+}
+
+template <typename DictionaryIdType>
+auto DictionaryNgramIndex<DictionaryIdType>::get_candidate_ids(
+        std::vector<ngram_t> const& ngrams
+) const -> std::vector<DictionaryIdType> {
+    std::vector<std::vector<DictionaryIdType> const*> id_lists;
+    id_lists.reserve(ngrams.size());
+    for (auto const ngram : ngrams) {
+        auto const it = m_ngram_to_ids.find(ngram);
+        if (m_ngram_to_ids.end() == it) {
+            return {};
+        }
+        id_lists.push_back(&it->second);
+    }
+
+    // Intersect the shortest lists first so that the intermediate results stay small
+    std::sort(id_lists.begin(), id_lists.end(), [](auto const* lhs, auto const* rhs) {
+        return lhs->size() < rhs->size();
+    });
+    std::vector<DictionaryIdType> candidate_ids{*id_lists.front()};
+    std::vector<DictionaryIdType> intersection;
+    for (size_t i = 1; i < id_lists.size() && false == candidate_ids.empty(); ++i) {
+        intersection.clear();
+        std::set_intersection(
+                candidate_ids.cbegin(),
+                candidate_ids.cend(),
+                id_lists[i]->cbegin(),
+                id_lists[i]->cend(),
+                std::back_inserter(intersection)
+        );
+        std::swap(candidate_ids, intersection);
+    }
+    return candidate_ids;
+}
+
+template <typename DictionaryIdType>
+auto DictionaryNgramIndex<DictionaryIdType>::get_memory_usage() const -> size_t {
+    // Each slot of a flat hash map holds a value and one byte of control metadata.
+    size_t memory_usage{
+            m_ngram_to_ids.capacity() * (sizeof(typename ngram_to_ids_t::value_type) + 1)
+    };
+    for (auto const& [ngram, ids] : m_ngram_to_ids) {
+        memory_usage += ids.capacity() * sizeof(DictionaryIdType);
+    }
+    return memory_usage;
+}
+
+template <typename DictionaryIdType>
+void DictionaryNgramIndex<DictionaryIdType>::append_ngrams(
+        std::string_view literal,
+        std::vector<ngram_t>& ngrams
+) {
+    if (literal.size() < cNgramLength) {
+        return;
+    }
+
+    // Lowercase the same way as `string_utils::to_lower` so that the index agrees with
+    // case-insensitive wildcard matching
+    ngram_t ngram{0};
+    for (size_t i = 0; i < literal.size(); ++i) {
+        auto const c = static_cast<ngram_t>(std::tolower(static_cast<unsigned char>(literal[i])));
+        ngram = ((ngram << 8) | c) & cNgramMask;
+        if (i + 1 >= cNgramLength) {
+            ngrams.push_back(ngram);
+        }
+    }
+}
+}  // namespace clp
+
+#endif  // CLP_DICTIONARYNGRAMINDEX_HPP
@@ -1,17 +1,21 @@
 #ifndef CLP_DICTIONARYREADER_HPP
 #define CLP_DICTIONARYREADER_HPP
 
+#include <cstddef>
 #include <iterator>
+#include <mutex>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
 #include <boost/algorithm/string.hpp>
 #include <string_utils/string_utils.hpp>
 
 #include "dictionary_utils.hpp"
 #include "DictionaryEntry.hpp"
+#include "DictionaryNgramIndex.hpp"
 #include "FileReader.hpp"
 #include "streaming_compression/passthrough/Decompressor.hpp"
 #include "streaming_compression/zstd/Decompressor.hpp"
@@ -85,15 +89,27 @@ public:
      */
     std::string const& get_value(DictionaryIdType id) const;
     /**
-     * Gets the entries matching the given search string
+     * Gets the entries matching the given search string. Lookups use hash indexes of the entries'
+     * values, which are built by the first case-sensitive and case-insensitive lookup respectively
+     * after the entries are read.
      * @param search_string
      * @param ignore_case
      * @return a vector of matching entries, or an empty vector if no entry matches.
      */
     std::vector<EntryType const*>
     get_entry_matching_value(std::string_view search_string, bool ignore_case) const;
+
+    /**
+     * @return The approximate number of bytes used by the indexes built to look up entries by value
+     * or by wildcard string
+     */
+    size_t get_value_index_memory_usage() const;
+
     /**
-     * Gets the entries that match a given wildcard string
+     * Gets the entries that match a given wildcard string. Once more than
+     * `cNumWildcardSearchesBeforeNgramIndexing` searches have had a literal segment long enough to
+     * contain an n-gram, an n-gram index of the entries' values is built and used to narrow the
+     * entries that need to be matched against such wildcard strings.
      * @param wildcard_string
      * @param ignore_case
      * @param entries Set in which to store found entries
@@ -105,12 +121,46 @@ public:
     ) const;
 
 protected:
+    // Constants
+    // Wildcard searches are often one-off, so the n-gram index is only built once it's likely to
+    // pay for itself
+    static constexpr size_t cNumWildcardSearchesBeforeNgramIndexing{1};
+
+    // Types
+    using ngram_index_t = DictionaryNgramIndex<DictionaryIdType>;
+    using value_to_id_t = absl::flat_hash_map<std::string_view, DictionaryIdType>;
+    using uppercase_value_to_ids_t
+            = absl::flat_hash_map<std::string, std::vector<DictionaryIdType>>;
+
     // Methods
     /**
      * Reads a segment's worth of IDs from the segment index
      */
     void read_segment_ids();
 
+    /**
+     * @return The index from each entry's value to its ID, building it if necessary
+     */
+    value_to_id_t const& get_value_index() const;
+
+    /**
+     * @return The index from each uppercased entry value to the IDs of the entries with that value,
+     * building it if necessary
+     */
+    uppercase_value_to_ids_t const& get_uppercase_value_index() const;
+
+    /**
+     * Counts a wildcard search that could use the n-gram index, building the index if enough such
+     * searches have been made.
+     * @return The n-gram index, or nullptr if it hasn't been built yet
+     */
+    ngram_index_t const* get_ngram_index() const;
+
+    /**
+     * Clears the value indexes, which must be done whenever the entries change.
+     */
+    void clear_value_indexes();
+
     // Variables
     bool m_is_open;
     std::unique_ptr<FileReader> m_dictionary_file_reader;
@@ -126,6 +176,17 @@ protected:
 #endif
     size_t m_num_segments_read_from_index;
     std::vector<EntryType> m_entries;
+
+    // The value indexes are built lazily by const lookups, so they're guarded by a mutex. The exact
+    // value index refers to the values stored in `m_entries`.
+    mutable std::mutex m_value_index_mutex;
+    mutable value_to_id_t m_value_to_id;
+    mutable uppercase_value_to_ids_t m_uppercase_value_to_ids;
+    mutable bool m_is_value_index_built{false};
+    mutable bool m_is_uppercase_value_index_built{false};
+    mutable ngram_index_t m_ngram_index;
+    mutable bool m_is_ngram_index_built{false};
+    mutable size_t m_num_ngram_searches{0};
 };
 
 template <typename DictionaryIdType, typename EntryType>
@@ -170,6 +231,7 @@ void DictionaryReader<DictionaryIdType, EntryType>::close() {
 
     m_num_segments_read_from_index = 0;
     m_entries.clear();
+    clear_value_indexes();
 
     m_is_open = false;
 }
@@ -190,6 +252,7 @@ void DictionaryReader<DictionaryIdType, EntryType>::read_new_entries() {
 
     // Read new dictionary entries
     if (num_dictionary_entries > m_entries.size()) {
+        clear_value_indexes();
         auto prev_num_dictionary_entries = m_entries.size();
         m_entries.resize(num_dictionary_entries);
 
@@ -246,44 +309,144 @@ DictionaryReader<DictionaryIdType, EntryType>::get_entry_matching_value(
 ) const {
     if (false == ignore_case) {
         // In case-sensitive match, there can be only one matched entry.
-        if (auto const it = std::ranges::find_if(
-                    m_entries,
-                    [&](auto const& entry) { return entry.get_value() == search_string; }
-            );
-            m_entries.cend() != it)
-        {
-            return {&(*it)};
+        auto const& value_to_id = get_value_index();
+        if (auto const it = value_to_id.find(search_string); value_to_id.cend() != it) {
+            return {&m_entries[it->second]};
         }
         return {};
     }
 
-    std::vector<EntryType const*> entries;
     std::string search_string_uppercase;
     std::ignore = boost::algorithm::to_upper_copy(
             std::back_inserter(search_string_uppercase),
             search_string
     );
-    for (auto const& entry : m_entries) {
-        if (boost::algorithm::to_upper_copy(entry.get_value()) == search_string_uppercase) {
-            entries.push_back(&entry);
-        }
+    auto const& uppercase_value_to_ids = get_uppercase_value_index();
+    auto const it = uppercase_value_to_ids.find(search_string_uppercase);
+    if (uppercase_value_to_ids.cend() == it) {
+        return {};
+    }
+    std::vector<EntryType const*> entries;
+    entries.reserve(it->second.size());
+    for (auto const id : it->second) {
+        entries.push_back(&m_entries[id]);
     }
     return entries;
 }
 
+template <typename DictionaryIdType, typename EntryType>
+size_t DictionaryReader<DictionaryIdType, EntryType>::get_value_index_memory_usage() const {
+    std::lock_guard<std::mutex> const lock{m_value_index_mutex};
+    // Each slot of a flat hash map holds a value and one byte of control metadata.
+    size_t memory_usage{
+            m_value_to_id.capacity() * (sizeof(typename value_to_id_t::value_type) + 1)
+            + m_uppercase_value_to_ids.capacity()
+                      * (sizeof(typename uppercase_value_to_ids_t::value_type) + 1)
+    };
+    for (auto const& [value, ids] : m_uppercase_value_to_ids) {
+        memory_usage += value.capacity() + ids.capacity() * sizeof(DictionaryIdType);
+    }
+    memory_usage += m_ngram_index.get_memory_usage();
+    return memory_usage;
+}
+
+template <typename DictionaryIdType, typename EntryType>
+auto DictionaryReader<DictionaryIdType, EntryType>::get_value_index() const
+        -> value_to_id_t const& {
+    std::lock_guard<std::mutex> const lock{m_value_index_mutex};
+    if (false == m_is_value_index_built) {
+        m_value_to_id.reserve(m_entries.size());
+        for (size_t i = 0; i < m_entries.size(); ++i) {
+            // Like a linear search, the first entry with a given value is the one that's matched.
+            m_value_to_id.try_emplace(m_entries[i].get_value(), i);
+        }
+        m_is_value_index_built = true;
+    }
+    return m_value_to_id;
+}
+
+template <typename DictionaryIdType, typename EntryType>
+auto DictionaryReader<DictionaryIdType, EntryType>::get_uppercase_value_index() const
+        -> uppercase_value_to_ids_t const& {
+    std::lock_guard<std::mutex> const lock{m_value_index_mutex};
+    if (false == m_is_uppercase_value_index_built) {
+        for (size_t i = 0; i < m_entries.size(); ++i) {
+            m_uppercase_value_to_ids[boost::algorithm::to_upper_copy(m_entries[i].get_value())]
+                    .push_back(i);
+        }
+        m_is_uppercase_value_index_built = true;
+    }
+    return m_uppercase_value_to_ids;
+}
+
+template <typename DictionaryIdType, typename EntryType>
+auto DictionaryReader<DictionaryIdType, EntryType>::get_ngram_index() const
+        -> ngram_index_t const* {
+    std::lock_guard<std::mutex> const lock{m_value_index_mutex};
+    if (false == m_is_ngram_index_built) {
+        if (m_num_ngram_searches < cNumWildcardSearchesBeforeNgramIndexing) {
+            ++m_num_ngram_searches;
+            return nullptr;
+        }
+        m_ngram_index.build(m_entries);
+        m_is_ngram_index_built = true;
+    }
+    return &m_ngram_index;
+}
+
+template <typename DictionaryIdType, typename EntryType>
+void DictionaryReader<DictionaryIdType, EntryType>::clear_value_indexes() {
+    std::lock_guard<std::mutex> const lock{m_value_index_mutex};
+    m_value_to_id = value_to_id_t{};
+    m_uppercase_value_to_ids = uppercase_value_to_ids_t{};
+    m_is_value_index_built = false;
+    m_is_uppercase_value_index_built = false;
+    m_ngram_index.clear();
+    m_is_ngram_index_built = false;
+    m_num_ngram_searches = 0;
+}
+
 template <typename DictionaryIdType, typename EntryType>
 void DictionaryReader<DictionaryIdType, EntryType>::get_entries_matching_wildcard_string(
         std::string_view wildcard_string,
         bool ignore_case,
         std::unordered_set<EntryType const*>& entries
 ) const {
+    // Lowercase the wildcard string once and reuse a buffer for each lowercased value, rather than
+    // letting `wildcard_match_unsafe` allocate lowercase copies of both strings for every entry
+    std::string lowercase_wildcard_string;
+    std::string lowercase_value;
+    if (ignore_case) {
+        lowercase_wildcard_string = wildcard_string;
+        string_utils::to_lower(lowercase_wildcard_string);
+    }
+    auto const matches = [&](std::string const& value) -> bool {
+        if (false == ignore_case) {
+            return string_utils::wildcard_match_unsafe_case_sensitive(value, wildcard_string);
+        }
+        lowercase_value.assign(value);
+        string_utils::to_lower(lowercase_value);
+        return string_utils::wildcard_match_unsafe_case_sensitive(
+                lowercase_value,
+                lowercase_wildcard_string
+        );
+    };
+
+    auto const ngrams = ngram_index_t::get_ngrams(wildcard_string);
+    if (false == ngrams.empty()) {
+        if (auto const* ngram_index = get_ngram_index(); nullptr != ngram_index) {
+            for (auto const id : ngram_index->get_candidate_ids(ngrams)) {
+                auto const& entry = m_entries[id];
+                if (matches(entry.get_value())) {
+                    entries.insert(&entry);
+                }
+            }
+            return;
+        }
+    }
+
     for (auto const& entry : m_entries) {
-        if (string_utils::wildcard_match_unsafe(
-                    entry.get_value(),
-                    wildcard_string,
-                    false == ignore_case
-            ))
-        {
+        if (matches(entry.get_value())) {
             entries.insert(&entry);
         }
     }
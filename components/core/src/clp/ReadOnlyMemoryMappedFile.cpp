@@ -1,7 +1,10 @@
 #include "ReadOnlyMemoryMappedFile.hpp"
 
 #include <sys/mman.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <cstddef>
 #include <string>
 #include <string_view>
 
@@ -38,4 +41,30 @@ ReadOnlyMemoryMappedFile::~ReadOnlyMemoryMappedFile() {
     // invalid arguments.
     munmap(m_data, m_buf_size);
 }
+
+void ReadOnlyMemoryMappedFile::advise(size_t offset, size_t size, AccessPattern access_pattern)
+        const {
+    if (offset >= m_buf_size) {
+        return;
+    }
+
+    int advice{MADV_NORMAL};
+    switch (access_pattern) {
+        case AccessPattern::Sequential:
+            advice = MADV_SEQUENTIAL;
+            break;
+        case AccessPattern::WillNeed:
+            advice = MADV_WILLNEED;
+            break;
+        case AccessPattern::Normal:
+        default:
+            break;
+    }
+
+    // `madvise` requires the start of the range to be page-aligned
+    auto const page_size{static_cast<size_t>(sysconf(_SC_PAGESIZE))};
+    auto const begin{offset - offset % page_size};
+    auto const end{offset + std::min(size, m_buf_size - offset)};
+    madvise(static_cast<char*>(m_data) + begin, end - begin, advice);
+}
 }  // namespace clp
@@ -2,6 +2,7 @@
 #define CLP_READONLYMEMORYMAPPEDFILE_HPP
 
 #include <cstddef>
+#include <cstdint>
 #include <span>
 #include <string>
 #include <string_view>
@@ -18,6 +19,15 @@ namespace clp {
 class ReadOnlyMemoryMappedFile {
 public:
     // Types
+    /**
+     * Hints about how a range of the mapped file will be accessed.
+     */
+    enum class AccessPattern : uint8_t {
+        Normal,
+        Sequential,
+        WillNeed
+    };
+
     class OperationFailed : public TraceableException {
     public:
         OperationFailed(
@@ -57,6 +67,15 @@ public:
         return std::span<char>{static_cast<char*>(m_data), m_buf_size};
     }
 
+    /**
+     * Advises the kernel of how a range of the mapped file will be accessed. Since this is only a
+     * hint, any failure is ignored.
+     * @param offset The offset of the range from the start of the file.
+     * @param size The size of the range, which is clamped to the end of the file.
+     * @param access_pattern
+     */
+    void advise(size_t offset, size_t size, AccessPattern access_pattern) const;
+
 private:
     void* m_data{nullptr};
     size_t m_buf_size{0};
@@ -1,6 +1,9 @@
 #ifndef CLP_STREAMING_ARCHIVE_CONSTANTS_HPP
 #define CLP_STREAMING_ARCHIVE_CONSTANTS_HPP
 
+#include <cstddef>
+#include <cstdint>
+
 #include "../Defs.h"
 
 namespace clp::streaming_archive {
@@ -14,6 +17,23 @@ constexpr char cMetadataFileName[] = "metadata";
 constexpr char cMetadataDBFileName[] = "metadata.db";
 constexpr char cSchemaFileName[] = "schema.txt";
 
+/**
+ * Segments compressed with zstd are made up of independent frames, each holding at most
+ * `MaxFrameSize` uncompressed bytes, followed by a seek table in the zstd seekable format. This
+ * allows any region of a segment to be decompressed without decompressing the data before it.
+ * Since the seek table is stored in a skippable frame, such segments can still be decompressed as
+ * a regular zstd stream.
+ */
+namespace cSeekableSegment {
+constexpr uint64_t MaxFrameSize{1024ULL * 1024};  // 1 MiB
+constexpr uint32_t SkippableFrameMagicNumber{0x184D'2A5E};
+constexpr uint32_t SeekableMagicNumber{0x8F92'EAB1};
+constexpr size_t SkippableFrameHeaderSize{2 * sizeof(uint32_t)};
+constexpr size_t SeekTableEntrySize{2 * sizeof(uint32_t)};
+constexpr size_t SeekTableFooterSize{2 * sizeof(uint32_t) + sizeof(uint8_t)};
+constexpr uint8_t ChecksumFlag{0x80};
+}  // namespace cSeekableSegment
+
 namespace cArchiveFormatVersion {
 constexpr uint8_t VersionMajor{0};
 constexpr uint8_t VersionMinor{1};
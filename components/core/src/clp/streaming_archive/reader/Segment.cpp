@@ -3,8 +3,13 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
 
 #include <boost/filesystem.hpp>
 #include <fmt/format.h>
@@ -24,6 +29,7 @@ Segment::~Segment() {
     // If user forgot to explicitly close the file for some reason, close it again (doesn't
     // hurt)
     close();
+    ZSTD_freeDCtx(m_frame_decompression_context);
 }
 
 ErrorCode Segment::try_open(string const& segment_dir_path, segment_id_t segment_id) {
@@ -67,6 +73,16 @@ ErrorCode Segment::try_open(string const& segment_dir_path, segment_id_t segment
     }
 
     auto const view{m_memory_mapped_segment_file.value().get_view()};
+#if USE_ZSTD_COMPRESSION
+    if (auto const error_code = try_read_seek_table(view); ErrorCode_Success != error_code) {
+        SPDLOG_ERROR(
+                "streaming_archive::reader::Segment: Corrupt seek table in segment {}",
+                segment_path.c_str()
+        );
+        m_memory_mapped_segment_file.reset();
+        return error_code;
+    }
+#endif
     m_decompressor.open(view.data(), view.size());
 
     m_segment_path = segment_path;
@@ -79,6 +95,9 @@ void Segment::close() {
         m_memory_mapped_segment_file.reset();
         m_segment_path.clear();
     }
+    m_frames.clear();
+    m_uncompressed_size = 0;
+    m_buffered_frame_idx.reset();
 }
 
 ErrorCode
@@ -92,10 +111,158 @@ Segment::try_read(uint64_t decompressed_stream_pos, char* extraction_buf, uint64
         );
         return ErrorCode_BadParam;
     }
+    if (is_seekable()) {
+        return try_read_frames(decompressed_stream_pos, extraction_buf, extraction_len);
+    }
     return m_decompressor.get_decompressed_stream_region(
             decompressed_stream_pos,
             extraction_buf,
             extraction_len
     );
 }
+
+ErrorCode Segment::try_read_seek_table(std::span<char const> segment) {
+    auto read_uint32 = [&](size_t pos) -> uint32_t {
+        uint32_t value{};
+        std::memcpy(&value, segment.data() + pos, sizeof(value));
+        return value;
+    };
+
+    // Segments without a seek table, e.g., those written before seek tables were added, are read as
+    // a single stream.
+    constexpr size_t cMinSeekTableSize{
+            cSeekableSegment::SkippableFrameHeaderSize + cSeekableSegment::SeekTableFooterSize
+    };
+    if (segment.size() < cMinSeekTableSize
+        || cSeekableSegment::SeekableMagicNumber != read_uint32(segment.size() - sizeof(uint32_t)))
+    {
+        return ErrorCode_Success;
+    }
+
+    auto const footer_pos = segment.size() - cSeekableSegment::SeekTableFooterSize;
+    uint64_t const num_frames{read_uint32(footer_pos)};
+    auto const descriptor = static_cast<uint8_t>(segment[footer_pos + sizeof(uint32_t)]);
+    size_t const entry_size{
+            cSeekableSegment::SeekTableEntrySize
+            + (0 != (descriptor & cSeekableSegment::ChecksumFlag) ? sizeof(uint32_t) : 0)
+    };
+    auto const seek_table_size = num_frames * entry_size + cSeekableSegment::SeekTableFooterSize;
+    if (segment.size() < seek_table_size + cSeekableSegment::SkippableFrameHeaderSize) {
+        return ErrorCode_Corrupt;
+    }
+    auto const skippable_frame_pos
+            = segment.size() - seek_table_size - cSeekableSegment::SkippableFrameHeaderSize;
+    if (cSeekableSegment::SkippableFrameMagicNumber != read_uint32(skippable_frame_pos)
+        || seek_table_size != read_uint32(skippable_frame_pos + sizeof(uint32_t)))
+    {
+        return ErrorCode_Corrupt;
+    }
+
+    std::vector<Frame> frames;
+    frames.reserve(num_frames);
+    uint64_t compressed_pos{0};
+    uint64_t uncompressed_pos{0};
+    auto entry_pos = skippable_frame_pos + cSeekableSegment::SkippableFrameHeaderSize;
+    for (uint64_t i = 0; i < num_frames; ++i, entry_pos += entry_size) {
+        Frame const frame{
+                compressed_pos,
+                uncompressed_pos,
+                read_uint32(entry_pos),
+                read_uint32(entry_pos + sizeof(uint32_t))
+        };
+        compressed_pos += frame.compressed_size;
+        uncompressed_pos += frame.uncompressed_size;
+        if (compressed_pos > skippable_frame_pos) {
+            return ErrorCode_Corrupt;
+        }
+        // Empty frames can't contain any region, so they're skipped.
+        if (frame.uncompressed_size > 0) {
+            frames.push_back(frame);
+        }
+    }
+
+    m_frames = std::move(frames);
+    m_uncompressed_size = uncompressed_pos;
+    m_buffered_frame_idx.reset();
+    return ErrorCode_Success;
+}
+
+ErrorCode Segment::try_read_frames(
+        uint64_t decompressed_stream_pos,
+        char* extraction_buf,
+        uint64_t extraction_len
+) {
+    if (decompressed_stream_pos > m_uncompressed_size
+        || extraction_len > m_uncompressed_size - decompressed_stream_pos)
+    {
+        return ErrorCode_Truncated;
+    }
+    if (0 == extraction_len) {
+        return ErrorCode_Success;
+    }
+
+    // Find the frame containing the first byte of the region
+    auto const it = std::upper_bound(
+            m_frames.cbegin(),
+            m_frames.cend(),
+            decompressed_stream_pos,
+            [](uint64_t pos, Frame const& frame) { return pos < frame.uncompressed_pos; }
+    );
+    auto frame_idx = static_cast<size_t>(it - m_frames.cbegin()) - 1;
+
+    while (extraction_len > 0) {
+        auto const& frame = m_frames[frame_idx];
+        auto const pos_in_frame = decompressed_stream_pos - frame.uncompressed_pos;
+        auto const len = std::min(extraction_len, frame.uncompressed_size - pos_in_frame);
+        if (m_buffered_frame_idx != frame_idx && len == frame.uncompressed_size) {
+            // The whole frame is needed, so decompress it directly into the output buffer
+            if (auto const error_code = try_decompress_frame(frame_idx, extraction_buf);
+                ErrorCode_Success != error_code)
+            {
+                return error_code;
+            }
+        } else {
+            if (m_buffered_frame_idx != frame_idx) {
+                m_buffered_frame_idx.reset();
+                m_frame_buffer.resize(frame.uncompressed_size);
+                if (auto const error_code = try_decompress_frame(frame_idx, m_frame_buffer.data());
+                    ErrorCode_Success != error_code)
+                {
+                    return error_code;
+                }
+                m_buffered_frame_idx = frame_idx;
+            }
+            std::memcpy(extraction_buf, m_frame_buffer.data() + pos_in_frame, len);
+        }
+
+        decompressed_stream_pos += len;
+        extraction_buf += len;
+        extraction_len -= len;
+        ++frame_idx;
+    }
+    return ErrorCode_Success;
+}
+
+ErrorCode Segment::try_decompress_frame(size_t frame_idx, char* buf) {
+    auto const& frame = m_frames[frame_idx];
+    auto const view{m_memory_mapped_segment_file.value().get_view()};
+    auto const result = ZSTD_decompressDCtx(
+            m_frame_decompression_context,
+            buf,
+            frame.uncompressed_size,
+            view.data() + frame.compressed_pos,
+            frame.compressed_size
+    );
+    if (ZSTD_isError(result)) {
+        SPDLOG_ERROR(
+                "streaming_archive::reader::Segment: ZSTD_decompressDCtx() error: {}",
+                ZSTD_getErrorName(result)
+        );
+        return ErrorCode_Failure;
+    }
+    if (result != frame.uncompressed_size) {
+        return ErrorCode_Failure;
+    }
+    return ErrorCode_Success;
+}
 }  // namespace clp::streaming_archive::reader
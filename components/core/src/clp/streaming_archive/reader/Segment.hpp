@@ -1,9 +1,15 @@
 #ifndef CLP_STREAMING_ARCHIVE_READER_SEGMENT_HPP
 #define CLP_STREAMING_ARCHIVE_READER_SEGMENT_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <vector>
+
+#include <zstd.h>
 
 #include "../../Defs.h"
 #include "../../ErrorCode.hpp"
@@ -15,7 +21,9 @@
 namespace clp::streaming_archive::reader {
 /**
  * Class for reading segments. A segment is a container for multiple compressed buffers that
- * itself may be further compressed and stored on disk.
+ * itself may be further compressed and stored on disk. If a zstd-compressed segment has a seek
+ * table (see `cSeekableSegment`), reads only decompress the frames covering the requested region;
+ * otherwise, the segment is decompressed as a single stream.
  */
 class Segment {
 public:
@@ -25,11 +33,18 @@ public:
     // Destructor
     ~Segment();
 
+    // Delete copy & move constructors and assignment operators
+    Segment(Segment const&) = delete;
+    Segment(Segment&&) = delete;
+    auto operator=(Segment const&) -> Segment& = delete;
+    auto operator=(Segment&&) -> Segment& = delete;
+
     /**
      * Opens a segment with the given ID from the given directory
      * @param segment_dir_path
      * @param segment_id
      * @return ErrorCode_Failure if unable to memory map the segment file
+     * @return ErrorCode_Corrupt if the segment's seek table is corrupt
      * @return ErrorCode_Success on success
      */
     ErrorCode try_open(std::string const& segment_dir_path, segment_id_t segment_id);
@@ -51,10 +66,64 @@ public:
     ErrorCode
     try_read(uint64_t decompressed_stream_pos, char* extraction_buf, uint64_t extraction_len);
 
+    /**
+     * @return Whether the segment has a seek table, allowing regions to be read without
+     * decompressing the data before them
+     */
+    [[nodiscard]] bool is_seekable() const { return false == m_frames.empty(); }
+
 private:
+    // Types
+    struct Frame {
+        uint64_t compressed_pos;
+        uint64_t uncompressed_pos;
+        uint32_t compressed_size;
+        uint32_t uncompressed_size;
+    };
+
+    // Methods
+    /**
+     * Reads the seek table at the end of the segment, if any
+     * @param segment
+     * @return ErrorCode_Corrupt if the seek table is corrupt
+     * @return ErrorCode_Success on success, including if the segment has no seek table
+     */
+    ErrorCode try_read_seek_table(std::span<char const> segment);
+
+    /**
+     * Reads content with the given offset and length into a buffer, decompressing only the frames
+     * that contain it
+     * @param decompressed_stream_pos
+     * @param extraction_buf
+     * @param extraction_len
+     * @return Same as `try_read`
+     */
+    ErrorCode try_read_frames(
+            uint64_t decompressed_stream_pos,
+            char* extraction_buf,
+            uint64_t extraction_len
+    );
+
+    /**
+     * Decompresses the frame with the given index
+     * @param frame_idx
+     * @param buf Buffer with room for the frame's uncompressed contents
+     * @return ErrorCode_Failure if decompression failed
+     * @return ErrorCode_Success on success
+     */
+    ErrorCode try_decompress_frame(size_t frame_idx, char* buf);
+
+    // Variables
     std::string m_segment_path;
     std::optional<ReadOnlyMemoryMappedFile> m_memory_mapped_segment_file;
 
+    std::vector<Frame> m_frames;
+    uint64_t m_uncompressed_size{0};
+    // The most recently decompressed frame, since consecutive reads often fall within one frame
+    std::vector<char> m_frame_buffer;
+    std::optional<size_t> m_buffered_frame_idx;
+    ZSTD_DCtx* m_frame_decompression_context{ZSTD_createDCtx()};
+
 #if USE_PASSTHROUGH_COMPRESSION
     streaming_compression::passthrough::Decompressor m_decompressor;
 #elif USE_ZSTD_COMPRESSION
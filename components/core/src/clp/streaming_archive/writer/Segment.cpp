@@ -2,13 +2,16 @@
 
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <climits>
 #include <cmath>
+#include <cstdint>
 #include <cstring>
 
 #include "../../ErrorCode.hpp"
 #include "../../FileWriter.hpp"
 #include "../../spdlog_with_specializations.hpp"
+#include "../Constants.hpp"
 
 using std::make_unique;
 using std::string;
@@ -39,6 +42,9 @@ void Segment::open(string const& segments_dir_path, segment_id_t id, int compres
 
     m_offset = 0;
     m_compressed_size = 0;
+    m_frame_sizes.clear();
+    m_frame_begin_pos = 0;
+    m_frame_uncompressed_size = 0;
 
     m_file_writer.open(m_segment_path, FileWriter::OpenMode::CREATE_FOR_WRITING);
 #if USE_PASSTHROUGH_COMPRESSION
@@ -51,7 +57,15 @@ void Segment::open(string const& segments_dir_path, segment_id_t id, int compres
 }
 
 void Segment::close() {
+#if USE_ZSTD_COMPRESSION
+    if (m_frame_uncompressed_size > 0) {
+        end_frame();
+    }
+    m_compressor.close();
+    write_seek_table();
+#else
     m_compressor.close();
+#endif
     m_compressed_size = m_file_writer.get_pos();
 
     m_file_writer.flush();
@@ -63,7 +77,24 @@ void Segment::close() {
 
 void Segment::append(char const* buf, uint64_t const buf_len, uint64_t& offset) {
     // Compress
+#if USE_ZSTD_COMPRESSION
+    // Split the buffer across frames so that each frame can be decompressed independently
+    uint64_t num_bytes_compressed{0};
+    while (num_bytes_compressed < buf_len) {
+        auto const num_bytes_to_compress = std::min(
+                buf_len - num_bytes_compressed,
+                cSeekableSegment::MaxFrameSize - m_frame_uncompressed_size
+        );
+        m_compressor.write(buf + num_bytes_compressed, num_bytes_to_compress);
+        num_bytes_compressed += num_bytes_to_compress;
+        m_frame_uncompressed_size += num_bytes_to_compress;
+        if (cSeekableSegment::MaxFrameSize == m_frame_uncompressed_size) {
+            end_frame();
+        }
+    }
+#else
     m_compressor.write(buf, buf_len);
+#endif
 
     // Return offset and update it
     offset = m_offset;
@@ -86,4 +117,39 @@ size_t Segment::get_compressed_size() {
 bool Segment::is_open() const {
     return !m_segment_path.empty();
 }
+
+void Segment::end_frame() {
+    m_compressor.flush();
+    uint64_t const frame_end_pos{m_file_writer.get_pos()};
+    auto const compressed_size = frame_end_pos - m_frame_begin_pos;
+    if (compressed_size > UINT32_MAX) {
+        throw OperationFailed(ErrorCode_OutOfBounds, __FILENAME__, __LINE__);
+    }
+    m_frame_sizes.push_back(
+            {static_cast<uint32_t>(compressed_size),
+             static_cast<uint32_t>(m_frame_uncompressed_size)}
+    );
+    m_frame_begin_pos = frame_end_pos;
+    m_frame_uncompressed_size = 0;
+}
+
+void Segment::write_seek_table() {
+    auto const num_frames = m_frame_sizes.size();
+    auto const seek_table_size = num_frames * cSeekableSegment::SeekTableEntrySize
+                                 + cSeekableSegment::SeekTableFooterSize;
+    if (seek_table_size > UINT32_MAX) {
+        throw OperationFailed(ErrorCode_OutOfBounds, __FILENAME__, __LINE__);
+    }
+
+    m_file_writer.write_numeric_value(cSeekableSegment::SkippableFrameMagicNumber);
+    m_file_writer.write_numeric_value(static_cast<uint32_t>(seek_table_size));
+    for (auto const& frame_size : m_frame_sizes) {
+        m_file_writer.write_numeric_value(frame_size.compressed_size);
+        m_file_writer.write_numeric_value(frame_size.uncompressed_size);
+    }
+    m_file_writer.write_numeric_value(static_cast<uint32_t>(num_frames));
+    // Frames have no checksums
+    m_file_writer.write_numeric_value(uint8_t{0});
+    m_file_writer.write_numeric_value(cSeekableSegment::SeekableMagicNumber);
+}
 }  // namespace clp::streaming_archive::writer
@@ -1,8 +1,10 @@
 #ifndef CLP_STREAMING_ARCHIVE_WRITER_SEGMENT_HPP
 #define CLP_STREAMING_ARCHIVE_WRITER_SEGMENT_HPP
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "../../Defs.h"
 #include "../../ErrorCode.hpp"
@@ -15,7 +17,8 @@
 namespace clp::streaming_archive::writer {
 /**
  * Class for writing segments. A segment is a container for multiple compressed buffers that
- * itself may be further compressed and then stored on disk.
+ * itself may be further compressed and then stored on disk. Segments compressed with zstd are
+ * written as independent frames followed by a seek table (see `cSeekableSegment`).
  */
 class Segment {
 public:
@@ -79,6 +82,23 @@ public:
     size_t get_compressed_size();
 
 private:
+    // Types
+    struct FrameSize {
+        uint32_t compressed_size;
+        uint32_t uncompressed_size;
+    };
+
+    // Methods
+    /**
+     * Ends the current frame and records its size
+     */
+    void end_frame();
+
+    /**
+     * Writes the seek table describing the segment's frames to the end of the segment
+     */
+    void write_seek_table();
+
     // Variables
     std::string m_segment_path;
     segment_id_t m_id;
@@ -87,6 +107,9 @@ private:
     uint64_t m_compressed_size;
 
     FileWriter m_file_writer;
+    std::vector<FrameSize> m_frame_sizes;
+    uint64_t m_frame_begin_pos{0};  // Position of the current frame in the file
+    uint64_t m_frame_uncompressed_size{0};
 #if USE_PASSTHROUGH_COMPRESSION
     streaming_compression::passthrough::Compressor m_compressor;
 #elif USE_ZSTD_COMPRESSION
@@ -0,0 +1,208 @@
+#include "ArchiveMetadataCache.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "DictionaryReader.hpp"
+#include "ReaderUtils.hpp"
+#include "SchemaTree.hpp"
+#include "TimestampDictionaryReader.hpp"
+
+namespace clp_s {
+namespace {
+// An estimate of the bookkeeping overhead of each node of a node-based container
+constexpr size_t cContainerNodeOverhead{4 * sizeof(void*)};
+
+/**
+ * @param schema_tree
+ * @return An estimate of the memory (B) used by the given schema tree
+ */
+auto estimate_memory_usage(SchemaTree const& schema_tree) -> size_t;
+
+/**
+ * @param schema_map
+ * @return An estimate of the memory (B) used by the given schema map
+ */
+auto estimate_memory_usage(ReaderUtils::SchemaMap const& schema_map) -> size_t;
+
+/**
+ * @param timestamp_dictionary
+ * @return An estimate of the memory (B) used by the given timestamp dictionary
+ */
+auto estimate_memory_usage(TimestampDictionaryReader const& timestamp_dictionary) -> size_t;
+
+/**
+ * @tparam DictionaryReaderType
+ * @param dictionary
+ * @return An estimate of the memory (B) used by the given dictionary, including any value indexes
+ * that have already been built
+ */
+template <typename DictionaryReaderType>
+auto estimate_memory_usage(DictionaryReaderType const& dictionary) -> size_t;
+
+/**
+ * @param metadata
+ * @return An estimate of the memory (B) used by the value indexes that have been built for the
+ * given metadata's dictionaries
+ */
+auto estimate_value_index_memory_usage(CachedArchiveMetadata const& metadata) -> size_t;
+
+auto estimate_memory_usage(SchemaTree const& schema_tree) -> size_t {
+    auto const& nodes = schema_tree.get_nodes();
+    size_t memory_usage{sizeof(SchemaTree) + nodes.capacity() * sizeof(SchemaNode)};
+    for (auto const& node : nodes) {
+        memory_usage += node.get_key_name().size()
+                        + node.get_children_ids().capacity() * sizeof(int32_t)
+                        // The tree's map from each node to its ID
+                        + cContainerNodeOverhead + sizeof(std::pair<int32_t, int32_t>);
+    }
+    return memory_usage;
+}
+
+auto estimate_memory_usage(ReaderUtils::SchemaMap const& schema_map) -> size_t {
+    size_t memory_usage{sizeof(ReaderUtils::SchemaMap)};
+    for (auto const& [schema_id, schema] : schema_map) {
+        memory_usage += cContainerNodeOverhead + sizeof(ReaderUtils::SchemaMap::value_type)
+                        + schema.size() * sizeof(int32_t);
+    }
+    return memory_usage;
+}
+
+auto estimate_memory_usage(TimestampDictionaryReader const& timestamp_dictionary) -> size_t {
+    size_t memory_usage{sizeof(TimestampDictionaryReader)};
+    for (auto it = timestamp_dictionary.pattern_begin(); timestamp_dictionary.pattern_end() != it;
+         ++it)
+    {
+        memory_usage += cContainerNodeOverhead + sizeof(*it);
+    }
+    for (auto it = timestamp_dictionary.tokenized_column_to_range_begin();
+         timestamp_dictionary.tokenized_column_to_range_end() != it;
+         ++it)
+    {
+        memory_usage += sizeof(*it) + sizeof(TimestampEntry);
+        for (auto const& token : it->first) {
+            memory_usage += sizeof(token) + token.size();
+        }
+    }
+    return memory_usage;
+}
+
+template <typename DictionaryReaderType>
+auto estimate_memory_usage(DictionaryReaderType const& dictionary) -> size_t {
+    auto const& entries = dictionary.get_entries();
+    size_t memory_usage{
+            sizeof(DictionaryReaderType)
+            + entries.capacity() * sizeof(typename std::decay_t<decltype(entries)>::value_type)
+            + dictionary.get_value_index_memory_usage()
+    };
+    for (auto const& entry : entries) {
+        memory_usage += entry.get_data_size();
+    }
+    return memory_usage;
+}
+
+auto estimate_value_index_memory_usage(CachedArchiveMetadata const& metadata) -> size_t {
+    return metadata.var_dict->get_value_index_memory_usage()
+           + metadata.log_dict->get_value_index_memory_usage()
+           + metadata.array_dict->get_value_index_memory_usage();
+}
+}  // namespace
+
+auto ArchiveMetadataCache::get(std::string_view archive_id)
+        -> std::shared_ptr<CachedArchiveMetadata const> {
+    std::lock_guard const lock{m_mutex};
+    auto const it = m_archive_id_to_entry.find(std::string{archive_id});
+    if (m_archive_id_to_entry.end() == it) {
+        ++m_stats.num_misses;
+        return nullptr;
+    }
+    ++m_stats.num_hits;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->metadata;
+}
+
+void ArchiveMetadataCache::insert(
+        std::string_view archive_id,
+        std::shared_ptr<CachedArchiveMetadata const> metadata
+) {
+    // Estimating the memory usage iterates over every dictionary entry, so it's done before taking
+    // the lock to avoid blocking concurrent lookups
+    auto const memory_usage = estimate_memory_usage(*metadata);
+    auto const value_index_memory_usage = estimate_value_index_memory_usage(*metadata);
+
+    std::lock_guard const lock{m_mutex};
+    if (auto const it = m_archive_id_to_entry.find(std::string{archive_id});
+        m_archive_id_to_entry.end() != it)
+    {
+        erase(it->second);
+    }
+    if (memory_usage > m_max_memory_usage) {
+        return;
+    }
+
+    m_entries.push_front(
+            {std::string{archive_id}, std::move(metadata), memory_usage, value_index_memory_usage}
+    );
+    m_archive_id_to_entry.emplace(m_entries.front().archive_id, m_entries.begin());
+    m_stats.memory_usage += memory_usage;
+    ++m_stats.num_archives;
+
+    evict();
+}
+
+void ArchiveMetadataCache::update_memory_usage(
+        std::string_view archive_id,
+        CachedArchiveMetadata const& metadata
+) {
+    auto const value_index_memory_usage = estimate_value_index_memory_usage(metadata);
+
+    std::lock_guard const lock{m_mutex};
+    auto const it = m_archive_id_to_entry.find(std::string{archive_id});
+    if (m_archive_id_to_entry.end() == it || it->second->metadata.get() != &metadata) {
+        return;
+    }
+    auto& entry = *it->second;
+    m_stats.memory_usage -= entry.memory_usage;
+    entry.memory_usage
+            = entry.memory_usage - entry.value_index_memory_usage + value_index_memory_usage;
+    entry.value_index_memory_usage = value_index_memory_usage;
+    m_stats.memory_usage += entry.memory_usage;
+
+    evict();
+}
+
+auto ArchiveMetadataCache::get_stats() const -> Stats {
+    std::lock_guard const lock{m_mutex};
+    return m_stats;
+}
+
+auto ArchiveMetadataCache::estimate_memory_usage(CachedArchiveMetadata const& metadata) -> size_t {
+    return sizeof(CachedArchiveMetadata) + clp_s::estimate_memory_usage(*metadata.schema_tree)
+           + clp_s::estimate_memory_usage(*metadata.schema_map)
+           + clp_s::estimate_memory_usage(*metadata.timestamp_dictionary)
+           + clp_s::estimate_memory_usage(*metadata.var_dict)
+           + clp_s::estimate_memory_usage(*metadata.log_dict)
+           + clp_s::estimate_memory_usage(*metadata.array_dict);
+}
+
+void ArchiveMetadataCache::erase(std::list<Entry>::iterator it) {
+    m_stats.memory_usage -= it->memory_usage;
+    --m_stats.num_archives;
+    m_archive_id_to_entry.erase(it->archive_id);
+    m_entries.erase(it);
+}
+
+void ArchiveMetadataCache::evict() {
+    while (m_stats.memory_usage > m_max_memory_usage) {
+        erase(std::prev(m_entries.end()));
+        ++m_stats.num_evictions;
+    }
+}
+}  // namespace clp_s
@@ -0,0 +1,127 @@
+#ifndef CLP_S_ARCHIVEMETADATACACHE_HPP
+#define CLP_S_ARCHIVEMETADATACACHE_HPP
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "DictionaryReader.hpp"
+#include "ReaderUtils.hpp"
+#include "SchemaTree.hpp"
+#include "TimestampDictionaryReader.hpp"
+
+namespace clp_s {
+/**
+ * The metadata of an archive that's decoded when the archive is opened. The metadata is never
+ * modified once it's decoded, so it can be shared by every search of the archive.
+ *
+ * NOTE: The dictionaries are fully read, so they mustn't be read again, and their entries are all
+ * decoded, so searches never decode them lazily.
+ */
+struct CachedArchiveMetadata {
+    std::shared_ptr<SchemaTree> schema_tree;
+    std::shared_ptr<ReaderUtils::SchemaMap> schema_map;
+    std::shared_ptr<TimestampDictionaryReader> timestamp_dictionary;
+    std::shared_ptr<VariableDictionaryReader> var_dict;
+    std::shared_ptr<LogTypeDictionaryReader> log_dict;
+    std::shared_ptr<LogTypeDictionaryReader> array_dict;
+};
+
+/**
+ * Thread-safe LRU cache of the decoded metadata of archives, keyed by archive ID. The cache is
+ * bounded by an estimate of the memory used by the metadata it holds, and evicts the least recently
+ * used archives to stay within that bound.
+ */
+class ArchiveMetadataCache {
+public:
+    // Types
+    struct Stats {
+        size_t num_hits{0};
+        size_t num_misses{0};
+        size_t num_evictions{0};
+        size_t num_archives{0};
+        size_t memory_usage{0};
+    };
+
+    // Constructors
+    /**
+     * @param max_memory_usage The maximum estimated memory (B) used by the cached metadata
+     */
+    explicit ArchiveMetadataCache(size_t max_memory_usage) : m_max_memory_usage{max_memory_usage} {}
+
+    // Methods
+    /**
+     * Gets the metadata of an archive, and marks the archive as the most recently used one.
+     * @param archive_id
+     * @return The metadata, or nullptr if the archive isn't cached
+     */
+    [[nodiscard]] auto get(std::string_view archive_id)
+            -> std::shared_ptr<CachedArchiveMetadata const>;
+
+    /**
+     * Caches the metadata of an archive as the most recently used one, replacing any metadata
+     * already cached for the archive, then evicts the least recently used archives until the cache
+     * is within its bound. Metadata which alone exceeds the bound isn't cached.
+     * @param archive_id
+     * @param metadata
+     */
+    void insert(std::string_view archive_id, std::shared_ptr<CachedArchiveMetadata const> metadata);
+
+    /**
+     * Re-estimates the memory used by the value indexes of an archive's cached dictionaries, which
+     * searches build lazily after the metadata is cached, then evicts the least recently used
+     * archives until the cache is within its bound. Does nothing if the given metadata is no longer
+     * cached for the archive.
+     * @param archive_id
+     * @param metadata The metadata that was searched
+     */
+    void update_memory_usage(std::string_view archive_id, CachedArchiveMetadata const& metadata);
+
+    [[nodiscard]] auto get_stats() const -> Stats;
+
+    /**
+     * @param metadata
+     * @return An estimate of the memory (B) used by the given metadata
+     */
+    [[nodiscard]] static auto estimate_memory_usage(CachedArchiveMetadata const& metadata)
+            -> size_t;
+
+private:
+    // Types
+    struct Entry {
+        std::string archive_id;
+        std::shared_ptr<CachedArchiveMetadata const> metadata;
+        size_t memory_usage;
+        // The part of `memory_usage` used by the dictionaries' value indexes
+        size_t value_index_memory_usage;
+    };
+
+    // Methods
+    /**
+     * Removes an entry from the cache.
+     * @param it
+     */
+    void erase(std::list<Entry>::iterator it);
+
+    /**
+     * Evicts the least recently used archives until the cache is within its bound.
+     */
+    void evict();
+
+    // Variables
+    size_t m_max_memory_usage;
+
+    mutable std::mutex m_mutex;
+    // Ordered from the most to the least recently used archive
+    std::list<Entry> m_entries;
+    absl::flat_hash_map<std::string, std::list<Entry>::iterator> m_archive_id_to_entry;
+    Stats m_stats;
+};
+}  // namespace clp_s
+
+#endif  // CLP_S_ARCHIVEMETADATACACHE_HPP
@@ -1,17 +1,29 @@
 #include "ArchiveReader.hpp"
 
+#include <cstddef>
 #include <filesystem>
+#include <memory>
+#include <numeric>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include "archive_constants.hpp"
+#include "ArchiveMetadataCache.hpp"
 #include "ArchiveReaderAdaptor.hpp"
+#include "BloomFilter.hpp"
 #include "InputConfig.hpp"
 #include "ReaderUtils.hpp"
+#include "SingleFileArchiveDefs.hpp"
 
 using std::string_view;
 
 namespace clp_s {
-void ArchiveReader::open(Path const& archive_path, NetworkAuthOption const& network_auth) {
+void ArchiveReader::open(
+        Path const& archive_path,
+        NetworkAuthOption const& network_auth,
+        bool memory_map
+) {
     if (m_is_open) {
         throw OperationFailed(ErrorCodeNotReady, __FILENAME__, __LINE__);
     }
@@ -21,20 +33,51 @@ void ArchiveReader::open(Path const& archive_path, NetworkAuthOption const& netw
         throw OperationFailed(ErrorCodeBadParam, __FILENAME__, __LINE__);
     }
 
-    m_archive_reader_adaptor = std::make_shared<ArchiveReaderAdaptor>(archive_path, network_auth);
+    std::shared_ptr<CachedArchiveMetadata const> cached_metadata;
+    if (nullptr != m_metadata_cache) {
+        cached_metadata = m_metadata_cache->get(m_archive_id);
+    }
+
+    m_archive_reader_adaptor
+            = std::make_shared<ArchiveReaderAdaptor>(archive_path, network_auth, memory_map);
+    if (nullptr != cached_metadata) {
+        m_archive_reader_adaptor->set_timestamp_dictionary(cached_metadata->timestamp_dictionary);
+    }
 
     if (auto const rc = m_archive_reader_adaptor->load_archive_metadata(); ErrorCodeSuccess != rc) {
         throw OperationFailed(rc, __FILENAME__, __LINE__);
     }
+    auto const archive_version = m_archive_reader_adaptor->get_header().version;
+    m_has_encoded_integer_columns = archive_version >= cEncodedIntegerColumnsArchiveVersion;
+    m_has_encoded_float_columns = archive_version >= cEncodedFloatColumnsArchiveVersion;
+    m_has_encoded_date_string_columns
+            = archive_version >= cEncodedDateStringColumnsArchiveVersion;
+
+    if (nullptr != cached_metadata) {
+        m_cached_metadata = cached_metadata;
+        m_schema_tree = cached_metadata->schema_tree;
+        m_schema_map = cached_metadata->schema_map;
+        m_var_dict = cached_metadata->var_dict;
+        m_log_dict = cached_metadata->log_dict;
+        m_array_dict = cached_metadata->array_dict;
+    } else {
+        // These sections are read by every search, and since they're adjacent, remote archives
+        // fetch them with a single request
+        m_archive_reader_adaptor->prefetch_sections(
+                {constants::cArchiveSchemaTreeFile,
+                 constants::cArchiveSchemaMapFile,
+                 constants::cArchiveTableMetadataFile}
+        );
 
-    m_schema_tree = ReaderUtils::read_schema_tree(*m_archive_reader_adaptor);
-    m_schema_map = ReaderUtils::read_schemas(*m_archive_reader_adaptor);
+        m_schema_tree = ReaderUtils::read_schema_tree(*m_archive_reader_adaptor);
+        m_schema_map = ReaderUtils::read_schemas(*m_archive_reader_adaptor);
 
-    m_log_event_idx_column_id = m_schema_tree->get_metadata_field_id(constants::cLogEventIdxName);
+        m_var_dict = ReaderUtils::get_variable_dictionary_reader();
+        m_log_dict = ReaderUtils::get_log_type_dictionary_reader();
+        m_array_dict = ReaderUtils::get_array_dictionary_reader();
+    }
 
-    m_var_dict = ReaderUtils::get_variable_dictionary_reader(*m_archive_reader_adaptor);
-    m_log_dict = ReaderUtils::get_log_type_dictionary_reader(*m_archive_reader_adaptor);
-    m_array_dict = ReaderUtils::get_array_dictionary_reader(*m_archive_reader_adaptor);
+    m_log_event_idx_column_id = m_schema_tree->get_metadata_field_id(constants::cLogEventIdxName);
 }
 
 void ArchiveReader::read_metadata() {
@@ -54,8 +97,60 @@ void ArchiveReader::read_metadata() {
         throw OperationFailed(error, __FILENAME__, __LINE__);
     }
 
-    if (0 != num_separate_column_schemas) {
-        throw OperationFailed(ErrorCode::ErrorCodeUnsupported, __FILENAME__, __LINE__);
+    std::vector<std::pair<int32_t, SchemaReader::SchemaMetadata>> separate_column_schemas;
+    separate_column_schemas.reserve(num_separate_column_schemas);
+    for (size_t i = 0; i < num_separate_column_schemas; ++i) {
+        int32_t schema_id;
+        uint64_t num_messages;
+        uint64_t first_stream_id;
+        uint64_t num_columns;
+
+        if (auto error = m_table_metadata_decompressor.try_read_numeric_value(schema_id);
+            ErrorCodeSuccess != error)
+        {
+            throw OperationFailed(error, __FILENAME__, __LINE__);
+        }
+
+        if (auto error = m_table_metadata_decompressor.try_read_numeric_value(num_messages);
+            ErrorCodeSuccess != error)
+        {
+            throw OperationFailed(error, __FILENAME__, __LINE__);
+        }
+
+        if (auto error = m_table_metadata_decompressor.try_read_numeric_value(first_stream_id);
+            ErrorCodeSuccess != error)
+        {
+            throw OperationFailed(error, __FILENAME__, __LINE__);
+        }
+
+        if (auto error = m_table_metadata_decompressor.try_read_numeric_value(num_columns);
+            ErrorCodeSuccess != error)
+        {
+            throw OperationFailed(error, __FILENAME__, __LINE__);
+        }
+
+        if (first_stream_id > m_stream_reader.get_num_streams()
+            || num_columns > m_stream_reader.get_num_streams() - first_stream_id)
+        {
+            throw OperationFailed(ErrorCodeCorrupt, __FILENAME__, __LINE__);
+        }
+
+        uint64_t uncompressed_size{0};
+        for (uint64_t stream_id = first_stream_id; stream_id < first_stream_id + num_columns;
+             ++stream_id)
+        {
+            uncompressed_size += m_stream_reader.get_uncompressed_stream_size(stream_id);
+        }
+        separate_column_schemas.emplace_back(
+                schema_id,
+                SchemaReader::SchemaMetadata{
+                        first_stream_id,
+                        0,
+                        num_messages,
+                        uncompressed_size,
+                        num_columns
+                }
+        );
     }
 
     size_t num_schemas;
@@ -120,20 +215,176 @@ void ArchiveReader::read_metadata() {
         prev_schema_id = schema_id;
         m_schema_ids.push_back(schema_id);
     }
-    prev_metadata.uncompressed_size
-            = m_stream_reader.get_uncompressed_stream_size(prev_metadata.stream_id)
-              - prev_metadata.stream_offset;
-    m_id_to_schema_metadata[prev_schema_id] = prev_metadata;
+    if (prev_metadata_initialized) {
+        prev_metadata.uncompressed_size
+                = m_stream_reader.get_uncompressed_stream_size(prev_metadata.stream_id)
+                  - prev_metadata.stream_offset;
+        m_id_to_schema_metadata[prev_schema_id] = prev_metadata;
+    }
+
+    // Tables stored as separate columns always follow the packed tables, so appending them keeps
+    // m_schema_ids in ascending stream order.
+    for (auto const& [schema_id, metadata] : separate_column_schemas) {
+        m_id_to_schema_metadata[schema_id] = metadata;
+        m_schema_ids.push_back(schema_id);
+    }
+
+    // Older archives end before the table timestamp ranges
+    size_t num_timestamp_ranges{0};
+    if (auto error = m_table_metadata_decompressor.try_read_numeric_value(num_timestamp_ranges);
+        ErrorCodeSuccess != error && ErrorCodeEndOfFile != error)
+    {
+        throw OperationFailed(error, __FILENAME__, __LINE__);
+    }
+    for (size_t i = 0; i < num_timestamp_ranges; ++i) {
+        int32_t schema_id;
+        epochtime_t begin_timestamp;
+        epochtime_t end_timestamp;
+
+        if (auto error = m_table_metadata_decompressor.try_read_numeric_value(schema_id);
+            ErrorCodeSuccess != error)
+        {
+            throw OperationFailed(error, __FILENAME__, __LINE__);
+        }
+
+        if (auto error = m_table_metadata_decompressor.try_read_numeric_value(begin_timestamp);
+            ErrorCodeSuccess != error)
+        {
+            throw OperationFailed(error, __FILENAME__, __LINE__);
+        }
+
+        if (auto error = m_table_metadata_decompressor.try_read_numeric_value(end_timestamp);
+            ErrorCodeSuccess != error)
+        {
+            throw OperationFailed(error, __FILENAME__, __LINE__);
+        }
+
+        auto it = m_id_to_schema_metadata.find(schema_id);
+        if (m_id_to_schema_metadata.end() == it) {
+            throw OperationFailed(ErrorCodeCorrupt, __FILENAME__, __LINE__);
+        }
+        it->second.timestamp_range.emplace(begin_timestamp, end_timestamp);
+    }
+
+    // Older archives end before the table column value ranges
+    size_t num_tables_with_value_ranges{0};
+    if (auto error
+        = m_table_metadata_decompressor.try_read_numeric_value(num_tables_with_value_ranges);
+        ErrorCodeSuccess != error && ErrorCodeEndOfFile != error)
+    {
+        throw OperationFailed(error, __FILENAME__, __LINE__);
+    }
+    for (size_t i = 0; i < num_tables_with_value_ranges; ++i) {
+        int32_t schema_id;
+        size_t num_value_ranges;
+
+        if (auto error = m_table_metadata_decompressor.try_read_numeric_value(schema_id);
+            ErrorCodeSuccess != error)
+        {
+            throw OperationFailed(error, __FILENAME__, __LINE__);
+        }
+
+        if (auto error = m_table_metadata_decompressor.try_read_numeric_value(num_value_ranges);
+            ErrorCodeSuccess != error)
+        {
+            throw OperationFailed(error, __FILENAME__, __LINE__);
+        }
+
+        auto it = m_id_to_schema_metadata.find(schema_id);
+        if (m_id_to_schema_metadata.end() == it) {
+            throw OperationFailed(ErrorCodeCorrupt, __FILENAME__, __LINE__);
+        }
+        auto& column_value_ranges = it->second.column_value_ranges;
+        for (size_t j = 0; j < num_value_ranges; ++j) {
+            int32_t column_id;
+            uint8_t value_type;
+
+            if (auto error = m_table_metadata_decompressor.try_read_numeric_value(column_id);
+                ErrorCodeSuccess != error)
+            {
+                throw OperationFailed(error, __FILENAME__, __LINE__);
+            }
+
+            if (auto error = m_table_metadata_decompressor.try_read_numeric_value(value_type);
+                ErrorCodeSuccess != error)
+            {
+                throw OperationFailed(error, __FILENAME__, __LINE__);
+            }
+
+            if (0 == value_type) {
+                column_value_ranges.emplace(column_id, read_value_range<int64_t>());
+            } else if (1 == value_type) {
+                column_value_ranges.emplace(column_id, read_value_range<double>());
+            } else {
+                throw OperationFailed(ErrorCodeCorrupt, __FILENAME__, __LINE__);
+            }
+        }
+    }
+
+    // Older archives end before the table dictionary ID filters
+    size_t num_tables_with_filters{0};
+    if (auto error = m_table_metadata_decompressor.try_read_numeric_value(num_tables_with_filters);
+        ErrorCodeSuccess != error && ErrorCodeEndOfFile != error)
+    {
+        throw OperationFailed(error, __FILENAME__, __LINE__);
+    }
+    for (size_t i = 0; i < num_tables_with_filters; ++i) {
+        int32_t schema_id;
+        size_t num_filters;
+
+        if (auto error = m_table_metadata_decompressor.try_read_numeric_value(schema_id);
+            ErrorCodeSuccess != error)
+        {
+            throw OperationFailed(error, __FILENAME__, __LINE__);
+        }
+
+        if (auto error = m_table_metadata_decompressor.try_read_numeric_value(num_filters);
+            ErrorCodeSuccess != error)
+        {
+            throw OperationFailed(error, __FILENAME__, __LINE__);
+        }
+
+        auto it = m_id_to_schema_metadata.find(schema_id);
+        if (m_id_to_schema_metadata.end() == it) {
+            throw OperationFailed(ErrorCodeCorrupt, __FILENAME__, __LINE__);
+        }
+        auto& dictionary_id_filters = it->second.dictionary_id_filters;
+        for (size_t j = 0; j < num_filters; ++j) {
+            int32_t column_id;
+            BloomFilter filter;
+
+            if (auto error = m_table_metadata_decompressor.try_read_numeric_value(column_id);
+                ErrorCodeSuccess != error)
+            {
+                throw OperationFailed(error, __FILENAME__, __LINE__);
+            }
+
+            if (auto error = filter.try_read_from_file(m_table_metadata_decompressor);
+                ErrorCodeSuccess != error)
+            {
+                throw OperationFailed(error, __FILENAME__, __LINE__);
+            }
+            dictionary_id_filters.emplace(column_id, std::move(filter));
+        }
+    }
     m_table_metadata_decompressor.close();
 
     m_archive_reader_adaptor->checkin_reader_for_section(constants::cArchiveTableMetadataFile);
+
+    // The dictionaries follow the table metadata in single-file archives, so this is the earliest
+    // point at which they can be read without seeking backwards
+    if (nullptr != m_metadata_cache && nullptr == m_cached_metadata) {
+        cache_metadata();
+    }
 }
 
 void ArchiveReader::read_dictionaries_and_metadata() {
     read_metadata();
-    m_var_dict->read_entries();
-    m_log_dict->read_entries();
-    m_array_dict->read_entries();
+    if (nullptr == m_cached_metadata) {
+        m_var_dict->read_entries(*m_archive_reader_adaptor);
+        m_log_dict->read_entries(*m_archive_reader_adaptor);
+        m_array_dict->read_entries(*m_archive_reader_adaptor);
+    }
 }
 
 void ArchiveReader::open_packed_streams() {
@@ -143,7 +394,8 @@ void ArchiveReader::open_packed_streams() {
 SchemaReader& ArchiveReader::read_schema_table(
         int32_t schema_id,
         bool should_extract_timestamp,
-        bool should_marshal_records
+        bool should_marshal_records,
+        FilterClass* filter
 ) {
     if (m_id_to_schema_metadata.count(schema_id) == 0) {
         throw OperationFailed(ErrorCodeFileNotFound, __FILENAME__, __LINE__);
@@ -157,26 +409,82 @@ SchemaReader& ArchiveReader::read_schema_table(
     );
 
     auto& schema_metadata = m_id_to_schema_metadata[schema_id];
+    if (0 != schema_metadata.num_column_streams) {
+        load_separate_columns(m_schema_reader, schema_metadata, filter);
+        return m_schema_reader;
+    }
     auto stream_buffer = read_stream(schema_metadata.stream_id, true);
     m_schema_reader
             .load(stream_buffer, schema_metadata.stream_offset, schema_metadata.uncompressed_size);
     return m_schema_reader;
 }
 
+std::unique_ptr<SchemaReader> ArchiveReader::create_schema_reader(
+        int32_t schema_id,
+        bool should_extract_timestamp,
+        bool should_marshal_records
+) {
+    if (m_id_to_schema_metadata.count(schema_id) == 0) {
+        throw OperationFailed(ErrorCodeFileNotFound, __FILENAME__, __LINE__);
+    }
+
+    auto reader = std::make_unique<SchemaReader>();
+    initialize_schema_reader(*reader, schema_id, should_extract_timestamp, should_marshal_records);
+    return reader;
+}
+
+std::vector<size_t> ArchiveReader::get_schema_table_stream_ids(
+        int32_t schema_id,
+        bool should_extract_timestamp,
+        bool should_marshal_records,
+        FilterClass* filter
+) {
+    auto const& schema_metadata = get_schema_metadata(schema_id);
+    if (0 == schema_metadata.num_column_streams) {
+        return {schema_metadata.stream_id};
+    }
+
+    auto const reader
+            = create_schema_reader(schema_id, should_extract_timestamp, should_marshal_records);
+    if (reader->get_column_size() != schema_metadata.num_column_streams) {
+        throw OperationFailed(ErrorCodeCorrupt, __FILENAME__, __LINE__);
+    }
+    std::vector<size_t> stream_ids;
+    for (size_t column_idx = 0; column_idx < schema_metadata.num_column_streams; ++column_idx) {
+        if (reader->is_column_required(column_idx, filter)) {
+            stream_ids.push_back(schema_metadata.stream_id + column_idx);
+        }
+    }
+    return stream_ids;
+}
+
+std::unique_ptr<SchemaReader> ArchiveReader::read_schema_table_into_new_reader(
+        int32_t schema_id,
+        bool should_extract_timestamp,
+        bool should_marshal_records
+) {
+    auto schema_reader
+            = create_schema_reader(schema_id, should_extract_timestamp, should_marshal_records);
+    auto& schema_metadata = m_id_to_schema_metadata[schema_id];
+    if (0 != schema_metadata.num_column_streams) {
+        load_separate_columns(*schema_reader, schema_metadata, nullptr);
+        return schema_reader;
+    }
+    auto stream_buffer = read_stream(schema_metadata.stream_id, false);
+    schema_reader->load(
+            stream_buffer,
+            schema_metadata.stream_offset,
+            schema_metadata.uncompressed_size
+    );
+    return schema_reader;
+}
+
 std::vector<std::shared_ptr<SchemaReader>> ArchiveReader::read_all_tables() {
     std::vector<std::shared_ptr<SchemaReader>> readers;
     readers.reserve(m_id_to_schema_metadata.size());
+    prefetch_all_streams();
     for (auto schema_id : m_schema_ids) {
-        auto schema_reader = std::make_shared<SchemaReader>();
-        initialize_schema_reader(*schema_reader, schema_id, true, true);
-        auto& schema_metadata = m_id_to_schema_metadata[schema_id];
-        auto stream_buffer = read_stream(schema_metadata.stream_id, false);
-        schema_reader->load(
-                stream_buffer,
-                schema_metadata.stream_offset,
-                schema_metadata.uncompressed_size
-        );
-        readers.push_back(std::move(schema_reader));
+        readers.emplace_back(read_schema_table_into_new_reader(schema_id, true, true));
     }
     return readers;
 }
@@ -186,13 +494,16 @@ BaseColumnReader* ArchiveReader::append_reader_column(SchemaReader& reader, int3
     auto const& node = m_schema_tree->get_node(column_id);
     switch (node.get_type()) {
         case NodeType::Integer:
-            column_reader = new Int64ColumnReader(column_id);
+            column_reader = new Int64ColumnReader(column_id, m_has_encoded_integer_columns);
             break;
         case NodeType::DeltaInteger:
-            column_reader = new DeltaEncodedInt64ColumnReader(column_id);
+            column_reader = new DeltaEncodedInt64ColumnReader(
+                    column_id,
+                    m_has_encoded_integer_columns
+            );
             break;
         case NodeType::Float:
-            column_reader = new FloatColumnReader(column_id);
+            column_reader = new FloatColumnReader(column_id, m_has_encoded_float_columns);
             break;
         case NodeType::ClpString:
             column_reader = new ClpStringColumnReader(column_id, m_var_dict, m_log_dict);
@@ -207,7 +518,11 @@ BaseColumnReader* ArchiveReader::append_reader_column(SchemaReader& reader, int3
             column_reader = new ClpStringColumnReader(column_id, m_var_dict, m_array_dict, true);
             break;
         case NodeType::DateString:
-            column_reader = new DateStringColumnReader(column_id, get_timestamp_dictionary());
+            column_reader = new DateStringColumnReader(
+                    column_id,
+                    get_timestamp_dictionary(),
+                    m_has_encoded_date_string_columns
+            );
             break;
         // No need to push columns without associated object readers into the SchemaReader.
         case NodeType::Metadata:
@@ -239,13 +554,16 @@ void ArchiveReader::append_unordered_reader_columns(
         auto const& node = m_schema_tree->get_node(column_id);
         switch (node.get_type()) {
             case NodeType::Integer:
-                column_reader = new Int64ColumnReader(column_id);
+                column_reader = new Int64ColumnReader(column_id, m_has_encoded_integer_columns);
                 break;
             case NodeType::DeltaInteger:
-                column_reader = new DeltaEncodedInt64ColumnReader(column_id);
+                column_reader = new DeltaEncodedInt64ColumnReader(
+                        column_id,
+                        m_has_encoded_integer_columns
+                );
                 break;
             case NodeType::Float:
-                column_reader = new FloatColumnReader(column_id);
+                column_reader = new FloatColumnReader(column_id, m_has_encoded_float_columns);
                 break;
             case NodeType::ClpString:
                 column_reader = new ClpStringColumnReader(column_id, m_var_dict, m_log_dict);
@@ -343,6 +661,7 @@ void ArchiveReader::initialize_schema_reader(
 
 void ArchiveReader::store(FileWriter& writer) {
     std::string message;
+    prefetch_all_streams();
     for (auto schema_id : m_schema_ids) {
         auto& schema_reader = read_schema_table(schema_id, false, true);
         while (schema_reader.get_next_message(message)) {
@@ -357,9 +676,19 @@ void ArchiveReader::close() {
     }
     m_is_open = false;
 
-    m_var_dict->close();
-    m_log_dict->close();
-    m_array_dict->close();
+    if (nullptr != m_cached_metadata) {
+        // The search may have built value indexes for the dictionaries, which are shared with
+        // other searches, so they're only released
+        m_metadata_cache->update_memory_usage(m_archive_id, *m_cached_metadata);
+        m_var_dict.reset();
+        m_log_dict.reset();
+        m_array_dict.reset();
+        m_cached_metadata.reset();
+    } else {
+        m_var_dict->close();
+        m_log_dict->close();
+        m_array_dict->close();
+    }
 
     m_stream_reader.close();
     m_archive_reader_adaptor.reset();
@@ -372,6 +701,53 @@ void ArchiveReader::close() {
     m_log_event_idx_column_id = -1;
 }
 
+void ArchiveReader::load_separate_columns(
+        SchemaReader& reader,
+        SchemaReader::SchemaMetadata const& schema_metadata,
+        FilterClass* filter
+) {
+    if (reader.get_column_size() != schema_metadata.num_column_streams) {
+        throw OperationFailed(ErrorCodeCorrupt, __FILENAME__, __LINE__);
+    }
+
+    for (size_t column_idx = 0; column_idx < schema_metadata.num_column_streams; ++column_idx) {
+        if (false == reader.is_column_required(column_idx, filter)) {
+            continue;
+        }
+        auto const stream_id = schema_metadata.stream_id + column_idx;
+        auto column_buffer = read_stream(stream_id, false);
+        reader.load_column(
+                column_idx,
+                column_buffer,
+                m_stream_reader.get_uncompressed_stream_size(stream_id)
+        );
+    }
+}
+
+void ArchiveReader::cache_metadata() {
+    // Entries are decoded up front since searches sharing the dictionaries can't decode them
+    // lazily
+    m_var_dict->read_entries(*m_archive_reader_adaptor);
+    m_log_dict->read_entries(*m_archive_reader_adaptor);
+    m_array_dict->read_entries(*m_archive_reader_adaptor);
+
+    m_cached_metadata = std::make_shared<CachedArchiveMetadata const>(CachedArchiveMetadata{
+            .schema_tree = m_schema_tree,
+            .schema_map = m_schema_map,
+            .timestamp_dictionary = m_archive_reader_adaptor->get_timestamp_dictionary(),
+            .var_dict = m_var_dict,
+            .log_dict = m_log_dict,
+            .array_dict = m_array_dict
+    });
+    m_metadata_cache->insert(m_archive_id, m_cached_metadata);
+}
+
+void ArchiveReader::prefetch_all_streams(size_t num_threads, size_t max_num_prefetched_streams) {
+    std::vector<size_t> stream_ids(m_stream_reader.get_num_streams());
+    std::iota(stream_ids.begin(), stream_ids.end(), 0ULL);
+    prefetch_streams(std::move(stream_ids), num_threads, max_num_prefetched_streams);
+}
+
 std::shared_ptr<char[]> ArchiveReader::read_stream(size_t stream_id, bool reuse_buffer) {
     if (nullptr != m_stream_buffer && m_cur_stream_id == stream_id) {
         return m_stream_buffer;
@@ -2,11 +2,15 @@
 #define CLP_S_ARCHIVEREADER_HPP
 
 #include <map>
+#include <memory>
+#include <optional>
 #include <set>
 #include <span>
 #include <string_view>
 #include <utility>
+#include <vector>
 
+#include "ArchiveMetadataCache.hpp"
 #include "ArchiveReaderAdaptor.hpp"
 #include "DictionaryReader.hpp"
 #include "InputConfig.hpp"
@@ -34,8 +38,13 @@ public:
      * Opens an archive for reading.
      * @param archive_path
      * @param network_auth
+     * @param memory_map Whether to memory map the archive if it's on a locally mounted file system
      */
-    void open(Path const& archive_path, NetworkAuthOption const& network_auth);
+    void open(
+            Path const& archive_path,
+            NetworkAuthOption const& network_auth,
+            bool memory_map = false
+    );
 
     /**
      * Reads the dictionaries and metadata.
@@ -53,7 +62,9 @@ public:
      * @return the variable dictionary reader
      */
     std::shared_ptr<VariableDictionaryReader> read_variable_dictionary(bool lazy = false) {
-        m_var_dict->read_entries(lazy);
+        if (nullptr == m_cached_metadata) {
+            m_var_dict->read_entries(*m_archive_reader_adaptor, lazy);
+        }
         return m_var_dict;
     }
 
@@ -63,7 +74,9 @@ public:
      * @return the log type dictionary reader
      */
     std::shared_ptr<LogTypeDictionaryReader> read_log_type_dictionary(bool lazy = false) {
-        m_log_dict->read_entries(lazy);
+        if (nullptr == m_cached_metadata) {
+            m_log_dict->read_entries(*m_archive_reader_adaptor, lazy);
+        }
         return m_log_dict;
     }
 
@@ -73,7 +86,9 @@ public:
      * @return the array dictionary reader
      */
     std::shared_ptr<LogTypeDictionaryReader> read_array_dictionary(bool lazy = false) {
-        m_array_dict->read_entries(lazy);
+        if (nullptr == m_cached_metadata) {
+            m_array_dict->read_entries(*m_archive_reader_adaptor, lazy);
+        }
         return m_array_dict;
     }
 
@@ -84,12 +99,119 @@ public:
 
     /**
      * Reads a table from the archive.
+     *
+     * For tables stored as separate columns, only the columns needed to apply `filter` and marshal
+     * the records are decompressed.
      * @param schema_id
      * @param should_extract_timestamp
      * @param should_marshal_records
+     * @param filter the filter that will be applied to the table, or nullptr if every column may be
+     * accessed
      * @return the schema reader
      */
     SchemaReader& read_schema_table(
+            int32_t schema_id,
+            bool should_extract_timestamp,
+            bool should_marshal_records,
+            FilterClass* filter = nullptr
+    );
+
+    /**
+     * Creates a schema reader for a table without loading the table. Together with
+     * `read_compressed_stream`, this allows a table to be decompressed and loaded on another
+     * thread: the returned reader only shares immutable archive state with this ArchiveReader.
+     * @param schema_id
+     * @param should_extract_timestamp
+     * @param should_marshal_records
+     * @return the schema reader
+     */
+    std::unique_ptr<SchemaReader> create_schema_reader(
+            int32_t schema_id,
+            bool should_extract_timestamp,
+            bool should_marshal_records
+    );
+
+    /**
+     * Reads a stream from the archive without decompressing it. Streams must be read in ascending
+     * order, as with `read_schema_table`.
+     * @param stream_id
+     * @param buffer A buffer that the stream is read into, unless the archive is memory mapped
+     * @return A view of the compressed stream, which can be decompressed with
+     * `PackedStreamReader::decompress_stream`. The view remains valid until `buffer` is modified or
+     * the archive is closed.
+     */
+    auto read_compressed_stream(size_t stream_id, std::vector<char>& buffer)
+            -> std::span<char const> {
+        return m_stream_reader.read_compressed_stream(stream_id, buffer);
+    }
+
+    [[nodiscard]] size_t get_uncompressed_stream_size(size_t stream_id) const {
+        return m_stream_reader.get_uncompressed_stream_size(stream_id);
+    }
+
+    /**
+     * @param schema_id
+     * @return the metadata describing where the table for a given schema is stored
+     */
+    [[nodiscard]] SchemaReader::SchemaMetadata const& get_schema_metadata(int32_t schema_id) const {
+        return m_id_to_schema_metadata.at(schema_id);
+    }
+
+    /**
+     * @param schema_id
+     * @param should_extract_timestamp
+     * @param should_marshal_records
+     * @param filter the filter that will be applied to the table, or nullptr if every column may be
+     * accessed
+     * @return the ids of the streams `read_schema_table` reads to load the table for a given
+     * schema with the same arguments, in ascending order
+     */
+    std::vector<size_t> get_schema_table_stream_ids(
+            int32_t schema_id,
+            bool should_extract_timestamp,
+            bool should_marshal_records,
+            FilterClass* filter = nullptr
+    );
+
+    /**
+     * Starts reading ahead and decompressing the given streams in the background, so that
+     * subsequent calls to `read_schema_table` pick up already decompressed streams. Only tables
+     * whose streams are all in `stream_ids` may be read afterwards. See
+     * `PackedStreamReader::enable_prefetching`.
+     * @param stream_ids the streams that will be read, in strictly ascending order
+     * @param num_threads
+     * @param max_num_prefetched_streams
+     */
+    void prefetch_streams(
+            std::vector<size_t> stream_ids,
+            size_t num_threads = PackedStreamReader::cDefaultNumPrefetchThreads,
+            size_t max_num_prefetched_streams = PackedStreamReader::cDefaultMaxNumPrefetchedStreams
+    ) {
+        m_stream_reader
+                .enable_prefetching(std::move(stream_ids), num_threads, max_num_prefetched_streams);
+    }
+
+    /**
+     * Prefetches every stream in the archive, for callers that read every table. See
+     * `prefetch_streams`.
+     * @param num_threads
+     * @param max_num_prefetched_streams
+     */
+    void prefetch_all_streams(
+            size_t num_threads = PackedStreamReader::cDefaultNumPrefetchThreads,
+            size_t max_num_prefetched_streams = PackedStreamReader::cDefaultMaxNumPrefetchedStreams
+    );
+
+    /**
+     * Reads a table from the archive into a new schema reader. Unlike the reader returned by
+     * `read_schema_table`, the reader remains valid once other tables are read, so it can be used
+     * on another thread. Tables must be read in the order given by `get_schema_ids`.
+     * @param schema_id
+     * @param should_extract_timestamp
+     * @param should_marshal_records
+     * @return the schema reader
+     */
+    std::unique_ptr<SchemaReader> read_schema_table_into_new_reader(
             int32_t schema_id,
             bool should_extract_timestamp,
             bool should_marshal_records
@@ -121,6 +243,10 @@ public:
         return m_archive_reader_adaptor->get_range_index();
     }
 
+    auto get_dictionary_summary() const -> std::optional<DictionarySummary> const& {
+        return m_archive_reader_adaptor->get_dictionary_summary();
+    }
+
     /**
      * Writes decoded messages to a file.
      * @param writer
@@ -142,11 +268,30 @@ public:
         m_projection = projection;
     }
 
+    /**
+     * Sets a cache of decoded archive metadata that's shared across searches. Archives whose
+     * metadata is cached are opened without decoding their schema tree, schema map, timestamp
+     * dictionary, or dictionaries. The metadata of any other archive is added to the cache once its
+     * table metadata has been read.
+     * @param metadata_cache
+     */
+    void set_metadata_cache(std::shared_ptr<ArchiveMetadataCache> metadata_cache) {
+        m_metadata_cache = std::move(metadata_cache);
+    }
+
     /**
      * @return true if this archive has log ordering information, and false otherwise.
      */
     bool has_log_order() { return m_log_event_idx_column_id >= 0; }
 
+    /**
+     * @return The ID of the log_event_idx column, or -1 if this archive has no log ordering
+     * information
+     */
+    [[nodiscard]] auto get_log_event_idx_column_id() const -> int32_t {
+        return m_log_event_idx_column_id;
+    }
+
 private:
     /**
      * Initializes a schema reader passed by reference to become a reader for a given schema.
@@ -185,6 +330,47 @@ private:
             bool should_marshal_records
     );
 
+    /**
+     * Loads the columns of a table stored as separate columns into a schema reader, skipping the
+     * columns that aren't required.
+     * @param reader
+     * @param schema_metadata
+     * @param filter
+     */
+    void load_separate_columns(
+            SchemaReader& reader,
+            SchemaReader::SchemaMetadata const& schema_metadata,
+            FilterClass* filter
+    );
+
+    /**
+     * Reads the dictionaries in full and adds the archive's metadata to the metadata cache.
+     */
+    void cache_metadata();
+
+    /**
+     * Reads the minimum and maximum values of a column value range from the table metadata.
+     * @tparam ValueType
+     * @return The value range
+     * @throw OperationFailed if the values can't be read
+     */
+    template <typename ValueType>
+    std::pair<ValueType, ValueType> read_value_range() {
+        ValueType min_value;
+        ValueType max_value;
+        if (auto error = m_table_metadata_decompressor.try_read_numeric_value(min_value);
+            ErrorCodeSuccess != error)
+        {
+            throw OperationFailed(error, __FILENAME__, __LINE__);
+        }
+        if (auto error = m_table_metadata_decompressor.try_read_numeric_value(max_value);
+            ErrorCodeSuccess != error)
+        {
+            throw OperationFailed(error, __FILENAME__, __LINE__);
+        }
+        return {min_value, max_value};
+    }
+
     /**
      * Reads a table with given ID from the packed stream reader. If read_stream is called multiple
      * times in a row for the same stream_id a cached buffer is returned. This function allows the
@@ -203,6 +389,14 @@ private:
     std::shared_ptr<LogTypeDictionaryReader> m_log_dict;
     std::shared_ptr<LogTypeDictionaryReader> m_array_dict;
     std::shared_ptr<ArchiveReaderAdaptor> m_archive_reader_adaptor;
+    std::shared_ptr<ArchiveMetadataCache> m_metadata_cache;
+    // The metadata if it came from, or was added to, the metadata cache. Either way, the
+    // dictionaries have been read in full and may be shared with other searches, so they mustn't be
+    // read again or closed.
+    std::shared_ptr<CachedArchiveMetadata const> m_cached_metadata;
+    bool m_has_encoded_integer_columns{false};
+    bool m_has_encoded_float_columns{false};
+    bool m_has_encoded_date_string_columns{false};
 
     std::shared_ptr<SchemaTree> m_schema_tree;
     std::shared_ptr<ReaderUtils::SchemaMap> m_schema_map;
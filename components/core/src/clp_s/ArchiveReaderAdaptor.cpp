@@ -1,9 +1,13 @@
 #include "ArchiveReaderAdaptor.hpp"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
+#include <exception>
 #include <filesystem>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -14,20 +18,48 @@
 #include <spdlog/spdlog.h>
 
 #include "../clp/BoundedReader.hpp"
+#include "../clp/BufferReader.hpp"
 #include "../clp/FileReader.hpp"
+#include "../clp/ReadOnlyMemoryMappedFile.hpp"
 #include "archive_constants.hpp"
+#include "BloomFilter.hpp"
 #include "InputConfig.hpp"
+#include "NetworkRangeFetcher.hpp"
 #include "RangeIndexWriter.hpp"
 #include "SingleFileArchiveDefs.hpp"
 
 namespace clp_s {
+namespace {
+/**
+ * @param section
+ * @return The expected access pattern of a memory mapped section
+ */
+auto get_section_access_pattern(std::string_view section)
+        -> clp::ReadOnlyMemoryMappedFile::AccessPattern {
+    using AccessPattern = clp::ReadOnlyMemoryMappedFile::AccessPattern;
+    if (constants::cArchiveTablesFile == section) {
+        // Streams are always read in ascending order
+        return AccessPattern::Sequential;
+    }
+    if (constants::cArchiveVarDictFile == section || constants::cArchiveLogDictFile == section
+        || constants::cArchiveArrayDictFile == section)
+    {
+        // Dictionaries are decompressed in full as soon as they're opened
+        return AccessPattern::WillNeed;
+    }
+    return AccessPattern::Normal;
+}
+}  // namespace
+
 ArchiveReaderAdaptor::ArchiveReaderAdaptor(
         Path const& archive_path,
-        NetworkAuthOption const& network_auth
+        NetworkAuthOption const& network_auth,
+        bool memory_map
 )
         : m_archive_path{archive_path},
           m_network_auth{network_auth},
           m_single_file_archive{false},
+          m_memory_map{memory_map && InputSource::Filesystem == archive_path.source},
           m_timestamp_dictionary{std::make_shared<TimestampDictionaryReader>()} {
     if (InputSource::Filesystem != archive_path.source
         || std::filesystem::is_regular_file(archive_path.path))
@@ -75,6 +107,9 @@ ArchiveReaderAdaptor::try_read_archive_file_info(ZstdDecompressor& decompressor,
 
 ErrorCode
 ArchiveReaderAdaptor::try_read_timestamp_dictionary(ZstdDecompressor& decompressor, size_t size) {
+    if (m_is_timestamp_dictionary_preloaded) {
+        return try_read_unknown_metadata_packet(decompressor, size);
+    }
     return m_timestamp_dictionary->read(decompressor);
 }
 
@@ -151,6 +186,29 @@ auto ArchiveReaderAdaptor::try_read_range_index(ZstdDecompressor& decompressor,
     return ErrorCodeSuccess;
 }
 
+auto ArchiveReaderAdaptor::try_read_dictionary_summary(ZstdDecompressor& decompressor, size_t size)
+        -> ErrorCode {
+    DictionarySummary dictionary_summary;
+    if (auto const rc = dictionary_summary.variable_values.try_read_from_file(decompressor);
+        ErrorCodeSuccess != rc)
+    {
+        return rc;
+    }
+    if (auto const rc = dictionary_summary.logtype_values.try_read_from_file(decompressor);
+        ErrorCodeSuccess != rc)
+    {
+        return rc;
+    }
+    if (dictionary_summary.variable_values.get_serialized_size()
+                + dictionary_summary.logtype_values.get_serialized_size()
+        != size)
+    {
+        return ErrorCodeCorrupt;
+    }
+    m_dictionary_summary.emplace(std::move(dictionary_summary));
+    return ErrorCodeSuccess;
+}
+
 auto
 ArchiveReaderAdaptor::try_read_unknown_metadata_packet(ZstdDecompressor& decompressor, size_t size)
         -> ErrorCode {
@@ -159,6 +217,10 @@ ArchiveReaderAdaptor::try_read_unknown_metadata_packet(ZstdDecompressor& decompr
 }
 
 ErrorCode ArchiveReaderAdaptor::load_archive_metadata() {
+    if (InputSource::Network == m_archive_path.source) {
+        return try_load_remote_archive_metadata();
+    }
+
     constexpr size_t cDecompressorFileReadBufferCapacity = 64 * 1024;
     m_reader = try_create_reader_at_header();
     if (nullptr == m_reader) {
@@ -178,6 +240,34 @@ ErrorCode ArchiveReaderAdaptor::load_archive_metadata() {
     return rc;
 }
 
+auto ArchiveReaderAdaptor::try_load_remote_archive_metadata() -> ErrorCode {
+    auto request_url{try_get_request_url(m_archive_path, m_network_auth)};
+    if (false == request_url.has_value()) {
+        return ErrorCodeFileNotFound;
+    }
+    m_range_fetcher = std::make_unique<NetworkRangeFetcher>(std::move(request_url.value()));
+
+    try {
+        auto const header = m_range_fetcher->fetch({{0, sizeof(m_archive_header)}});
+        clp::BufferReader header_reader{header.front().data(), header.front().size()};
+        if (auto const rc = try_read_header(header_reader); ErrorCodeSuccess != rc) {
+            return rc;
+        }
+
+        m_files_section_offset = sizeof(m_archive_header) + m_archive_header.metadata_section_size;
+        auto const metadata_section
+                = m_range_fetcher->fetch({{sizeof(m_archive_header), m_files_section_offset}});
+        ZstdDecompressor decompressor;
+        decompressor.open(metadata_section.front().data(), metadata_section.front().size());
+        auto const rc = try_read_archive_metadata(decompressor);
+        decompressor.close();
+        return rc;
+    } catch (std::exception const& e) {
+        SPDLOG_ERROR("Failed to fetch archive metadata - {}", e.what());
+        return ErrorCodeFailureNetwork;
+    }
+}
+
 ErrorCode ArchiveReaderAdaptor::try_read_header(clp::ReaderInterface& reader) {
     auto const clp_rc = reader.try_read_exact_length(
             reinterpret_cast<char*>(&m_archive_header),
@@ -238,6 +328,9 @@ ErrorCode ArchiveReaderAdaptor::try_read_archive_metadata(ZstdDecompressor& deco
             case ArchiveMetadataPacketType::RangeIndex:
                 rc = try_read_range_index(decompressor, packet_size);
                 break;
+            case ArchiveMetadataPacketType::DictionarySummary:
+                rc = try_read_dictionary_summary(decompressor, packet_size);
+                break;
             default:
                 rc = try_read_unknown_metadata_packet(decompressor, packet_size);
                 break;
@@ -259,6 +352,16 @@ std::shared_ptr<clp::ReaderInterface> ArchiveReaderAdaptor::try_create_reader_at
             SPDLOG_ERROR("Failed to open archive header for reading - {}", e.what());
             return nullptr;
         }
+    } else if (m_memory_map) {
+        try {
+            m_memory_mapped_archive
+                    = std::make_unique<clp::ReadOnlyMemoryMappedFile>(m_archive_path.path);
+        } catch (std::exception const& e) {
+            SPDLOG_ERROR("Failed to memory map archive - {}", e.what());
+            return nullptr;
+        }
+        auto const view{m_memory_mapped_archive->get_view()};
+        return std::make_shared<clp::BufferReader>(view.data(), view.size());
     } else {
         return try_create_reader(m_archive_path, m_network_auth);
     }
@@ -274,34 +377,114 @@ std::unique_ptr<clp::ReaderInterface> ArchiveReaderAdaptor::checkout_reader_for_
     m_current_reader_holder.emplace(section);
     if (m_single_file_archive) {
         return checkout_reader_for_sfa_section(section);
-    } else {
-        return std::make_unique<clp::FileReader>(m_archive_path.path + std::string{section});
     }
+
+    auto const section_path{m_archive_path.path + std::string{section}};
+    if (m_memory_map) {
+        m_memory_mapped_section = std::make_unique<clp::ReadOnlyMemoryMappedFile>(section_path);
+        auto const view{m_memory_mapped_section->get_view()};
+        // Empty files aren't mapped, so they're read through a regular file reader instead
+        if (false == view.empty()) {
+            m_memory_mapped_section->advise(0, view.size(), get_section_access_pattern(section));
+            m_checked_out_section_view.emplace(view);
+            return std::make_unique<clp::BufferReader>(view.data(), view.size());
+        }
+        m_memory_mapped_section.reset();
+    }
+    return std::make_unique<clp::FileReader>(section_path);
 }
 
-std::unique_ptr<clp::ReaderInterface> ArchiveReaderAdaptor::checkout_reader_for_sfa_section(
-        std::string_view section
-) {
+void ArchiveReaderAdaptor::prefetch_sections(std::vector<std::string_view> const& sections) {
+    if (nullptr == m_range_fetcher) {
+        return;
+    }
+
+    std::vector<std::string_view> sections_to_fetch;
+    std::vector<NetworkRangeFetcher::ByteRange> ranges;
+    for (auto const section : sections) {
+        if (m_fetched_sections.contains(section)) {
+            continue;
+        }
+        sections_to_fetch.push_back(section);
+        ranges.push_back(get_sfa_section_range(section));
+    }
+
+    auto contents{m_range_fetcher->fetch(ranges)};
+    for (size_t i{0}; i < sections_to_fetch.size(); ++i) {
+        m_fetched_sections.emplace(std::string{sections_to_fetch[i]}, std::move(contents[i]));
+    }
+}
+
+auto ArchiveReaderAdaptor::read_section_ranges(
+        std::string_view section,
+        std::vector<NetworkRangeFetcher::ByteRange> const& ranges
+) const -> std::vector<std::vector<char>> {
+    if (nullptr == m_range_fetcher) {
+        throw OperationFailed(ErrorCodeNotReady, __FILENAME__, __LINE__);
+    }
+
+    auto const section_range{get_sfa_section_range(section)};
+    auto const section_size{section_range.end - section_range.begin};
+    std::vector<NetworkRangeFetcher::ByteRange> archive_ranges;
+    archive_ranges.reserve(ranges.size());
+    for (auto const& range : ranges) {
+        if (range.begin > range.end || range.end > section_size) {
+            throw OperationFailed(ErrorCodeOutOfBounds, __FILENAME__, __LINE__);
+        }
+        archive_ranges.push_back(NetworkRangeFetcher::ByteRange{
+                .begin = section_range.begin + range.begin,
+                .end = section_range.begin + range.end
+        });
+    }
+    return m_range_fetcher->fetch(archive_ranges);
+}
+
+auto ArchiveReaderAdaptor::get_sfa_section_range(std::string_view section) const
+        -> NetworkRangeFetcher::ByteRange {
     auto it = std::find_if(
-            m_archive_file_info.files.begin(),
-            m_archive_file_info.files.end(),
-            [&](ArchiveFileInfo& info) { return info.n == section; }
+            m_archive_file_info.files.cbegin(),
+            m_archive_file_info.files.cend(),
+            [&](ArchiveFileInfo const& info) { return info.n == section; }
     );
-    if (m_archive_file_info.files.end() == it) {
+    if (m_archive_file_info.files.cend() == it) {
         throw OperationFailed(ErrorCodeBadParam, __FILENAME__, __LINE__);
     }
 
+    size_t const begin{m_files_section_offset + it->o};
+    ++it;
+    size_t end{m_archive_header.compressed_size};
+    if (m_archive_file_info.files.cend() != it) {
+        end = m_files_section_offset + it->o;
+    }
+    if (begin > end) {
+        throw OperationFailed(ErrorCodeCorrupt, __FILENAME__, __LINE__);
+    }
+    return {begin, end};
+}
+
+std::unique_ptr<clp::ReaderInterface> ArchiveReaderAdaptor::checkout_reader_for_sfa_section(
+        std::string_view section
+) {
+    auto const section_range{get_sfa_section_range(section)};
+    if (nullptr != m_range_fetcher) {
+        if (false == m_fetched_sections.contains(section)) {
+            auto contents{m_range_fetcher->fetch({section_range})};
+            m_fetched_sections.emplace(std::string{section}, std::move(contents.front()));
+        }
+        auto const& contents{m_fetched_sections.find(section)->second};
+        if (contents.empty()) {
+            throw OperationFailed(ErrorCodeCorrupt, __FILENAME__, __LINE__);
+        }
+        return std::make_unique<clp::BufferReader>(contents.data(), contents.size());
+    }
+
     size_t curr_pos{};
     if (auto rc = m_reader->try_get_pos(curr_pos); clp::ErrorCode::ErrorCode_Success != rc) {
         throw OperationFailed(ErrorCodeFailure, __FILENAME__, __LINE__);
     }
 
-    size_t file_offset = m_files_section_offset + it->o;
-    ++it;
-    size_t next_file_offset{m_archive_header.compressed_size};
-    if (m_archive_file_info.files.end() != it) {
-        next_file_offset = m_files_section_offset + it->o;
-    }
+    size_t const file_offset{section_range.begin};
+    size_t const next_file_offset{section_range.end};
 
     if (curr_pos > file_offset) {
         throw OperationFailed(ErrorCodeCorrupt, __FILENAME__, __LINE__);
@@ -315,6 +498,17 @@ std::unique_ptr<clp::ReaderInterface> ArchiveReaderAdaptor::checkout_reader_for_
         }
     }
 
+    if (nullptr != m_memory_mapped_archive) {
+        auto const view{m_memory_mapped_archive->get_view()};
+        if (next_file_offset > view.size()) {
+            throw OperationFailed(ErrorCodeCorrupt, __FILENAME__, __LINE__);
+        }
+        auto const section_size{next_file_offset - file_offset};
+        m_memory_mapped_archive
+                ->advise(file_offset, section_size, get_section_access_pattern(section));
+        m_checked_out_section_view.emplace(view.subspan(file_offset, section_size));
+    }
+
     return std::make_unique<clp::BoundedReader>(m_reader.get(), next_file_offset);
 }
 
@@ -328,5 +522,10 @@ void ArchiveReaderAdaptor::checkin_reader_for_section(std::string_view section)
     }
 
     m_current_reader_holder.reset();
+    m_checked_out_section_view.reset();
+    m_memory_mapped_section.reset();
+    if (auto const it{m_fetched_sections.find(section)}; m_fetched_sections.end() != it) {
+        m_fetched_sections.erase(it);
+    }
 }
 }  // namespace clp_s
@@ -2,8 +2,11 @@
 #define CLP_S_ARCHIVEREADERADAPTOR_HPP
 
 #include <cstddef>
+#include <functional>
+#include <map>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -18,7 +21,10 @@
 
 #include "../clp/BoundedReader.hpp"
 #include "../clp/ReaderInterface.hpp"
+#include "../clp/ReadOnlyMemoryMappedFile.hpp"
+#include "BloomFilter.hpp"
 #include "InputConfig.hpp"
+#include "NetworkRangeFetcher.hpp"
 #include "SingleFileArchiveDefs.hpp"
 #include "TimestampDictionaryReader.hpp"
 #include "TraceableException.hpp"
@@ -40,9 +46,25 @@ struct RangeIndexEntry {
     nlohmann::json fields;
 };
 
+/**
+ * DictionarySummary holds filters over the values of an archive's variable and logtype
+ * dictionaries, allowing a search to rule out an archive without reading its dictionaries.
+ */
+struct DictionarySummary {
+    BloomFilter variable_values;
+    BloomFilter logtype_values;
+};
+
 /**
  * ArchiveReaderAdaptor is an adaptor class which helps with reading single and multi-file archives
  * which exist on either S3 or a locally mounted file system.
+ *
+ * Archives on a locally mounted file system can optionally be memory mapped, in which case sections
+ * are read directly from the mapping and a view of the checked out section is available through
+ * `get_checked_out_section_view`.
+ *
+ * Sections of archives on the network are fetched individually with range requests rather than by
+ * streaming the whole archive, so sections can be checked out in any order.
  */
 class ArchiveReaderAdaptor {
 public:
@@ -53,7 +75,17 @@ public:
                 : TraceableException(error_code, filename, line_number) {}
     };
 
-    explicit ArchiveReaderAdaptor(Path const& archive_path, NetworkAuthOption const& network_auth);
+    /**
+     * @param archive_path
+     * @param network_auth
+     * @param memory_map Whether to memory map the archive. Ignored for archives that aren't on a
+     * locally mounted file system.
+     */
+    explicit ArchiveReaderAdaptor(
+            Path const& archive_path,
+            NetworkAuthOption const& network_auth,
+            bool memory_map = false
+    );
 
     /**
      * Loads metadata for an archive including the header and metadata section. This method must be
@@ -70,6 +102,7 @@ public:
      * @return A ReaderInterface opened and pointing to the requested section.
      * @throw OperationFailed if a reader is already checked out, or checking out this section would
      *        force a backwards seek.
+     * @throw NetworkRangeFetcher::OperationFailed if the section couldn't be fetched.
      */
     std::unique_ptr<clp::ReaderInterface> checkout_reader_for_section(std::string_view section);
 
@@ -81,14 +114,83 @@ public:
      */
     void checkin_reader_for_section(std::string_view section);
 
+    /**
+     * @return A view of the memory mapped contents of the section currently checked out, or
+     * std::nullopt if the archive isn't memory mapped or no section is checked out. The view is
+     * only valid until the section is checked back in.
+     */
+    [[nodiscard]] auto get_checked_out_section_view() const
+            -> std::optional<std::span<char const>> {
+        return m_checked_out_section_view;
+    }
+
+    /**
+     * @return Whether sections are fetched with range requests, in which case parts of a section
+     * can be read with `read_section_ranges` without checking out the section.
+     */
+    [[nodiscard]] auto is_fetching_ranges() const -> bool { return nullptr != m_range_fetcher; }
+
+    /**
+     * Fetches several sections with concurrent and coalesced range requests, so that checking them
+     * out later doesn't take a request each. Does nothing unless sections are fetched with range
+     * requests.
+     * @param sections
+     * @throw OperationFailed if a section doesn't exist.
+     * @throw NetworkRangeFetcher::OperationFailed if the sections couldn't be fetched.
+     */
+    void prefetch_sections(std::vector<std::string_view> const& sections);
+
+    /**
+     * Fetches ranges of a section without fetching the rest of the section. This method is
+     * thread-safe and can only be used if sections are fetched with range requests.
+     * @param section
+     * @param ranges Ranges relative to the beginning of the section
+     * @return The contents of each range
+     * @throw OperationFailed if sections aren't fetched with range requests, the section doesn't
+     *        exist, or a range is out of the section's bounds.
+     * @throw NetworkRangeFetcher::OperationFailed if the ranges couldn't be fetched.
+     */
+    [[nodiscard]] auto read_section_ranges(
+            std::string_view section,
+            std::vector<NetworkRangeFetcher::ByteRange> const& ranges
+    ) const -> std::vector<std::vector<char>>;
+
+    /**
+     * @param section
+     * @return The size of a section of a single file archive
+     * @throw OperationFailed if the section doesn't exist.
+     */
+    [[nodiscard]] auto get_sfa_section_size(std::string_view section) const -> size_t {
+        auto const range{get_sfa_section_range(section)};
+        return range.end - range.begin;
+    }
+
     std::shared_ptr<TimestampDictionaryReader> get_timestamp_dictionary() {
         return m_timestamp_dictionary;
     }
 
+    /**
+     * Uses a timestamp dictionary that was already read for this archive, so that the archive's
+     * timestamp dictionary is skipped rather than decoded when loading the archive metadata. This
+     * method must be invoked before `load_archive_metadata`.
+     * @param timestamp_dictionary
+     */
+    void set_timestamp_dictionary(std::shared_ptr<TimestampDictionaryReader> timestamp_dictionary) {
+        m_timestamp_dictionary = std::move(timestamp_dictionary);
+        m_is_timestamp_dictionary_preloaded = true;
+    }
+
     ArchiveHeader const& get_header() const { return m_archive_header; }
 
     std::vector<RangeIndexEntry> const& get_range_index() const { return m_range_index; }
 
+    /**
+     * @return The archive's dictionary summary, or std::nullopt if the archive doesn't have one
+     */
+    std::optional<DictionarySummary> const& get_dictionary_summary() const {
+        return m_dictionary_summary;
+    }
+
 private:
     /**
      * Tries to read an ArchiveFileInfo packet from the archive metadata.
@@ -125,6 +227,14 @@ private:
      */
     auto try_read_range_index(ZstdDecompressor& decompressor, size_t size) -> ErrorCode;
 
+    /**
+     * Tries to read a DictionarySummary packet from the archive metadata.
+     * @param decompressor
+     * @param size The number of decompressed bytes making up the packet.
+     * @return ErrorCodeSuccess on success or the relevant ErrorCode on failure.
+     */
+    auto try_read_dictionary_summary(ZstdDecompressor& decompressor, size_t size) -> ErrorCode;
+
     /**
      * Tries to read an unknown metadata packet from the archive metadata.
      * @param decompressor
@@ -133,6 +243,20 @@ private:
      */
     auto try_read_unknown_metadata_packet(ZstdDecompressor& decompressor, size_t size) -> ErrorCode;
 
+    /**
+     * Loads the header and metadata section of an archive on the network with range requests.
+     * @return ErrorCodeSuccess on success or the relevant ErrorCode on failure.
+     */
+    auto try_load_remote_archive_metadata() -> ErrorCode;
+
+    /**
+     * @param section
+     * @return The range of bytes that a section occupies in the single file archive
+     * @throw OperationFailed if the section doesn't exist in ArchiveFileInfo.
+     */
+    [[nodiscard]] auto get_sfa_section_range(std::string_view section) const
+            -> NetworkRangeFetcher::ByteRange;
+
     /**
      * Tries to create a reader for the archive header.
      * @return A ReaderInterface opened and pointing to the archive header on success.
@@ -168,14 +292,25 @@ private:
     Path m_archive_path{};
     NetworkAuthOption m_network_auth{};
     bool m_single_file_archive{false};
+    bool m_memory_map{false};
     ArchiveFileInfoPacket m_archive_file_info{};
     ArchiveHeader m_archive_header{};
     ArchiveInfoPacket m_archive_info{};
     size_t m_files_section_offset{};
     std::optional<std::string> m_current_reader_holder;
     std::shared_ptr<TimestampDictionaryReader> m_timestamp_dictionary;
+    bool m_is_timestamp_dictionary_preloaded{false};
     std::shared_ptr<clp::ReaderInterface> m_reader;
+    // For memory mapped single file archives, the whole archive is mapped up front, whereas for
+    // multi-file archives each section is mapped while it's checked out.
+    std::unique_ptr<clp::ReadOnlyMemoryMappedFile> m_memory_mapped_archive;
+    std::unique_ptr<clp::ReadOnlyMemoryMappedFile> m_memory_mapped_section;
+    std::optional<std::span<char const>> m_checked_out_section_view;
+    std::unique_ptr<NetworkRangeFetcher> m_range_fetcher;
+    // Sections that have been fetched with range requests but not yet checked in
+    std::map<std::string, std::vector<char>, std::less<>> m_fetched_sections;
     std::vector<RangeIndexEntry> m_range_index;
+    std::optional<DictionarySummary> m_dictionary_summary;
 };
 }  // namespace clp_s
 #endif  // CLP_S_ARCHIVEREADERADAPTOR_HPP
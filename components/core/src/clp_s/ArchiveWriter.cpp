@@ -1,13 +1,25 @@
 #include "ArchiveWriter.hpp"
 
 #include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
 #include <filesystem>
+#include <map>
+#include <mutex>
 #include <sstream>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 #include <spdlog/spdlog.h>
 
 #include "archive_constants.hpp"
+#include "BloomFilter.hpp"
+#include "ColumnValueRange.hpp"
 #include "Defs.hpp"
 #include "SchemaTree.hpp"
 
@@ -18,6 +30,8 @@ void ArchiveWriter::open(ArchiveWriterOption const& option) {
     m_print_archive_stats = option.print_archive_stats;
     m_single_file_archive = option.single_file_archive;
     m_min_table_size = option.min_table_size;
+    m_num_compression_threads = option.num_compression_threads;
+    m_separate_columns_table_size = option.separate_columns_table_size;
     m_archives_dir = option.archives_dir;
     m_authoritative_timestamp = option.authoritative_timestamp;
     m_authoritative_timestamp_namespace = option.authoritative_timestamp_namespace;
@@ -63,6 +77,8 @@ auto ArchiveWriter::close(bool is_split) -> ArchiveStats {
             throw OperationFailed(rc, __FILENAME__, __LINE__);
         }
     }
+    m_var_dict_summary = m_var_dict->get_value_filter();
+    m_log_dict_summary = m_log_dict->get_value_filter();
     auto var_dict_compressed_size = m_var_dict->close();
     auto log_dict_compressed_size = m_log_dict->close();
     auto array_dict_compressed_size = m_array_dict->close();
@@ -125,6 +141,8 @@ auto ArchiveWriter::close(bool is_split) -> ArchiveStats {
     m_schema_tree.clear();
     m_schema_map.clear();
     m_timestamp_dict.clear();
+    m_var_dict_summary = BloomFilter{};
+    m_log_dict_summary = BloomFilter{};
     m_encoded_message_size = 0UL;
     m_uncompressed_size = 0UL;
     m_compressed_size = 0UL;
@@ -169,7 +187,7 @@ auto ArchiveWriter::write_archive_metadata(
     if (false == m_range_index_writer.empty()) {
         ++num_optional_packets;
     }
-    uint8_t const num_constant_packets{3U};
+    uint8_t const num_constant_packets{4U};
     compressor.write_numeric_value<uint8_t>(num_constant_packets + num_optional_packets);
 
     // Write archive info
@@ -197,6 +215,14 @@ auto ArchiveWriter::write_archive_metadata(
     compressor.write_numeric_value(static_cast<uint32_t>(encoded_timestamp_dict.size()));
     compressor.write(encoded_timestamp_dict.data(), encoded_timestamp_dict.size());
 
+    // Write dictionary summary
+    compressor.write_numeric_value(ArchiveMetadataPacketType::DictionarySummary);
+    auto const dictionary_summary_size
+            = m_var_dict_summary.get_serialized_size() + m_log_dict_summary.get_serialized_size();
+    compressor.write_numeric_value(static_cast<uint32_t>(dictionary_summary_size));
+    m_var_dict_summary.write_to_file(compressor);
+    m_log_dict_summary.write_to_file(compressor);
+
     // Write range index
     nlohmann::json archive_range_index;
     if (auto rc = m_range_index_writer.write(compressor, archive_range_index);
@@ -266,6 +292,9 @@ ArchiveWriter::append_message(int32_t schema_id, Schema const& schema, ParsedMes
     }
 
     m_encoded_message_size += schema_writer->append_message(message);
+    // Readers report a timestamp of 0 for messages without an authoritative timestamp
+    schema_writer->update_timestamp_range(m_message_timestamp.value_or(0));
+    m_message_timestamp.reset();
     ++m_next_log_event_id;
 }
 
@@ -365,6 +394,11 @@ std::pair<size_t, size_t> ArchiveWriter::store_tables() {
      * which compression stream they belong to, the offset into that compression stream where
      * they can be found, and how many messages that schema table contains.
      *
+     * Schema tables whose uncompressed size is at least m_separate_columns_table_size are instead
+     * stored as separate columns: each of their columns gets its own compression stream, so that
+     * readers can decompress only the columns they need. These streams always follow the streams
+     * containing packed schema tables.
+     *
      * Section 1: Compression Streams Metadata
      * - Contains metadata about each compression stream.
      * - Structure:
@@ -373,8 +407,13 @@ std::pair<size_t, size_t> ArchiveWriter::store_tables() {
      *     - Offset into the file: <64-bit integer>
      *     - Uncompressed size: <64-bit integer>
      *   - Number of separate column schemas: <64-bit integer>
-     *     It is always 0 in the current implementation.
-     *   - Undefined section for separate column schemas, reserved for future support.
+     *   - For each separate column schema:
+     *     - Schema ID: <32-bit integer>
+     *     - Number of messages: <64-bit integer>
+     *     - Stream ID of the first column: <64-bit integer>
+     *     - Number of columns: <64-bit integer>
+     *     The columns of the schema are stored in consecutive streams, in the same order as the
+     *     columns of the schema table.
      *
      * Section 2: Schema Tables Metadata
      * - Contains metadata about schema tables associated with each compression stream.
@@ -386,19 +425,87 @@ std::pair<size_t, size_t> ArchiveWriter::store_tables() {
      *     - Schema ID: <32-bit integer>
      *     - Number of messages: <64-bit integer>
      *
+     * Section 3: Schema Table Timestamp Ranges
+     * - Contains the range of timestamps reported for the messages in each schema table, allowing
+     *   searches for the latest results to skip tables that can't contain any of them. Archives
+     *   written without this section can still be read.
+     * - Structure:
+     *   - Number of schema tables: <64-bit integer>
+     *   - For each schema table:
+     *     - Schema ID: <32-bit integer>
+     *     - Begin timestamp: <64-bit integer>
+     *     - End timestamp: <64-bit integer>
+     *
+     * Section 4: Schema Table Column Value Ranges
+     * - Contains the range of values in each integer, float, and date string column of each schema
+     *   table, allowing searches to skip tables whose values can't satisfy a filter. Archives
+     *   written without this section can still be read.
+     * - Structure:
+     *   - Number of schema tables: <64-bit integer>
+     *   - For each schema table:
+     *     - Schema ID: <32-bit integer>
+     *     - Number of columns with a value range: <64-bit integer>
+     *     - For each column:
+     *       - Column ID: <32-bit integer>
+     *       - Value type (0 for integers, 1 for floats): <8-bit integer>
+     *       - Minimum value: <64-bit integer or double>
+     *       - Maximum value: <64-bit integer or double>
+     *
+     * Section 5: Schema Table Dictionary ID Filters
+     * - Contains a Bloom filter over the dictionary IDs in each variable string column and the
+     *   logtype IDs in each clp string column of each schema table, allowing searches for a
+     *   dictionary entry to skip tables that can't contain it. Archives written without this
+     *   section can still be read.
+     * - Structure:
+     *   - Number of schema tables: <64-bit integer>
+     *   - For each schema table:
+     *     - Schema ID: <32-bit integer>
+     *     - Number of columns with a filter: <64-bit integer>
+     *     - For each column:
+     *       - Column ID: <32-bit integer>
+     *       - Number of hash functions: <32-bit integer>
+     *       - Number of 64-bit words in the filter: <64-bit integer>
+     *       - Filter words: <64-bit integer> * number of words
+     *
      * We buffer the first half of the metadata in the "stream_metadata" vector, and the second half
      * of the metadata in the "schema_metadata" vector as we compress the tables. The metadata is
      * flushed once all of the schema tables have been compressed.
      */
     using schema_map_it = decltype(m_id_to_schema_writer)::iterator;
     std::vector<schema_map_it> schemas;
-    std::vector<StreamMetadata> stream_metadata;
+    std::vector<schema_map_it> separate_column_schemas;
     std::vector<SchemaMetadata> schema_metadata;
+    // The schema writers are deleted once their tables are written, so the timestamp ranges,
+    // column value ranges, and dictionary ID filters are collected up front
+    std::vector<std::tuple<int32_t, epochtime_t, epochtime_t>> schema_timestamp_ranges;
+    std::vector<std::pair<int32_t, std::map<int32_t, ColumnValueRange>>> schema_value_ranges;
+    std::vector<std::pair<int32_t, std::map<int32_t, BloomFilter>>> schema_dictionary_id_filters;
 
     schema_metadata.reserve(m_id_to_schema_writer.size());
     schemas.reserve(m_id_to_schema_writer.size());
+    schema_timestamp_ranges.reserve(m_id_to_schema_writer.size());
+    schema_value_ranges.reserve(m_id_to_schema_writer.size());
+    schema_dictionary_id_filters.reserve(m_id_to_schema_writer.size());
     for (auto it = m_id_to_schema_writer.begin(); it != m_id_to_schema_writer.end(); ++it) {
-        schemas.push_back(it);
+        schema_timestamp_ranges.emplace_back(
+                it->first,
+                it->second->get_begin_timestamp(),
+                it->second->get_end_timestamp()
+        );
+        schema_value_ranges.emplace_back(it->first, it->second->get_column_value_ranges());
+        schema_dictionary_id_filters.emplace_back(
+                it->first,
+                it->second->get_column_dictionary_id_filters()
+        );
+        // Tables are laid out by their encoded size
+        it->second->encode_columns();
+        if (0 != m_separate_columns_table_size
+            && it->second->get_total_uncompressed_size() >= m_separate_columns_table_size)
+        {
+            separate_column_schemas.push_back(it);
+        } else {
+            schemas.push_back(it);
+        }
     }
     auto comp = [](schema_map_it const& lhs, schema_map_it const& rhs) -> bool {
         return lhs->second->get_total_uncompressed_size()
@@ -406,44 +513,61 @@ std::pair<size_t, size_t> ArchiveWriter::store_tables() {
     };
     std::sort(schemas.begin(), schemas.end(), comp);
 
-    uint64_t current_stream_offset = 0;
-    uint64_t current_stream_id = 0;
-    uint64_t current_table_file_offset = 0;
-    m_tables_compressor.open(m_tables_file_writer, m_compression_level);
+    // Tables are assigned to packed streams up front so that each stream can be compressed
+    // independently of the others.
+    std::vector<PackedStream> streams;
+    uint64_t current_stream_offset{0};
+    bool start_new_stream{true};
     for (auto it : schemas) {
-        it->second->store(m_tables_compressor);
+        if (start_new_stream) {
+            streams.emplace_back();
+            current_stream_offset = 0;
+            start_new_stream = false;
+        }
         schema_metadata.emplace_back(
-                current_stream_id,
+                streams.size() - 1,
                 current_stream_offset,
                 it->first,
                 it->second->get_num_messages()
         );
+        streams.back().tables.push_back(it->second);
         current_stream_offset += it->second->get_total_uncompressed_size();
-        delete it->second;
 
-        if (current_stream_offset > m_min_table_size || schemas.size() == schema_metadata.size()) {
-            stream_metadata.emplace_back(current_table_file_offset, current_stream_offset);
-            m_tables_compressor.close();
-            current_stream_offset = 0;
-            ++current_stream_id;
-            current_table_file_offset = m_tables_file_writer.get_pos();
+        if (current_stream_offset > m_min_table_size) {
+            start_new_stream = true;
+        }
+    }
 
-            if (schemas.size() != schema_metadata.size()) {
-                m_tables_compressor.open(m_tables_file_writer, m_compression_level);
-            }
+    std::vector<uint64_t> separate_column_schema_first_stream_ids;
+    separate_column_schema_first_stream_ids.reserve(separate_column_schemas.size());
+    for (auto it : separate_column_schemas) {
+        separate_column_schema_first_stream_ids.push_back(streams.size());
+        for (size_t column_idx{0}; column_idx < it->second->get_num_columns(); ++column_idx) {
+            streams.emplace_back(PackedStream{.tables{it->second}, .column_idx{column_idx}});
         }
     }
 
+    auto const stream_metadata = write_packed_streams(streams);
+    for (auto it : separate_column_schemas) {
+        delete it->second;
+    }
+
     m_table_metadata_compressor.write_numeric_value(stream_metadata.size());
     for (auto& stream : stream_metadata) {
         m_table_metadata_compressor.write_numeric_value(stream.file_offset);
         m_table_metadata_compressor.write_numeric_value(stream.uncompressed_size);
     }
 
-    // The current implementation doesn't store large tables as separate columns, so this is always
-    // zero.
-    size_t const num_separate_column_schemas{0};
-    m_table_metadata_compressor.write_numeric_value(num_separate_column_schemas);
+    m_table_metadata_compressor.write_numeric_value(separate_column_schemas.size());
+    for (size_t i{0}; i < separate_column_schemas.size(); ++i) {
+        auto const it = separate_column_schemas[i];
+        m_table_metadata_compressor.write_numeric_value(it->first);
+        m_table_metadata_compressor.write_numeric_value(it->second->get_num_messages());
+        m_table_metadata_compressor.write_numeric_value(separate_column_schema_first_stream_ids[i]);
+        m_table_metadata_compressor.write_numeric_value(
+                static_cast<uint64_t>(it->second->get_num_columns())
+        );
+    }
 
     m_table_metadata_compressor.write_numeric_value(schema_metadata.size());
     for (auto& schema : schema_metadata) {
@@ -452,6 +576,42 @@ std::pair<size_t, size_t> ArchiveWriter::store_tables() {
         m_table_metadata_compressor.write_numeric_value(schema.schema_id);
         m_table_metadata_compressor.write_numeric_value(schema.num_messages);
     }
+
+    m_table_metadata_compressor.write_numeric_value(schema_timestamp_ranges.size());
+    for (auto const& [schema_id, begin_timestamp, end_timestamp] : schema_timestamp_ranges) {
+        m_table_metadata_compressor.write_numeric_value(schema_id);
+        m_table_metadata_compressor.write_numeric_value(begin_timestamp);
+        m_table_metadata_compressor.write_numeric_value(end_timestamp);
+    }
+
+    m_table_metadata_compressor.write_numeric_value(schema_value_ranges.size());
+    for (auto const& [schema_id, column_value_ranges] : schema_value_ranges) {
+        m_table_metadata_compressor.write_numeric_value(schema_id);
+        m_table_metadata_compressor.write_numeric_value(column_value_ranges.size());
+        for (auto const& [column_id, value_range] : column_value_ranges) {
+            m_table_metadata_compressor.write_numeric_value(column_id);
+            m_table_metadata_compressor.write_numeric_value(
+                    static_cast<uint8_t>(value_range.index())
+            );
+            std::visit(
+                    [&](auto const& range) {
+                        m_table_metadata_compressor.write_numeric_value(range.first);
+                        m_table_metadata_compressor.write_numeric_value(range.second);
+                    },
+                    value_range
+            );
+        }
+    }
+
+    m_table_metadata_compressor.write_numeric_value(schema_dictionary_id_filters.size());
+    for (auto const& [schema_id, column_filters] : schema_dictionary_id_filters) {
+        m_table_metadata_compressor.write_numeric_value(schema_id);
+        m_table_metadata_compressor.write_numeric_value(column_filters.size());
+        for (auto const& [column_id, filter] : column_filters) {
+            m_table_metadata_compressor.write_numeric_value(column_id);
+            filter.write_to_file(m_table_metadata_compressor);
+        }
+    }
     m_table_metadata_compressor.close();
 
     auto table_metadata_compressed_size = m_table_metadata_file_writer.get_pos();
@@ -462,4 +622,142 @@ std::pair<size_t, size_t> ArchiveWriter::store_tables() {
 
     return {table_metadata_compressed_size, table_compressed_size};
 }
+
+auto ArchiveWriter::write_packed_streams(std::vector<PackedStream> const& streams)
+        -> std::vector<StreamMetadata> {
+    auto const num_streams{streams.size()};
+    std::vector<StreamMetadata> stream_metadata;
+    stream_metadata.reserve(num_streams);
+    auto store_stream = [&](size_t stream_id, ZstdCompressor& compressor) {
+        auto const& stream = streams[stream_id];
+        if (stream.column_idx.has_value()) {
+            stream.tables.front()->store_column(stream.column_idx.value(), compressor);
+        } else {
+            for (auto* schema_writer : stream.tables) {
+                schema_writer->store(compressor);
+                delete schema_writer;
+            }
+        }
+    };
+
+    auto const num_workers{std::min(m_num_compression_threads, num_streams)};
+    if (num_workers <= 1) {
+        // Without parallel workers, streams are compressed straight into the tables file so that
+        // no compressed stream is buffered in memory
+        ZstdCompressor compressor;
+        for (size_t stream_id{0}; stream_id < num_streams; ++stream_id) {
+            auto const file_offset = m_tables_file_writer.get_pos();
+            compressor.open(m_tables_file_writer, m_compression_level);
+            store_stream(stream_id, compressor);
+            auto const uncompressed_size = compressor.get_uncompressed_stream_pos();
+            compressor.close();
+            stream_metadata.emplace_back(file_offset, uncompressed_size);
+        }
+        return stream_metadata;
+    }
+
+    std::vector<uint64_t> uncompressed_stream_sizes(num_streams, 0);
+    std::vector<std::vector<char>> compressed_streams(num_streams);
+    auto compress_stream = [&](size_t stream_id, ZstdCompressor& compressor) {
+        compressor.open(compressed_streams[stream_id], m_compression_level);
+        store_stream(stream_id, compressor);
+        uncompressed_stream_sizes[stream_id] = compressor.get_uncompressed_stream_pos();
+        compressor.close();
+    };
+    auto write_stream = [&](size_t stream_id) {
+        auto& compressed_stream = compressed_streams[stream_id];
+        stream_metadata.emplace_back(
+                m_tables_file_writer.get_pos(),
+                uncompressed_stream_sizes[stream_id]
+        );
+        m_tables_file_writer.write(compressed_stream.data(), compressed_stream.size());
+        std::vector<char>{}.swap(compressed_stream);
+    };
+
+    // Workers compress streams in stream-id order, but may finish out of order. The calling thread
+    // writes each stream as soon as it and all streams before it are ready. To bound memory usage,
+    // workers don't start compressing a stream that is too far ahead of the next stream to write.
+    size_t const max_num_buffered_streams{2 * num_workers};
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<uint8_t> stream_is_compressed(num_streams, 0);
+    size_t next_stream_to_compress{0};
+    size_t next_stream_to_write{0};
+    std::exception_ptr exception;
+
+    auto compress_streams = [&]() {
+        ZstdCompressor compressor;
+        while (true) {
+            size_t stream_id{};
+            {
+                std::unique_lock lock{mutex};
+                cv.wait(lock, [&]() {
+                    return nullptr != exception || next_stream_to_compress >= num_streams
+                           || next_stream_to_compress < next_stream_to_write
+                                                                + max_num_buffered_streams;
+                });
+                if (nullptr != exception || next_stream_to_compress >= num_streams) {
+                    return;
+                }
+                stream_id = next_stream_to_compress++;
+            }
+
+            try {
+                compress_stream(stream_id, compressor);
+            } catch (...) {
+                std::lock_guard const lock{mutex};
+                exception = std::current_exception();
+                cv.notify_all();
+                return;
+            }
+
+            {
+                std::lock_guard const lock{mutex};
+                stream_is_compressed[stream_id] = 1;
+            }
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(num_workers);
+    for (size_t i{0}; i < num_workers; ++i) {
+        workers.emplace_back(compress_streams);
+    }
+
+    for (size_t stream_id{0}; stream_id < num_streams; ++stream_id) {
+        {
+            std::unique_lock lock{mutex};
+            cv.wait(lock, [&]() {
+                return nullptr != exception || 0 != stream_is_compressed[stream_id];
+            });
+            if (nullptr != exception) {
+                break;
+            }
+        }
+
+        try {
+            write_stream(stream_id);
+        } catch (...) {
+            std::lock_guard const lock{mutex};
+            exception = std::current_exception();
+            cv.notify_all();
+            break;
+        }
+
+        {
+            std::lock_guard const lock{mutex};
+            next_stream_to_write = stream_id + 1;
+        }
+        cv.notify_all();
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (nullptr != exception) {
+        std::rethrow_exception(exception);
+    }
+    return stream_metadata;
+}
 }  // namespace clp_s
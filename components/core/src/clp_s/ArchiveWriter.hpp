@@ -5,6 +5,7 @@
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_io.hpp>
@@ -12,6 +13,7 @@
 
 #include "../clp/streaming_archive/Constants.hpp"
 #include "archive_constants.hpp"
+#include "BloomFilter.hpp"
 #include "DictionaryWriter.hpp"
 #include "RangeIndexWriter.hpp"
 #include "Schema.hpp"
@@ -29,6 +31,8 @@ struct ArchiveWriterOption {
     bool print_archive_stats;
     bool single_file_archive;
     size_t min_table_size;
+    size_t num_compression_threads{1};
+    size_t separate_columns_table_size{0};
     std::vector<std::string> authoritative_timestamp;
     std::string authoritative_timestamp_namespace;
 };
@@ -115,6 +119,15 @@ public:
         uint64_t uncompressed_size{};
     };
 
+    /**
+     * The contents of a packed stream: either a group of whole tables, or one column of a table
+     * that is stored as separate columns.
+     */
+    struct PackedStream {
+        std::vector<SchemaWriter*> tables;
+        std::optional<size_t> column_idx;
+    };
+
     struct SchemaMetadata {
         SchemaMetadata(
                 uint64_t stream_id,
@@ -205,7 +218,8 @@ public:
             std::string_view timestamp,
             uint64_t& pattern_id
     ) {
-        return m_timestamp_dict.ingest_entry(key, node_id, timestamp, pattern_id);
+        m_message_timestamp = m_timestamp_dict.ingest_entry(key, node_id, timestamp, pattern_id);
+        return m_message_timestamp.value();
     }
 
     /**
@@ -216,10 +230,13 @@ public:
      */
     void ingest_timestamp_entry(std::string_view key, int32_t node_id, double timestamp) {
         m_timestamp_dict.ingest_entry(key, node_id, timestamp);
+        // Matches how readers convert floating point timestamps
+        m_message_timestamp = static_cast<epochtime_t>(timestamp);
     }
 
     void ingest_timestamp_entry(std::string_view key, int32_t node_id, int64_t timestamp) {
         m_timestamp_dict.ingest_entry(key, node_id, timestamp);
+        m_message_timestamp = timestamp;
     }
 
     /**
@@ -285,6 +302,18 @@ private:
      */
     [[nodiscard]] std::pair<size_t, size_t> store_tables();
 
+    /**
+     * Compresses each packed stream and writes the streams to the tables file in order. When
+     * configured with more than one compression thread, streams are compressed concurrently into
+     * a bounded number of in-memory buffers; otherwise, they're compressed straight into the tables
+     * file. The schema writers of streams containing whole tables are deleted once they have been
+     * compressed.
+     * @param streams The contents of each packed stream, indexed by stream id
+     * @return The metadata for each packed stream, indexed by stream id
+     */
+    [[nodiscard]] auto write_packed_streams(std::vector<PackedStream> const& streams)
+            -> std::vector<StreamMetadata>;
+
     /**
      * Writes the archive to a single file
      * @param files
@@ -333,11 +362,17 @@ private:
     std::shared_ptr<VariableDictionaryWriter> m_var_dict;
     std::shared_ptr<LogTypeDictionaryWriter> m_log_dict;
     std::shared_ptr<LogTypeDictionaryWriter> m_array_dict;  // log type dictionary for arrays
+    // Filters over the values of the variable and logtype dictionaries, written to the archive
+    // metadata so that searches can rule out the archive without reading its dictionaries
+    BloomFilter m_var_dict_summary;
+    BloomFilter m_log_dict_summary;
     TimestampDictionaryWriter m_timestamp_dict;
     int m_compression_level{};
     bool m_print_archive_stats{};
     bool m_single_file_archive{};
     size_t m_min_table_size{};
+    size_t m_num_compression_threads{1};
+    size_t m_separate_columns_table_size{0};
 
     std::vector<std::string> m_authoritative_timestamp;
     std::string m_authoritative_timestamp_namespace;
@@ -348,10 +383,11 @@ private:
     SchemaTree m_schema_tree;
 
     std::map<int32_t, SchemaWriter*> m_id_to_schema_writer;
+    // The timestamp of the message being parsed, if it has an authoritative timestamp
+    std::optional<epochtime_t> m_message_timestamp;
 
     FileWriter m_tables_file_writer;
     FileWriter m_table_metadata_file_writer;
-    ZstdCompressor m_tables_compressor;
     ZstdCompressor m_table_metadata_compressor;
 
     RangeIndexWriter m_range_index_writer;
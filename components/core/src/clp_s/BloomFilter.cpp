@@ -0,0 +1,95 @@
+#include "BloomFilter.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace clp_s {
+namespace {
+constexpr size_t cNumBitsPerWord{64};
+}  // namespace
+
+BloomFilter::BloomFilter(size_t num_values)
+        : m_words((num_values * cNumBitsPerValue + cNumBitsPerWord - 1) / cNumBitsPerWord + 1) {}
+
+void BloomFilter::add(uint64_t value) {
+    // Double hashing derives every bit position from two hashes of the value
+    uint64_t const num_bits{m_words.size() * cNumBitsPerWord};
+    uint64_t const first_hash{hash(value)};
+    uint64_t const second_hash{hash(first_hash) | 1};
+    for (uint32_t i = 0; i < m_num_hash_functions; ++i) {
+        uint64_t const bit{(first_hash + i * second_hash) % num_bits};
+        m_words[bit / cNumBitsPerWord] |= uint64_t{1} << (bit % cNumBitsPerWord);
+    }
+}
+
+bool BloomFilter::possibly_contains(uint64_t value) const {
+    if (m_words.empty()) {
+        return false;
+    }
+
+    uint64_t const num_bits{m_words.size() * cNumBitsPerWord};
+    uint64_t const first_hash{hash(value)};
+    uint64_t const second_hash{hash(first_hash) | 1};
+    for (uint32_t i = 0; i < m_num_hash_functions; ++i) {
+        uint64_t const bit{(first_hash + i * second_hash) % num_bits};
+        if (0 == (m_words[bit / cNumBitsPerWord] & (uint64_t{1} << (bit % cNumBitsPerWord)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void BloomFilter::write_to_file(ZstdCompressor& compressor) const {
+    compressor.write_numeric_value(m_num_hash_functions);
+    compressor.write_numeric_value(m_words.size());
+    compressor.write(
+            reinterpret_cast<char const*>(m_words.data()),
+            m_words.size() * sizeof(uint64_t)
+    );
+}
+
+ErrorCode BloomFilter::try_read_from_file(ZstdDecompressor& decompressor) {
+    ErrorCode error_code = decompressor.try_read_numeric_value(m_num_hash_functions);
+    if (ErrorCodeSuccess != error_code) {
+        return error_code;
+    }
+
+    size_t num_words;
+    error_code = decompressor.try_read_numeric_value(num_words);
+    if (ErrorCodeSuccess != error_code) {
+        return error_code;
+    }
+    if (0 == m_num_hash_functions || 0 == num_words) {
+        return ErrorCodeCorrupt;
+    }
+
+    m_words.resize(num_words);
+    return decompressor.try_read_exact_length(
+            reinterpret_cast<char*>(m_words.data()),
+            num_words * sizeof(uint64_t)
+    );
+}
+
+uint64_t BloomFilter::hash(uint64_t value) {
+    // The SplitMix64 finalizer, which spreads sequential dictionary IDs across the whole range
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+}
+
+uint64_t BloomFilter::hash(std::string_view value) {
+    // FNV-1a, since the hash is persisted and `std::hash` may differ between standard libraries
+    constexpr uint64_t cFnvOffsetBasis{0xcbf29ce484222325ULL};
+    constexpr uint64_t cFnvPrime{0x100000001b3ULL};
+    uint64_t fnv_hash{cFnvOffsetBasis};
+    for (auto const c : value) {
+        fnv_hash ^= static_cast<unsigned char>(c);
+        fnv_hash *= cFnvPrime;
+    }
+    return fnv_hash;
+}
+}  // namespace clp_s
@@ -0,0 +1,102 @@
+#ifndef CLP_S_BLOOMFILTER_HPP
+#define CLP_S_BLOOMFILTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "ErrorCode.hpp"
+#include "ZstdCompressor.hpp"
+#include "ZstdDecompressor.hpp"
+
+namespace clp_s {
+/**
+ * A Bloom filter over 64-bit values or strings, used to record which dictionary IDs a column of a
+ * schema table contains and which values an archive's dictionaries contain. A lookup never misses a
+ * value that was added, but may report a value that wasn't added with a probability of roughly 1%
+ * when the filter is sized for the number of values added.
+ */
+class BloomFilter {
+public:
+    // Constants
+    static constexpr size_t cNumBitsPerValue{10};
+    static constexpr uint32_t cNumHashFunctions{7};
+
+    // Constructors
+    BloomFilter() = default;
+
+    /**
+     * Creates an empty filter sized for the given number of distinct values
+     * @param num_values
+     */
+    explicit BloomFilter(size_t num_values);
+
+    // Methods
+    /**
+     * Adds a value to the filter
+     * @param value
+     */
+    void add(uint64_t value);
+
+    /**
+     * Adds a string to the filter
+     * @param value
+     */
+    void add(std::string_view value) { add(hash(value)); }
+
+    /**
+     * @param value
+     * @return false if the value was definitely not added to the filter, true otherwise
+     */
+    [[nodiscard]] bool possibly_contains(uint64_t value) const;
+
+    /**
+     * @param value
+     * @return false if the string was definitely not added to the filter, true otherwise
+     */
+    [[nodiscard]] bool possibly_contains(std::string_view value) const {
+        return possibly_contains(hash(value));
+    }
+
+    /**
+     * @return The number of bytes written by `write_to_file`
+     */
+    [[nodiscard]] size_t get_serialized_size() const {
+        return sizeof(m_num_hash_functions) + sizeof(size_t) + m_words.size() * sizeof(uint64_t);
+    }
+
+    /**
+     * Writes the filter to a compressed stream
+     * @param compressor
+     */
+    void write_to_file(ZstdCompressor& compressor) const;
+
+    /**
+     * Tries to read the filter from a compressed stream
+     * @param decompressor
+     * @return ErrorCodeSuccess on success
+     * @return ErrorCodeCorrupt if the filter is malformed
+     * @return Same as ZstdDecompressor::try_read_exact_length on failure to read
+     */
+    [[nodiscard]] ErrorCode try_read_from_file(ZstdDecompressor& decompressor);
+
+private:
+    /**
+     * @param value
+     * @return A well-mixed 64-bit hash of the value
+     */
+    static uint64_t hash(uint64_t value);
+
+    /**
+     * @param value
+     * @return A 64-bit hash of the string that is stable across platforms and builds
+     */
+    static uint64_t hash(std::string_view value);
+
+    uint32_t m_num_hash_functions{cNumHashFunctions};
+    std::vector<uint64_t> m_words;
+};
+}  // namespace clp_s
+
+#endif  // CLP_S_BLOOMFILTER_HPP
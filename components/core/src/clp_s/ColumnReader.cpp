@@ -1,13 +1,25 @@
 #include "ColumnReader.hpp"
 
+#include <cstdint>
+#include <span>
+#include <vector>
+
 #include "../clp/EncodedVariableInterpreter.hpp"
 #include "BufferViewReader.hpp"
 #include "ColumnWriter.hpp"
+#include "FloatEncoding.hpp"
+#include "IntegerEncoding.hpp"
 #include "Utils.hpp"
 
 namespace clp_s {
 void Int64ColumnReader::load(BufferViewReader& reader, uint64_t num_messages) {
-    m_values = reader.read_unaligned_span<int64_t>(num_messages);
+    if (false == m_is_encoded) {
+        m_values = reader.read_unaligned_span<int64_t>(num_messages);
+        return;
+    }
+    m_decoded_values.resize(num_messages);
+    decode_integers(reader, m_decoded_values);
+    m_values = {reinterpret_cast<char*>(m_decoded_values.data()), num_messages};
 }
 
 std::variant<int64_t, double, std::string, uint8_t> Int64ColumnReader::extract_value(
@@ -17,7 +29,18 @@ std::variant<int64_t, double, std::string, uint8_t> Int64ColumnReader::extract_v
 }
 
 void DeltaEncodedInt64ColumnReader::load(BufferViewReader& reader, uint64_t num_messages) {
-    m_values = reader.read_unaligned_span<int64_t>(num_messages);
+    if (false == m_is_encoded) {
+        m_values = reader.read_unaligned_span<int64_t>(num_messages);
+    } else {
+        m_decoded_values.resize(num_messages);
+        std::span<int64_t> deltas{m_decoded_values};
+        if (num_messages > 0) {
+            deltas.front() = reader.read_value<int64_t>();
+            deltas = deltas.subspan(1);
+        }
+        decode_integers(reader, deltas);
+        m_values = {reinterpret_cast<char*>(m_decoded_values.data()), num_messages};
+    }
     if (num_messages > 0) {
         m_cur_idx = 0;
         m_cur_value = m_values[0];
@@ -47,7 +70,13 @@ std::variant<int64_t, double, std::string, uint8_t> DeltaEncodedInt64ColumnReade
 }
 
 void FloatColumnReader::load(BufferViewReader& reader, uint64_t num_messages) {
-    m_values = reader.read_unaligned_span<double>(num_messages);
+    if (false == m_is_encoded) {
+        m_values = reader.read_unaligned_span<double>(num_messages);
+        return;
+    }
+    m_decoded_values.resize(num_messages);
+    decode_floats(reader, m_decoded_values);
+    m_values = {reinterpret_cast<char*>(m_decoded_values.data()), num_messages};
 }
 
 void
@@ -186,8 +215,18 @@ int64_t VariableStringColumnReader::get_variable_id(uint64_t cur_message) {
 }
 
 void DateStringColumnReader::load(BufferViewReader& reader, uint64_t num_messages) {
-    m_timestamps = reader.read_unaligned_span<int64_t>(num_messages);
-    m_timestamp_encodings = reader.read_unaligned_span<int64_t>(num_messages);
+    if (false == m_is_encoded) {
+        m_timestamps = reader.read_unaligned_span<int64_t>(num_messages);
+        m_timestamp_encodings = reader.read_unaligned_span<int64_t>(num_messages);
+        return;
+    }
+    m_decoded_timestamps.resize(num_messages);
+    decode_delta_of_delta_integers(reader, m_decoded_timestamps);
+    m_timestamps = {reinterpret_cast<char*>(m_decoded_timestamps.data()), num_messages};
+    m_decoded_timestamp_encodings.resize(num_messages);
+    decode_integers(reader, m_decoded_timestamp_encodings);
+    m_timestamp_encodings
+            = {reinterpret_cast<char*>(m_decoded_timestamp_encodings.data()), num_messages};
 }
 
 std::variant<int64_t, double, std::string, uint8_t> DateStringColumnReader::extract_value(
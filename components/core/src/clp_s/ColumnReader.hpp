@@ -3,6 +3,7 @@
 
 #include <string>
 #include <variant>
+#include <vector>
 
 #include "BufferViewReader.hpp"
 #include "DictionaryReader.hpp"
@@ -71,7 +72,13 @@ private:
 class Int64ColumnReader : public BaseColumnReader {
 public:
     // Constructor
-    explicit Int64ColumnReader(int32_t id) : BaseColumnReader(id) {}
+    /**
+     * @param id
+     * @param is_encoded Whether the column is stored with an `IntegerEncoding`, rather than as is
+     */
+    Int64ColumnReader(int32_t id, bool is_encoded)
+            : BaseColumnReader(id),
+              m_is_encoded(is_encoded) {}
 
     // Destructor
     ~Int64ColumnReader() override = default;
@@ -87,14 +94,29 @@ public:
 
     void extract_string_value_into_buffer(uint64_t cur_message, std::string& buffer) override;
 
+    /**
+     * @return The values of every message in the column
+     */
+    [[nodiscard]] auto get_values() const -> UnalignedMemSpan<int64_t> { return m_values; }
+
 private:
+    bool m_is_encoded;
+    // The decoded values, which `m_values` points to if the column is encoded
+    std::vector<int64_t> m_decoded_values;
     UnalignedMemSpan<int64_t> m_values;
 };
 
 class DeltaEncodedInt64ColumnReader : public BaseColumnReader {
 public:
     // Constructor
-    explicit DeltaEncodedInt64ColumnReader(int32_t id) : BaseColumnReader(id) {}
+    /**
+     * @param id
+     * @param is_encoded Whether the column's deltas are stored with an `IntegerEncoding`, rather
+     * than as is
+     */
+    DeltaEncodedInt64ColumnReader(int32_t id, bool is_encoded)
+            : BaseColumnReader(id),
+              m_is_encoded(is_encoded) {}
 
     // Destructor
     ~DeltaEncodedInt64ColumnReader() override = default;
@@ -119,6 +141,9 @@ private:
      */
     int64_t get_value_at_idx(size_t idx);
 
+    bool m_is_encoded;
+    // The decoded deltas, which `m_values` points to if the column is encoded
+    std::vector<int64_t> m_decoded_values;
     UnalignedMemSpan<int64_t> m_values;
     int64_t m_cur_value{};
     size_t m_cur_idx{};
@@ -127,7 +152,13 @@ private:
 class FloatColumnReader : public BaseColumnReader {
 public:
     // Constructor
-    explicit FloatColumnReader(int32_t id) : BaseColumnReader(id) {}
+    /**
+     * @param id
+     * @param is_encoded Whether the column is stored with a `FloatEncoding`, rather than as is
+     */
+    FloatColumnReader(int32_t id, bool is_encoded)
+            : BaseColumnReader(id),
+              m_is_encoded(is_encoded) {}
 
     // Destructor
     ~FloatColumnReader() override = default;
@@ -143,7 +174,15 @@ public:
 
     void extract_string_value_into_buffer(uint64_t cur_message, std::string& buffer) override;
 
+    /**
+     * @return The values of every message in the column
+     */
+    [[nodiscard]] auto get_values() const -> UnalignedMemSpan<double> { return m_values; }
+
 private:
+    bool m_is_encoded;
+    // The decoded values, which `m_values` points to if the column is encoded
+    std::vector<double> m_decoded_values;
     UnalignedMemSpan<double> m_values;
 };
 
@@ -166,6 +205,11 @@ public:
 
     void extract_string_value_into_buffer(uint64_t cur_message, std::string& buffer) override;
 
+    /**
+     * @return The values of every message in the column
+     */
+    [[nodiscard]] auto get_values() const -> UnalignedMemSpan<uint8_t> { return m_values; }
+
 private:
     UnalignedMemSpan<uint8_t> m_values;
 };
@@ -258,6 +302,13 @@ public:
      */
     int64_t get_variable_id(uint64_t cur_message);
 
+    /**
+     * @return The encoded variable ids of every message in the column
+     */
+    [[nodiscard]] auto get_variable_ids() const -> UnalignedMemSpan<uint64_t> {
+        return m_variables;
+    }
+
 private:
     std::shared_ptr<VariableDictionaryReader> m_var_dict;
 
@@ -267,9 +318,20 @@ private:
 class DateStringColumnReader : public BaseColumnReader {
 public:
     // Constructor
-    DateStringColumnReader(int32_t id, std::shared_ptr<TimestampDictionaryReader> timestamp_dict)
+    /**
+     * @param id
+     * @param timestamp_dict
+     * @param is_encoded Whether the column's timestamps and timestamp encodings are stored with
+     * `encode_delta_of_delta_integers` and `encode_integers`, rather than as is
+     */
+    DateStringColumnReader(
+            int32_t id,
+            std::shared_ptr<TimestampDictionaryReader> timestamp_dict,
+            bool is_encoded
+    )
             : BaseColumnReader(id),
-              m_timestamp_dict(std::move(timestamp_dict)) {}
+              m_timestamp_dict(std::move(timestamp_dict)),
+              m_is_encoded(is_encoded) {}
 
     // Destructor
     ~DateStringColumnReader() override = default;
@@ -293,7 +355,12 @@ public:
 
 private:
     std::shared_ptr<TimestampDictionaryReader> m_timestamp_dict;
+    bool m_is_encoded;
 
+    // The decoded timestamps and timestamp encodings, which the spans below point to if the column
+    // is encoded
+    std::vector<int64_t> m_decoded_timestamps;
+    std::vector<int64_t> m_decoded_timestamp_encodings;
     UnalignedMemSpan<int64_t> m_timestamps;
     UnalignedMemSpan<int64_t> m_timestamp_encodings;
 };
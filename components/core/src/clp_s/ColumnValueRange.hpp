@@ -0,0 +1,16 @@
+#ifndef CLP_S_COLUMNVALUERANGE_HPP
+#define CLP_S_COLUMNVALUERANGE_HPP
+
+#include <cstdint>
+#include <utility>
+#include <variant>
+
+namespace clp_s {
+/**
+ * The minimum and maximum of the values stored in a numeric column of a schema table. Integer and
+ * date string columns have integer ranges, whereas float columns have floating point ranges.
+ */
+using ColumnValueRange = std::variant<std::pair<int64_t, int64_t>, std::pair<double, double>>;
+}  // namespace clp_s
+
+#endif  // CLP_S_COLUMNVALUERANGE_HPP
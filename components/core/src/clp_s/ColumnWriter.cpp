@@ -1,22 +1,50 @@
 #include "ColumnWriter.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <variant>
+#include <vector>
 
 #include "../clp/Defs.h"
 #include "../clp/EncodedVariableInterpreter.hpp"
+#include "FloatEncoding.hpp"
+#include "IntegerEncoding.hpp"
 #include "ParsedMessage.hpp"
 #include "ZstdCompressor.hpp"
 
 namespace clp_s {
 size_t Int64ColumnWriter::add_value(ParsedMessage::variable_t& value) {
-    m_values.push_back(std::get<int64_t>(value));
+    auto const int_value = std::get<int64_t>(value);
+    m_values.push_back(int_value);
+    m_min = std::min(m_min, int_value);
+    m_max = std::max(m_max, int_value);
     return sizeof(int64_t);
 }
 
+std::optional<ColumnValueRange> Int64ColumnWriter::get_value_range() const {
+    // The values are released once encoded, so an empty column is detected by its unset range
+    if (m_min > m_max) {
+        return std::nullopt;
+    }
+    return std::make_pair(m_min, m_max);
+}
+
+size_t Int64ColumnWriter::encode() {
+    auto const unencoded_size = m_values.size() * sizeof(int64_t) + get_total_header_size();
+    encode_integers(m_values, m_encoded_values);
+    std::vector<int64_t>{}.swap(m_values);
+    return unencoded_size - m_encoded_values.size();
+}
+
 void Int64ColumnWriter::store(ZstdCompressor& compressor) {
-    size_t size = m_values.size() * sizeof(int64_t);
-    compressor.write(reinterpret_cast<char const*>(m_values.data()), size);
+    compressor.write(m_encoded_values.data(), m_encoded_values.size());
 }
 
 size_t DeltaEncodedInt64ColumnWriter::add_value(ParsedMessage::variable_t& value) {
@@ -28,22 +56,65 @@ size_t DeltaEncodedInt64ColumnWriter::add_value(ParsedMessage::variable_t& value
         m_values.push_back(next - m_cur);
         m_cur = next;
     }
+    m_min = std::min(m_min, m_cur);
+    m_max = std::max(m_max, m_cur);
     return sizeof(int64_t);
 }
 
+std::optional<ColumnValueRange> DeltaEncodedInt64ColumnWriter::get_value_range() const {
+    if (m_min > m_max) {
+        return std::nullopt;
+    }
+    return std::make_pair(m_min, m_max);
+}
+
+size_t DeltaEncodedInt64ColumnWriter::encode() {
+    auto const unencoded_size = m_values.size() * sizeof(int64_t) + get_total_header_size();
+    // The first value is kept as is since it would widen the range of the deltas that follow it
+    std::span<int64_t const> deltas{m_values};
+    if (false == deltas.empty()) {
+        m_encoded_values.resize(sizeof(int64_t));
+        std::memcpy(m_encoded_values.data(), &deltas.front(), sizeof(int64_t));
+        deltas = deltas.subspan(1);
+    }
+    encode_integers(deltas, m_encoded_values);
+    std::vector<int64_t>{}.swap(m_values);
+    return unencoded_size - m_encoded_values.size();
+}
+
 void DeltaEncodedInt64ColumnWriter::store(ZstdCompressor& compressor) {
-    size_t size = m_values.size() * sizeof(int64_t);
-    compressor.write(reinterpret_cast<char const*>(m_values.data()), size);
+    compressor.write(m_encoded_values.data(), m_encoded_values.size());
 }
 
 size_t FloatColumnWriter::add_value(ParsedMessage::variable_t& value) {
-    m_values.push_back(std::get<double>(value));
+    auto const float_value = std::get<double>(value);
+    m_values.push_back(float_value);
+    if (std::isnan(float_value)) {
+        m_has_nan = true;
+    } else {
+        m_min = std::min(m_min, float_value);
+        m_max = std::max(m_max, float_value);
+    }
     return sizeof(double);
 }
 
+std::optional<ColumnValueRange> FloatColumnWriter::get_value_range() const {
+    // NaN is unordered, so no range can tell whether a comparison may match it
+    if (m_min > m_max || m_has_nan) {
+        return std::nullopt;
+    }
+    return std::make_pair(m_min, m_max);
+}
+
+size_t FloatColumnWriter::encode() {
+    auto const unencoded_size = m_values.size() * sizeof(double) + get_total_header_size();
+    encode_floats(m_values, m_encoded_values);
+    std::vector<double>{}.swap(m_values);
+    return unencoded_size - m_encoded_values.size();
+}
+
 void FloatColumnWriter::store(ZstdCompressor& compressor) {
-    size_t size = m_values.size() * sizeof(double);
-    compressor.write(reinterpret_cast<char const*>(m_values.data()), size);
+    compressor.write(m_encoded_values.data(), m_encoded_values.size());
 }
 
 size_t BooleanColumnWriter::add_value(ParsedMessage::variable_t& value) {
@@ -58,13 +129,13 @@ void BooleanColumnWriter::store(ZstdCompressor& compressor) {
 
 size_t ClpStringColumnWriter::add_value(ParsedMessage::variable_t& value) {
     uint64_t offset{m_encoded_vars.size()};
-    std::vector<clp::variable_dictionary_id_t> temp_var_dict_ids;
+    m_var_dict_ids.clear();
     clp::EncodedVariableInterpreter::encode_and_add_to_dictionary(
-            std::get<std::string>(value),
+            std::get<std::string_view>(value),
             m_logtype_entry,
             *m_var_dict,
             m_encoded_vars,
-            temp_var_dict_ids
+            m_var_dict_ids
     );
     clp::logtype_dictionary_id_t id{};
     m_log_dict->add_entry(m_logtype_entry, id);
@@ -84,28 +155,58 @@ void ClpStringColumnWriter::store(ZstdCompressor& compressor) {
 
 size_t VariableStringColumnWriter::add_value(ParsedMessage::variable_t& value) {
     clp::variable_dictionary_id_t id{};
-    m_var_dict->add_entry(std::get<std::string>(value), id);
+    m_var_dict->add_entry(std::get<std::string_view>(value), id);
     m_var_dict_ids.push_back(id);
     return sizeof(clp::variable_dictionary_id_t);
 }
 
+bool ClpStringColumnWriter::append_dictionary_ids(std::vector<uint64_t>& dictionary_ids) const {
+    for (auto const encoded_id : m_logtypes) {
+        dictionary_ids.push_back(get_encoded_log_dict_id(encoded_id));
+    }
+    return true;
+}
+
 void VariableStringColumnWriter::store(ZstdCompressor& compressor) {
     auto size{m_var_dict_ids.size() * sizeof(clp::variable_dictionary_id_t)};
     compressor.write(reinterpret_cast<char const*>(m_var_dict_ids.data()), size);
 }
 
+bool VariableStringColumnWriter::append_dictionary_ids(std::vector<uint64_t>& dictionary_ids
+) const {
+    dictionary_ids.insert(dictionary_ids.end(), m_var_dict_ids.cbegin(), m_var_dict_ids.cend());
+    return true;
+}
+
 size_t DateStringColumnWriter::add_value(ParsedMessage::variable_t& value) {
     auto encoded_timestamp = std::get<std::pair<uint64_t, epochtime_t>>(value);
     m_timestamps.push_back(encoded_timestamp.second);
     m_timestamp_encodings.push_back(encoded_timestamp.first);
+    m_min = std::min(m_min, encoded_timestamp.second);
+    m_max = std::max(m_max, encoded_timestamp.second);
     return 2 * sizeof(int64_t);
-    ;
+}
+
+std::optional<ColumnValueRange> DateStringColumnWriter::get_value_range() const {
+    if (m_min > m_max) {
+        return std::nullopt;
+    }
+    return std::make_pair(m_min, m_max);
+}
+
+size_t DateStringColumnWriter::encode() {
+    auto const unencoded_size
+            = (m_timestamps.size() + m_timestamp_encodings.size()) * sizeof(int64_t)
+              + get_total_header_size();
+    encode_delta_of_delta_integers(m_timestamps, m_encoded_values);
+    // A column almost always has a single timestamp format, which bit-packs into zero bits
+    encode_integers(m_timestamp_encodings, m_encoded_values);
+    std::vector<int64_t>{}.swap(m_timestamps);
+    std::vector<int64_t>{}.swap(m_timestamp_encodings);
+    return unencoded_size - m_encoded_values.size();
 }
 
 void DateStringColumnWriter::store(ZstdCompressor& compressor) {
-    size_t timestamps_size = m_timestamps.size() * sizeof(int64_t);
-    compressor.write(reinterpret_cast<char const*>(m_timestamps.data()), timestamps_size);
-    size_t encodings_size = m_timestamp_encodings.size() * sizeof(int64_t);
-    compressor.write(reinterpret_cast<char const*>(m_timestamp_encodings.data()), encodings_size);
+    compressor.write(m_encoded_values.data(), m_encoded_values.size());
 }
 }  // namespace clp_s
@@ -1,12 +1,19 @@
 #ifndef CLP_S_COLUMNWRITER_HPP
 #define CLP_S_COLUMNWRITER_HPP
 
+#include <cstdint>
+#include <limits>
+#include <optional>
 #include <utility>
 #include <variant>
+#include <vector>
 
 #include "../clp/Defs.h"
+#include "ColumnValueRange.hpp"
 #include "DictionaryWriter.hpp"
 #include "FileWriter.hpp"
+#include "FloatEncoding.hpp"
+#include "IntegerEncoding.hpp"
 #include "ParsedMessage.hpp"
 #include "TimestampDictionaryWriter.hpp"
 #include "ZstdCompressor.hpp"
@@ -42,6 +49,31 @@ public:
      */
     virtual size_t get_total_header_size() const { return 0; }
 
+    /**
+     * Encodes the values added to the column, after which no more values can be added. Must be
+     * called before the column is stored.
+     * @return the number of bytes by which encoding shrank the data that will be written to the
+     * compressor
+     */
+    virtual size_t encode() { return 0; }
+
+    /**
+     * @return The range of the values added to the column, or std::nullopt if the column isn't
+     * numeric, has no values, or has values that can't be ordered
+     */
+    virtual std::optional<ColumnValueRange> get_value_range() const { return std::nullopt; }
+
+    /**
+     * Appends the dictionary IDs of the values added to the column to the given vector.
+     * @param dictionary_ids
+     * @return Whether the column's values are dictionary IDs
+     */
+    virtual bool append_dictionary_ids(std::vector<uint64_t>& dictionary_ids) const {
+        return false;
+    }
+
+    int32_t get_id() const { return m_id; }
+
 protected:
     int32_t m_id;
 };
@@ -59,8 +91,17 @@ public:
 
     void store(ZstdCompressor& compressor) override;
 
+    size_t get_total_header_size() const override { return sizeof(IntegerEncoding); }
+
+    size_t encode() override;
+
+    std::optional<ColumnValueRange> get_value_range() const override;
+
 private:
     std::vector<int64_t> m_values;
+    std::vector<char> m_encoded_values;
+    int64_t m_min{std::numeric_limits<int64_t>::max()};
+    int64_t m_max{std::numeric_limits<int64_t>::min()};
 };
 
 class DeltaEncodedInt64ColumnWriter : public BaseColumnWriter {
@@ -76,9 +117,18 @@ public:
 
     void store(ZstdCompressor& compressor) override;
 
+    size_t get_total_header_size() const override { return sizeof(IntegerEncoding); }
+
+    size_t encode() override;
+
+    std::optional<ColumnValueRange> get_value_range() const override;
+
 private:
     std::vector<int64_t> m_values;
+    std::vector<char> m_encoded_values;
     int64_t m_cur{};
+    int64_t m_min{std::numeric_limits<int64_t>::max()};
+    int64_t m_max{std::numeric_limits<int64_t>::min()};
 };
 
 class FloatColumnWriter : public BaseColumnWriter {
@@ -94,8 +144,18 @@ public:
 
     void store(ZstdCompressor& compressor) override;
 
+    size_t get_total_header_size() const override { return sizeof(FloatEncoding); }
+
+    size_t encode() override;
+
+    std::optional<ColumnValueRange> get_value_range() const override;
+
 private:
     std::vector<double> m_values;
+    std::vector<char> m_encoded_values;
+    double m_min{std::numeric_limits<double>::infinity()};
+    double m_max{-std::numeric_limits<double>::infinity()};
+    bool m_has_nan{false};
 };
 
 class BooleanColumnWriter : public BaseColumnWriter {
@@ -140,6 +200,9 @@ public:
 
     size_t get_total_header_size() const override { return sizeof(size_t); }
 
+    // Only the logtype IDs are appended since they're what a search resolves first
+    bool append_dictionary_ids(std::vector<uint64_t>& dictionary_ids) const override;
+
     /**
      * @param encoded_id
      * @return the encoded log dict id
@@ -174,7 +237,11 @@ private:
 
     std::shared_ptr<VariableDictionaryWriter> m_var_dict;
     std::shared_ptr<LogTypeDictionaryWriter> m_log_dict;
+    // The logtype entry and the dictionary IDs of the variables in a value are only needed while
+    // the value is being added, and are reused across values so that adding a value whose logtype
+    // and variables are already in the dictionaries doesn't allocate
     LogTypeDictionaryEntry m_logtype_entry;
+    std::vector<clp::variable_dictionary_id_t> m_var_dict_ids;
 
     std::vector<encoded_log_dict_id_t> m_logtypes;
     std::vector<clp::encoded_variable_t> m_encoded_vars;
@@ -195,6 +262,8 @@ public:
 
     void store(ZstdCompressor& compressor) override;
 
+    bool append_dictionary_ids(std::vector<uint64_t>& dictionary_ids) const override;
+
 private:
     std::shared_ptr<VariableDictionaryWriter> m_var_dict;
     std::vector<clp::variable_dictionary_id_t> m_var_dict_ids;
@@ -213,9 +282,18 @@ public:
 
     void store(ZstdCompressor& compressor) override;
 
+    size_t get_total_header_size() const override { return 2 * sizeof(IntegerEncoding); }
+
+    size_t encode() override;
+
+    std::optional<ColumnValueRange> get_value_range() const override;
+
 private:
     std::vector<int64_t> m_timestamps;
     std::vector<int64_t> m_timestamp_encodings;
+    std::vector<char> m_encoded_values;
+    int64_t m_min{std::numeric_limits<int64_t>::max()};
+    int64_t m_max{std::numeric_limits<int64_t>::min()};
 };
 }  // namespace clp_s
 
@@ -164,11 +164,13 @@ CommandLineArguments::parse_arguments(int argc, char const** argv) {
                 std::cerr << "  c - compress" << std::endl;
                 std::cerr << "  x - decompress" << std::endl;
                 std::cerr << "  s - search" << std::endl;
+                std::cerr << "  d - serve searches as a daemon" << std::endl;
                 std::cerr << std::endl;
                 std::cerr << "Try "
                           << " c --help OR"
                           << " x --help OR"
-                          << " s --help for command-specific details." << std::endl;
+                          << " s --help OR"
+                          << " d --help for command-specific details." << std::endl;
 
                 po::options_description visible_options;
                 visible_options.add(general_options);
@@ -183,6 +185,7 @@ CommandLineArguments::parse_arguments(int argc, char const** argv) {
             case (char)Command::Compress:
             case (char)Command::Extract:
             case (char)Command::Search:
+            case (char)Command::Serve:
                 m_command = (Command)command_input;
                 break;
             default:
@@ -227,6 +230,24 @@ CommandLineArguments::parse_arguments(int argc, char const** argv) {
                     po::value<size_t>(&m_minimum_table_size)->value_name("MIN_TABLE_SIZE")->
                         default_value(m_minimum_table_size),
                     "Minimum size (B) for a packed table before it gets compressed."
+            )(
+                    "separate-columns-table-size",
+                    po::value<size_t>(&m_separate_columns_table_size)
+                        ->value_name("TABLE_SIZE")
+                        ->default_value(m_separate_columns_table_size),
+                    "Minimum size (B) for a table to store each of its columns in a separate"
+                    " stream, allowing searches to decompress only the columns they need"
+                    " (0 disables)."
+            )(
+                    "num-threads",
+                    po::value<size_t>(&m_num_threads)->value_name("NUM_THREADS")->
+                        default_value(m_num_threads),
+                    "Number of threads used to compress each archive's tables."
+            )(
+                    "archive-per-thread",
+                    po::bool_switch(&m_archive_per_thread),
+                    "Divide the input files between --num-threads threads that each parse their"
+                    " files into separate archives."
             )(
                     "max-document-size",
                     po::value<size_t>(&m_max_document_size)->value_name("DOC_SIZE")->
@@ -331,6 +352,10 @@ CommandLineArguments::parse_arguments(int argc, char const** argv) {
                 throw std::invalid_argument("No input paths specified.");
             }
 
+            if (0 == m_num_threads) {
+                throw std::invalid_argument("The number of threads must be greater than zero.");
+            }
+
             if (cJsonFileType == file_type) {
                 m_file_type = FileType::Json;
             } else if (cKeyValueIrFileType == file_type) {
@@ -382,11 +407,39 @@ CommandLineArguments::parse_arguments(int argc, char const** argv) {
                     "print-ordered-chunk-stats",
                     po::bool_switch(&m_print_ordered_chunk_stats),
                     "Print statistics (ndjson) about each chunk file after it's extracted."
+            )(
+                    "max-ordered-memory-usage",
+                    po::value<size_t>(&m_max_ordered_memory_usage)
+                            ->default_value(m_max_ordered_memory_usage)
+                            ->value_name("SIZE"),
+                    "Maximum memory (B) used by the compressed and decompressed streams read from"
+                    " an archive when decompressing records in log order. Tables that don't fit"
+                    " are released and decompressed again when their records are reached, so"
+                    " tables with interleaved records that don't fit together are decompressed"
+                    " repeatedly. A table that alone exceeds it is still decompressed. When set to"
+                    " 0, no limit is applied."
             )(
                     "archive-id",
                     po::value<std::string>(&archive_id)->value_name("ID"),
                     "Limit decompression to the archive with the given ID in a subdirectory of"
                     " archive-path"
+            )(
+                    "memory-map",
+                    po::bool_switch(&m_memory_map),
+                    "Memory map archives on the local file system instead of reading them"
+            )(
+                    "num-threads",
+                    po::value<size_t>(&m_num_threads)
+                        ->value_name("NUM_THREADS")
+                        ->default_value(m_num_threads),
+                    "Number of threads used to marshal the tables of each archive, and to write"
+                    " chunks when decompressing records in log order."
+            )(
+                    "parallelism",
+                    po::value<size_t>(&m_parallelism)
+                        ->value_name("NUM_ARCHIVES")
+                        ->default_value(m_parallelism),
+                    "Number of archives to decompress concurrently."
             )(
                     "auth",
                     po::value<std::string>(&auth)
@@ -456,6 +509,14 @@ CommandLineArguments::parse_arguments(int argc, char const** argv) {
                 throw std::invalid_argument("No output directory specified");
             }
 
+            if (0 == m_num_threads) {
+                throw std::invalid_argument("The number of threads must be greater than zero.");
+            }
+
+            if (0 == m_parallelism) {
+                throw std::invalid_argument("The parallelism must be greater than zero.");
+            }
+
             if (false == m_ordered_decompression) {
                 if (0 != m_target_ordered_chunk_size) {
                     throw std::invalid_argument(
@@ -551,6 +612,22 @@ CommandLineArguments::parse_arguments(int argc, char const** argv) {
                 "Type of authentication required for network requests (s3 | none). Authentication"
                 " with s3 requires the AWS_ACCESS_KEY_ID and AWS_SECRET_ACCESS_KEY environment"
                 " variables, and optionally the AWS_SESSION_TOKEN environment variable."
+            )(
+                "num-threads",
+                po::value<size_t>(&m_num_threads)
+                    ->value_name("NUM_THREADS")
+                    ->default_value(m_num_threads),
+                "Number of threads used to decompress and filter the tables of each archive."
+            )(
+                "parallelism",
+                po::value<size_t>(&m_parallelism)
+                    ->value_name("NUM_ARCHIVES")
+                    ->default_value(m_parallelism),
+                "Number of archives to search concurrently."
+            )(
+                "memory-map",
+                po::bool_switch(&m_memory_map),
+                "Memory map archives on the local file system instead of reading them"
             );
             // clang-format on
             search_options.add(match_options);
@@ -712,6 +789,14 @@ CommandLineArguments::parse_arguments(int argc, char const** argv) {
                 throw std::invalid_argument("No query specified");
             }
 
+            if (0 == m_num_threads) {
+                throw std::invalid_argument("The number of threads must be greater than zero.");
+            }
+
+            if (0 == m_parallelism) {
+                throw std::invalid_argument("The parallelism must be greater than zero.");
+            }
+
             if (parsed_command_line_options.count("tge")) {
                 m_search_begin_ts = parsed_command_line_options["tge"].as<epochtime_t>();
             }
@@ -804,6 +889,84 @@ CommandLineArguments::parse_arguments(int argc, char const** argv) {
                         "The --count-by-time and --count options are mutually exclusive."
                 );
             }
+        } else if ((char)Command::Serve == command_input) {
+            po::options_description serve_positional_options;
+            // clang-format off
+            serve_positional_options.add_options()(
+                    "socket-path",
+                    po::value<std::string>(&m_socket_path)->value_name("PATH"),
+                    "Path of the Unix domain socket to accept queries on"
+            );
+            // clang-format on
+
+            po::options_description serve_options("Serve Options");
+            // clang-format off
+            serve_options.add_options()(
+                    "cache-size",
+                    po::value<size_t>(&m_metadata_cache_size)
+                            ->default_value(m_metadata_cache_size)
+                            ->value_name("SIZE"),
+                    "Maximum memory (B) used to cache the decoded metadata of archives across"
+                    " queries"
+            );
+            // clang-format on
+
+            po::options_description all_serve_options;
+            all_serve_options.add(serve_positional_options);
+            all_serve_options.add(serve_options);
+
+            po::positional_options_description positional_options;
+            positional_options.add("socket-path", 1);
+
+            std::vector<std::string> unrecognized_options
+                    = po::collect_unrecognized(parsed.options, po::include_positional);
+            unrecognized_options.erase(unrecognized_options.begin());
+            po::store(
+                    po::command_line_parser(unrecognized_options)
+                            .options(all_serve_options)
+                            .positional(positional_options)
+                            .run(),
+                    parsed_command_line_options
+            );
+
+            po::notify(parsed_command_line_options);
+
+            if (parsed_command_line_options.count("help")) {
+                print_serve_usage();
+                std::cerr << "Each connection carries one request, which is a line holding a JSON"
+                             " object:"
+                          << std::endl;
+                std::cerr << R"(  {"command": "search", "args": [ARCHIVES_DIR, KQL_QUERY, ...]})"
+                          << std::endl;
+                std::cerr << "    Searches with the arguments of the s command. Results bound for"
+                             " stdout are returned as"
+                          << std::endl;
+                std::cerr << R"(    {"result": RECORD} lines, followed by a {"success": BOOL})"
+                             " line."
+                          << std::endl;
+                std::cerr << R"(  {"command": "stats"})" << std::endl;
+                std::cerr << "    Returns the metadata cache's hit, miss and eviction counts, and"
+                             " its memory usage."
+                          << std::endl;
+                std::cerr << std::endl;
+
+                std::cerr << "Examples:" << std::endl;
+                std::cerr << "  # Serve searches on /tmp/clp-s.sock with a 4 GiB metadata cache"
+                          << std::endl;
+                std::cerr << "  " << m_program_name << " d /tmp/clp-s.sock --cache-size 4294967296"
+                          << std::endl;
+                std::cerr << std::endl;
+
+                po::options_description visible_options;
+                visible_options.add(general_options);
+                visible_options.add(serve_options);
+                std::cerr << visible_options << std::endl;
+                return ParsingResult::InfoCommand;
+            }
+
+            if (m_socket_path.empty()) {
+                throw std::invalid_argument("No socket path specified");
+            }
         }
     } catch (std::exception& e) {
         SPDLOG_ERROR("{}", e.what());
@@ -917,4 +1080,8 @@ void CommandLineArguments::print_search_usage() const {
                  " [OUTPUT_HANDLER [OUTPUT_HANDLER_OPTIONS]]"
               << std::endl;
 }
+
+void CommandLineArguments::print_serve_usage() const {
+    std::cerr << "Usage: " << m_program_name << " d [OPTIONS] SOCKET_PATH" << std::endl;
+}
 }  // namespace clp_s
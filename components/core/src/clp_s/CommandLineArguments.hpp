@@ -26,7 +26,8 @@ public:
     enum class Command : char {
         Compress = 'c',
         Extract = 'x',
-        Search = 's'
+        Search = 's',
+        Serve = 'd'
     };
 
     enum class OutputHandlerType : uint8_t {
@@ -110,14 +111,30 @@ public:
 
     size_t get_target_ordered_chunk_size() const { return m_target_ordered_chunk_size; }
 
+    size_t get_max_ordered_memory_usage() const { return m_max_ordered_memory_usage; }
+
     size_t get_minimum_table_size() const { return m_minimum_table_size; }
 
+    size_t get_num_threads() const { return m_num_threads; }
+
+    bool get_archive_per_thread() const { return m_archive_per_thread; }
+
+    size_t get_parallelism() const { return m_parallelism; }
+
+    bool get_memory_map() const { return m_memory_map; }
+
+    size_t get_separate_columns_table_size() const { return m_separate_columns_table_size; }
+
     std::vector<std::string> const& get_projection_columns() const { return m_projection_columns; }
 
     bool get_record_log_order() const { return false == m_disable_log_order; }
 
     [[nodiscard]] auto get_file_type() const -> FileType { return m_file_type; }
 
+    std::string const& get_socket_path() const { return m_socket_path; }
+
+    size_t get_metadata_cache_size() const { return m_metadata_cache_size; }
+
 private:
     // Methods
     /**
@@ -167,6 +184,8 @@ private:
 
     void print_search_usage() const;
 
+    void print_serve_usage() const;
+
     // Variables
     std::string m_program_name;
     Command m_command;
@@ -174,6 +193,7 @@ private:
     // Compression and decompression variables
     std::vector<Path> m_input_paths;
     NetworkAuthOption m_network_auth{};
+    bool m_memory_map{false};
     std::string m_archives_dir;
     std::string m_output_dir;
     std::string m_timestamp_key;
@@ -185,8 +205,12 @@ private:
     bool m_structurize_arrays{false};
     bool m_ordered_decompression{false};
     size_t m_target_ordered_chunk_size{};
+    size_t m_max_ordered_memory_usage{1ULL * 1024 * 1024 * 1024};  // 1 GiB
     bool m_print_ordered_chunk_stats{false};
     size_t m_minimum_table_size{1ULL * 1024 * 1024};  // 1 MB
+    size_t m_num_threads{1};
+    bool m_archive_per_thread{false};
+    size_t m_separate_columns_table_size{0};
     bool m_disable_log_order{false};
     FileType m_file_type{FileType::Json};
 
@@ -206,6 +230,7 @@ private:
     std::optional<epochtime_t> m_search_end_ts;
     bool m_ignore_case{false};
     std::vector<std::string> m_projection_columns;
+    size_t m_parallelism{1};
 
     // Search aggregation variables
     std::string m_reducer_host;
@@ -216,6 +241,10 @@ private:
     int64_t m_count_by_time_bucket_size{0};  // Milliseconds
 
     OutputHandlerType m_output_handler_type{OutputHandlerType::Stdout};
+
+    // Search server variables
+    std::string m_socket_path;
+    size_t m_metadata_cache_size{1ULL * 1024 * 1024 * 1024};  // 1 GiB
 };
 }  // namespace clp_s
 
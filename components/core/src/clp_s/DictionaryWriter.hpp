@@ -3,9 +3,12 @@
 #ifndef CLP_S_DICTIONARYWRITER_HPP
 #define CLP_S_DICTIONARYWRITER_HPP
 
+#include <string_view>
+
 #include <absl/container/flat_hash_map.h>
 
 #include "../clp/Defs.h"
+#include "BloomFilter.hpp"
 #include "DictionaryEntry.hpp"
 
 namespace clp_s {
@@ -54,6 +57,13 @@ public:
      */
     size_t get_data_size() const { return m_data_size; }
 
+    /**
+     * Builds a filter over the values in the dictionary. Must be called before the dictionary is
+     * closed.
+     * @return The filter
+     */
+    BloomFilter get_value_filter() const;
+
 protected:
     // Types
     using value_to_id_t = absl::flat_hash_map<std::string, DictionaryIdType>;
@@ -149,6 +159,15 @@ size_t DictionaryWriter<DictionaryIdType, EntryType>::close() {
     return compressed_size;
 }
 
+template <typename DictionaryIdType, typename EntryType>
+BloomFilter DictionaryWriter<DictionaryIdType, EntryType>::get_value_filter() const {
+    BloomFilter filter{m_value_to_id.size()};
+    for (auto const& [value, id] : m_value_to_id) {
+        filter.add(std::string_view{value});
+    }
+    return filter;
+}
+
 template <typename DictionaryIdType, typename EntryType>
 void DictionaryWriter<DictionaryIdType, EntryType>::write_header_and_flush_to_disk() {
     if (false == m_is_open) {
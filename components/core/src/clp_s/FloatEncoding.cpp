@@ -0,0 +1,211 @@
+#include "FloatEncoding.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "BufferViewReader.hpp"
+#include "ErrorCode.hpp"
+#include "IntegerEncoding.hpp"
+
+namespace clp_s {
+namespace {
+constexpr std::array<double, 19> cPowersOfTen{
+        1e0,
+        1e1,
+        1e2,
+        1e3,
+        1e4,
+        1e5,
+        1e6,
+        1e7,
+        1e8,
+        1e9,
+        1e10,
+        1e11,
+        1e12,
+        1e13,
+        1e14,
+        1e15,
+        1e16,
+        1e17,
+        1e18
+};
+constexpr uint8_t cMaxExponent{cPowersOfTen.size() - 1};
+// Scaled floats must fit in an int64_t once rounded
+constexpr double cMaxScaledMagnitude{0x1p62};
+constexpr size_t cMaxNumSampledValues{1024};
+
+/**
+ * Appends a value's bytes to a buffer.
+ * @tparam T
+ * @param value
+ * @param buffer
+ */
+template <typename T>
+void append_value(T value, std::vector<char>& buffer);
+
+/**
+ * Scales a float by ten to the given exponent, and checks that the scaled integer decodes back to
+ * the same float.
+ * @param value
+ * @param exponent
+ * @param digits Returns the scaled integer
+ * @return Whether the float can be encoded as the scaled integer
+ */
+auto try_scale(double value, uint8_t exponent, int64_t& digits) -> bool;
+
+/**
+ * @param digits
+ * @param exponent
+ * @return The float encoded as the given scaled integer
+ */
+auto unscale(int64_t digits, uint8_t exponent) -> double;
+
+/**
+ * Chooses the smallest exponent that scales the most floats in an evenly spaced sample exactly.
+ * @param values
+ * @return The exponent
+ */
+auto choose_exponent(std::span<double const> values) -> uint8_t;
+
+template <typename T>
+void append_value(T value, std::vector<char>& buffer) {
+    auto const size = buffer.size();
+    buffer.resize(size + sizeof(T));
+    std::memcpy(buffer.data() + size, &value, sizeof(T));
+}
+
+auto try_scale(double value, uint8_t exponent, int64_t& digits) -> bool {
+    auto const scaled = value * cPowersOfTen[exponent];
+    // Also rejects NaNs and infinities
+    if (false == (std::abs(scaled) < cMaxScaledMagnitude)) {
+        return false;
+    }
+    digits = std::llround(scaled);
+    // Negative zeros are rejected since they decode to positive zeros
+    return std::bit_cast<uint64_t>(unscale(digits, exponent)) == std::bit_cast<uint64_t>(value);
+}
+
+auto unscale(int64_t digits, uint8_t exponent) -> double {
+    return static_cast<double>(digits) / cPowersOfTen[exponent];
+}
+
+auto choose_exponent(std::span<double const> values) -> uint8_t {
+    auto const step = std::max<size_t>(1, values.size() / cMaxNumSampledValues);
+    uint8_t best_exponent{0};
+    size_t min_num_exceptions{std::numeric_limits<size_t>::max()};
+    for (uint8_t exponent{0}; exponent <= cMaxExponent; ++exponent) {
+        size_t num_exceptions{0};
+        int64_t digits{};
+        for (size_t i{0}; i < values.size(); i += step) {
+            if (false == try_scale(values[i], exponent, digits)) {
+                ++num_exceptions;
+            }
+        }
+        if (num_exceptions < min_num_exceptions) {
+            best_exponent = exponent;
+            min_num_exceptions = num_exceptions;
+        }
+        if (0 == num_exceptions) {
+            // Larger exponents only widen the scaled integers
+            break;
+        }
+    }
+    return best_exponent;
+}
+}  // namespace
+
+void encode_floats(std::span<double const> values, std::vector<char>& buffer) {
+    auto const begin = buffer.size();
+    auto const plain_size = values.size() * sizeof(double);
+    if (false == values.empty()) {
+        auto const exponent = choose_exponent(values);
+        std::vector<int64_t> digits(values.size());
+        std::vector<uint64_t> exception_idxs;
+        for (size_t i{0}; i < values.size(); ++i) {
+            if (false == try_scale(values[i], exponent, digits[i])) {
+                exception_idxs.push_back(i);
+            }
+        }
+
+        if (exception_idxs.size() < values.size()) {
+            // Exceptions repeat a neighbouring integer so that they don't widen the integers' range
+            // or break their runs
+            size_t first_scaled_idx{0};
+            for (auto const idx : exception_idxs) {
+                if (first_scaled_idx != idx) {
+                    break;
+                }
+                ++first_scaled_idx;
+            }
+            for (auto const idx : exception_idxs) {
+                digits[idx] = (0 == idx) ? digits[first_scaled_idx] : digits[idx - 1];
+            }
+
+            append_value(FloatEncoding::Decimal, buffer);
+            append_value(exponent, buffer);
+            encode_integers(digits, buffer);
+            append_value(static_cast<uint64_t>(exception_idxs.size()), buffer);
+            for (auto const idx : exception_idxs) {
+                append_value(idx, buffer);
+                append_value(values[idx], buffer);
+            }
+            if (buffer.size() - begin <= sizeof(FloatEncoding) + plain_size) {
+                return;
+            }
+            buffer.resize(begin);
+        }
+    }
+
+    append_value(FloatEncoding::Plain, buffer);
+    auto const* plain_values = reinterpret_cast<char const*>(values.data());
+    buffer.insert(buffer.end(), plain_values, plain_values + plain_size);
+}
+
+void decode_floats(BufferViewReader& reader, std::span<double> values) {
+    switch (reader.read_value<FloatEncoding>()) {
+        case FloatEncoding::Plain: {
+            auto const plain_values = reader.read_unaligned_span<double>(values.size());
+            for (size_t i{0}; i < values.size(); ++i) {
+                values[i] = plain_values[i];
+            }
+            break;
+        }
+        case FloatEncoding::Decimal: {
+            auto const exponent = reader.read_value<uint8_t>();
+            if (exponent > cMaxExponent) {
+                throw BufferViewReader::OperationFailed(ErrorCodeCorrupt, __FILENAME__, __LINE__);
+            }
+            std::vector<int64_t> digits(values.size());
+            decode_integers(reader, digits);
+            for (size_t i{0}; i < values.size(); ++i) {
+                values[i] = unscale(digits[i], exponent);
+            }
+
+            auto const num_exceptions = reader.read_value<uint64_t>();
+            for (uint64_t i{0}; i < num_exceptions; ++i) {
+                auto const idx = reader.read_value<uint64_t>();
+                if (idx >= values.size()) {
+                    throw BufferViewReader::OperationFailed(
+                            ErrorCodeCorrupt,
+                            __FILENAME__,
+                            __LINE__
+                    );
+                }
+                values[idx] = reader.read_value<double>();
+            }
+            break;
+        }
+        default:
+            throw BufferViewReader::OperationFailed(ErrorCodeCorrupt, __FILENAME__, __LINE__);
+    }
+}
+}  // namespace clp_s
@@ -0,0 +1,41 @@
+#ifndef CLP_S_FLOATENCODING_HPP
+#define CLP_S_FLOATENCODING_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "BufferViewReader.hpp"
+
+namespace clp_s {
+/**
+ * The encodings of float columns, each of which is recorded before the encoded floats.
+ */
+enum class FloatEncoding : uint8_t {
+    // The floats as is
+    Plain = 0,
+    // A decimal exponent, each float scaled by ten to the exponent as an integer with an
+    // `IntegerEncoding`, and the floats that can't be scaled exactly as exceptions
+    Decimal = 1
+};
+
+/**
+ * Encodes floats with whichever encoding takes the fewest bytes, and appends the encoding followed
+ * by the encoded floats to a buffer. The decimal encoding's exponent is chosen from a sample of the
+ * floats.
+ * @param values
+ * @param buffer
+ */
+void encode_floats(std::span<double const> values, std::vector<char>& buffer);
+
+/**
+ * Decodes floats that were encoded by `encode_floats`. Every float is decoded bit for bit,
+ * including NaNs, infinities, and negative zeros.
+ * @param reader
+ * @param values Returns the decoded floats, and must be sized for the number of encoded floats
+ * @throw BufferViewReader::OperationFailed if the encoded floats are truncated or corrupt
+ */
+void decode_floats(BufferViewReader& reader, std::span<double> values);
+}  // namespace clp_s
+
+#endif  // CLP_S_FLOATENCODING_HPP
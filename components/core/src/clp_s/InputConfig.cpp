@@ -4,6 +4,7 @@
 #include <exception>
 #include <filesystem>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -141,23 +142,15 @@ auto try_sign_url(std::string& url) -> bool {
     return true;
 }
 
-auto try_create_network_reader(std::string_view const url, NetworkAuthOption const& auth)
+auto try_create_network_reader(Path const& path, NetworkAuthOption const& auth)
         -> std::shared_ptr<clp::ReaderInterface> {
-    std::string request_url{url};
-    switch (auth.method) {
-        case AuthMethod::S3PresignedUrlV4:
-            if (false == try_sign_url(request_url)) {
-                return nullptr;
-            }
-            break;
-        case AuthMethod::None:
-            break;
-        default:
-            return nullptr;
+    auto const request_url{try_get_request_url(path, auth)};
+    if (false == request_url.has_value()) {
+        return nullptr;
     }
 
     try {
-        return std::make_shared<clp::NetworkReader>(request_url);
+        return std::make_shared<clp::NetworkReader>(request_url.value());
     } catch (clp::NetworkReader::OperationFailed const& e) {
         SPDLOG_ERROR("Failed to open url for reading - {}", e.what());
         return nullptr;
@@ -165,12 +158,33 @@ auto try_create_network_reader(std::string_view const url, NetworkAuthOption con
 }
 }  // namespace
 
+auto try_get_request_url(Path const& path, NetworkAuthOption const& network_auth)
+        -> std::optional<std::string> {
+    if (InputSource::Network != path.source) {
+        return std::nullopt;
+    }
+
+    std::string request_url{path.path};
+    switch (network_auth.method) {
+        case AuthMethod::S3PresignedUrlV4:
+            if (false == try_sign_url(request_url)) {
+                return std::nullopt;
+            }
+            break;
+        case AuthMethod::None:
+            break;
+        default:
+            return std::nullopt;
+    }
+    return request_url;
+}
+
 auto try_create_reader(Path const& path, NetworkAuthOption const& network_auth)
         -> std::shared_ptr<clp::ReaderInterface> {
     if (InputSource::Filesystem == path.source) {
         return try_create_file_reader(path.path);
     } else if (InputSource::Network == path.source) {
-        return try_create_network_reader(path.path, network_auth);
+        return try_create_network_reader(path, network_auth);
     } else {
         return nullptr;
     }
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <variant>
@@ -113,6 +114,16 @@ get_input_archives_for_raw_path(std::string_view const path, std::vector<Path>&
 [[nodiscard]] auto get_archive_id_from_path(Path const& archive_path, std::string& archive_id)
         -> bool;
 
+/**
+ * Tries to get the URL that requests for a network path should be sent to, signing it if the given
+ * NetworkAuthOption requires it.
+ * @param path
+ * @param network_auth
+ * @return the request URL or std::nullopt on error
+ */
+[[nodiscard]] auto try_get_request_url(Path const& path, NetworkAuthOption const& network_auth)
+        -> std::optional<std::string>;
+
 /**
  * Tries to open a clp::ReaderInterface using the given Path and NetworkAuthOption.
  * @param path
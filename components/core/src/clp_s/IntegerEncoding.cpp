@@ -0,0 +1,280 @@
+#include "IntegerEncoding.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "BufferViewReader.hpp"
+#include "ErrorCode.hpp"
+
+namespace clp_s {
+namespace {
+constexpr size_t cNumBitsPerWord{std::numeric_limits<uint64_t>::digits};
+
+/**
+ * Appends a value's bytes to a buffer.
+ * @tparam T
+ * @param value
+ * @param buffer
+ */
+template <typename T>
+void append_value(T value, std::vector<char>& buffer);
+
+/**
+ * @param num_values
+ * @param bit_width
+ * @return The number of words needed to pack `num_values` values of `bit_width` bits each
+ */
+auto get_num_packed_words(size_t num_values, uint8_t bit_width) -> size_t;
+
+/**
+ * Appends the minimum value and each value's offset from it, packed into `bit_width` bits, to a
+ * buffer.
+ * @param values
+ * @param min
+ * @param bit_width
+ * @param buffer
+ */
+void encode_bit_packed(
+        std::span<int64_t const> values,
+        int64_t min,
+        uint8_t bit_width,
+        std::vector<char>& buffer
+);
+
+/**
+ * Appends the number of runs and each run's value and length to a buffer.
+ * @param values
+ * @param num_runs
+ * @param buffer
+ */
+void
+encode_run_length(std::span<int64_t const> values, size_t num_runs, std::vector<char>& buffer);
+
+/**
+ * Decodes values encoded by `encode_bit_packed`.
+ * @param reader
+ * @param values
+ * @throw BufferViewReader::OperationFailed if the encoded values are truncated or corrupt
+ */
+void decode_bit_packed(BufferViewReader& reader, std::span<int64_t> values);
+
+/**
+ * Decodes values encoded by `encode_run_length`.
+ * @param reader
+ * @param values
+ * @throw BufferViewReader::OperationFailed if the encoded values are truncated or corrupt
+ */
+void decode_run_length(BufferViewReader& reader, std::span<int64_t> values);
+
+template <typename T>
+void append_value(T value, std::vector<char>& buffer) {
+    auto const size = buffer.size();
+    buffer.resize(size + sizeof(T));
+    std::memcpy(buffer.data() + size, &value, sizeof(T));
+}
+
+auto get_num_packed_words(size_t num_values, uint8_t bit_width) -> size_t {
+    return (num_values * bit_width + cNumBitsPerWord - 1) / cNumBitsPerWord;
+}
+
+void encode_bit_packed(
+        std::span<int64_t const> values,
+        int64_t min,
+        uint8_t bit_width,
+        std::vector<char>& buffer
+) {
+    append_value(min, buffer);
+    append_value(bit_width, buffer);
+    if (0 == bit_width) {
+        return;
+    }
+
+    auto const num_words = get_num_packed_words(values.size(), bit_width);
+    buffer.reserve(buffer.size() + num_words * sizeof(uint64_t));
+    uint64_t word{0};
+    size_t num_bits_in_word{0};
+    for (auto const value : values) {
+        // Offsets are computed with unsigned arithmetic so that ranges wider than INT64_MAX wrap
+        auto const offset = static_cast<uint64_t>(value) - static_cast<uint64_t>(min);
+        word |= offset << num_bits_in_word;
+        num_bits_in_word += bit_width;
+        if (num_bits_in_word >= cNumBitsPerWord) {
+            append_value(word, buffer);
+            num_bits_in_word -= cNumBitsPerWord;
+            // The offset's high bits that didn't fit in the full word start the next one
+            word = (0 == num_bits_in_word) ? 0 : offset >> (bit_width - num_bits_in_word);
+        }
+    }
+    if (0 != num_bits_in_word) {
+        append_value(word, buffer);
+    }
+}
+
+void
+encode_run_length(std::span<int64_t const> values, size_t num_runs, std::vector<char>& buffer) {
+    append_value(static_cast<uint64_t>(num_runs), buffer);
+    for (size_t run_begin{0}; run_begin < values.size();) {
+        size_t run_end{run_begin + 1};
+        while (run_end < values.size() && values[run_end] == values[run_begin]) {
+            ++run_end;
+        }
+        append_value(values[run_begin], buffer);
+        append_value(static_cast<uint64_t>(run_end - run_begin), buffer);
+        run_begin = run_end;
+    }
+}
+
+void decode_bit_packed(BufferViewReader& reader, std::span<int64_t> values) {
+    auto const min = reader.read_value<int64_t>();
+    auto const bit_width = reader.read_value<uint8_t>();
+    if (bit_width > cNumBitsPerWord) {
+        throw BufferViewReader::OperationFailed(ErrorCodeCorrupt, __FILENAME__, __LINE__);
+    }
+    if (0 == bit_width) {
+        std::fill(values.begin(), values.end(), min);
+        return;
+    }
+
+    auto const words = reader.read_unaligned_span<uint64_t>(
+            get_num_packed_words(values.size(), bit_width)
+    );
+    uint64_t const mask{
+            cNumBitsPerWord == bit_width ? std::numeric_limits<uint64_t>::max()
+                                         : (uint64_t{1} << bit_width) - 1
+    };
+    size_t bit_idx{0};
+    for (auto& value : values) {
+        auto const word_idx = bit_idx / cNumBitsPerWord;
+        auto const bit_offset = bit_idx % cNumBitsPerWord;
+        uint64_t offset{words[word_idx] >> bit_offset};
+        if (bit_offset + bit_width > cNumBitsPerWord) {
+            offset |= words[word_idx + 1] << (cNumBitsPerWord - bit_offset);
+        }
+        value = static_cast<int64_t>(static_cast<uint64_t>(min) + (offset & mask));
+        bit_idx += bit_width;
+    }
+}
+
+void decode_run_length(BufferViewReader& reader, std::span<int64_t> values) {
+    auto const num_runs = reader.read_value<uint64_t>();
+    auto it = values.begin();
+    for (uint64_t run_idx{0}; run_idx < num_runs; ++run_idx) {
+        auto const value = reader.read_value<int64_t>();
+        auto const length = reader.read_value<uint64_t>();
+        if (length > static_cast<uint64_t>(values.end() - it)) {
+            throw BufferViewReader::OperationFailed(ErrorCodeCorrupt, __FILENAME__, __LINE__);
+        }
+        it = std::fill_n(it, length, value);
+    }
+    if (values.end() != it) {
+        throw BufferViewReader::OperationFailed(ErrorCodeCorrupt, __FILENAME__, __LINE__);
+    }
+}
+}  // namespace
+
+void encode_integers(std::span<int64_t const> values, std::vector<char>& buffer) {
+    int64_t min{0};
+    int64_t max{0};
+    size_t num_runs{0};
+    if (false == values.empty()) {
+        min = values.front();
+        max = values.front();
+        num_runs = 1;
+        for (size_t i{1}; i < values.size(); ++i) {
+            min = std::min(min, values[i]);
+            max = std::max(max, values[i]);
+            if (values[i] != values[i - 1]) {
+                ++num_runs;
+            }
+        }
+    }
+
+    auto const bit_width = static_cast<uint8_t>(
+            std::bit_width(static_cast<uint64_t>(max) - static_cast<uint64_t>(min))
+    );
+    auto const plain_size = values.size() * sizeof(int64_t);
+    auto const bit_packed_size = sizeof(int64_t) + sizeof(uint8_t)
+                                 + get_num_packed_words(values.size(), bit_width)
+                                           * sizeof(uint64_t);
+    auto const run_length_size = sizeof(uint64_t) + num_runs * (sizeof(int64_t) + sizeof(uint64_t));
+
+    if (plain_size <= bit_packed_size && plain_size <= run_length_size) {
+        append_value(IntegerEncoding::Plain, buffer);
+        auto const* plain_values = reinterpret_cast<char const*>(values.data());
+        buffer.insert(buffer.end(), plain_values, plain_values + plain_size);
+    } else if (bit_packed_size <= run_length_size) {
+        append_value(IntegerEncoding::BitPacked, buffer);
+        encode_bit_packed(values, min, bit_width, buffer);
+    } else {
+        append_value(IntegerEncoding::RunLength, buffer);
+        encode_run_length(values, num_runs, buffer);
+    }
+}
+
+void decode_integers(BufferViewReader& reader, std::span<int64_t> values) {
+    switch (reader.read_value<IntegerEncoding>()) {
+        case IntegerEncoding::Plain: {
+            auto const plain_values = reader.read_unaligned_span<int64_t>(values.size());
+            for (size_t i{0}; i < values.size(); ++i) {
+                values[i] = plain_values[i];
+            }
+            break;
+        }
+        case IntegerEncoding::BitPacked:
+            decode_bit_packed(reader, values);
+            break;
+        case IntegerEncoding::RunLength:
+            decode_run_length(reader, values);
+            break;
+        default:
+            throw BufferViewReader::OperationFailed(ErrorCodeCorrupt, __FILENAME__, __LINE__);
+    }
+}
+
+void encode_delta_of_delta_integers(std::span<int64_t const> values, std::vector<char>& buffer) {
+    // Deltas are computed with unsigned arithmetic so that they wrap instead of overflowing
+    auto get_delta = [&](size_t idx) -> uint64_t {
+        return static_cast<uint64_t>(values[idx]) - static_cast<uint64_t>(values[idx - 1]);
+    };
+
+    // The first integer and delta are kept as is since they would widen the range of the deltas
+    // of deltas
+    if (values.size() > 0) {
+        append_value(values[0], buffer);
+    }
+    if (values.size() > 1) {
+        append_value(static_cast<int64_t>(get_delta(1)), buffer);
+    }
+    std::vector<int64_t> deltas_of_deltas;
+    deltas_of_deltas.reserve(values.size() - std::min<size_t>(values.size(), 2));
+    for (size_t i{2}; i < values.size(); ++i) {
+        deltas_of_deltas.push_back(static_cast<int64_t>(get_delta(i) - get_delta(i - 1)));
+    }
+    encode_integers(deltas_of_deltas, buffer);
+}
+
+void decode_delta_of_delta_integers(BufferViewReader& reader, std::span<int64_t> values) {
+    auto const num_unencoded_values = std::min<size_t>(values.size(), 2);
+    uint64_t delta{0};
+    if (num_unencoded_values > 0) {
+        values[0] = reader.read_value<int64_t>();
+    }
+    if (num_unencoded_values > 1) {
+        delta = static_cast<uint64_t>(reader.read_value<int64_t>());
+        values[1] = static_cast<int64_t>(static_cast<uint64_t>(values[0]) + delta);
+    }
+
+    // The deltas of deltas are decoded in place and then summed twice
+    decode_integers(reader, values.subspan(num_unencoded_values));
+    for (size_t i{2}; i < values.size(); ++i) {
+        delta += static_cast<uint64_t>(values[i]);
+        values[i] = static_cast<int64_t>(static_cast<uint64_t>(values[i - 1]) + delta);
+    }
+}
+}  // namespace clp_s
@@ -0,0 +1,58 @@
+#ifndef CLP_S_INTEGERENCODING_HPP
+#define CLP_S_INTEGERENCODING_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "BufferViewReader.hpp"
+
+namespace clp_s {
+/**
+ * The encodings of integer columns, each of which is recorded before the encoded integers.
+ */
+enum class IntegerEncoding : uint8_t {
+    // The integers as is
+    Plain = 0,
+    // The minimum integer followed by each integer's offset from it, packed into the fewest bits
+    // that fit every offset
+    BitPacked = 1,
+    // The number of runs followed by each run's integer and length
+    RunLength = 2
+};
+
+/**
+ * Encodes integers with whichever encoding takes the fewest bytes, and appends the encoding
+ * followed by the encoded integers to a buffer.
+ * @param values
+ * @param buffer
+ */
+void encode_integers(std::span<int64_t const> values, std::vector<char>& buffer);
+
+/**
+ * Decodes integers that were encoded by `encode_integers`.
+ * @param reader
+ * @param values Returns the decoded integers, and must be sized for the number of encoded integers
+ * @throw BufferViewReader::OperationFailed if the encoded integers are truncated or corrupt
+ */
+void decode_integers(BufferViewReader& reader, std::span<int64_t> values);
+
+/**
+ * Encodes near-monotonic integers, such as timestamps, as the first integer, the first delta, and
+ * the deltas between consecutive deltas, and appends them to a buffer. The deltas of deltas are
+ * encoded by `encode_integers`.
+ * @param values
+ * @param buffer
+ */
+void encode_delta_of_delta_integers(std::span<int64_t const> values, std::vector<char>& buffer);
+
+/**
+ * Decodes integers that were encoded by `encode_delta_of_delta_integers`.
+ * @param reader
+ * @param values Returns the decoded integers, and must be sized for the number of encoded integers
+ * @throw BufferViewReader::OperationFailed if the encoded integers are truncated or corrupt
+ */
+void decode_delta_of_delta_integers(BufferViewReader& reader, std::span<int64_t> values);
+}  // namespace clp_s
+
+#endif  // CLP_S_INTEGERENCODING_HPP
@@ -1,8 +1,22 @@
 #include "JsonConstructor.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
 #include <filesystem>
-#include <queue>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
 #include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include <fmt/core.h>
 #include <mongocxx/client.hpp>
@@ -14,9 +28,185 @@
 
 #include "archive_constants.hpp"
 #include "ErrorCode.hpp"
+#include "OrderedTableMerger.hpp"
+#include "SchemaReader.hpp"
 #include "TraceableException.hpp"
 
 namespace clp_s {
+namespace {
+/**
+ * Writes chunks of decompressed records to their own files on a pool of threads, bounding the
+ * number of chunks that are waiting to be written.
+ */
+class ChunkWriterPool {
+public:
+    // Constructors
+    /**
+     * @param num_threads
+     * @param on_chunk_written If not empty, called with the path of each chunk once it has been
+     * written, from the thread that wrote it
+     */
+    ChunkWriterPool(
+            size_t num_threads,
+            std::function<void(std::filesystem::path const&)> on_chunk_written
+    );
+
+    // Disable copy/move constructors/assignment operators
+    ChunkWriterPool(ChunkWriterPool const&) = delete;
+    ChunkWriterPool(ChunkWriterPool&&) = delete;
+    auto operator=(ChunkWriterPool const&) -> ChunkWriterPool& = delete;
+    auto operator=(ChunkWriterPool&&) -> ChunkWriterPool& = delete;
+
+    // Destructor
+    ~ChunkWriterPool() { stop(); }
+
+    // Methods
+    /**
+     * Queues a chunk to be written, waiting while too many chunks are waiting to be written.
+     * @param path
+     * @param contents
+     * @throw The exception thrown while writing any earlier chunk
+     */
+    void write(std::filesystem::path path, std::string contents);
+
+    /**
+     * Waits for every queued chunk to be written, then stops the threads.
+     * @throw The exception thrown while writing any chunk
+     */
+    void finish();
+
+private:
+    // Types
+    struct Chunk {
+        std::filesystem::path path;
+        std::string contents;
+    };
+
+    // Methods
+    /**
+     * Writes queued chunks until the pool is stopped.
+     */
+    void write_chunks();
+
+    void stop();
+
+    /**
+     * Rethrows the exception thrown while writing any chunk. Must be called with `m_mutex` held.
+     */
+    void rethrow_if_failed() const;
+
+    // Variables
+    size_t m_max_num_pending_chunks;
+    std::function<void(std::filesystem::path const&)> m_on_chunk_written;
+
+    std::mutex m_mutex;
+    std::condition_variable m_chunk_available;
+    std::condition_variable m_chunk_written;
+    std::deque<Chunk> m_pending_chunks;
+    size_t m_num_chunks_being_written{0};
+    std::exception_ptr m_exception;
+    bool m_is_stopping{false};
+    std::vector<std::thread> m_threads;
+};
+
+ChunkWriterPool::ChunkWriterPool(
+        size_t num_threads,
+        std::function<void(std::filesystem::path const&)> on_chunk_written
+)
+        : m_max_num_pending_chunks{num_threads},
+          m_on_chunk_written{std::move(on_chunk_written)} {
+    m_threads.reserve(num_threads);
+    for (size_t i{0}; i < num_threads; ++i) {
+        m_threads.emplace_back([this]() { write_chunks(); });
+    }
+}
+
+void ChunkWriterPool::write(std::filesystem::path path, std::string contents) {
+    {
+        std::unique_lock lock{m_mutex};
+        m_chunk_written.wait(lock, [&]() {
+            return nullptr != m_exception
+                   || m_pending_chunks.size() + m_num_chunks_being_written
+                              < m_max_num_pending_chunks;
+        });
+        rethrow_if_failed();
+        m_pending_chunks.push_back({std::move(path), std::move(contents)});
+    }
+    m_chunk_available.notify_one();
+}
+
+void ChunkWriterPool::finish() {
+    {
+        std::unique_lock lock{m_mutex};
+        m_chunk_written.wait(lock, [&]() {
+            return nullptr != m_exception
+                   || (m_pending_chunks.empty() && 0 == m_num_chunks_being_written);
+        });
+        rethrow_if_failed();
+    }
+    stop();
+}
+
+void ChunkWriterPool::write_chunks() {
+    while (true) {
+        Chunk chunk;
+        {
+            std::unique_lock lock{m_mutex};
+            m_chunk_available.wait(lock, [&]() {
+                return m_is_stopping || false == m_pending_chunks.empty();
+            });
+            if (m_pending_chunks.empty()) {
+                return;
+            }
+            chunk = std::move(m_pending_chunks.front());
+            m_pending_chunks.pop_front();
+            ++m_num_chunks_being_written;
+        }
+
+        std::exception_ptr exception;
+        try {
+            FileWriter writer;
+            writer.open(chunk.path.string(), FileWriter::OpenMode::CreateForWriting);
+            writer.write(chunk.contents.data(), chunk.contents.size());
+            writer.close();
+            if (m_on_chunk_written) {
+                m_on_chunk_written(chunk.path);
+            }
+        } catch (...) {
+            exception = std::current_exception();
+        }
+
+        {
+            std::lock_guard const lock{m_mutex};
+            --m_num_chunks_being_written;
+            if (nullptr == m_exception) {
+                m_exception = exception;
+            }
+        }
+        m_chunk_written.notify_all();
+    }
+}
+
+void ChunkWriterPool::stop() {
+    {
+        std::lock_guard const lock{m_mutex};
+        m_is_stopping = true;
+        m_pending_chunks.clear();
+    }
+    m_chunk_available.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+    m_threads.clear();
+}
+
+void ChunkWriterPool::rethrow_if_failed() const {
+    if (nullptr != m_exception) {
+        std::rethrow_exception(m_exception);
+    }
+}
+}  // namespace
+
 JsonConstructor::JsonConstructor(JsonConstructorOption const& option) : m_option{option} {
     std::error_code error_code;
     if (false == std::filesystem::create_directory(option.output_dir, error_code) && error_code) {
@@ -33,9 +223,9 @@ JsonConstructor::JsonConstructor(JsonConstructorOption const& option) : m_option
     }
 }
 
-void JsonConstructor::store() {
+void JsonConstructor::store(std::mutex* output_mutex) {
     m_archive_reader = std::make_unique<ArchiveReader>();
-    m_archive_reader->open(m_option.archive_path, m_option.network_auth);
+    m_archive_reader->open(m_option.archive_path, m_option.network_auth, m_option.memory_map);
     m_archive_reader->read_dictionaries_and_metadata();
 
     if (m_option.ordered && false == m_archive_reader->has_log_order()) {
@@ -52,33 +242,169 @@ void JsonConstructor::store() {
                 m_option.output_dir + "/original",
                 FileWriter::OpenMode::CreateIfNonexistentForAppending
         );
-        m_archive_reader->store(writer);
+        if (m_option.num_threads > 1 || nullptr != output_mutex) {
+            store_concurrently(writer, output_mutex);
+        } else {
+            m_archive_reader->store(writer);
+        }
 
         writer.close();
     } else {
-        construct_in_order();
+        construct_in_order(output_mutex);
     }
     m_archive_reader->close();
 }
 
-void JsonConstructor::construct_in_order() {
+void JsonConstructor::store_concurrently(FileWriter& writer, std::mutex* output_mutex) {
+    struct MarshalledTable {
+        std::unique_ptr<SchemaReader> reader;
+        std::string records;
+        std::exception_ptr exception;
+        bool is_done{false};
+    };
+
+    // Limit the number of tables that have been read but not yet written so that memory use stays
+    // bounded while keeping every worker busy.
+    size_t const max_num_in_flight_tables{2 * m_option.num_threads};
+
+    std::mutex mutex;
+    std::condition_variable table_available;
+    std::condition_variable table_done;
+    std::deque<MarshalledTable*> pending_tables;
+    bool is_stopping{false};
+    std::deque<std::unique_ptr<MarshalledTable>> in_flight_tables;
+    std::vector<std::thread> workers;
+
+    auto run_worker = [&]() {
+        std::string message;
+        while (true) {
+            MarshalledTable* table{nullptr};
+            {
+                std::unique_lock lock{mutex};
+                table_available.wait(lock, [&]() {
+                    return is_stopping || false == pending_tables.empty();
+                });
+                if (pending_tables.empty()) {
+                    return;
+                }
+                table = pending_tables.front();
+                pending_tables.pop_front();
+            }
+
+            try {
+                while (table->reader->get_next_message(message)) {
+                    table->records += message;
+                }
+            } catch (...) {
+                table->exception = std::current_exception();
+            }
+            // Release the decompressed table as soon as it has been marshalled
+            table->reader.reset();
+
+            {
+                std::lock_guard const lock{mutex};
+                table->is_done = true;
+            }
+            table_done.notify_all();
+        }
+    };
+
+    auto stop_workers = [&]() {
+        {
+            std::lock_guard const lock{mutex};
+            is_stopping = true;
+            pending_tables.clear();
+        }
+        table_available.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+    };
+
+    // Waits for the oldest table to be marshalled and writes its records
+    auto write_next_table = [&]() {
+        std::unique_ptr<MarshalledTable> table;
+        {
+            std::unique_lock lock{mutex};
+            table_done.wait(lock, [&]() { return in_flight_tables.front()->is_done; });
+            table = std::move(in_flight_tables.front());
+            in_flight_tables.pop_front();
+        }
+        if (nullptr != table->exception) {
+            std::rethrow_exception(table->exception);
+        }
+        if (nullptr == output_mutex) {
+            writer.write(table->records.data(), table->records.size());
+            return;
+        }
+        std::lock_guard const lock{*output_mutex};
+        writer.write(table->records.data(), table->records.size());
+        writer.flush();
+    };
+
+    try {
+        for (size_t i{0}; i < m_option.num_threads; ++i) {
+            workers.emplace_back(run_worker);
+        }
+
+        m_archive_reader->prefetch_all_streams(m_option.num_threads, max_num_in_flight_tables);
+        for (auto const schema_id : m_archive_reader->get_schema_ids()) {
+            auto table = std::make_unique<MarshalledTable>();
+            table->reader
+                    = m_archive_reader->read_schema_table_into_new_reader(schema_id, false, true);
+            {
+                std::lock_guard const lock{mutex};
+                pending_tables.push_back(table.get());
+                in_flight_tables.push_back(std::move(table));
+            }
+            table_available.notify_one();
+
+            if (in_flight_tables.size() >= max_num_in_flight_tables) {
+                write_next_table();
+            }
+        }
+
+        while (false == in_flight_tables.empty()) {
+            write_next_table();
+        }
+    } catch (...) {
+        stop_workers();
+        throw;
+    }
+    stop_workers();
+}
+
+void JsonConstructor::construct_in_order(std::mutex* output_mutex) {
     std::string buffer;
-    auto tables = m_archive_reader->read_all_tables();
-    using ReaderPointer = std::shared_ptr<SchemaReader>;
-    auto cmp = [](ReaderPointer& left, ReaderPointer& right) {
-        return left->get_next_log_event_idx() > right->get_next_log_event_idx();
+    OrderedTableMerger table_merger{*m_archive_reader, m_option.max_ordered_memory_usage};
+
+    std::mutex print_mutex;
+    auto print_chunk_stats = [&](std::filesystem::path const& chunk_path) {
+        nlohmann::json json_msg;
+        json_msg["path"] = chunk_path.string();
+        std::lock_guard const lock{nullptr != output_mutex ? *output_mutex : print_mutex};
+        std::cout << json_msg.dump(-1, ' ', true, nlohmann::json::error_handler_t::ignore)
+                  << std::endl;
     };
-    std::priority_queue record_queue(tables.begin(), tables.end(), cmp);
-    // Clear tables vector so that memory gets deallocated after we have marshalled all records for
-    // a given table
-    tables.clear();
 
     int64_t first_idx{};
     int64_t last_idx{};
     size_t chunk_size{};
     auto src_path = std::filesystem::path(m_option.output_dir) / m_archive_reader->get_archive_id();
     FileWriter writer;
-    writer.open(src_path, FileWriter::OpenMode::CreateForWriting);
+    // With several threads, each chunk is buffered in `chunk` and written to its file by the pool
+    std::optional<ChunkWriterPool> chunk_writer_pool;
+    std::string chunk;
+    if (m_option.num_threads > 1 && 0 != m_option.target_ordered_chunk_size) {
+        std::function<void(std::filesystem::path const&)> on_chunk_written;
+        if (m_option.print_ordered_chunk_stats) {
+            on_chunk_written = print_chunk_stats;
+        }
+        chunk_writer_pool.emplace(m_option.num_threads, std::move(on_chunk_written));
+    } else {
+        writer.open(src_path, FileWriter::OpenMode::CreateForWriting);
+    }
 
     mongocxx::client client;
     mongocxx::collection collection;
@@ -97,14 +423,22 @@ void JsonConstructor::construct_in_order() {
     auto finalize_chunk = [&](bool open_new_writer) {
         // Add one to last_idx to match clp's behaviour of having the end index be exclusive
         ++last_idx;
-        writer.close();
         std::string new_file_name = src_path.string() + "_" + std::to_string(first_idx) + "_"
                                     + std::to_string(last_idx) + ".jsonl";
         auto new_file_path = std::filesystem::path(new_file_name);
-        std::error_code ec;
-        std::filesystem::rename(src_path, new_file_path, ec);
-        if (ec) {
-            throw OperationFailed(ErrorCodeFailure, __FILE__, __LINE__, ec.message());
+        if (chunk_writer_pool.has_value()) {
+            chunk_writer_pool->write(new_file_path, std::move(chunk));
+            chunk.clear();
+        } else {
+            writer.close();
+            std::error_code ec;
+            std::filesystem::rename(src_path, new_file_path, ec);
+            if (ec) {
+                throw OperationFailed(ErrorCodeFailure, __FILE__, __LINE__, ec.message());
+            }
+            if (m_option.print_ordered_chunk_stats) {
+                print_chunk_stats(new_file_path);
+            }
         }
 
         if (m_option.metadata_db.has_value()) {
@@ -136,30 +470,20 @@ void JsonConstructor::construct_in_order() {
             );
         }
 
-        if (m_option.print_ordered_chunk_stats) {
-            nlohmann::json json_msg;
-            json_msg["path"] = new_file_path.string();
-            std::cout << json_msg.dump(-1, ' ', true, nlohmann::json::error_handler_t::ignore)
-                      << std::endl;
-        }
-
-        if (open_new_writer) {
+        if (open_new_writer && false == chunk_writer_pool.has_value()) {
             writer.open(src_path, FileWriter::OpenMode::CreateForWriting);
         }
     };
 
-    while (false == record_queue.empty()) {
-        ReaderPointer next = record_queue.top();
-        record_queue.pop();
-        last_idx = next->get_next_log_event_idx();
+    while (table_merger.get_next_message(buffer, last_idx)) {
         if (0 == chunk_size) {
             first_idx = last_idx;
         }
-        next->get_next_message(buffer);
-        if (false == next->done()) {
-            record_queue.emplace(std::move(next));
+        if (chunk_writer_pool.has_value()) {
+            chunk += buffer;
+        } else {
+            writer.write(buffer.c_str(), buffer.length());
         }
-        writer.write(buffer.c_str(), buffer.length());
         chunk_size += buffer.length();
 
         if (0 != m_option.target_ordered_chunk_size
@@ -170,9 +494,15 @@ void JsonConstructor::construct_in_order() {
         }
     }
 
+    SPDLOG_DEBUG(
+            "Peak memory used to decompress archive {} in log order: {} B",
+            m_archive_reader->get_archive_id(),
+            table_merger.get_peak_memory_usage()
+    );
+
     if (chunk_size > 0) {
         finalize_chunk(false);
-    } else {
+    } else if (false == chunk_writer_pool.has_value()) {
         writer.close();
         std::error_code ec;
         std::filesystem::remove(src_path, ec);
@@ -181,6 +511,10 @@ void JsonConstructor::construct_in_order() {
         }
     }
 
+    if (chunk_writer_pool.has_value()) {
+        chunk_writer_pool->finish();
+    }
+
     if (false == results.empty()) {
         try {
             collection.insert_many(results);
@@ -189,4 +523,45 @@ void JsonConstructor::construct_in_order() {
         }
     }
 }
+
+auto decompress_archives_concurrently(
+        std::vector<Path> const& archive_paths,
+        JsonConstructorOption const& option,
+        size_t parallelism
+) -> bool {
+    auto const num_workers = std::min(parallelism, archive_paths.size());
+
+    std::mutex output_mutex;
+    std::atomic_size_t next_archive_idx{0};
+    std::atomic_bool failed{false};
+    std::vector<std::thread> workers;
+    workers.reserve(num_workers);
+    for (size_t i{0}; i < num_workers; ++i) {
+        workers.emplace_back([&]() {
+            auto archive_option = option;
+            while (false == failed) {
+                auto const archive_idx = next_archive_idx++;
+                if (archive_idx >= archive_paths.size()) {
+                    break;
+                }
+                archive_option.archive_path = archive_paths[archive_idx];
+                try {
+                    JsonConstructor constructor{archive_option};
+                    constructor.store(&output_mutex);
+                } catch (std::exception const& e) {
+                    SPDLOG_ERROR(
+                            "Failed to decompress '{}' - {}",
+                            archive_option.archive_path.path,
+                            e.what()
+                    );
+                    failed = true;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return false == failed;
+}
 }  // namespace clp_s
@@ -1,10 +1,13 @@
 #ifndef CLP_S_JSONCONSTRUCTOR_HPP
 #define CLP_S_JSONCONSTRUCTOR_HPP
 
+#include <cstddef>
+#include <mutex>
 #include <optional>
 #include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "ArchiveReader.hpp"
 #include "ErrorCode.hpp"
@@ -24,10 +27,13 @@ struct MetadataDbOption {
 struct JsonConstructorOption {
     Path archive_path{};
     NetworkAuthOption network_auth{};
+    bool memory_map{false};
     std::string output_dir;
     bool ordered{false};
     bool print_ordered_chunk_stats{false};
     size_t target_ordered_chunk_size{};
+    size_t max_ordered_memory_usage{};
+    size_t num_threads{1};
     std::optional<MetadataDbOption> metadata_db{std::nullopt};
 };
 
@@ -57,19 +63,50 @@ public:
 
     /**
      * Decompresses each archive and stores the decompressed files in the output directory
+     * @param output_mutex A mutex shared by every JsonConstructor decompressing archives into the
+     * same output directory concurrently, or nullptr if there are no others. It's held while
+     * writing to shared output files and to stdout.
      */
-    void store();
+    void store(std::mutex* output_mutex = nullptr);
 
 private:
+    /**
+     * Marshals the tables from m_archive_reader on `num_threads` workers and writes the records
+     * they contain to writer, in the same order as `ArchiveReader::store`.
+     * @param writer
+     * @param output_mutex If not nullptr, it's held while writing to writer, and writer is flushed
+     * before it's released
+     */
+    void store_concurrently(FileWriter& writer, std::mutex* output_mutex);
+
     /**
      * Reads all of the tables from m_archive_reader and writes all of the records
-     * they contain to writer in log order.
+     * they contain to writer in log order. Tables are decompressed on demand and released once
+     * drained, so that the memory used stays within `max_ordered_memory_usage` where possible.
+     * When chunking with several threads, each chunk is buffered and written to its file on a
+     * separate thread while the next chunk is decompressed.
+     * @param output_mutex If not nullptr, it's held while printing chunk statistics
      */
-    void construct_in_order();
+    void construct_in_order(std::mutex* output_mutex);
 
     JsonConstructorOption m_option{};
     std::unique_ptr<ArchiveReader> m_archive_reader;
 };
+
+/**
+ * Decompresses archives into the same output directory, decompressing up to `parallelism`
+ * archives concurrently, each with its own JsonConstructor. Once any decompression fails, no
+ * further archives are decompressed.
+ * @param archive_paths
+ * @param option The options shared by every archive
+ * @param parallelism
+ * @return Whether every archive was decompressed
+ */
+auto decompress_archives_concurrently(
+        std::vector<Path> const& archive_paths,
+        JsonConstructorOption const& option,
+        size_t parallelism
+) -> bool;
 }  // namespace clp_s
 
 #endif  // CLP_S_JSONCONSTRUCTOR_HPP
@@ -126,6 +126,8 @@ JsonParser::JsonParser(JsonParserOption const& option)
     m_archive_options.print_archive_stats = option.print_archive_stats;
     m_archive_options.single_file_archive = option.single_file_archive;
     m_archive_options.min_table_size = option.min_table_size;
+    m_archive_options.num_compression_threads = option.num_threads;
+    m_archive_options.separate_columns_table_size = option.separate_columns_table_size;
     m_archive_options.id = m_generator();
     m_archive_options.authoritative_timestamp = m_timestamp_column;
     m_archive_options.authoritative_timestamp_namespace = m_timestamp_namespace;
@@ -367,8 +369,7 @@ void JsonParser::parse_line(ondemand::value line, int32_t parent_node_id, std::s
                     );
                     parse_array(std::move(line.get_array()), node_id);
                 } else {
-                    std::string value
-                            = std::string(std::string_view(simdjson::to_json_string(line)));
+                    std::string_view const value{simdjson::to_json_string(line)};
                     node_id = m_archive_writer->add_node(
                             node_id_stack.top(),
                             NodeType::UnstructuredArray,
@@ -42,11 +42,13 @@ struct JsonParserOption {
     size_t target_encoded_size{};
     size_t max_document_size{};
     size_t min_table_size{};
+    size_t separate_columns_table_size{};
     int compression_level{};
     bool print_archive_stats{};
     bool structurize_arrays{};
     bool record_log_order{true};
     bool single_file_archive{false};
+    size_t num_threads{1};
     NetworkAuthOption network_auth{};
 };
 
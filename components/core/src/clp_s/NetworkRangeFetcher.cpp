@@ -0,0 +1,178 @@
+#include "NetworkRangeFetcher.hpp"
+
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "../clp/CurlEasyHandle.hpp"
+#include "../clp/CurlOperationFailed.hpp"
+#include "../clp/CurlStringList.hpp"
+#include "ErrorCode.hpp"
+
+namespace clp_s {
+namespace {
+/**
+ * The destination of the response to a range request.
+ */
+struct RangeResponse {
+    std::vector<char>* contents;
+    size_t expected_size;
+};
+
+/**
+ * libcurl write callback that appends the response to a range request to its destination.
+ * @param ptr
+ * @param size
+ * @param nmemb
+ * @param response_ptr
+ * @return The number of bytes appended, or 0 to abort the transfer if the server returned more
+ * bytes than were requested.
+ */
+extern "C" auto range_write_callback(char* ptr, size_t size, size_t nmemb, void* response_ptr)
+        -> size_t {
+    auto& response{*static_cast<RangeResponse*>(response_ptr)};
+    auto const num_bytes{size * nmemb};
+    if (response.contents->size() + num_bytes > response.expected_size) {
+        // The server ignored the range, so stop before downloading the rest of the file
+        return 0;
+    }
+    response.contents->insert(response.contents->end(), ptr, ptr + num_bytes);
+    return num_bytes;
+}
+}  // namespace
+
+NetworkRangeFetcher::NetworkRangeFetcher(
+        std::string url,
+        size_t max_num_connections,
+        size_t max_coalescing_gap
+)
+        : m_url{std::move(url)},
+          m_max_num_connections{std::max(max_num_connections, size_t{1})},
+          m_max_coalescing_gap{max_coalescing_gap} {}
+
+auto NetworkRangeFetcher::fetch(std::vector<ByteRange> const& ranges) const
+        -> std::vector<std::vector<char>> {
+    constexpr size_t cNoRequest{std::numeric_limits<size_t>::max()};
+
+    // Coalesce the ranges in order of their beginning, skipping empty ranges
+    std::vector<size_t> range_order(ranges.size());
+    std::iota(range_order.begin(), range_order.end(), 0);
+    std::sort(range_order.begin(), range_order.end(), [&](size_t lhs, size_t rhs) {
+        return ranges[lhs].begin < ranges[rhs].begin;
+    });
+    std::vector<ByteRange> requests;
+    std::vector<size_t> range_request_indices(ranges.size(), cNoRequest);
+    for (auto const range_idx : range_order) {
+        auto const& range = ranges[range_idx];
+        if (range.begin > range.end) {
+            throw OperationFailed(ErrorCodeBadParam, __FILENAME__, __LINE__);
+        }
+        if (range.begin == range.end) {
+            continue;
+        }
+        if (false == requests.empty()
+            && range.begin <= requests.back().end + m_max_coalescing_gap)
+        {
+            requests.back().end = std::max(requests.back().end, range.end);
+        } else {
+            requests.push_back(range);
+        }
+        range_request_indices[range_idx] = requests.size() - 1;
+    }
+
+    std::vector<std::vector<char>> responses(requests.size());
+    std::atomic_size_t next_request_idx{0};
+    std::mutex exception_mutex;
+    std::exception_ptr exception;
+    auto record_exception = [&](std::exception_ptr const& request_exception) {
+        std::lock_guard const lock{exception_mutex};
+        if (nullptr == exception) {
+            exception = request_exception;
+        }
+        // Stop any remaining requests from being sent
+        next_request_idx = requests.size();
+    };
+    auto send_requests = [&]() {
+        try {
+            clp::CurlEasyHandle easy_handle;
+            for (auto i{next_request_idx++}; i < requests.size(); i = next_request_idx++) {
+                fetch_range(easy_handle, requests[i], responses[i]);
+            }
+        } catch (clp::CurlOperationFailed const& e) {
+            record_exception(std::make_exception_ptr(
+                    OperationFailed(ErrorCodeFailureNetwork, __FILENAME__, __LINE__)
+            ));
+        } catch (...) {
+            record_exception(std::current_exception());
+        }
+    };
+
+    auto const num_connections{std::min(m_max_num_connections, requests.size())};
+    std::vector<std::thread> threads;
+    threads.reserve(num_connections > 0 ? num_connections - 1 : 0);
+    for (size_t i{1}; i < num_connections; ++i) {
+        threads.emplace_back(send_requests);
+    }
+    send_requests();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (nullptr != exception) {
+        std::rethrow_exception(exception);
+    }
+
+    std::vector<std::vector<char>> contents(ranges.size());
+    for (size_t i{0}; i < ranges.size(); ++i) {
+        auto const request_idx{range_request_indices[i]};
+        if (cNoRequest == request_idx) {
+            continue;
+        }
+        auto const& range{ranges[i]};
+        auto const& response{responses[request_idx]};
+        auto const begin{response.begin() + (range.begin - requests[request_idx].begin)};
+        contents[i].assign(begin, begin + (range.end - range.begin));
+    }
+    return contents;
+}
+
+void NetworkRangeFetcher::fetch_range(
+        clp::CurlEasyHandle& easy_handle,
+        ByteRange range,
+        std::vector<char>& contents
+) const {
+    auto const size{range.end - range.begin};
+    contents.clear();
+    contents.reserve(size);
+    RangeResponse response{&contents, size};
+
+    CURLcode ret_code{CURLE_OK};
+    try {
+        clp::CurlStringList http_headers;
+        http_headers.append(fmt::format("range: bytes={}-{}", range.begin, range.end - 1));
+        easy_handle.set_option(CURLOPT_URL, m_url.c_str());
+        easy_handle.set_option(CURLOPT_HTTPHEADER, http_headers.get_raw_list());
+        easy_handle.set_option(CURLOPT_WRITEFUNCTION, range_write_callback);
+        easy_handle.set_option(CURLOPT_WRITEDATA, static_cast<void*>(&response));
+        ret_code = easy_handle.perform();
+        // The header list is freed once this scope ends, so the handle mustn't keep pointing to it
+        easy_handle.set_option(CURLOPT_HTTPHEADER, static_cast<curl_slist*>(nullptr));
+    } catch (clp::CurlOperationFailed const& e) {
+        throw OperationFailed(ErrorCodeFailureNetwork, __FILENAME__, __LINE__);
+    }
+    if (CURLE_OK != ret_code || contents.size() != size) {
+        throw OperationFailed(ErrorCodeFailureNetwork, __FILENAME__, __LINE__);
+    }
+}
+}  // namespace clp_s
@@ -0,0 +1,89 @@
+#ifndef CLP_S_NETWORKRANGEFETCHER_HPP
+#define CLP_S_NETWORKRANGEFETCHER_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "../clp/CurlEasyHandle.hpp"
+#include "../clp/CurlGlobalInstance.hpp"
+#include "ErrorCode.hpp"
+#include "TraceableException.hpp"
+
+namespace clp_s {
+/**
+ * Class that fetches byte ranges of a remote file with HTTP range requests. Ranges that are
+ * adjacent, or separated by a small gap, are coalesced into a single request, and requests are
+ * sent concurrently over several connections.
+ *
+ * Fetching is thread-safe since every call uses its own connections.
+ */
+class NetworkRangeFetcher {
+public:
+    // Types
+    class OperationFailed : public TraceableException {
+    public:
+        // Constructors
+        OperationFailed(ErrorCode error_code, char const* const filename, int line_number)
+                : TraceableException(error_code, filename, line_number) {}
+    };
+
+    /**
+     * The range of bytes [begin, end) of the remote file.
+     */
+    struct ByteRange {
+        size_t begin;
+        size_t end;
+    };
+
+    // Constants
+    static constexpr size_t cDefaultMaxNumConnections{4};
+    // Downloading a gap this small takes less time than the round trip of another request
+    static constexpr size_t cDefaultMaxCoalescingGap{64ULL * 1024};  // 64 KiB
+
+    // Constructors
+    /**
+     * @param url
+     * @param max_num_connections The maximum number of requests that are sent concurrently
+     * @param max_coalescing_gap The maximum number of bytes between two ranges for them to be
+     * fetched by the same request
+     */
+    explicit NetworkRangeFetcher(
+            std::string url,
+            size_t max_num_connections = cDefaultMaxNumConnections,
+            size_t max_coalescing_gap = cDefaultMaxCoalescingGap
+    );
+
+    // Methods
+    /**
+     * Fetches the given ranges of the remote file.
+     * @param ranges
+     * @return The contents of each range, in the same order as `ranges`
+     * @throw OperationFailed if a range is invalid, or if a request fails or doesn't return exactly
+     * the requested range
+     */
+    [[nodiscard]] auto fetch(std::vector<ByteRange> const& ranges) const
+            -> std::vector<std::vector<char>>;
+
+private:
+    /**
+     * Fetches a range with a single request.
+     * @param easy_handle A handle that can be reused across requests to reuse its connection
+     * @param range
+     * @param contents Returns the contents of the range
+     * @throw OperationFailed if the request fails or doesn't return exactly the requested range
+     */
+    void fetch_range(
+            clp::CurlEasyHandle& easy_handle,
+            ByteRange range,
+            std::vector<char>& contents
+    ) const;
+
+    clp::CurlGlobalInstance m_curl_global_instance;
+    std::string m_url;
+    size_t m_max_num_connections;
+    size_t m_max_coalescing_gap;
+};
+}  // namespace clp_s
+
+#endif  // CLP_S_NETWORKRANGEFETCHER_HPP
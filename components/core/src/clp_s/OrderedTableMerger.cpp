@@ -0,0 +1,205 @@
+#include "OrderedTableMerger.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "ArchiveReader.hpp"
+#include "ErrorCode.hpp"
+#include "PackedStreamReader.hpp"
+
+namespace clp_s {
+OrderedTableMerger::OrderedTableMerger(ArchiveReader& archive_reader, size_t max_memory_usage)
+        : m_archive_reader{archive_reader},
+          m_max_memory_usage{max_memory_usage} {
+    auto const log_event_idx_column_id = m_archive_reader.get_log_event_idx_column_id();
+    if (log_event_idx_column_id < 0) {
+        throw OperationFailed(ErrorCodeBadParam, __FILENAME__, __LINE__);
+    }
+
+    for (auto const schema_id : m_archive_reader.get_schema_ids()) {
+        auto const& metadata = m_archive_reader.get_schema_metadata(schema_id);
+        if (0 == metadata.num_messages) {
+            continue;
+        }
+        auto& table = m_tables.emplace_back();
+        table.schema_id = schema_id;
+        table.metadata = &metadata;
+        for (auto const stream_id : get_stream_ids(table)) {
+            ++m_compressed_streams[stream_id].num_pending_tables;
+        }
+    }
+    m_next_unread_stream_it = m_compressed_streams.begin();
+
+    for (size_t table_idx{0}; table_idx < m_tables.size(); ++table_idx) {
+        auto& table = m_tables[table_idx];
+        auto const& value_ranges = table.metadata->column_value_ranges;
+        auto const it = value_ranges.find(log_event_idx_column_id);
+        if (value_ranges.end() != it
+            && std::holds_alternative<std::pair<int64_t, int64_t>>(it->second))
+        {
+            table.next_log_event_idx = std::get<std::pair<int64_t, int64_t>>(it->second).first;
+        } else {
+            // Older archives don't record the range, so the table's first record has to be read
+            load_table(table_idx);
+        }
+        m_queue.emplace(table.next_log_event_idx, table_idx);
+    }
+}
+
+auto OrderedTableMerger::get_next_message(std::string& message, int64_t& log_event_idx) -> bool {
+    while (false == m_queue.empty()) {
+        auto const [next_log_event_idx, table_idx] = m_queue.top();
+        m_queue.pop();
+        auto& table = m_tables[table_idx];
+        if (nullptr == table.reader) {
+            load_table(table_idx);
+            if (table.next_log_event_idx != next_log_event_idx) {
+                // The queue only held a lower bound for the table's next record
+                m_queue.emplace(table.next_log_event_idx, table_idx);
+                continue;
+            }
+        }
+
+        log_event_idx = next_log_event_idx;
+        table.reader->get_next_message(message);
+        ++table.num_messages_read;
+        if (table.reader->done()) {
+            release_table(table_idx);
+        } else {
+            table.next_log_event_idx = table.reader->get_next_log_event_idx();
+            m_queue.emplace(table.next_log_event_idx, table_idx);
+        }
+        return true;
+    }
+    return false;
+}
+
+auto OrderedTableMerger::get_stream_ids(Table const& table) -> std::vector<size_t> {
+    auto const& metadata = *table.metadata;
+    if (0 == metadata.num_column_streams) {
+        return {metadata.stream_id};
+    }
+    std::vector<size_t> stream_ids(metadata.num_column_streams);
+    std::iota(stream_ids.begin(), stream_ids.end(), metadata.stream_id);
+    return stream_ids;
+}
+
+void OrderedTableMerger::load_table(size_t table_idx) {
+    auto& table = m_tables[table_idx];
+    auto const& metadata = *table.metadata;
+    auto reader = m_archive_reader.create_schema_reader(table.schema_id, false, true);
+    if (0 != metadata.num_column_streams) {
+        if (reader->get_column_size() != metadata.num_column_streams) {
+            throw OperationFailed(ErrorCodeCorrupt, __FILENAME__, __LINE__);
+        }
+        for (size_t column_idx{0}; column_idx < metadata.num_column_streams; ++column_idx) {
+            auto const stream_id = metadata.stream_id + column_idx;
+            reader->load_column(
+                    column_idx,
+                    acquire_decompressed_stream(stream_id),
+                    m_archive_reader.get_uncompressed_stream_size(stream_id)
+            );
+        }
+    } else {
+        reader->load(
+                acquire_decompressed_stream(metadata.stream_id),
+                metadata.stream_offset,
+                metadata.uncompressed_size
+        );
+    }
+    reader->skip_messages(table.num_messages_read);
+    table.next_log_event_idx = reader->get_next_log_event_idx();
+    table.reader = std::move(reader);
+    m_loaded_table_idxs.push_back(table_idx);
+
+    enforce_memory_limit(table_idx);
+}
+
+void OrderedTableMerger::release_table(size_t table_idx) {
+    auto& table = m_tables[table_idx];
+    table.reader.reset();
+    std::erase(m_loaded_table_idxs, table_idx);
+
+    bool const is_drained{table.num_messages_read == table.metadata->num_messages};
+    for (auto const stream_id : get_stream_ids(table)) {
+        auto const decompressed_stream_it = m_decompressed_streams.find(stream_id);
+        if (0 == --decompressed_stream_it->second.num_loaded_tables) {
+            m_memory_usage -= m_archive_reader.get_uncompressed_stream_size(stream_id);
+            m_decompressed_streams.erase(decompressed_stream_it);
+        }
+
+        if (false == is_drained) {
+            continue;
+        }
+        auto const compressed_stream_it = m_compressed_streams.find(stream_id);
+        if (0 == --compressed_stream_it->second.num_pending_tables) {
+            m_memory_usage -= compressed_stream_it->second.buffer.capacity();
+            m_compressed_streams.erase(compressed_stream_it);
+        }
+    }
+}
+
+void OrderedTableMerger::enforce_memory_limit(size_t table_idx_to_keep) {
+    while (0 != m_max_memory_usage && m_memory_usage > m_max_memory_usage) {
+        // The table whose next record is furthest away is the last one the merge needs again
+        std::optional<size_t> table_idx_to_release;
+        for (auto const table_idx : m_loaded_table_idxs) {
+            if (table_idx_to_keep == table_idx) {
+                continue;
+            }
+            if (false == table_idx_to_release.has_value()
+                || m_tables[table_idx].next_log_event_idx
+                           > m_tables[table_idx_to_release.value()].next_log_event_idx)
+            {
+                table_idx_to_release = table_idx;
+            }
+        }
+        if (false == table_idx_to_release.has_value()) {
+            break;
+        }
+        release_table(table_idx_to_release.value());
+    }
+}
+
+auto OrderedTableMerger::acquire_decompressed_stream(size_t stream_id) -> std::shared_ptr<char[]> {
+    auto& decompressed_stream = m_decompressed_streams[stream_id];
+    if (nullptr == decompressed_stream.buffer) {
+        auto const uncompressed_size = m_archive_reader.get_uncompressed_stream_size(stream_id);
+        decompressed_stream.buffer = PackedStreamReader::decompress_stream(
+                read_compressed_stream(stream_id).data,
+                uncompressed_size
+        );
+        add_memory_usage(uncompressed_size);
+    }
+    ++decompressed_stream.num_loaded_tables;
+    return decompressed_stream.buffer;
+}
+
+auto OrderedTableMerger::read_compressed_stream(size_t stream_id) -> CompressedStream const& {
+    for (; m_compressed_streams.end() != m_next_unread_stream_it
+           && m_next_unread_stream_it->first <= stream_id;
+         ++m_next_unread_stream_it)
+    {
+        auto& [unread_stream_id, compressed_stream] = *m_next_unread_stream_it;
+        compressed_stream.data = m_archive_reader.read_compressed_stream(
+                unread_stream_id,
+                compressed_stream.buffer
+        );
+        add_memory_usage(compressed_stream.buffer.capacity());
+    }
+    return m_compressed_streams.at(stream_id);
+}
+
+void OrderedTableMerger::add_memory_usage(size_t num_bytes) {
+    m_memory_usage += num_bytes;
+    m_peak_memory_usage = std::max(m_peak_memory_usage, m_memory_usage);
+}
+}  // namespace clp_s
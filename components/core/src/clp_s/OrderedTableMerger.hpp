@@ -0,0 +1,166 @@
+#ifndef CLP_S_ORDEREDTABLEMERGER_HPP
+#define CLP_S_ORDEREDTABLEMERGER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <queue>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ArchiveReader.hpp"
+#include "ErrorCode.hpp"
+#include "SchemaReader.hpp"
+#include "TraceableException.hpp"
+
+namespace clp_s {
+/**
+ * Merges the tables of an archive to iterate over its records in log order, while bounding the
+ * memory used by decompressed tables.
+ *
+ * Tables are only decompressed once the merge reaches their first record, which is known up front
+ * for archives that record each table's log_event_idx range. Once a table has been drained, its
+ * decompressed and compressed streams are released. If loading a table takes the memory used
+ * over the limit, the loaded tables whose next record is furthest away are released, and are
+ * decompressed again from their compressed streams when the merge reaches them. The table being
+ * read is never released, so the limit is exceeded if it alone doesn't fit.
+ *
+ * Releasing the table that's needed furthest in the future decompresses tables the fewest times,
+ * but tables whose records are interleaved and that don't fit within the limit together are still
+ * decompressed again each time the merge switches between them.
+ *
+ * Since the tables section can't be read backwards, the compressed streams that are read are kept
+ * until every table in them has been drained. Compressed streams of memory mapped archives aren't
+ * copied, so they don't count towards the memory used.
+ */
+class OrderedTableMerger {
+public:
+    // Types
+    class OperationFailed : public TraceableException {
+    public:
+        // Constructors
+        OperationFailed(ErrorCode error_code, char const* const filename, int line_number)
+                : TraceableException(error_code, filename, line_number) {}
+    };
+
+    // Constructors
+    /**
+     * @param archive_reader An archive reader with log ordering information whose packed streams
+     * have been opened, but not read
+     * @param max_memory_usage The maximum memory (B) used by the streams read from the archive, or
+     * 0 for no limit
+     * @throw OperationFailed if the archive has no log ordering information
+     */
+    OrderedTableMerger(ArchiveReader& archive_reader, size_t max_memory_usage);
+
+    // Methods
+    /**
+     * Gets the next record in log order.
+     * @param message Returns the marshalled record
+     * @param log_event_idx Returns the record's log_event_idx
+     * @return true if there was a next record, false if every record has been read
+     */
+    auto get_next_message(std::string& message, int64_t& log_event_idx) -> bool;
+
+    /**
+     * @return The peak memory (B) used by the streams read from the archive
+     */
+    [[nodiscard]] auto get_peak_memory_usage() const -> size_t { return m_peak_memory_usage; }
+
+private:
+    // Types
+    struct Table {
+        int32_t schema_id{};
+        SchemaReader::SchemaMetadata const* metadata{nullptr};
+        // nullptr while the table isn't loaded
+        std::unique_ptr<SchemaReader> reader;
+        uint64_t num_messages_read{0};
+        // Exact while the table is loaded, and a lower bound otherwise
+        int64_t next_log_event_idx{0};
+    };
+
+    struct CompressedStream {
+        std::vector<char> buffer;
+        std::span<char const> data;
+        // The number of tables in the stream that haven't been drained
+        size_t num_pending_tables{0};
+    };
+
+    struct DecompressedStream {
+        std::shared_ptr<char[]> buffer;
+        // The number of loaded tables in the stream
+        size_t num_loaded_tables{0};
+    };
+
+    // Pairs of a table's next log_event_idx and its index in `m_tables`
+    using QueueEntry = std::pair<int64_t, size_t>;
+
+    // Methods
+    /**
+     * @param table
+     * @return The IDs of the streams the table is stored in
+     */
+    [[nodiscard]] static auto get_stream_ids(Table const& table) -> std::vector<size_t>;
+
+    /**
+     * Decompresses a table and resumes iterating over it where it was released, then releases
+     * other tables if the memory limit is exceeded.
+     * @param table_idx
+     */
+    void load_table(size_t table_idx);
+
+    /**
+     * Releases the decompressed streams of a table, as well as its compressed streams once it has
+     * been drained.
+     * @param table_idx
+     */
+    void release_table(size_t table_idx);
+
+    /**
+     * Releases the loaded tables whose next record is furthest away, other than the given table,
+     * until the memory used is within the limit.
+     * @param table_idx_to_keep
+     */
+    void enforce_memory_limit(size_t table_idx_to_keep);
+
+    /**
+     * Gets a decompressed stream, decompressing it if no loaded table uses it.
+     * @param stream_id
+     * @return A buffer containing the decompressed stream
+     */
+    auto acquire_decompressed_stream(size_t stream_id) -> std::shared_ptr<char[]>;
+
+    /**
+     * Reads the compressed streams in ascending order up to and including the given stream.
+     * @param stream_id
+     * @return The compressed stream
+     */
+    auto read_compressed_stream(size_t stream_id) -> CompressedStream const&;
+
+    /**
+     * Adds to the memory used, updating the peak memory used.
+     * @param num_bytes
+     */
+    void add_memory_usage(size_t num_bytes);
+
+    // Variables
+    ArchiveReader& m_archive_reader;
+    size_t m_max_memory_usage;
+    size_t m_memory_usage{0};
+    size_t m_peak_memory_usage{0};
+
+    std::vector<Table> m_tables;
+    std::vector<size_t> m_loaded_table_idxs;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<>> m_queue;
+    std::map<size_t, CompressedStream> m_compressed_streams;
+    // The first compressed stream that hasn't been read from the archive
+    std::map<size_t, CompressedStream>::iterator m_next_unread_stream_it;
+    std::map<size_t, DecompressedStream> m_decompressed_streams;
+};
+}  // namespace clp_s
+
+#endif  // CLP_S_ORDEREDTABLEMERGER_HPP
@@ -1,8 +1,11 @@
 #include "OutputHandlerImpl.hpp"
 
+#include <map>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <utility>
 
 #include <mongocxx/client.hpp>
 #include <mongocxx/collection.hpp>
@@ -14,8 +17,10 @@
 
 #include "../clp/networking/socket_utils.hpp"
 #include "../reducer/CountOperator.hpp"
+#include "../reducer/GroupTags.hpp"
 #include "../reducer/network_utils.hpp"
 #include "../reducer/Record.hpp"
+#include "../reducer/RecordGroupIterator.hpp"
 #include "archive_constants.hpp"
 #include "search/OutputHandler.hpp"
 
@@ -23,6 +28,18 @@ using std::string;
 using std::string_view;
 
 namespace clp_s {
+void SocketOutputHandler::write(string_view message) {
+    // Records end with a newline, which has to follow the enclosing object instead
+    if (false == message.empty() && '\n' == message.back()) {
+        message.remove_suffix(1);
+    }
+    m_buffer.clear();
+    m_buffer += R"({"result":)";
+    m_buffer += message;
+    m_buffer += "}\n";
+    clp::networking::send(m_socket_fd, m_buffer.data(), m_buffer.size());
+}
+
 NetworkOutputHandler::NetworkOutputHandler(
         string const& host,
         int port,
@@ -58,11 +75,13 @@ ResultsCacheOutputHandler::ResultsCacheOutputHandler(
         string const& collection,
         uint64_t batch_size,
         uint64_t max_num_results,
+        std::shared_ptr<search::TopKTimestamps> top_k_timestamps,
         bool should_output_timestamp
 )
         : ::clp_s::search::OutputHandler(should_output_timestamp, true),
           m_batch_size(batch_size),
-          m_max_num_results(max_num_results) {
+          m_max_num_results(max_num_results),
+          m_top_k_timestamps(std::move(top_k_timestamps)) {
     try {
         auto mongo_uri = mongocxx::uri(uri);
         m_client = mongocxx::client(mongo_uri);
@@ -135,6 +154,12 @@ void ResultsCacheOutputHandler::write(
         string_view archive_id,
         int64_t log_event_idx
 ) {
+    // Results that can't be among the latest results of the whole search (including the tables
+    // and archives that were already flushed) are dropped
+    if (false == m_top_k_timestamps->add(timestamp)) {
+        return;
+    }
+
     if (m_latest_results.size() < m_max_num_results) {
         m_latest_results.emplace(
                 std::make_unique<
@@ -149,20 +174,20 @@ void ResultsCacheOutputHandler::write(
     }
 }
 
-CountOutputHandler::CountOutputHandler(int reducer_socket_fd)
-        : ::clp_s::search::OutputHandler(false, false),
-          m_reducer_socket_fd(reducer_socket_fd),
-          m_pipeline(reducer::PipelineInputMode::InterStage) {
-    m_pipeline.add_pipeline_stage(std::make_shared<reducer::CountOperator>());
-}
-
-void CountOutputHandler::write(string_view message) {
-    m_pipeline.push_record(reducer::EmptyRecord{});
-}
-
 ErrorCode CountOutputHandler::finish() {
+    // Like the reducer's count operator, only send a count if there were any results
+    std::map<reducer::GroupTags, int64_t> group_counts;
+    if (m_count > 0) {
+        group_counts.emplace(reducer::GroupTags{}, m_count);
+    }
     if (false
-        == reducer::send_pipeline_results(m_reducer_socket_fd, std::move(m_pipeline.finish())))
+        == reducer::send_pipeline_results(
+                m_reducer_socket_fd,
+                std::make_unique<reducer::Int64MapRecordGroupIterator>(
+                        group_counts,
+                        reducer::CountOperator::cRecordElementKey
+                )
+        ))
     {
         return ErrorCode::ErrorCodeFailureNetwork;
     }
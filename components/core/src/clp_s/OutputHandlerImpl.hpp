@@ -6,18 +6,22 @@
 #include <unistd.h>
 
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <queue>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include <mongocxx/client.hpp>
 #include <mongocxx/collection.hpp>
 
-#include "../reducer/Pipeline.hpp"
 #include "../reducer/RecordGroupIterator.hpp"
 #include "Defs.hpp"
 #include "search/OutputHandler.hpp"
+#include "search/TopKTimestamps.hpp"
 #include "TraceableException.hpp"
 
 namespace clp_s {
@@ -43,6 +47,34 @@ public:
     void write(std::string_view message) override { std::cout << message; }
 };
 
+/**
+ * Output handler that writes to a connected socket. Each result is written as a line holding a JSON
+ * object with the record under the `result` key.
+ */
+class SocketOutputHandler : public ::clp_s::search::OutputHandler {
+public:
+    // Constructors
+    explicit SocketOutputHandler(int socket_fd)
+            : ::clp_s::search::OutputHandler(false, true),
+              m_socket_fd{socket_fd} {}
+
+    // Methods inherited from OutputHandler
+    void write(
+            std::string_view message,
+            [[maybe_unused]] epochtime_t timestamp,
+            [[maybe_unused]] std::string_view archive_id,
+            [[maybe_unused]] int64_t log_event_idx
+    ) override {
+        write(message);
+    }
+
+    void write(std::string_view message) override;
+
+private:
+    int m_socket_fd;
+    std::string m_buffer;
+};
+
 /**
  * Output handler that writes to a network destination.
  */
@@ -131,11 +163,21 @@ public:
     };
 
     // Constructor
+    /**
+     * @param uri
+     * @param collection
+     * @param batch_size
+     * @param max_num_results
+     * @param top_k_timestamps The latest timestamps kept so far, shared by the output handlers of
+     * every archive in the search. Must track `max_num_results` timestamps.
+     * @param should_output_metadata
+     */
     ResultsCacheOutputHandler(
             std::string const& uri,
             std::string const& collection,
             uint64_t batch_size,
             uint64_t max_num_results,
+            std::shared_ptr<::clp_s::search::TopKTimestamps> top_k_timestamps,
             bool should_output_metadata = true
     );
 
@@ -156,12 +198,21 @@ public:
 
     void write(std::string_view message) override { write(message, 0, {}, 0); }
 
+    // Only the latest results are kept regardless of the order they are written in
+    [[nodiscard]] auto should_preserve_table_order() const -> bool override { return false; }
+
+    [[nodiscard]] auto get_top_k_timestamps() const
+            -> ::clp_s::search::TopKTimestamps const* override {
+        return m_top_k_timestamps.get();
+    }
+
 private:
     mongocxx::client m_client;
     mongocxx::collection m_collection;
     std::vector<bsoncxx::document::value> m_results;
     uint64_t m_batch_size;
     uint64_t m_max_num_results;
+    std::shared_ptr<::clp_s::search::TopKTimestamps> m_top_k_timestamps;
     std::priority_queue<
             std::unique_ptr<QueryResult>,
             std::vector<std::unique_ptr<QueryResult>>,
@@ -175,7 +226,9 @@ private:
 class CountOutputHandler : public ::clp_s::search::OutputHandler {
 public:
     // Constructors
-    CountOutputHandler(int reducer_socket_fd);
+    explicit CountOutputHandler(int reducer_socket_fd)
+            : ::clp_s::search::OutputHandler(false, false),
+              m_reducer_socket_fd{reducer_socket_fd} {}
 
     // Methods inherited from OutputHandler
     void write(
@@ -185,7 +238,15 @@ public:
             int64_t log_event_idx
     ) override {}
 
-    void write(std::string_view message) override;
+    void write(std::string_view message) override { ++m_count; }
+
+    void add_count(uint64_t count) override { m_count += static_cast<int64_t>(count); }
+
+    [[nodiscard]] auto should_preserve_table_order() const -> bool override { return false; }
+
+    [[nodiscard]] auto get_pushdown_aggregation() const -> PushdownAggregation override {
+        return PushdownAggregation::Count;
+    }
 
     /**
      * Flushes the count.
@@ -196,7 +257,7 @@ public:
 
 private:
     int m_reducer_socket_fd;
-    reducer::Pipeline m_pipeline;
+    int64_t m_count{0};
 };
 
 /**
@@ -218,12 +279,27 @@ public:
             std::string_view archive_id,
             int64_t log_event_idx
     ) override {
-        int64_t bucket = (timestamp / m_count_by_time_bucket_size) * m_count_by_time_bucket_size;
-        m_bucket_counts[bucket] += 1;
+        add_count_by_time(timestamp, 1);
     }
 
     void write(std::string_view message) override {}
 
+    void add_count_by_time(epochtime_t timestamp, uint64_t count) override {
+        int64_t bucket = (timestamp / m_count_by_time_bucket_size) * m_count_by_time_bucket_size;
+        // Consecutive results usually fall in the same bucket, so cache the last bucket's count
+        if (nullptr == m_last_bucket_count || bucket != m_last_bucket) {
+            m_last_bucket = bucket;
+            m_last_bucket_count = &m_bucket_counts[bucket];
+        }
+        *m_last_bucket_count += static_cast<int64_t>(count);
+    }
+
+    [[nodiscard]] auto should_preserve_table_order() const -> bool override { return false; }
+
+    [[nodiscard]] auto get_pushdown_aggregation() const -> PushdownAggregation override {
+        return PushdownAggregation::CountByTime;
+    }
+
     /**
      * Flushes the counts.
      * @return ErrorCodeSuccess on success
@@ -235,6 +311,85 @@ private:
     int m_reducer_socket_fd;
     std::map<int64_t, int64_t> m_bucket_counts;
     int64_t m_count_by_time_bucket_size;
+    int64_t m_last_bucket{0};
+    int64_t* m_last_bucket_count{nullptr};
+};
+
+/**
+ * Output handler that forwards results to another output handler while holding a mutex, allowing
+ * the output handlers of several concurrent searches to share a destination (e.g. standard output
+ * or the reducer socket) without interleaving their output.
+ */
+class SynchronizedOutputHandler : public ::clp_s::search::OutputHandler {
+public:
+    // Constructors
+    /**
+     * @param output_handler The output handler to forward results to
+     * @param mutex The mutex shared by every output handler writing to the same destination
+     */
+    SynchronizedOutputHandler(
+            std::unique_ptr<::clp_s::search::OutputHandler> output_handler,
+            std::mutex& mutex
+    )
+            : ::clp_s::search::OutputHandler(
+                      output_handler->should_output_metadata(),
+                      output_handler->should_marshal_records()
+              ),
+              m_output_handler{std::move(output_handler)},
+              m_mutex{mutex} {}
+
+    // Methods inherited from OutputHandler
+    void write(
+            std::string_view message,
+            epochtime_t timestamp,
+            std::string_view archive_id,
+            int64_t log_event_idx
+    ) override {
+        std::lock_guard const lock{m_mutex};
+        m_output_handler->write(message, timestamp, archive_id, log_event_idx);
+    }
+
+    void write(std::string_view message) override {
+        std::lock_guard const lock{m_mutex};
+        m_output_handler->write(message);
+    }
+
+    [[nodiscard]] auto flush() -> ErrorCode override {
+        std::lock_guard const lock{m_mutex};
+        return m_output_handler->flush();
+    }
+
+    [[nodiscard]] auto finish() -> ErrorCode override {
+        std::lock_guard const lock{m_mutex};
+        return m_output_handler->finish();
+    }
+
+    void add_count(uint64_t count) override {
+        std::lock_guard const lock{m_mutex};
+        m_output_handler->add_count(count);
+    }
+
+    void add_count_by_time(epochtime_t timestamp, uint64_t count) override {
+        std::lock_guard const lock{m_mutex};
+        m_output_handler->add_count_by_time(timestamp, count);
+    }
+
+    [[nodiscard]] auto should_preserve_table_order() const -> bool override {
+        return m_output_handler->should_preserve_table_order();
+    }
+
+    [[nodiscard]] auto get_pushdown_aggregation() const -> PushdownAggregation override {
+        return m_output_handler->get_pushdown_aggregation();
+    }
+
+    [[nodiscard]] auto get_top_k_timestamps() const
+            -> ::clp_s::search::TopKTimestamps const* override {
+        return m_output_handler->get_top_k_timestamps();
+    }
+
+private:
+    std::unique_ptr<::clp_s::search::OutputHandler> m_output_handler;
+    std::mutex& m_mutex;
 };
 
 /**
@@ -1,8 +1,19 @@
 #include "PackedStreamReader.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
 #include "../clp/BoundedReader.hpp"
 #include "archive_constants.hpp"
 #include "ArchiveReaderAdaptor.hpp"
+#include "NetworkRangeFetcher.hpp"
 
 namespace clp_s {
 void PackedStreamReader::read_metadata(ZstdDecompressor& decompressor) {
@@ -50,7 +61,14 @@ void PackedStreamReader::open_packed_streams(std::shared_ptr<ArchiveReaderAdapto
             throw OperationFailed(ErrorCodeNotReady, __FILE__, __LINE__);
     }
     m_adaptor = adaptor;
+    if (m_adaptor->is_fetching_ranges()) {
+        // Streams are fetched individually, so the tables section doesn't need to be checked out
+        m_is_fetching_ranges = true;
+        m_tables_section_size = m_adaptor->get_sfa_section_size(constants::cArchiveTablesFile);
+        return;
+    }
     m_packed_stream_reader = m_adaptor->checkout_reader_for_section(constants::cArchiveTablesFile);
+    m_packed_stream_view = m_adaptor->get_checked_out_section_view();
     if (auto rc = m_packed_stream_reader->try_get_pos(m_begin_offset);
         clp::ErrorCode::ErrorCode_Success != rc)
     {
@@ -59,29 +77,284 @@ void PackedStreamReader::open_packed_streams(std::shared_ptr<ArchiveReaderAdapto
 }
 
 void PackedStreamReader::close() {
+    stop_prefetching();
     bool needs_checkin{false};
     switch (m_state) {
         case PackedStreamReaderState::PackedStreamsOpened:
         case PackedStreamReaderState::ReadingPackedStreams:
-            needs_checkin = true;
+            needs_checkin = false == m_is_fetching_ranges;
             break;
         default:
             needs_checkin = false;
             break;
     }
+    m_packed_stream_view.reset();
     if (needs_checkin) {
         m_adaptor->checkin_reader_for_section(constants::cArchiveTablesFile);
     }
     m_adaptor.reset();
+    m_is_fetching_ranges = false;
+    m_tables_section_size = 0ULL;
+    m_compressed_stream_buffer = std::vector<char>{};
     m_prev_stream_id = 0ULL;
     m_begin_offset = 0ULL;
     m_stream_metadata.clear();
     m_state = PackedStreamReaderState::Uninitialized;
 }
 
+void PackedStreamReader::enable_prefetching(
+        std::vector<size_t> stream_ids,
+        size_t num_threads,
+        size_t max_num_prefetched_streams
+) {
+    if (PackedStreamReaderState::PackedStreamsOpened != m_state || m_is_prefetching) {
+        throw OperationFailed(ErrorCodeNotReady, __FILE__, __LINE__);
+    }
+    if (0 == num_threads || 0 == max_num_prefetched_streams) {
+        throw OperationFailed(ErrorCodeBadParam, __FILE__, __LINE__);
+    }
+    for (size_t i = 0; i < stream_ids.size(); ++i) {
+        if (stream_ids[i] >= m_stream_metadata.size()
+            || (i > 0 && stream_ids[i - 1] >= stream_ids[i]))
+        {
+            throw OperationFailed(ErrorCodeBadParam, __FILE__, __LINE__);
+        }
+    }
+
+    m_prefetch_stream_ids = std::move(stream_ids);
+    m_prefetched_streams.clear();
+    m_prefetched_streams.resize(m_prefetch_stream_ids.size());
+    m_max_num_prefetched_streams = max_num_prefetched_streams;
+    m_next_prefetch_read_idx = 0;
+    m_next_prefetch_consume_idx = 0;
+    m_stop_prefetching = false;
+    m_is_prefetching = true;
+
+    num_threads = std::min(num_threads, m_prefetch_stream_ids.size());
+    m_prefetch_threads.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+        m_prefetch_threads.emplace_back([this]() { prefetch_streams(); });
+    }
+}
+
 void
 PackedStreamReader::read_stream(size_t stream_id, std::shared_ptr<char[]>& buf, size_t& buf_size) {
+    if (m_is_prefetching) {
+        buf = read_prefetched_stream(stream_id);
+        buf_size = m_stream_metadata[stream_id].uncompressed_size;
+        return;
+    }
+
     constexpr size_t cDecompressorFileReadBufferCapacity = 64 * 1024;  // 64 KB
+    std::optional<clp::BoundedReader> bounded_reader;
+    if (m_packed_stream_view.has_value() || m_is_fetching_ranges) {
+        auto const compressed_stream = read_packed_stream(stream_id, m_compressed_stream_buffer);
+        m_packed_stream_decompressor.open(compressed_stream.data(), compressed_stream.size());
+    } else {
+        auto const end_pos = seek_to_stream(stream_id);
+        bounded_reader.emplace(m_packed_stream_reader.get(), end_pos);
+        m_packed_stream_decompressor.open(*bounded_reader, cDecompressorFileReadBufferCapacity);
+    }
+
+    auto const uncompressed_size = m_stream_metadata[stream_id].uncompressed_size;
+    if (buf_size < uncompressed_size) {
+        // make_shared is supposed to work here for c++20, but it seems like the compiler version
+        // we use doesn't support it, so we convert a unique_ptr to a shared_ptr instead.
+        buf = std::make_unique<char[]>(uncompressed_size);
+        buf_size = uncompressed_size;
+    }
+    if (auto error
+        = m_packed_stream_decompressor.try_read_exact_length(buf.get(), uncompressed_size);
+        ErrorCodeSuccess != error)
+    {
+        throw OperationFailed(error, __FILE__, __LINE__);
+    }
+    m_packed_stream_decompressor.close_for_reuse();
+}
+
+auto PackedStreamReader::read_compressed_stream(size_t stream_id, std::vector<char>& buffer)
+        -> std::span<char const> {
+    if (m_is_prefetching) {
+        throw OperationFailed(ErrorCodeNotReady, __FILE__, __LINE__);
+    }
+    return read_packed_stream(stream_id, buffer);
+}
+
+auto PackedStreamReader::decompress_stream(
+        std::span<char const> compressed_stream,
+        size_t uncompressed_size
+) -> std::shared_ptr<char[]> {
+    std::shared_ptr<char[]> buf = std::make_unique<char[]>(uncompressed_size);
+    ZstdDecompressor decompressor;
+    decompressor.open(compressed_stream.data(), compressed_stream.size());
+    if (auto error = decompressor.try_read_exact_length(buf.get(), uncompressed_size);
+        ErrorCodeSuccess != error)
+    {
+        throw OperationFailed(error, __FILE__, __LINE__);
+    }
+    decompressor.close();
+    return buf;
+}
+
+auto PackedStreamReader::read_packed_stream(size_t stream_id, std::vector<char>& buffer)
+        -> std::span<char const> {
+    if (m_packed_stream_view.has_value()) {
+        return get_mapped_stream(stream_id);
+    }
+    if (m_is_fetching_ranges) {
+        return fetch_stream(get_stream_range(stream_id, m_tables_section_size), buffer);
+    }
+
+    auto const end_pos = seek_to_stream(stream_id);
+    size_t begin_pos{};
+    if (auto error = m_packed_stream_reader->try_get_pos(begin_pos);
+        clp::ErrorCode::ErrorCode_Success != error)
+    {
+        throw OperationFailed(static_cast<ErrorCode>(error), __FILE__, __LINE__);
+    }
+    if (end_pos < begin_pos) {
+        throw OperationFailed(ErrorCodeCorrupt, __FILE__, __LINE__);
+    }
+
+    buffer.resize(end_pos - begin_pos);
+    if (auto error = m_packed_stream_reader->try_read_exact_length(buffer.data(), buffer.size());
+        clp::ErrorCode::ErrorCode_Success != error)
+    {
+        throw OperationFailed(static_cast<ErrorCode>(error), __FILE__, __LINE__);
+    }
+    return buffer;
+}
+
+auto PackedStreamReader::read_prefetched_stream(size_t stream_id) -> std::shared_ptr<char[]> {
+    std::unique_lock<std::mutex> lock{m_prefetch_mutex};
+    auto const it = std::lower_bound(
+            m_prefetch_stream_ids.begin() + m_next_prefetch_consume_idx,
+            m_prefetch_stream_ids.end(),
+            stream_id
+    );
+    if (m_prefetch_stream_ids.end() == it || *it != stream_id) {
+        throw OperationFailed(ErrorCodeBadParam, __FILE__, __LINE__);
+    }
+    auto const idx = static_cast<size_t>(it - m_prefetch_stream_ids.begin());
+
+    // Discard any skipped streams, and let the prefetching threads move on past them. The stream
+    // being read must remain claimable until it's ready, so it's only consumed after the wait.
+    for (size_t i = m_next_prefetch_consume_idx; i < idx; ++i) {
+        m_prefetched_streams[i] = PrefetchedStream{};
+    }
+    m_next_prefetch_consume_idx = idx;
+    m_prefetch_cv.notify_all();
+
+    auto& prefetched_stream = m_prefetched_streams[idx];
+    m_prefetch_cv.wait(lock, [&]() { return prefetched_stream.is_ready; });
+    auto buffer = std::move(prefetched_stream.buffer);
+    auto exception = std::move(prefetched_stream.exception);
+    prefetched_stream = PrefetchedStream{};
+    m_next_prefetch_consume_idx = idx + 1;
+    m_prefetch_cv.notify_all();
+    if (nullptr != exception) {
+        std::rethrow_exception(exception);
+    }
+    return buffer;
+}
+
+void PackedStreamReader::prefetch_streams() {
+    std::vector<char> compressed_buffer;
+    std::span<char const> compressed_stream;
+    while (true) {
+        size_t idx{};
+        std::exception_ptr exception;
+        std::optional<NetworkRangeFetcher::ByteRange> range_to_fetch;
+        {
+            // Streams are claimed and read while holding the read mutex so that they're read from
+            // the tables section in ascending order.
+            std::lock_guard<std::mutex> const read_lock{m_prefetch_read_mutex};
+            {
+                std::unique_lock<std::mutex> lock{m_prefetch_mutex};
+                m_next_prefetch_read_idx
+                        = std::max(m_next_prefetch_read_idx, m_next_prefetch_consume_idx);
+                m_prefetch_cv.wait(lock, [&]() {
+                    return m_stop_prefetching
+                           || m_next_prefetch_read_idx >= m_prefetch_stream_ids.size()
+                           || m_next_prefetch_read_idx
+                                      < m_next_prefetch_consume_idx + m_max_num_prefetched_streams;
+                });
+                m_next_prefetch_read_idx
+                        = std::max(m_next_prefetch_read_idx, m_next_prefetch_consume_idx);
+                if (m_stop_prefetching || m_next_prefetch_read_idx >= m_prefetch_stream_ids.size())
+                {
+                    return;
+                }
+                idx = m_next_prefetch_read_idx++;
+            }
+            try {
+                if (m_is_fetching_ranges) {
+                    // Streams are fetched once the read mutex is released so that several
+                    // streams can be fetched concurrently.
+                    range_to_fetch
+                            = get_stream_range(m_prefetch_stream_ids[idx], m_tables_section_size);
+                } else {
+                    compressed_stream
+                            = read_packed_stream(m_prefetch_stream_ids[idx], compressed_buffer);
+                }
+            } catch (...) {
+                exception = std::current_exception();
+            }
+        }
+
+        if (nullptr == exception && range_to_fetch.has_value()) {
+            try {
+                compressed_stream = fetch_stream(range_to_fetch.value(), compressed_buffer);
+            } catch (...) {
+                exception = std::current_exception();
+            }
+        }
+
+        std::shared_ptr<char[]> decompressed_stream;
+        if (nullptr == exception) {
+            try {
+                decompressed_stream = decompress_stream(
+                        compressed_stream,
+                        m_stream_metadata[m_prefetch_stream_ids[idx]].uncompressed_size
+                );
+            } catch (...) {
+                exception = std::current_exception();
+            }
+        }
+
+        std::lock_guard<std::mutex> const lock{m_prefetch_mutex};
+        if (idx < m_next_prefetch_consume_idx) {
+            // The stream was skipped while it was being prefetched.
+            continue;
+        }
+        auto& prefetched_stream = m_prefetched_streams[idx];
+        prefetched_stream.buffer = std::move(decompressed_stream);
+        prefetched_stream.exception = std::move(exception);
+        prefetched_stream.is_ready = true;
+        m_prefetch_cv.notify_all();
+    }
+}
+
+void PackedStreamReader::stop_prefetching() {
+    {
+        std::lock_guard<std::mutex> const lock{m_prefetch_mutex};
+        m_stop_prefetching = true;
+    }
+    m_prefetch_cv.notify_all();
+    for (auto& thread : m_prefetch_threads) {
+        thread.join();
+    }
+    m_prefetch_threads.clear();
+    m_prefetch_stream_ids.clear();
+    m_prefetched_streams.clear();
+    m_max_num_prefetched_streams = 0;
+    m_next_prefetch_read_idx = 0;
+    m_next_prefetch_consume_idx = 0;
+    m_is_prefetching = false;
+    m_stop_prefetching = false;
+}
+
+void PackedStreamReader::advance_to_stream(size_t stream_id) {
     if (stream_id >= m_stream_metadata.size()) {
         throw OperationFailed(ErrorCodeCorrupt, __FILE__, __LINE__);
     }
@@ -99,9 +372,12 @@ PackedStreamReader::read_stream(size_t stream_id, std::shared_ptr<char[]>& buf,
             throw OperationFailed(ErrorCodeNotReady, __FILE__, __LINE__);
     }
     m_prev_stream_id = stream_id;
+}
+
+auto PackedStreamReader::seek_to_stream(size_t stream_id) -> size_t {
+    advance_to_stream(stream_id);
 
-    auto& [file_offset, uncompressed_size] = m_stream_metadata[stream_id];
-    size_t adjusted_file_offset = m_begin_offset + file_offset;
+    size_t adjusted_file_offset = m_begin_offset + m_stream_metadata[stream_id].file_offset;
     if (auto error = m_packed_stream_reader->try_seek_from_begin(adjusted_file_offset);
         clp::ErrorCode::ErrorCode_Success != error)
     {
@@ -112,21 +388,36 @@ PackedStreamReader::read_stream(size_t stream_id, std::shared_ptr<char[]>& buf,
     if ((stream_id + 1) < m_stream_metadata.size()) {
         end_pos = m_begin_offset + m_stream_metadata[stream_id + 1].file_offset;
     }
-    clp::BoundedReader bounded_reader{m_packed_stream_reader.get(), end_pos};
+    return end_pos;
+}
 
-    m_packed_stream_decompressor.open(bounded_reader, cDecompressorFileReadBufferCapacity);
-    if (buf_size < uncompressed_size) {
-        // make_shared is supposed to work here for c++20, but it seems like the compiler version
-        // we use doesn't support it, so we convert a unique_ptr to a shared_ptr instead.
-        buf = std::make_unique<char[]>(uncompressed_size);
-        buf_size = uncompressed_size;
+auto PackedStreamReader::get_stream_range(size_t stream_id, size_t section_size)
+        -> NetworkRangeFetcher::ByteRange {
+    advance_to_stream(stream_id);
+
+    size_t const begin_pos = m_stream_metadata[stream_id].file_offset;
+    size_t end_pos = section_size;
+    if ((stream_id + 1) < m_stream_metadata.size()) {
+        end_pos = m_stream_metadata[stream_id + 1].file_offset;
     }
-    if (auto error
-        = m_packed_stream_decompressor.try_read_exact_length(buf.get(), uncompressed_size);
-        ErrorCodeSuccess != error)
-    {
-        throw OperationFailed(error, __FILE__, __LINE__);
+    if (begin_pos > end_pos || end_pos > section_size) {
+        throw OperationFailed(ErrorCodeCorrupt, __FILE__, __LINE__);
     }
-    m_packed_stream_decompressor.close_for_reuse();
+    return {begin_pos, end_pos};
+}
+
+auto PackedStreamReader::get_mapped_stream(size_t stream_id) -> std::span<char const> {
+    auto const& view = m_packed_stream_view.value();
+    auto const range = get_stream_range(stream_id, view.size());
+    return view.subspan(range.begin, range.end - range.begin);
+}
+
+auto PackedStreamReader::fetch_stream(
+        NetworkRangeFetcher::ByteRange range,
+        std::vector<char>& buffer
+) const -> std::span<char const> {
+    auto contents = m_adaptor->read_section_ranges(constants::cArchiveTablesFile, {range});
+    buffer = std::move(contents.front());
+    return buffer;
 }
 }  // namespace clp_s
@@ -1,13 +1,20 @@
 #ifndef CLP_S_PACKEDSTREAMREADER_HPP
 #define CLP_S_PACKEDSTREAMREADER_HPP
 
+#include <condition_variable>
 #include <cstddef>
+#include <exception>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "../clp/ReaderInterface.hpp"
 #include "ArchiveReaderAdaptor.hpp"
+#include "NetworkRangeFetcher.hpp"
 #include "ZstdDecompressor.hpp"
 
 namespace clp_s {
@@ -16,6 +23,14 @@ namespace clp_s {
  * read the tables section without loading the tables metadata, and any attempt to read tables
  * section out of order will throw. As well, any incorrect usage of this class (e.g. closing without
  * opening) will throw.
+ *
+ * Streams can optionally be prefetched: given the list of streams that will be read, background
+ * threads read ahead and decompress a bounded number of upcoming streams, so that reading,
+ * decompressing, and processing streams overlap.
+ *
+ * If the archive is memory mapped, streams are decompressed directly from the mapping rather than
+ * being read into a buffer first. If the archive's sections are fetched with range requests, only
+ * the streams that are read get fetched, and prefetching threads fetch streams concurrently.
  */
 class PackedStreamReader {
 public:
@@ -26,6 +41,9 @@ public:
                 : TraceableException(error_code, filename, line_number) {}
     };
 
+    static constexpr size_t cDefaultNumPrefetchThreads{2};
+    static constexpr size_t cDefaultMaxNumPrefetchedStreams{4};
+
     struct PackedStreamMetadata {
         PackedStreamMetadata(size_t offset, size_t size)
                 : file_offset(offset),
@@ -35,6 +53,18 @@ public:
         size_t uncompressed_size;
     };
 
+    // Constructors
+    PackedStreamReader() = default;
+
+    // Delete copy & move constructors and assignment operators
+    PackedStreamReader(PackedStreamReader const&) = delete;
+    PackedStreamReader(PackedStreamReader&&) = delete;
+    auto operator=(PackedStreamReader const&) -> PackedStreamReader& = delete;
+    auto operator=(PackedStreamReader&&) -> PackedStreamReader& = delete;
+
+    // Destructor
+    ~PackedStreamReader() { stop_prefetching(); }
+
     /**
      * Reads packed stream metadata from the provided compression stream. Must be invoked before
      * reading packed streams.
@@ -49,16 +79,38 @@ public:
     void open_packed_streams(std::shared_ptr<ArchiveReaderAdaptor> adaptor);
 
     /**
-     * Closes the file reader for the tables section.
+     * Closes the file reader for the tables section, stopping any prefetching.
      */
     void close();
 
+    /**
+     * Starts prefetching the given streams in the background. Must be invoked after
+     * `open_packed_streams` and before any stream is read.
+     *
+     * Once prefetching, `read_stream` may only be called for the given streams, in ascending order.
+     * Streams may be skipped, in which case their prefetched contents are discarded.
+     * `read_compressed_stream` can't be used while prefetching.
+     *
+     * @param stream_ids the streams that will be read, in strictly ascending order
+     * @param num_threads the number of threads reading and decompressing streams
+     * @param max_num_prefetched_streams the maximum number of streams that have been claimed by
+     * the background threads but not yet returned by `read_stream`, bounding the memory used
+     */
+    void enable_prefetching(
+            std::vector<size_t> stream_ids,
+            size_t num_threads = cDefaultNumPrefetchThreads,
+            size_t max_num_prefetched_streams = cDefaultMaxNumPrefetchedStreams
+    );
+
     /**
      * Decompresses a stream with a given stream_id and returns it. This function must be called
      * strictly in ascending stream_id order. If this function is called twice for the same stream
      * or if a stream with lower id is requested after a stream with higher id then an error is
      * thrown.
      *
+     * If prefetching is enabled, this function waits for the stream to be decompressed in the
+     * background and replaces the buffer with the one it was decompressed into.
+     *
      * Note: the buffer and buffer size are returned by reference. This is to support the use case
      * where the caller wants to re-use the same buffer for multiple streams to avoid allocations
      * when they already have a sufficiently large buffer. If no buffer is provided or the provided
@@ -73,11 +125,113 @@ public:
      */
     void read_stream(size_t stream_id, std::shared_ptr<char[]>& buf, size_t& buf_size);
 
+    /**
+     * Reads a stream with a given stream_id without decompressing it, so that it can be
+     * decompressed later with `decompress_stream`, potentially on another thread. This function
+     * is subject to the same ordering requirements as `read_stream`, and can't be used while
+     * prefetching is enabled.
+     *
+     * @param stream_id
+     * @param buffer a buffer that the stream is read into, unless the archive is memory mapped
+     * @return a view of the compressed contents of the stream, which remains valid until `buffer`
+     * is modified or the packed streams are closed
+     */
+    auto read_compressed_stream(size_t stream_id, std::vector<char>& buffer)
+            -> std::span<char const>;
+
+    /**
+     * Decompresses a stream returned by `read_compressed_stream`. This function doesn't depend on
+     * the state of any PackedStreamReader, so it can be called concurrently from several threads.
+     *
+     * @param compressed_stream
+     * @param uncompressed_size
+     * @return a buffer containing the decompressed stream
+     */
+    [[nodiscard]] static auto
+    decompress_stream(std::span<char const> compressed_stream, size_t uncompressed_size)
+            -> std::shared_ptr<char[]>;
+
     [[nodiscard]] size_t get_uncompressed_stream_size(size_t stream_id) const {
         return m_stream_metadata.at(stream_id).uncompressed_size;
     }
 
+    [[nodiscard]] size_t get_num_streams() const { return m_stream_metadata.size(); }
+
 private:
+    // Types
+    struct PrefetchedStream {
+        std::shared_ptr<char[]> buffer;
+        std::exception_ptr exception;
+        bool is_ready{false};
+    };
+
+    // Methods
+    /**
+     * Reads the compressed contents of a stream from the tables section.
+     * @param stream_id
+     * @param buffer a buffer that the stream is read into, unless the archive is memory mapped
+     * @return a view of the compressed contents of the stream
+     */
+    auto read_packed_stream(size_t stream_id, std::vector<char>& buffer) -> std::span<char const>;
+
+    /**
+     * Waits for a stream to be prefetched and returns it, discarding any skipped streams.
+     * @param stream_id
+     * @return a buffer containing the decompressed stream
+     */
+    auto read_prefetched_stream(size_t stream_id) -> std::shared_ptr<char[]>;
+
+    /**
+     * Reads and decompresses streams in the prefetch list until every stream has been prefetched
+     * or prefetching is stopped.
+     */
+    void prefetch_streams();
+
+    /**
+     * Stops any prefetching threads and clears the prefetching state.
+     */
+    void stop_prefetching();
+
+    /**
+     * Validates that the stream with a given stream_id may be read next, and marks it as read.
+     * @param stream_id
+     */
+    void advance_to_stream(size_t stream_id);
+
+    /**
+     * Validates that the stream with a given stream_id may be read next, and seeks the tables file
+     * reader to the beginning of the stream.
+     * @param stream_id
+     * @return the position in the tables file reader where the stream ends
+     */
+    auto seek_to_stream(size_t stream_id) -> size_t;
+
+    /**
+     * Validates that the stream with a given stream_id may be read next, and gets the range it
+     * occupies in the tables section.
+     * @param stream_id
+     * @param section_size the size of the tables section
+     * @return the range of the stream relative to the beginning of the tables section
+     */
+    auto get_stream_range(size_t stream_id, size_t section_size) -> NetworkRangeFetcher::ByteRange;
+
+    /**
+     * Validates that the stream with a given stream_id may be read next, and gets it from the
+     * memory mapped tables section.
+     * @param stream_id
+     * @return a view of the compressed contents of the stream
+     */
+    auto get_mapped_stream(size_t stream_id) -> std::span<char const>;
+
+    /**
+     * Fetches a range of the tables section with a range request.
+     * @param range
+     * @param buffer Returns the contents of the range
+     * @return a view of the contents of the range
+     */
+    auto fetch_stream(NetworkRangeFetcher::ByteRange range, std::vector<char>& buffer) const
+            -> std::span<char const>;
+
     enum PackedStreamReaderState {
         Uninitialized,
         MetadataRead,
@@ -88,10 +242,28 @@ private:
     std::vector<PackedStreamMetadata> m_stream_metadata;
     std::shared_ptr<ArchiveReaderAdaptor> m_adaptor;
     std::unique_ptr<clp::ReaderInterface> m_packed_stream_reader;
+    std::optional<std::span<char const>> m_packed_stream_view;
+    bool m_is_fetching_ranges{false};
+    size_t m_tables_section_size{0ULL};
+    std::vector<char> m_compressed_stream_buffer;
     ZstdDecompressor m_packed_stream_decompressor;
     PackedStreamReaderState m_state{PackedStreamReaderState::Uninitialized};
     size_t m_begin_offset{};
     size_t m_prev_stream_id{0ULL};
+
+    // Prefetching state; `m_prefetch_mutex` guards everything except the threads, and
+    // `m_prefetch_read_mutex` ensures streams are read from the tables section in order.
+    std::vector<size_t> m_prefetch_stream_ids;
+    std::vector<PrefetchedStream> m_prefetched_streams;
+    size_t m_max_num_prefetched_streams{0ULL};
+    size_t m_next_prefetch_read_idx{0ULL};
+    size_t m_next_prefetch_consume_idx{0ULL};
+    bool m_is_prefetching{false};
+    bool m_stop_prefetching{false};
+    std::mutex m_prefetch_mutex;
+    std::mutex m_prefetch_read_mutex;
+    std::condition_variable m_prefetch_cv;
+    std::vector<std::thread> m_prefetch_threads;
 };
 }  // namespace clp_s
 
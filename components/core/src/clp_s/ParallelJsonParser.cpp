@@ -0,0 +1,181 @@
+#include "ParallelJsonParser.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include "ArchiveWriter.hpp"
+#include "ErrorCode.hpp"
+#include "InputConfig.hpp"
+#include "JsonParser.hpp"
+
+namespace clp_s {
+namespace {
+/**
+ * @param path
+ * @return The size of the file at `path` if it's on the local filesystem and its size can be
+ * determined, or std::nullopt otherwise.
+ */
+auto get_input_size(Path const& path) -> std::optional<uint64_t>;
+
+/**
+ * Runs `task(i)` for every worker index `i` in `[0, num_workers)` on its own thread and waits for
+ * all of them to complete. Exceptions thrown by a task are logged and treated as failures.
+ * @param num_workers
+ * @param task
+ * @return Whether every task succeeded
+ */
+template <typename Task>
+auto run_on_worker_threads(size_t num_workers, Task task) -> bool;
+
+auto get_input_size(Path const& path) -> std::optional<uint64_t> {
+    if (InputSource::Filesystem != path.source) {
+        return std::nullopt;
+    }
+    std::error_code ec;
+    auto const size = std::filesystem::file_size(path.path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    return size;
+}
+
+template <typename Task>
+auto run_on_worker_threads(size_t num_workers, Task task) -> bool {
+    std::vector<uint8_t> succeeded(num_workers, 0);
+    std::vector<std::thread> threads;
+    threads.reserve(num_workers);
+    for (size_t i{0}; i < num_workers; ++i) {
+        threads.emplace_back([&, i]() {
+            try {
+                succeeded[i] = task(i) ? 1 : 0;
+            } catch (std::exception const& e) {
+                SPDLOG_ERROR("Compression worker {} failed - {}", i, e.what());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return std::ranges::all_of(succeeded, [](uint8_t s) { return 0 != s; });
+}
+}  // namespace
+
+ParallelJsonParser::ParallelJsonParser(JsonParserOption const& option)
+        : m_input_file_type{option.input_file_type},
+          m_print_archive_stats{option.print_archive_stats} {
+    if (0 == option.num_threads) {
+        throw OperationFailed(ErrorCodeBadParam, __FILENAME__, __LINE__);
+    }
+
+    // Each worker prints nothing on its own; statistics are printed once all workers are done so
+    // that the output of concurrent workers isn't interleaved.
+    JsonParserOption worker_option{option};
+    worker_option.print_archive_stats = false;
+    auto partitions = partition_input_paths(option.input_paths, option.num_threads);
+    if (partitions.empty()) {
+        return;
+    }
+    // Threads that aren't needed for parsing are shared between the workers for compressing their
+    // tables.
+    worker_option.num_threads = std::max<size_t>(1, option.num_threads / partitions.size());
+    for (auto& partition : partitions) {
+        worker_option.input_paths = std::move(partition);
+        m_workers.emplace_back(std::make_unique<JsonParser>(worker_option));
+    }
+}
+
+auto ParallelJsonParser::parse() -> bool {
+    return run_on_worker_threads(m_workers.size(), [&](size_t worker_idx) -> bool {
+        auto& worker = *m_workers[worker_idx];
+        if (FileType::KeyValueIr == m_input_file_type) {
+            return worker.parse_from_ir();
+        }
+        return worker.parse();
+    });
+}
+
+auto ParallelJsonParser::store() -> std::vector<ArchiveStats> {
+    std::vector<std::vector<ArchiveStats>> worker_stats(m_workers.size());
+    std::ignore = run_on_worker_threads(m_workers.size(), [&](size_t worker_idx) -> bool {
+        worker_stats[worker_idx] = m_workers[worker_idx]->store();
+        return true;
+    });
+
+    std::vector<ArchiveStats> archive_stats;
+    for (auto& stats : worker_stats) {
+        std::move(stats.begin(), stats.end(), std::back_inserter(archive_stats));
+    }
+    if (m_print_archive_stats) {
+        for (auto const& stats : archive_stats) {
+            std::cout << stats.as_string() << '\n';
+        }
+        std::cout << std::flush;
+    }
+    return archive_stats;
+}
+
+auto ParallelJsonParser::partition_input_paths(
+        std::vector<Path> const& input_paths,
+        size_t num_partitions
+) -> std::vector<std::vector<Path>> {
+    num_partitions = std::min(num_partitions, input_paths.size());
+    if (0 == num_partitions) {
+        return {};
+    }
+
+    // Inputs whose size can't be determined (e.g. network inputs) are weighted by the average size
+    // of the inputs that could be measured, or equally if none could be.
+    std::vector<std::optional<uint64_t>> measured_sizes;
+    measured_sizes.reserve(input_paths.size());
+    uint64_t total_measured_size{0};
+    size_t num_measured{0};
+    for (auto const& path : input_paths) {
+        auto const size = get_input_size(path);
+        if (size.has_value()) {
+            total_measured_size += size.value();
+            ++num_measured;
+        }
+        measured_sizes.emplace_back(size);
+    }
+    uint64_t const default_size{0 == num_measured ? 1 : total_measured_size / num_measured};
+
+    // Greedily assign the largest remaining input to the least-loaded partition (LPT scheduling).
+    std::vector<size_t> input_order(input_paths.size());
+    std::iota(input_order.begin(), input_order.end(), 0);
+    auto size_of = [&](size_t idx) -> uint64_t {
+        return measured_sizes[idx].value_or(default_size);
+    };
+    std::ranges::stable_sort(input_order, [&](size_t lhs, size_t rhs) {
+        return size_of(lhs) > size_of(rhs);
+    });
+    std::vector<uint64_t> partition_sizes(num_partitions, 0);
+    std::vector<size_t> input_to_partition(input_paths.size(), 0);
+    for (auto const input_idx : input_order) {
+        auto const partition_idx = static_cast<size_t>(
+                std::ranges::min_element(partition_sizes) - partition_sizes.begin()
+        );
+        partition_sizes[partition_idx] += size_of(input_idx);
+        input_to_partition[input_idx] = partition_idx;
+    }
+
+    std::vector<std::vector<Path>> partitions(num_partitions);
+    for (size_t i{0}; i < input_paths.size(); ++i) {
+        partitions[input_to_partition[i]].emplace_back(input_paths[i]);
+    }
+    return partitions;
+}
+}  // namespace clp_s
@@ -0,0 +1,80 @@
+#ifndef CLP_S_PARALLELJSONPARSER_HPP
+#define CLP_S_PARALLELJSONPARSER_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "ArchiveWriter.hpp"
+#include "ErrorCode.hpp"
+#include "InputConfig.hpp"
+#include "JsonParser.hpp"
+#include "TraceableException.hpp"
+
+namespace clp_s {
+/**
+ * Compresses a set of input files using several `JsonParser` workers running concurrently.
+ *
+ * The input files are partitioned between the workers so that each worker receives roughly the same
+ * number of input bytes. Each worker owns a complete archive writing pipeline (schema tree,
+ * dictionaries, and per-schema `SchemaWriter`s), so workers never contend on shared state while
+ * parsing. Every worker produces its own archive(s) in the output directory; together they contain
+ * exactly the records produced by a single-threaded `JsonParser` run over the same inputs, with each
+ * input file's records kept together and in their original order.
+ */
+class ParallelJsonParser {
+public:
+    class OperationFailed : public TraceableException {
+    public:
+        // Constructors
+        OperationFailed(ErrorCode error_code, char const* const filename, int line_number)
+                : TraceableException(error_code, filename, line_number) {}
+    };
+
+    // Constructor
+    /**
+     * @param option Options shared by every worker. `option.num_threads` determines the maximum
+     * number of workers; fewer workers are used when there are fewer input paths than threads, in
+     * which case the remaining threads are split between the workers for compressing tables.
+     * @throw ParallelJsonParser::OperationFailed if the number of threads is zero
+     */
+    explicit ParallelJsonParser(JsonParserOption const& option);
+
+    // Methods
+    /**
+     * Parses all input paths, running each worker on its own thread.
+     * @return Whether every worker parsed its input successfully
+     */
+    [[nodiscard]] auto parse() -> bool;
+
+    /**
+     * Writes the metadata and archive data for every worker to disk.
+     * @return Statistics for every archive that was written without encountering an error.
+     */
+    [[nodiscard]] auto store() -> std::vector<ArchiveStats>;
+
+    /**
+     * @return The number of workers used to parse the input
+     */
+    [[nodiscard]] auto get_num_workers() const -> size_t { return m_workers.size(); }
+
+    /**
+     * Partitions input paths between a number of workers such that the total size of the inputs
+     * assigned to each worker is roughly balanced. Within a partition, paths keep their relative
+     * order from `input_paths`.
+     * @param input_paths
+     * @param num_partitions
+     * @return The non-empty partitions
+     */
+    [[nodiscard]] static auto
+    partition_input_paths(std::vector<Path> const& input_paths, size_t num_partitions)
+            -> std::vector<std::vector<Path>>;
+
+private:
+    std::vector<std::unique_ptr<JsonParser>> m_workers;
+    FileType m_input_file_type{FileType::Json};
+    bool m_print_archive_stats{false};
+};
+}  // namespace clp_s
+
+#endif  // CLP_S_PARALLELJSONPARSER_HPP
@@ -1,21 +1,36 @@
 #ifndef CLP_S_PARSEDMESSAGE_HPP
 #define CLP_S_PARSEDMESSAGE_HPP
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
-#include <map>
+#include <deque>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <variant>
+#include <vector>
 
 #include "Defs.hpp"
 
 namespace clp_s {
+/**
+ * The values of a record, keyed by their MST node IDs.
+ *
+ * String values are copied into blocks owned by the message, so they stay valid until the message
+ * is cleared. Clearing the message keeps its blocks and containers for the next record, so parsing
+ * a record only allocates when it's larger than every record before it, or when its values don't
+ * arrive in MST node ID order and have to be sorted.
+ */
 class ParsedMessage {
 public:
     // Types
-    using variable_t
-            = std::variant<int64_t, double, std::string, bool, std::pair<uint64_t, epochtime_t>>;
+    using variable_t = std::
+            variant<int64_t, double, std::string_view, bool, std::pair<uint64_t, epochtime_t>>;
+
+    // Constants
+    // String values are copied into blocks of this size, or of the value's size if it's larger
+    static constexpr size_t cStringBlockSize{64 * 1024};
 
     // Constructor
     ParsedMessage() : m_schema_id(-1) {}
@@ -33,11 +48,15 @@ public:
      */
     template <typename T>
     inline void add_value(int32_t node_id, T const& value) {
-        m_message.emplace(node_id, value);
+        emplace(node_id, value);
     }
 
     inline void add_value(int32_t node_id, std::string_view value) {
-        m_message.emplace(node_id, std::string{value});
+        emplace(node_id, store_string(value));
+    }
+
+    inline void add_value(int32_t node_id, std::string const& value) {
+        add_value(node_id, std::string_view{value});
     }
 
     /**
@@ -47,7 +66,7 @@ public:
      * @param value
      */
     inline void add_value(int32_t node_id, uint64_t encoding_id, epochtime_t value) {
-        m_message.emplace(node_id, std::make_pair(encoding_id, value));
+        emplace(node_id, std::make_pair(encoding_id, value));
     }
 
     /**
@@ -62,22 +81,34 @@ public:
     }
 
     inline void add_unordered_value(std::string_view value) {
-        m_unordered_message.emplace_back(std::string{value});
+        m_unordered_message.emplace_back(store_string(value));
+    }
+
+    inline void add_unordered_value(std::string const& value) {
+        add_unordered_value(std::string_view{value});
     }
 
     /**
-     * Clears the message
+     * Clears the message, invalidating its string values
      */
     void clear() {
         m_schema_id = -1;
         m_message.clear();
+        m_is_content_sorted = true;
         m_unordered_message.clear();
+        for (auto& block : m_string_blocks) {
+            block.clear();
+        }
+        m_cur_string_block_idx = 0;
     }
 
     /**
-     * @return The content of the message
+     * @return The content of the message, sorted by MST node ID
      */
-    std::map<int32_t, variable_t>& get_content() { return m_message; }
+    std::vector<std::pair<int32_t, variable_t>>& get_content() {
+        sort_content();
+        return m_message;
+    }
 
     /**
      * @return the unordered content of the message
@@ -85,9 +116,65 @@ public:
     std::vector<variable_t>& get_unordered_content() { return m_unordered_message; }
 
 private:
+    // Methods
+    /**
+     * Adds a value to the message for a given MST node ID. Values are appended rather than inserted
+     * in order, since a record's values usually arrive in MST node ID order, and the content is
+     * only sorted when they didn't.
+     * @param node_id
+     * @param value
+     */
+    void emplace(int32_t node_id, variable_t value) {
+        if (false == m_message.empty() && m_message.back().first >= node_id) {
+            m_is_content_sorted = false;
+        }
+        m_message.emplace_back(node_id, value);
+    }
+
+    /**
+     * Sorts the content of the message by MST node ID, keeping only the first value added for each
+     * node.
+     */
+    void sort_content() {
+        if (m_is_content_sorted) {
+            return;
+        }
+        auto const get_node_id = [](auto const& entry) { return entry.first; };
+        std::ranges::stable_sort(m_message, {}, get_node_id);
+        auto const duplicates = std::ranges::unique(m_message, {}, get_node_id);
+        m_message.erase(duplicates.begin(), duplicates.end());
+        m_is_content_sorted = true;
+    }
+
+    /**
+     * Copies a string into the message's string blocks.
+     * @param value
+     * @return A view of the copy
+     */
+    std::string_view store_string(std::string_view value) {
+        // Blocks are only appended to within their capacity, so they're never reallocated
+        for (; m_cur_string_block_idx < m_string_blocks.size(); ++m_cur_string_block_idx) {
+            auto& block = m_string_blocks[m_cur_string_block_idx];
+            if (block.capacity() - block.size() >= value.size()) {
+                auto const offset = block.size();
+                block.append(value);
+                return {block.data() + offset, value.size()};
+            }
+        }
+        // A deque doesn't move its existing blocks as it grows
+        auto& block = m_string_blocks.emplace_back();
+        block.reserve(std::max(cStringBlockSize, value.size()));
+        block.append(value);
+        return {block.data(), value.size()};
+    }
+
+    // Variables
     int32_t m_schema_id;
-    std::map<int32_t, variable_t> m_message;
+    std::vector<std::pair<int32_t, variable_t>> m_message;
+    bool m_is_content_sorted{true};
     std::vector<variable_t> m_unordered_message;
+    std::deque<std::string> m_string_blocks;
+    size_t m_cur_string_block_idx{0};
 };
 }  // namespace clp_s
 
@@ -1,7 +1,12 @@
 #include "SchemaReader.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
 #include <stack>
 #include <string>
+#include <utility>
 
 #include "archive_constants.hpp"
 #include "BufferViewReader.hpp"
@@ -63,6 +68,39 @@ SchemaReader::load(std::shared_ptr<char[]> stream_buffer, size_t offset, size_t
     }
 }
 
+void SchemaReader::load_column(
+        size_t column_idx,
+        std::shared_ptr<char[]> column_buffer,
+        size_t uncompressed_size
+) {
+    BufferViewReader buffer_reader{column_buffer.get(), uncompressed_size};
+    m_columns.at(column_idx)->load(buffer_reader, m_num_messages);
+    if (buffer_reader.get_remaining_size() > 0) {
+        throw OperationFailed(ErrorCodeCorrupt, __FILENAME__, __LINE__);
+    }
+    m_column_buffers.emplace_back(std::move(column_buffer));
+}
+
+bool SchemaReader::is_column_required(size_t column_idx, FilterClass* filter) const {
+    auto* column = m_columns.at(column_idx);
+    if (nullptr == filter || column == m_timestamp_column || column == m_log_event_idx_column) {
+        return true;
+    }
+
+    if (m_should_marshal_records) {
+        // Unordered columns are marshalled as part of their enclosing object, so they're always
+        // loaded.
+        auto it = m_column_map.find(column->get_id());
+        if (m_column_map.end() == it || it->second != column
+            || m_projection->matches_node(column->get_id()))
+        {
+            return true;
+        }
+    }
+
+    return filter->requires_column(column->get_id());
+}
+
 void SchemaReader::generate_json_string() {
     m_json_serializer.reset();
     m_json_serializer.begin_document();
@@ -201,72 +239,122 @@ bool SchemaReader::get_next_message(std::string& message) {
 }
 
 bool SchemaReader::get_next_message(std::string& message, FilterClass* filter) {
-    while (m_cur_message < m_num_messages) {
-        if (false == filter->filter(m_cur_message)) {
-            m_cur_message++;
-            continue;
-        }
-
-        if (m_should_marshal_records) {
-            if (false == m_serializer_initialized) {
-                initialize_serializer();
-            }
-            generate_json_string();
-            message = m_json_serializer.get_serialized_string();
+    if (false == advance_to_next_filtered_message(filter)) {
+        return false;
+    }
 
-            if (message.back() != '\n') {
-                message += '\n';
-            }
+    if (m_should_marshal_records) {
+        if (false == m_serializer_initialized) {
+            initialize_serializer();
         }
+        generate_json_string();
+        message = m_json_serializer.get_serialized_string();
 
-        m_cur_message++;
-        return true;
+        if (message.back() != '\n') {
+            message += '\n';
+        }
     }
 
-    return false;
+    m_cur_message++;
+    return true;
 }
 
 bool SchemaReader::get_next_message_with_metadata(
         std::string& message,
         epochtime_t& timestamp,
         int64_t& log_event_idx,
-        FilterClass* filter
+        FilterClass* filter,
+        search::TopKTimestamps const* top_k_timestamps
 ) {
-    // TODO: If we already get max_num_results messages, we can skip messages
-    // with the timestamp less than the smallest timestamp in the priority queue
-    while (m_cur_message < m_num_messages) {
-        if (false == filter->filter(m_cur_message)) {
-            m_cur_message++;
-            continue;
+    while (true) {
+        if (false == advance_to_next_filtered_message(filter)) {
+            return false;
+        }
+        timestamp = m_get_timestamp();
+        if (nullptr == top_k_timestamps || top_k_timestamps->can_contain_latest(timestamp)) {
+            break;
         }
+        m_cur_message++;
+    }
 
-        if (m_should_marshal_records) {
-            if (false == m_serializer_initialized) {
-                initialize_serializer();
-            }
-            generate_json_string();
-            message = m_json_serializer.get_serialized_string();
+    if (m_should_marshal_records) {
+        if (false == m_serializer_initialized) {
+            initialize_serializer();
+        }
+        generate_json_string();
+        message = m_json_serializer.get_serialized_string();
 
-            if (message.back() != '\n') {
-                message += '\n';
-            }
+        if (message.back() != '\n') {
+            message += '\n';
         }
+    }
 
-        timestamp = m_get_timestamp();
-        log_event_idx = get_next_log_event_idx();
+    log_event_idx = get_next_log_event_idx();
 
-        m_cur_message++;
-        return true;
-    }
+    m_cur_message++;
+    return true;
+}
 
+bool SchemaReader::advance_to_next_filtered_message(FilterClass* filter) {
+    constexpr size_t cBitsPerWord{FilterClass::cBitsPerSelectionWord};
+    while (m_cur_message < m_num_messages) {
+        if (m_cur_message < m_filter_batch_begin || m_cur_message >= m_filter_batch_end) {
+            m_filter_batch_begin = m_cur_message;
+            m_filter_batch_end
+                    = std::min(m_num_messages, m_cur_message + FilterClass::cBatchSize);
+            filter->filter_batch(
+                    m_filter_batch_begin,
+                    m_filter_batch_end - m_filter_batch_begin,
+                    m_selection
+            );
+        }
+
+        size_t const offset = m_cur_message - m_filter_batch_begin;
+        size_t const batch_size = m_filter_batch_end - m_filter_batch_begin;
+        size_t word_idx = offset / cBitsPerWord;
+        uint64_t word = m_selection[word_idx] & (~0ULL << (offset % cBitsPerWord));
+        size_t const num_words = (batch_size + cBitsPerWord - 1) / cBitsPerWord;
+        while (0 == word && ++word_idx < num_words) {
+            word = m_selection[word_idx];
+        }
+        if (0 != word) {
+            m_cur_message = m_filter_batch_begin + word_idx * cBitsPerWord
+                            + static_cast<size_t>(std::countr_zero(word));
+            return true;
+        }
+        m_cur_message = m_filter_batch_end;
+    }
     return false;
 }
 
+uint64_t SchemaReader::count_filtered_messages(FilterClass* filter) {
+    uint64_t num_filtered_messages{0};
+    while (m_cur_message < m_num_messages) {
+        m_filter_batch_begin = m_cur_message;
+        m_filter_batch_end = std::min(m_num_messages, m_cur_message + FilterClass::cBatchSize);
+        filter->filter_batch(
+                m_filter_batch_begin,
+                m_filter_batch_end - m_filter_batch_begin,
+                m_selection
+        );
+        // Bits past the end of the batch are cleared, so every set bit is a matching message
+        for (auto const word : m_selection) {
+            num_filtered_messages += static_cast<uint64_t>(std::popcount(word));
+        }
+        m_cur_message = m_filter_batch_end;
+    }
+    return num_filtered_messages;
+}
+
 void SchemaReader::initialize_filter(FilterClass* filter) {
+    m_filter_batch_begin = 0;
+    m_filter_batch_end = 0;
     filter->init(this, m_columns);
 }
 
 void SchemaReader::initialize_filter_with_column_map(FilterClass* filter) {
+    m_filter_batch_begin = 0;
+    m_filter_batch_end = 0;
     filter->init(this, m_column_map);
 }
 
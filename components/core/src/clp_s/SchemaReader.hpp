@@ -1,18 +1,27 @@
 #ifndef CLP_S_SCHEMAREADER_HPP
 #define CLP_S_SCHEMAREADER_HPP
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <optional>
 #include <span>
 #include <string>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
 
+#include "BloomFilter.hpp"
 #include "ColumnReader.hpp"
+#include "ColumnValueRange.hpp"
 #include "FileReader.hpp"
 #include "JsonSerializer.hpp"
 #include "SchemaTree.hpp"
 #include "search/Projection.hpp"
+#include "search/TopKTimestamps.hpp"
 #include "ZstdDecompressor.hpp"
 
 namespace clp_s {
@@ -20,6 +29,16 @@ class SchemaReader;
 
 class FilterClass {
 public:
+    // Types
+    static constexpr size_t cBatchSize{1024};
+    static constexpr size_t cBitsPerSelectionWord{64};
+
+    /**
+     * Bitmap of the messages accepted in a batch. Bit `i % 64` of word `i / 64` corresponds to the
+     * `i`th message of the batch.
+     */
+    using Selection = std::array<uint64_t, cBatchSize / cBitsPerSelectionWord>;
+
     /**
      * Initializes the filter
      * @param reader
@@ -43,6 +62,31 @@ public:
      * @return true if the message is accepted
      */
     virtual bool filter(uint64_t cur_message) = 0;
+
+    /**
+     * Filters a batch of consecutive messages. Filters that can evaluate many messages at once
+     * should override this method; the default implementation calls `filter` on every message.
+     * @param begin_message the first message in the batch
+     * @param num_messages the number of messages in the batch, at most `cBatchSize`
+     * @param selection Returns the messages in the batch that are accepted. Bits past the end of
+     * the batch are cleared.
+     */
+    virtual void filter_batch(uint64_t begin_message, size_t num_messages, Selection& selection) {
+        selection.fill(0);
+        for (size_t i{0}; i < num_messages; ++i) {
+            if (filter(begin_message + i)) {
+                selection[i / cBitsPerSelectionWord] |= 1ULL << (i % cBitsPerSelectionWord);
+            }
+        }
+    }
+
+    /**
+     * Checks whether the filter needs to read a column of the current schema. Columns that aren't
+     * needed by the filter, or for any other reason, may not be loaded.
+     * @param column_id
+     * @return true if the filter reads the column
+     */
+    virtual bool requires_column(int32_t column_id) { return true; }
 };
 
 class SchemaReader {
@@ -59,6 +103,17 @@ public:
         uint64_t stream_offset;
         uint64_t num_messages;
         uint64_t uncompressed_size;
+        // Non-zero for tables stored as separate columns, whose columns are stored in the streams
+        // [stream_id, stream_id + num_column_streams).
+        uint64_t num_column_streams{0};
+        // The range of timestamps reported for the table's messages, if the archive records it
+        std::optional<std::pair<epochtime_t, epochtime_t>> timestamp_range;
+        // The range of values in each of the table's numeric columns, keyed by column ID, if the
+        // archive records them
+        std::map<int32_t, ColumnValueRange> column_value_ranges;
+        // Filters over the dictionary IDs in each of the table's dictionary-encoded columns, keyed
+        // by column ID, if the archive records them
+        std::map<int32_t, BloomFilter> dictionary_id_filters;
     };
 
     // Constructor
@@ -96,6 +151,8 @@ public:
         m_schema_id = schema_id;
         m_num_messages = num_messages;
         m_cur_message = 0;
+        m_filter_batch_begin = 0;
+        m_filter_batch_end = 0;
         m_serializer_initialized = false;
         m_ordered_schema = ordered_schema;
         delete_columns();
@@ -105,6 +162,7 @@ public:
         m_timestamp_column = nullptr;
         m_get_timestamp = []() -> epochtime_t { return 0; };
         m_log_event_idx_column = nullptr;
+        m_column_buffers.clear();
         m_local_id_to_global_id.clear();
         m_global_id_to_local_id.clear();
         m_global_id_to_unordered_object.clear();
@@ -149,6 +207,27 @@ public:
      */
     void load(std::shared_ptr<char[]> stream_buffer, size_t offset, size_t uncompressed_size);
 
+    /**
+     * Loads a single column of a table stored as separate columns from its own buffer
+     * @param column_idx the index of the column in the order it was appended
+     * @param column_buffer
+     * @param uncompressed_size
+     */
+    void load_column(
+            size_t column_idx,
+            std::shared_ptr<char[]> column_buffer,
+            size_t uncompressed_size
+    );
+
+    /**
+     * Checks whether a column needs to be loaded to filter and marshal the records in this table.
+     * @param column_idx the index of the column in the order it was appended
+     * @param filter the filter that will be applied to the table, or nullptr if records won't be
+     * filtered
+     * @return true if the column needs to be loaded
+     */
+    [[nodiscard]] bool is_column_required(size_t column_idx, FilterClass* filter) const;
+
     /**
      * @return the number of messages in the schema
      */
@@ -175,15 +254,41 @@ public:
      * @param timestamp
      * @param log_event_idx
      * @param filter
+     * @param top_k_timestamps If not nullptr, messages whose timestamp can't be among the latest
+     * timestamps are skipped without being marshalled
      * @return true if there is a next message
      */
     bool get_next_message_with_metadata(
             std::string& message,
             epochtime_t& timestamp,
             int64_t& log_event_idx,
-            FilterClass* filter
+            FilterClass* filter,
+            search::TopKTimestamps const* top_k_timestamps = nullptr
     );
 
+    /**
+     * Counts the remaining messages matching a filter without marshalling them, leaving no
+     * messages to iterate over.
+     * @param filter
+     * @return The number of matching messages
+     */
+    uint64_t count_filtered_messages(FilterClass* filter);
+
+    /**
+     * Calls a function with the timestamp of each remaining message matching a filter without
+     * marshalling the messages, leaving no messages to iterate over.
+     * @tparam TimestampHandler Function with the signature `void(epochtime_t)`
+     * @param filter
+     * @param handle_timestamp
+     */
+    template <typename TimestampHandler>
+    void for_each_filtered_timestamp(FilterClass* filter, TimestampHandler handle_timestamp) {
+        while (advance_to_next_filtered_message(filter)) {
+            handle_timestamp(m_get_timestamp());
+            ++m_cur_message;
+        }
+    }
+
     /**
      * Initializes the filter
      * @param filter
@@ -235,7 +340,25 @@ public:
      */
     bool done() const { return m_cur_message >= m_num_messages; }
 
+    /**
+     * Skips over the next messages without marshalling them, e.g. to resume iterating over a table
+     * that has been reloaded.
+     * @param num_messages
+     */
+    void skip_messages(uint64_t num_messages) {
+        m_cur_message = std::min(m_cur_message + num_messages, m_num_messages);
+    }
+
 private:
+    /**
+     * Advances m_cur_message to the next message accepted by the filter. Messages are filtered a
+     * batch at a time, and the selection for the current batch is cached until m_cur_message moves
+     * past it.
+     * @param filter
+     * @return true if a message was found, or false if there are no more matching messages
+     */
+    bool advance_to_next_filtered_message(FilterClass* filter);
+
     /**
      * Merges the current local schema tree with the section of the global schema tree corresponding
      * to the path from the root of the global schema tree to the node matching the global MPT node
@@ -314,10 +437,16 @@ private:
     uint64_t m_cur_message;
     std::span<int32_t> m_ordered_schema;
 
+    // Messages in [m_filter_batch_begin, m_filter_batch_end) have been filtered into m_selection
+    uint64_t m_filter_batch_begin{0};
+    uint64_t m_filter_batch_end{0};
+    FilterClass::Selection m_selection{};
+
     std::unordered_map<int32_t, BaseColumnReader*> m_column_map;
     std::vector<BaseColumnReader*> m_columns;
     std::vector<BaseColumnReader*> m_reordered_columns;
     std::shared_ptr<char[]> m_stream_buffer;
+    std::vector<std::shared_ptr<char[]>> m_column_buffers;
 
     BaseColumnReader* m_timestamp_column;
     std::function<epochtime_t()> m_get_timestamp;
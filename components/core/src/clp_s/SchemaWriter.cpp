@@ -1,6 +1,14 @@
 #include "SchemaWriter.hpp"
 
+#include <algorithm>
+#include <map>
+#include <set>
+#include <type_traits>
 #include <utility>
+#include <variant>
+#include <vector>
+
+#include "BloomFilter.hpp"
 
 namespace clp_s {
 void SchemaWriter::append_column(BaseColumnWriter* column_writer) {
@@ -26,6 +34,76 @@ size_t SchemaWriter::append_message(ParsedMessage& message) {
     return total_size;
 }
 
+std::map<int32_t, ColumnValueRange> SchemaWriter::get_column_value_ranges() const {
+    std::map<int32_t, ColumnValueRange> ranges;
+    std::set<int32_t> unranged_column_ids;
+    for (auto const* column : m_columns) {
+        auto const column_id = column->get_id();
+        auto const range = column->get_value_range();
+        if (false == range.has_value()) {
+            unranged_column_ids.insert(column_id);
+            continue;
+        }
+
+        auto const [it, inserted] = ranges.emplace(column_id, range.value());
+        if (inserted) {
+            continue;
+        }
+        if (it->second.index() != range->index()) {
+            unranged_column_ids.insert(column_id);
+            continue;
+        }
+        std::visit(
+                [&](auto& merged_range) {
+                    auto const& [min, max] = std::get<std::decay_t<decltype(merged_range)>>(
+                            range.value()
+                    );
+                    merged_range.first = std::min(merged_range.first, min);
+                    merged_range.second = std::max(merged_range.second, max);
+                },
+                it->second
+        );
+    }
+
+    for (auto const column_id : unranged_column_ids) {
+        ranges.erase(column_id);
+    }
+    return ranges;
+}
+
+std::map<int32_t, BloomFilter> SchemaWriter::get_column_dictionary_id_filters() const {
+    std::map<int32_t, std::vector<uint64_t>> column_dictionary_ids;
+    for (auto const* column : m_columns) {
+        std::vector<uint64_t> dictionary_ids;
+        if (column->append_dictionary_ids(dictionary_ids)) {
+            auto& ids = column_dictionary_ids[column->get_id()];
+            ids.insert(ids.end(), dictionary_ids.cbegin(), dictionary_ids.cend());
+        }
+    }
+
+    std::map<int32_t, BloomFilter> filters;
+    for (auto& [column_id, dictionary_ids] : column_dictionary_ids) {
+        // Size the filter for the distinct IDs since most columns repeat a small set of values
+        std::sort(dictionary_ids.begin(), dictionary_ids.end());
+        dictionary_ids.erase(
+                std::unique(dictionary_ids.begin(), dictionary_ids.end()),
+                dictionary_ids.end()
+        );
+        BloomFilter filter{dictionary_ids.size()};
+        for (auto const id : dictionary_ids) {
+            filter.add(id);
+        }
+        filters.emplace(column_id, std::move(filter));
+    }
+    return filters;
+}
+
+void SchemaWriter::encode_columns() {
+    for (auto* column : m_columns) {
+        m_total_uncompressed_size -= column->encode();
+    }
+}
+
 void SchemaWriter::store(ZstdCompressor& compressor) {
     for (auto& writer : m_columns) {
         writer->store(compressor);
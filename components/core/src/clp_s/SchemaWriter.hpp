@@ -1,9 +1,14 @@
 #ifndef CLP_S_SCHEMAWRITER_HPP
 #define CLP_S_SCHEMAWRITER_HPP
 
+#include <algorithm>
+#include <map>
 #include <vector>
 
+#include "BloomFilter.hpp"
+#include "ColumnValueRange.hpp"
 #include "ColumnWriter.hpp"
+#include "Defs.hpp"
 #include "FileWriter.hpp"
 #include "ParsedMessage.hpp"
 #include "ZstdCompressor.hpp"
@@ -37,22 +42,69 @@ public:
      */
     size_t append_message(ParsedMessage& message);
 
+    /**
+     * Encodes the columns, after which no more messages can be appended. Must be called before the
+     * columns are stored.
+     */
+    void encode_columns();
+
     /**
      * Stores the columns to disk.
      * @param compressor
      */
     void store(ZstdCompressor& compressor);
 
+    /**
+     * Stores a single column to disk.
+     * @param column_idx
+     * @param compressor
+     */
+    void store_column(size_t column_idx, ZstdCompressor& compressor) {
+        m_columns[column_idx]->store(compressor);
+    }
+
     uint64_t get_num_messages() const { return m_num_messages; }
 
+    size_t get_num_columns() const { return m_columns.size(); }
+
     /**
      * @return the uncompressed in-memory size of the data that will be written to the compressor
      */
     size_t get_total_uncompressed_size() const { return m_total_uncompressed_size; }
 
+    /**
+     * Extends the range of timestamps in the table to include the timestamp of a message.
+     * @param timestamp
+     */
+    void update_timestamp_range(epochtime_t timestamp) {
+        m_begin_timestamp = std::min(m_begin_timestamp, timestamp);
+        m_end_timestamp = std::max(m_end_timestamp, timestamp);
+    }
+
+    epochtime_t get_begin_timestamp() const { return m_begin_timestamp; }
+
+    epochtime_t get_end_timestamp() const { return m_end_timestamp; }
+
+    /**
+     * Gets the range of values in each numeric column of the table. Columns that share an ID are
+     * merged into a single range, and IDs with any column that has no range are omitted.
+     * @return A map from column ID to the range of values in the column(s) with that ID
+     */
+    std::map<int32_t, ColumnValueRange> get_column_value_ranges() const;
+
+    /**
+     * Builds a filter over the dictionary IDs in each dictionary-encoded column of the table.
+     * Columns that share an ID get a single filter.
+     * @return A map from column ID to the filter over the dictionary IDs in the column(s) with that
+     * ID
+     */
+    std::map<int32_t, BloomFilter> get_column_dictionary_id_filters() const;
+
 private:
     uint64_t m_num_messages;
     size_t m_total_uncompressed_size{};
+    epochtime_t m_begin_timestamp{cEpochTimeMax};
+    epochtime_t m_end_timestamp{cEpochTimeMin};
 
     std::vector<BaseColumnWriter*> m_columns;
     std::vector<BaseColumnWriter*> m_unordered_columns;
@@ -0,0 +1,160 @@
+#include "SearchServer.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include "../clp/ErrorCode.hpp"
+#include "../clp/networking/socket_utils.hpp"
+
+namespace clp_s {
+SearchServer::~SearchServer() {
+    if (-1 != m_listen_fd) {
+        close(m_listen_fd);
+    }
+}
+
+auto SearchServer::listen() -> bool {
+    sockaddr_un address{};
+    if (m_socket_path.size() >= sizeof(address.sun_path)) {
+        SPDLOG_ERROR("Socket path '{}' is too long", m_socket_path);
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    m_socket_path.copy(address.sun_path, m_socket_path.size());
+
+    // Remove the socket left behind by a previous server
+    if (std::error_code error_code; std::filesystem::is_socket(m_socket_path, error_code)) {
+        std::filesystem::remove(m_socket_path, error_code);
+    }
+
+    auto const listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (-1 == listen_fd) {
+        SPDLOG_ERROR("Failed to create socket, errno={}", errno);
+        return false;
+    }
+    if (0 != bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address))
+        || 0 != ::listen(listen_fd, SOMAXCONN))
+    {
+        SPDLOG_ERROR("Failed to listen on '{}', errno={}", m_socket_path, errno);
+        close(listen_fd);
+        return false;
+    }
+    m_listen_fd = listen_fd;
+    SPDLOG_INFO("Serving searches on '{}'", m_socket_path);
+    return true;
+}
+
+auto SearchServer::serve() -> bool {
+    while (true) {
+        auto const client_socket_fd = accept(m_listen_fd, nullptr, nullptr);
+        if (-1 == client_socket_fd) {
+            if (m_is_stopped) {
+                return true;
+            }
+            if (EINTR == errno) {
+                continue;
+            }
+            SPDLOG_ERROR("Failed to accept connection, errno={}", errno);
+            return false;
+        }
+        try {
+            handle_request(client_socket_fd);
+        } catch (std::exception const& e) {
+            SPDLOG_ERROR("Failed to handle request - {}", e.what());
+        }
+        close(client_socket_fd);
+        if (m_is_stopped) {
+            return true;
+        }
+    }
+}
+
+void SearchServer::stop() {
+    m_is_stopped = true;
+    // Shutting down the listening socket wakes up any thread waiting to accept a connection
+    shutdown(m_listen_fd, SHUT_RDWR);
+}
+
+void SearchServer::handle_request(int client_socket_fd) {
+    constexpr size_t cMaxRequestSize{1024ULL * 1024};  // 1 MiB
+    std::string request;
+    std::array<char, 4096> buf{};
+    while (std::string::npos == request.find('\n')) {
+        if (request.size() > cMaxRequestSize) {
+            SPDLOG_ERROR("Request exceeds {} B", cMaxRequestSize);
+            return;
+        }
+        size_t num_bytes_received{0};
+        auto const rc = clp::networking::try_receive(
+                client_socket_fd,
+                buf.data(),
+                buf.size(),
+                num_bytes_received
+        );
+        if (clp::ErrorCode_EndOfFile == rc) {
+            break;
+        }
+        if (clp::ErrorCode_Success != rc) {
+            SPDLOG_ERROR("Failed to receive request, errno={}", errno);
+            return;
+        }
+        request.append(buf.data(), num_bytes_received);
+    }
+    request.resize(std::min(request.find('\n'), request.size()));
+
+    auto const json_request = nlohmann::json::parse(request);
+    auto const command = json_request.at("command").get<std::string>();
+    nlohmann::json response;
+    if ("search" == command) {
+        auto const args = json_request.at("args").get<std::vector<std::string>>();
+        bool succeeded{false};
+        try {
+            succeeded = m_search(args, m_metadata_cache, client_socket_fd);
+        } catch (std::exception const& e) {
+            SPDLOG_ERROR("Encountered error during search - {}", e.what());
+        }
+        response["success"] = succeeded;
+
+        auto const stats = m_metadata_cache->get_stats();
+        SPDLOG_INFO(
+                "Archive metadata cache: {} hits, {} misses, {} evictions, {} archives using {} B",
+                stats.num_hits,
+                stats.num_misses,
+                stats.num_evictions,
+                stats.num_archives,
+                stats.memory_usage
+        );
+    } else if ("stats" == command) {
+        auto const stats = m_metadata_cache->get_stats();
+        response["num_hits"] = stats.num_hits;
+        response["num_misses"] = stats.num_misses;
+        response["num_evictions"] = stats.num_evictions;
+        response["num_archives"] = stats.num_archives;
+        response["memory_usage"] = stats.memory_usage;
+    } else {
+        SPDLOG_ERROR("Unknown command '{}'", command);
+        response["success"] = false;
+    }
+
+    auto const serialized_response = response.dump() + "\n";
+    clp::networking::send(
+            client_socket_fd,
+            serialized_response.data(),
+            serialized_response.size()
+    );
+}
+}  // namespace clp_s
@@ -0,0 +1,101 @@
+#ifndef CLP_S_SEARCHSERVER_HPP
+#define CLP_S_SEARCHSERVER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ArchiveMetadataCache.hpp"
+
+namespace clp_s {
+/**
+ * Server that serves search requests sent to a Unix domain socket, one connection at a time, while
+ * caching the decoded metadata of the searched archives across requests.
+ *
+ * Each connection sends a single request: a line holding a JSON object whose `command` is either:
+ * - "search", to search with the `s` command's arguments listed in `args`. Results bound for
+ *   standard output are written to the client, followed by a line with the search's `success`.
+ * - "stats", to get the statistics of the metadata cache.
+ */
+class SearchServer {
+public:
+    // Types
+    /**
+     * Searches with the given `s` command arguments, writing any results bound for standard output
+     * to the client's socket.
+     * @param args
+     * @param metadata_cache
+     * @param client_socket_fd
+     * @return Whether the search succeeded
+     */
+    using SearchFunction = std::function<bool(
+            std::vector<std::string> const& args,
+            std::shared_ptr<ArchiveMetadataCache> const& metadata_cache,
+            int client_socket_fd
+    )>;
+
+    // Constructors
+    /**
+     * @param socket_path
+     * @param metadata_cache_size The maximum estimated memory (B) used by the cached metadata
+     * @param search
+     */
+    SearchServer(std::string socket_path, size_t metadata_cache_size, SearchFunction search)
+            : m_socket_path{std::move(socket_path)},
+              m_metadata_cache{std::make_shared<ArchiveMetadataCache>(metadata_cache_size)},
+              m_search{std::move(search)} {}
+
+    // Delete copy & move constructors and assignment operators
+    SearchServer(SearchServer const&) = delete;
+    SearchServer(SearchServer&&) = delete;
+    auto operator=(SearchServer const&) -> SearchServer& = delete;
+    auto operator=(SearchServer&&) -> SearchServer& = delete;
+
+    // Destructor
+    ~SearchServer();
+
+    // Methods
+    /**
+     * Starts listening on the socket, replacing any socket left behind by a previous server.
+     * @return Whether the server is listening
+     */
+    [[nodiscard]] auto listen() -> bool;
+
+    /**
+     * Serves requests until the server is stopped or stops accepting connections.
+     * @return Whether the server was stopped, rather than failing to accept a connection
+     */
+    [[nodiscard]] auto serve() -> bool;
+
+    /**
+     * Stops the server once it finishes handling its current request. Can be called from any
+     * thread while the server is serving.
+     */
+    void stop();
+
+    [[nodiscard]] auto get_metadata_cache() const -> std::shared_ptr<ArchiveMetadataCache> const& {
+        return m_metadata_cache;
+    }
+
+private:
+    // Methods
+    /**
+     * Handles the request sent on a connection.
+     * @param client_socket_fd
+     */
+    void handle_request(int client_socket_fd);
+
+    // Variables
+    std::string m_socket_path;
+    std::shared_ptr<ArchiveMetadataCache> m_metadata_cache;
+    SearchFunction m_search;
+    int m_listen_fd{-1};
+    std::atomic_bool m_is_stopped{false};
+};
+}  // namespace clp_s
+
+#endif  // CLP_S_SEARCHSERVER_HPP
@@ -10,9 +10,16 @@
 namespace clp_s {
 // define the version
 constexpr uint8_t cArchiveMajorVersion = 0;
-constexpr uint8_t cArchiveMinorVersion = 4;
+constexpr uint8_t cArchiveMinorVersion = 7;
 constexpr uint16_t cArchivePatchVersion = 0;
 
+// The first version whose integer columns are stored with an `IntegerEncoding`
+constexpr uint32_t cEncodedIntegerColumnsArchiveVersion = (0U << 24) | (5U << 16);
+// The first version whose float columns are stored with a `FloatEncoding`
+constexpr uint32_t cEncodedFloatColumnsArchiveVersion = (0U << 24) | (6U << 16);
+// The first version whose date string columns are stored with `encode_delta_of_delta_integers`
+constexpr uint32_t cEncodedDateStringColumnsArchiveVersion = (0U << 24) | (7U << 16);
+
 // define the magic number
 constexpr uint8_t cStructuredSFAMagicNumber[] = {0xFD, 0x2F, 0xC5, 0x30};
 
@@ -35,7 +42,8 @@ enum struct ArchiveMetadataPacketType : uint8_t {
     ArchiveInfo = 0,
     ArchiveFileInfo = 1,
     TimestampDictionary = 2,
-    RangeIndex = 3
+    RangeIndex = 3,
+    DictionarySummary = 4
 };
 
 struct ArchiveInfoPacket {
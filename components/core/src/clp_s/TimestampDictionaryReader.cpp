@@ -1,5 +1,6 @@
 #include "TimestampDictionaryReader.hpp"
 
+#include <algorithm>
 #include <unordered_set>
 
 #include "search/ast/SearchUtils.hpp"
@@ -76,4 +77,12 @@ TimestampDictionaryReader::get_string_encoding(epochtime_t epoch, uint64_t forma
 
     return ret;
 }
+
+auto TimestampDictionaryReader::get_max_reported_timestamp() const -> epochtime_t {
+    // The first entry is the authoritative timestamp column
+    if (m_entries.empty()) {
+        return 0;
+    }
+    return std::max(epochtime_t{0}, m_entries.front().get_end_timestamp());
+}
 }  // namespace clp_s
@@ -61,6 +61,13 @@ public:
         return m_authoritative_timestamp_column_ids;
     }
 
+    /**
+     * Gets an upper bound on the timestamps reported when searching the archive. Records without
+     * an authoritative timestamp are reported with a timestamp of 0.
+     * @return The upper bound
+     */
+    [[nodiscard]] auto get_max_reported_timestamp() const -> epochtime_t;
+
 private:
     using id_to_pattern_t = std::map<uint64_t, TimestampPattern>;
     using tokenized_column_to_range_t
@@ -5,6 +5,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <zstd.h>
 #include <zstd_errors.h>
@@ -66,6 +67,11 @@ public:
      */
     void flush();
 
+    /**
+     * @return The number of uncompressed bytes written to the compressor since it was opened
+     */
+    size_t get_uncompressed_stream_pos() const { return m_uncompressed_stream_pos; }
+
     // Methods implementing the Compressor interface
     /**
      * Closes the compressor
@@ -79,9 +85,32 @@ public:
      */
     void open(FileWriter& file_writer, int compression_level = cDefaultCompressionLevel);
 
+    /**
+     * Initialize streaming compressor to append compressed data to an in-memory buffer
+     * @param compressed_buffer
+     * @param compression_level
+     */
+    void
+    open(std::vector<char>& compressed_buffer, int compression_level = cDefaultCompressionLevel);
+
 private:
+    // Methods
+    /**
+     * Initializes the compression stream
+     * @param compression_level
+     */
+    void init_compression_stream(int compression_level);
+
+    /**
+     * Writes compressed data to the file or buffer the compressor was opened with
+     * @param data
+     * @param data_length
+     */
+    void write_compressed_data(char const* data, size_t data_length);
+
     // Variables
     FileWriter* m_compressed_stream_file_writer{};
+    std::vector<char>* m_compressed_stream_buffer{};
 
     // Compressed stream variables
     ZSTD_CStream* m_compression_stream;
@@ -1,12 +1,18 @@
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <cstdlib>
 #include <exception>
 #include <filesystem>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <system_error>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include <mongocxx/instance.hpp>
 #include <nlohmann/json.hpp>
@@ -17,12 +23,14 @@
 #include "../clp/ir/constants.hpp"
 #include "../clp/streaming_archive/ArchiveMetadata.hpp"
 #include "../reducer/network_utils.hpp"
+#include "ArchiveMetadataCache.hpp"
 #include "CommandLineArguments.hpp"
 #include "Defs.hpp"
 #include "JsonConstructor.hpp"
 #include "JsonParser.hpp"
 #include "kv_ir_search.hpp"
 #include "OutputHandlerImpl.hpp"
+#include "ParallelJsonParser.hpp"
 #include "search/AddTimestampConditions.hpp"
 #include "search/ast/ConvertToExists.hpp"
 #include "search/ast/EmptyExpr.hpp"
@@ -37,6 +45,8 @@
 #include "search/OutputHandler.hpp"
 #include "search/Projection.hpp"
 #include "search/SchemaMatch.hpp"
+#include "search/TopKTimestamps.hpp"
+#include "SearchServer.hpp"
 #include "TimestampPattern.hpp"
 #include "Utils.hpp"
 
@@ -60,8 +70,13 @@ bool compress(CommandLineArguments const& command_line_arguments);
 /**
  * Decompresses the archive specified by the given JsonConstructorOption.
  * @param json_constructor_option
+ * @param output_mutex The mutex guarding output files shared with concurrent decompressions, or
+ * nullptr if there are none
  */
-void decompress_archive(clp_s::JsonConstructorOption const& json_constructor_option);
+void decompress_archive(
+        clp_s::JsonConstructorOption const& json_constructor_option,
+        std::mutex* output_mutex
+);
 
 /**
  * Searches the given archive.
@@ -69,15 +84,104 @@ void decompress_archive(clp_s::JsonConstructorOption const& json_constructor_opt
  * @param archive_reader
  * @param expr A copy of the search AST which may be modified
  * @param reducer_socket_fd
+ * @param client_socket_fd The socket of the search server's client, to which results bound for
+ * standard output are written instead, or -1 if there's no client
+ * @param output_mutex The mutex guarding output destinations shared with concurrent searches, or
+ * nullptr if inputs are searched one at a time
+ * @param top_k_timestamps The latest results found across every searched archive, or nullptr if
+ * they aren't tracked
  * @return Whether the search succeeded
  */
 bool search_archive(
         CommandLineArguments const& command_line_arguments,
         std::shared_ptr<clp_s::ArchiveReader> const& archive_reader,
         std::shared_ptr<ast::Expression> expr,
-        int reducer_socket_fd
+        int reducer_socket_fd,
+        int client_socket_fd,
+        std::mutex* output_mutex,
+        std::shared_ptr<TopKTimestamps> const& top_k_timestamps
+);
+
+/**
+ * Searches the given input, which is either a KV-IR stream or an archive.
+ * @param command_line_arguments
+ * @param input_path
+ * @param archive_reader The reader used to open the input if it's an archive
+ * @param expr The search AST, which is copied before being modified
+ * @param reducer_socket_fd
+ * @param client_socket_fd The socket of the search server's client, or -1 if there's no client
+ * @param output_mutex The mutex guarding output destinations shared with concurrent searches, or
+ * nullptr if inputs are searched one at a time
+ * @param top_k_timestamps
+ * @return Whether the search succeeded
+ */
+bool search_input(
+        CommandLineArguments const& command_line_arguments,
+        clp_s::Path const& input_path,
+        std::shared_ptr<clp_s::ArchiveReader> const& archive_reader,
+        std::shared_ptr<ast::Expression> const& expr,
+        int reducer_socket_fd,
+        int client_socket_fd,
+        std::mutex* output_mutex,
+        std::shared_ptr<TopKTimestamps> const& top_k_timestamps
 );
 
+/**
+ * Searches the inputs specified by the command line arguments, searching up to `--parallelism`
+ * inputs concurrently, each with its own ArchiveReader. Once any search fails, no further inputs
+ * are searched.
+ * @param command_line_arguments
+ * @param expr
+ * @param reducer_socket_fd
+ * @param client_socket_fd The socket of the search server's client, or -1 if there's no client
+ * @param metadata_cache The cache of archive metadata shared across queries, or nullptr if there's
+ * no cache
+ * @param top_k_timestamps
+ * @return Whether every search succeeded
+ */
+bool search_inputs_concurrently(
+        CommandLineArguments const& command_line_arguments,
+        std::shared_ptr<ast::Expression> const& expr,
+        int reducer_socket_fd,
+        int client_socket_fd,
+        std::shared_ptr<clp_s::ArchiveMetadataCache> const& metadata_cache,
+        std::shared_ptr<TopKTimestamps> const& top_k_timestamps
+);
+
+/**
+ * Searches the inputs specified by the command line arguments for the query they specify.
+ * @param command_line_arguments
+ * @param metadata_cache The cache of archive metadata shared across queries, or nullptr if there's
+ * no cache
+ * @param client_socket_fd The socket of the search server's client, or -1 if there's no client
+ * @return Whether the search succeeded
+ */
+bool search(
+        CommandLineArguments const& command_line_arguments,
+        std::shared_ptr<clp_s::ArchiveMetadataCache> const& metadata_cache,
+        int client_socket_fd
+);
+
+/**
+ * Searches with the `s` command's arguments, for the search server.
+ * @param args
+ * @param metadata_cache
+ * @param client_socket_fd
+ * @return Whether the search succeeded
+ */
+bool serve_search(
+        std::vector<std::string> const& args,
+        std::shared_ptr<clp_s::ArchiveMetadataCache> const& metadata_cache,
+        int client_socket_fd
+);
+
+/**
+ * Serves search requests sent to the Unix domain socket specified by the command line arguments.
+ * @param command_line_arguments
+ * @return false if the server couldn't start or stopped accepting connections
+ */
+bool serve(CommandLineArguments const& command_line_arguments);
+
 bool compress(CommandLineArguments const& command_line_arguments) {
     auto archives_dir = std::filesystem::path(command_line_arguments.get_archives_dir());
 
@@ -101,12 +205,25 @@ bool compress(CommandLineArguments const& command_line_arguments) {
     option.target_encoded_size = command_line_arguments.get_target_encoded_size();
     option.max_document_size = command_line_arguments.get_max_document_size();
     option.min_table_size = command_line_arguments.get_minimum_table_size();
+    option.separate_columns_table_size
+            = command_line_arguments.get_separate_columns_table_size();
     option.compression_level = command_line_arguments.get_compression_level();
     option.timestamp_key = command_line_arguments.get_timestamp_key();
     option.print_archive_stats = command_line_arguments.print_archive_stats();
     option.single_file_archive = command_line_arguments.get_single_file_archive();
     option.structurize_arrays = command_line_arguments.get_structurize_arrays();
     option.record_log_order = command_line_arguments.get_record_log_order();
+    option.num_threads = command_line_arguments.get_num_threads();
+
+    if (command_line_arguments.get_archive_per_thread() && option.num_threads > 1) {
+        clp_s::ParallelJsonParser parser(option);
+        if (false == parser.parse()) {
+            SPDLOG_ERROR("Encountered error while parsing input");
+            return false;
+        }
+        std::ignore = parser.store();
+        return true;
+    }
 
     clp_s::JsonParser parser(option);
     if (clp_s::FileType::KeyValueIr == option.input_file_type) {
@@ -124,16 +241,22 @@ bool compress(CommandLineArguments const& command_line_arguments) {
     return true;
 }
 
-void decompress_archive(clp_s::JsonConstructorOption const& json_constructor_option) {
+void decompress_archive(
+        clp_s::JsonConstructorOption const& json_constructor_option,
+        std::mutex* output_mutex
+) {
     clp_s::JsonConstructor constructor(json_constructor_option);
-    constructor.store();
+    constructor.store(output_mutex);
 }
 
 bool search_archive(
         CommandLineArguments const& command_line_arguments,
         std::shared_ptr<clp_s::ArchiveReader> const& archive_reader,
         std::shared_ptr<ast::Expression> expr,
-        int reducer_socket_fd
+        int reducer_socket_fd,
+        int client_socket_fd,
+        std::mutex* output_mutex,
+        std::shared_ptr<TopKTimestamps> const& top_k_timestamps
 ) {
     auto const& query = command_line_arguments.get_query();
 
@@ -261,11 +384,16 @@ bool search_archive(
                         command_line_arguments.get_mongodb_uri(),
                         command_line_arguments.get_mongodb_collection(),
                         command_line_arguments.get_batch_size(),
-                        command_line_arguments.get_max_num_results()
+                        command_line_arguments.get_max_num_results(),
+                        top_k_timestamps
                 );
                 break;
             case CommandLineArguments::OutputHandlerType::Stdout:
-                output_handler = std::make_unique<clp_s::StandardOutputHandler>();
+                if (-1 != client_socket_fd) {
+                    output_handler = std::make_unique<clp_s::SocketOutputHandler>(client_socket_fd);
+                } else {
+                    output_handler = std::make_unique<clp_s::StandardOutputHandler>();
+                }
                 break;
             default:
                 SPDLOG_ERROR("Unhandled OutputHandlerType.");
@@ -276,21 +404,289 @@ bool search_archive(
         return false;
     }
 
+    // Standard output and the reducer socket are shared by every concurrent search, whereas the
+    // other output handlers each own their connection.
+    if (nullptr != output_mutex
+        && (CommandLineArguments::OutputHandlerType::Stdout
+                    == command_line_arguments.get_output_handler_type()
+            || CommandLineArguments::OutputHandlerType::Reducer
+                       == command_line_arguments.get_output_handler_type()))
+    {
+        output_handler = std::make_unique<clp_s::SynchronizedOutputHandler>(
+                std::move(output_handler),
+                *output_mutex
+        );
+    }
+
     // output result
     Output output(
             match_pass,
             expr,
             archive_reader,
             std::move(output_handler),
-            command_line_arguments.get_ignore_case()
+            command_line_arguments.get_ignore_case(),
+            command_line_arguments.get_num_threads()
     );
     return output.filter();
 }
+
+bool search_input(
+        CommandLineArguments const& command_line_arguments,
+        clp_s::Path const& input_path,
+        std::shared_ptr<clp_s::ArchiveReader> const& archive_reader,
+        std::shared_ptr<ast::Expression> const& expr,
+        int reducer_socket_fd,
+        int client_socket_fd,
+        std::mutex* output_mutex,
+        std::shared_ptr<TopKTimestamps> const& top_k_timestamps
+) {
+    if (std::string::npos != input_path.path.find(clp::ir::cIrFileExtension)) {
+        if (-1 != client_socket_fd) {
+            // KV-IR stream searches write to standard output directly
+            SPDLOG_ERROR("Searching IR streams isn't supported by the search server");
+            return false;
+        }
+        auto const result{clp_s::search_kv_ir_stream(
+                input_path,
+                command_line_arguments,
+                expr->copy(),
+                reducer_socket_fd,
+                output_mutex
+        )};
+        if (false == result.has_error()) {
+            return true;
+        }
+
+        auto const error{result.error()};
+        if (std::errc::result_out_of_range == error) {
+            // To support real-time search, we will allow incomplete IR streams.
+            // TODO: Use dedicated error code for this case once issue #904 is resolved.
+            SPDLOG_WARN("IR stream `{}` is truncated", input_path.path);
+            return true;
+        }
+
+        if (KvIrSearchError{KvIrSearchErrorEnum::ProjectionSupportNotImplemented} == error
+            || KvIrSearchError{KvIrSearchErrorEnum::UnsupportedOutputHandlerType} == error
+            || KvIrSearchError{KvIrSearchErrorEnum::CountSupportNotImplemented} == error)
+        {
+            // These errors are treated as non-fatal because they result from unsupported
+            // features. However, this approach may cause archives with this extension to be
+            // skipped if the search uses advanced features that are not yet implemented. To
+            // mitigate this, we log a warning and proceed to search the input as an
+            // archive.
+            SPDLOG_WARN(
+                    "Attempted to search an IR stream using unsupported features. Falling"
+                    " back to searching the input as an archive."
+            );
+        } else if (KvIrSearchError{KvIrSearchErrorEnum::DeserializerCreationFailure} != error) {
+            // If the error is `DeserializerCreationFailure`, we may continue to treat the
+            // input as an archive and retry. Otherwise, it should be considered as a
+            // non-recoverable failure and return directly.
+            SPDLOG_ERROR(
+                    "Failed to search '{}' as an IR stream, error_category={}, error={}",
+                    input_path.path,
+                    error.category().name(),
+                    error.message()
+            );
+            return false;
+        }
+    }
+
+    try {
+        archive_reader->open(
+                input_path,
+                command_line_arguments.get_network_auth(),
+                command_line_arguments.get_memory_map()
+        );
+    } catch (std::exception const& e) {
+        SPDLOG_ERROR("Failed to open archive - {}", e.what());
+        return false;
+    }
+    if (false
+        == search_archive(
+                command_line_arguments,
+                archive_reader,
+                expr->copy(),
+                reducer_socket_fd,
+                client_socket_fd,
+                output_mutex,
+                top_k_timestamps
+        ))
+    {
+        return false;
+    }
+    archive_reader->close();
+    return true;
+}
+
+bool search_inputs_concurrently(
+        CommandLineArguments const& command_line_arguments,
+        std::shared_ptr<ast::Expression> const& expr,
+        int reducer_socket_fd,
+        int client_socket_fd,
+        std::shared_ptr<clp_s::ArchiveMetadataCache> const& metadata_cache,
+        std::shared_ptr<TopKTimestamps> const& top_k_timestamps
+) {
+    auto const& input_paths = command_line_arguments.get_input_paths();
+    auto const num_workers
+            = std::min(command_line_arguments.get_parallelism(), input_paths.size());
+
+    std::mutex output_mutex;
+    std::atomic_size_t next_input_idx{0};
+    std::atomic_bool failed{false};
+    std::vector<std::thread> workers;
+    workers.reserve(num_workers);
+    for (size_t i{0}; i < num_workers; ++i) {
+        workers.emplace_back([&]() {
+            auto archive_reader = std::make_shared<clp_s::ArchiveReader>();
+            archive_reader->set_metadata_cache(metadata_cache);
+            while (false == failed) {
+                auto const input_idx = next_input_idx++;
+                if (input_idx >= input_paths.size()) {
+                    break;
+                }
+                auto const& input_path = input_paths[input_idx];
+                try {
+                    if (false
+                        == search_input(
+                                command_line_arguments,
+                                input_path,
+                                archive_reader,
+                                expr,
+                                reducer_socket_fd,
+                                client_socket_fd,
+                                &output_mutex,
+                                top_k_timestamps
+                        ))
+                    {
+                        failed = true;
+                    }
+                } catch (std::exception const& e) {
+                    SPDLOG_ERROR("Failed to search '{}' - {}", input_path.path, e.what());
+                    failed = true;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return false == failed;
+}
+
+bool search(
+        CommandLineArguments const& command_line_arguments,
+        std::shared_ptr<clp_s::ArchiveMetadataCache> const& metadata_cache,
+        int client_socket_fd
+) {
+    auto const& query = command_line_arguments.get_query();
+    auto query_stream = std::istringstream(query);
+    auto expr = kql::parse_kql_expression(query_stream);
+    if (nullptr == expr) {
+        return false;
+    }
+
+    if (std::dynamic_pointer_cast<ast::EmptyExpr>(expr)) {
+        SPDLOG_ERROR("Query '{}' is logically false", query);
+        return false;
+    }
+
+    int reducer_socket_fd{-1};
+    if (command_line_arguments.get_output_handler_type()
+        == CommandLineArguments::OutputHandlerType::Reducer)
+    {
+        reducer_socket_fd = reducer::connect_to_reducer(
+                command_line_arguments.get_reducer_host(),
+                command_line_arguments.get_reducer_port(),
+                command_line_arguments.get_job_id()
+        );
+        if (-1 == reducer_socket_fd) {
+            SPDLOG_ERROR("Failed to connect to reducer");
+            return false;
+        }
+    }
+
+    // The latest results are tracked across every archive searched, so that archives and
+    // tables that can't contain any of them can be skipped
+    std::shared_ptr<TopKTimestamps> top_k_timestamps;
+    if (CommandLineArguments::OutputHandlerType::ResultsCache
+        == command_line_arguments.get_output_handler_type())
+    {
+        auto const max_num_results = command_line_arguments.get_max_num_results();
+        top_k_timestamps = std::make_shared<TopKTimestamps>(max_num_results);
+    }
+
+    if (command_line_arguments.get_parallelism() > 1) {
+        if (false
+            == search_inputs_concurrently(
+                    command_line_arguments,
+                    expr,
+                    reducer_socket_fd,
+                    client_socket_fd,
+                    metadata_cache,
+                    top_k_timestamps
+            ))
+        {
+            return false;
+        }
+    } else {
+        auto archive_reader = std::make_shared<clp_s::ArchiveReader>();
+        archive_reader->set_metadata_cache(metadata_cache);
+        for (auto const& input_path : command_line_arguments.get_input_paths()) {
+            if (false
+                == search_input(
+                        command_line_arguments,
+                        input_path,
+                        archive_reader,
+                        expr,
+                        reducer_socket_fd,
+                        client_socket_fd,
+                        nullptr,
+                        top_k_timestamps
+                ))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool serve_search(
+        std::vector<std::string> const& args,
+        std::shared_ptr<clp_s::ArchiveMetadataCache> const& metadata_cache,
+        int client_socket_fd
+) {
+    std::vector<char const*> argv{"clp-s", "s"};
+    for (auto const& arg : args) {
+        argv.push_back(arg.c_str());
+    }
+
+    CommandLineArguments command_line_arguments("clp-s");
+    auto const parsing_result
+            = command_line_arguments.parse_arguments(static_cast<int>(argv.size()), argv.data());
+    return CommandLineArguments::ParsingResult::Success == parsing_result
+           && search(command_line_arguments, metadata_cache, client_socket_fd);
+}
+
+bool serve(CommandLineArguments const& command_line_arguments) {
+    clp_s::SearchServer server{
+            command_line_arguments.get_socket_path(),
+            command_line_arguments.get_metadata_cache_size(),
+            serve_search
+    };
+    if (false == server.listen()) {
+        return false;
+    }
+    // The server is never stopped, so it only returns once it fails to accept a connection
+    std::ignore = server.serve();
+    return false;
+}
 }  // namespace
 
 int main(int argc, char const* argv[]) {
     try {
-        auto stderr_logger = spdlog::stderr_logger_st("stderr");
+        auto stderr_logger = spdlog::stderr_logger_mt("stderr");
         spdlog::set_default_logger(stderr_logger);
         spdlog::set_pattern("%Y-%m-%dT%H:%M:%S.%e%z [%l] %v");
     } catch (std::exception& e) {
@@ -328,118 +724,45 @@ int main(int argc, char const* argv[]) {
         option.output_dir = command_line_arguments.get_output_dir();
         option.ordered = command_line_arguments.get_ordered_decompression();
         option.target_ordered_chunk_size = command_line_arguments.get_target_ordered_chunk_size();
+        option.max_ordered_memory_usage = command_line_arguments.get_max_ordered_memory_usage();
         option.print_ordered_chunk_stats = command_line_arguments.print_ordered_chunk_stats();
         option.network_auth = command_line_arguments.get_network_auth();
+        option.memory_map = command_line_arguments.get_memory_map();
+        option.num_threads = command_line_arguments.get_num_threads();
         if (false == command_line_arguments.get_mongodb_uri().empty()) {
             option.metadata_db
                     = {command_line_arguments.get_mongodb_uri(),
                        command_line_arguments.get_mongodb_collection()};
         }
 
-        try {
-            for (auto const& archive_path : command_line_arguments.get_input_paths()) {
-                option.archive_path = archive_path;
-                decompress_archive(option);
-            }
-        } catch (std::exception const& e) {
-            SPDLOG_ERROR("Encountered error during decompression - {}", e.what());
-            return 1;
-        }
-    } else {
-        auto const& query = command_line_arguments.get_query();
-        auto query_stream = std::istringstream(query);
-        auto expr = kql::parse_kql_expression(query_stream);
-        if (nullptr == expr) {
-            return 1;
-        }
-
-        if (std::dynamic_pointer_cast<ast::EmptyExpr>(expr)) {
-            SPDLOG_ERROR("Query '{}' is logically false", query);
-            return 1;
-        }
-
-        int reducer_socket_fd{-1};
-        if (command_line_arguments.get_output_handler_type()
-            == CommandLineArguments::OutputHandlerType::Reducer)
-        {
-            reducer_socket_fd = reducer::connect_to_reducer(
-                    command_line_arguments.get_reducer_host(),
-                    command_line_arguments.get_reducer_port(),
-                    command_line_arguments.get_job_id()
-            );
-            if (-1 == reducer_socket_fd) {
-                SPDLOG_ERROR("Failed to connect to reducer");
+        if (command_line_arguments.get_parallelism() > 1) {
+            if (false
+                == clp_s::decompress_archives_concurrently(
+                        command_line_arguments.get_input_paths(),
+                        option,
+                        command_line_arguments.get_parallelism()
+                ))
+            {
                 return 1;
             }
-        }
-
-        auto archive_reader = std::make_shared<clp_s::ArchiveReader>();
-        for (auto const& input_path : command_line_arguments.get_input_paths()) {
-            if (std::string::npos != input_path.path.find(clp::ir::cIrFileExtension)) {
-                auto const result{clp_s::search_kv_ir_stream(
-                        input_path,
-                        command_line_arguments,
-                        expr->copy(),
-                        reducer_socket_fd
-                )};
-                if (false == result.has_error()) {
-                    continue;
-                }
-
-                auto const error{result.error()};
-                if (std::errc::result_out_of_range == error) {
-                    // To support real-time search, we will allow incomplete IR streams.
-                    // TODO: Use dedicated error code for this case once issue #904 is resolved.
-                    SPDLOG_WARN("IR stream `{}` is truncated", input_path.path);
-                    continue;
-                }
-
-                if (KvIrSearchError{KvIrSearchErrorEnum::ProjectionSupportNotImplemented} == error
-                    || KvIrSearchError{KvIrSearchErrorEnum::UnsupportedOutputHandlerType} == error
-                    || KvIrSearchError{KvIrSearchErrorEnum::CountSupportNotImplemented} == error)
-                {
-                    // These errors are treated as non-fatal because they result from unsupported
-                    // features. However, this approach may cause archives with this extension to be
-                    // skipped if the search uses advanced features that are not yet implemented. To
-                    // mitigate this, we log a warning and proceed to search the input as an
-                    // archive.
-                    SPDLOG_WARN(
-                            "Attempted to search an IR stream using unsupported features. Falling"
-                            " back to searching the input as an archive."
-                    );
-                } else if (KvIrSearchError{KvIrSearchErrorEnum::DeserializerCreationFailure}
-                           != error)
-                {
-                    // If the error is `DeserializerCreationFailure`, we may continue to treat the
-                    // input as an archive and retry. Otherwise, it should be considered as a
-                    // non-recoverable failure and return directly.
-                    SPDLOG_ERROR(
-                            "Failed to search '{}' as an IR stream, error_category={}, error={}",
-                            input_path.path,
-                            error.category().name(),
-                            error.message()
-                    );
-                    return 1;
-                }
-            }
-
+        } else {
             try {
-                archive_reader->open(input_path, command_line_arguments.get_network_auth());
+                for (auto const& archive_path : command_line_arguments.get_input_paths()) {
+                    option.archive_path = archive_path;
+                    decompress_archive(option, nullptr);
+                }
             } catch (std::exception const& e) {
-                SPDLOG_ERROR("Failed to open archive - {}", e.what());
-                return 1;
-            }
-            if (false
-                == search_archive(
-                        command_line_arguments,
-                        archive_reader,
-                        expr->copy(),
-                        reducer_socket_fd
-                ))
-            {
+                SPDLOG_ERROR("Encountered error during decompression - {}", e.what());
                 return 1;
             }
-            archive_reader->close();
+        }
+    } else if (CommandLineArguments::Command::Search == command_line_arguments.get_command()) {
+        if (false == search(command_line_arguments, nullptr, -1)) {
+            return 1;
+        }
+    } else {
+        if (false == serve(command_line_arguments)) {
+            return 1;
         }
     }
 
@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -53,14 +54,18 @@ public:
     /**
      * @param command_line_arguments
      * @param reducer_socket_fd
+     * @param output_mutex The mutex guarding the output shared with concurrent searches, or nullptr
+     * if there are none
      * @return A result containing the created IrUnitHandler on success, or an error code indicating
      * the failure:
      * - KvIrSearchErrorEnum::UnsupportedOutputHandlerType if the output handler type is not
      *   supported.
      */
-    [[nodiscard]] static auto
-    create(CommandLineArguments const& command_line_arguments, int reducer_socket_fd)
-            -> ystdlib::error_handling::Result<IrUnitHandler>;
+    [[nodiscard]] static auto create(
+            CommandLineArguments const& command_line_arguments,
+            int reducer_socket_fd,
+            std::mutex* output_mutex
+    ) -> ystdlib::error_handling::Result<IrUnitHandler>;
 
     // Delete copy constructor and assignment operator
     IrUnitHandler(IrUnitHandler const&) = delete;
@@ -97,7 +102,10 @@ public:
 
 private:
     // Constructor
-    IrUnitHandler() = default;
+    explicit IrUnitHandler(std::mutex* output_mutex) : m_output_mutex{output_mutex} {}
+
+    // Variables
+    std::mutex* m_output_mutex;
 };
 
 /**
@@ -106,6 +114,7 @@ private:
  * @param command_line_arguments
  * @param query
  * @param reducer_socket_fd
+ * @param output_mutex
  * @return A void result on success, or an error code indicating the failure:
  * - KvIrSearchErrorEnum::DeserializerCreationFailure if `clp::ffi::ir_stream::Deserializer::create`
  *   failed. This specific error code is returned instead of propagating the return values of
@@ -119,12 +128,14 @@ private:
         clp::ReaderInterface& stream_reader,
         CommandLineArguments const& command_line_arguments,
         std::shared_ptr<search::ast::Expression> query,
-        int reducer_socket_fd
+        int reducer_socket_fd,
+        std::mutex* output_mutex
 ) -> ystdlib::error_handling::Result<void>;
 
 auto IrUnitHandler::create(
         CommandLineArguments const& command_line_arguments,
-        [[maybe_unused]] int reducer_socket_fd
+        [[maybe_unused]] int reducer_socket_fd,
+        std::mutex* output_mutex
 ) -> ystdlib::error_handling::Result<IrUnitHandler> {
     switch (command_line_arguments.get_output_handler_type()) {
         case CommandLineArguments::OutputHandlerType::Stdout:
@@ -140,17 +151,9 @@ auto IrUnitHandler::create(
             SPDLOG_ERROR("kv-ir search: Unknown output method.");
             return KvIrSearchError{KvIrSearchErrorEnum::UnsupportedOutputHandlerType};
     }
-    return IrUnitHandler{};
+    return IrUnitHandler{output_mutex};
 }
 
-/**
- * The following clang-tidy check is disabled because this function is intentionally designed as a
- * non-static member function for the following reasons:
- * - It is expected to be extended in the future to support additional search features.
- * - It must be invoked through an object created by the factory function, which ensures all
- *   necessary validations are performed.
- */
-// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
 auto IrUnitHandler::handle_log_event(clp::ffi::KeyValuePairLogEvent log_event) -> IRErrorCode {
     auto const serialize_result{log_event.serialize_to_json()};
     if (serialize_result.has_error()) {
@@ -167,13 +170,20 @@ auto IrUnitHandler::handle_log_event(clp::ffi::KeyValuePairLogEvent log_event) -
     try {
         constexpr std::string_view cAutoGenKey{"\"auto_generated_kv_pairs\""};
         constexpr std::string_view cUserGenKey{"\"user_generated_kv_pairs\""};
-        std::cout << fmt::format(
+        auto const result{fmt::format(
                 "{{{}:{},{}:{}}}\n",
                 cAutoGenKey,
                 auto_gen_kv_pairs.dump(),
                 cUserGenKey,
                 user_gen_kv_pairs.dump()
-        );
+        )};
+        // Each result is written while holding the output mutex so that the results of concurrent
+        // searches don't interleave, without serializing the searches themselves.
+        std::unique_lock<std::mutex> output_lock;
+        if (nullptr != m_output_mutex) {
+            output_lock = std::unique_lock<std::mutex>{*m_output_mutex};
+        }
+        std::cout << result;
     } catch (nlohmann::json::exception const& ex) {
         SPDLOG_ERROR(
                 "kv-ir search: Failed to serialize kv-pair log event into JSON strings."
@@ -190,7 +200,8 @@ auto deserialize_and_search_kv_ir_stream(
         clp::ReaderInterface& stream_reader,
         CommandLineArguments const& command_line_arguments,
         std::shared_ptr<search::ast::Expression> query,
-        int reducer_socket_fd
+        int reducer_socket_fd,
+        std::mutex* output_mutex
 ) -> ystdlib::error_handling::Result<void> {
     auto trivial_new_projected_schema_tree_node_callback
             = []([[maybe_unused]] bool is_auto_generated,
@@ -201,7 +212,7 @@ auto deserialize_and_search_kv_ir_stream(
             decltype(trivial_new_projected_schema_tree_node_callback)>;
 
     auto ir_unit_handler{YSTDLIB_ERROR_HANDLING_TRYX(
-            IrUnitHandler::create(command_line_arguments, reducer_socket_fd)
+            IrUnitHandler::create(command_line_arguments, reducer_socket_fd, output_mutex)
     )};
     auto query_handler{YSTDLIB_ERROR_HANDLING_TRYX(
             QueryHandlerType::create(
@@ -233,7 +244,8 @@ auto search_kv_ir_stream(
         Path const& stream_path,
         CommandLineArguments const& command_line_arguments,
         std::shared_ptr<search::ast::Expression> query,
-        int reducer_socket_fd
+        int reducer_socket_fd,
+        std::mutex* output_mutex
 ) -> ystdlib::error_handling::Result<void> {
     if (false == command_line_arguments.get_projection_columns().empty()) {
         SPDLOG_ERROR("kv-ir search: Projection support is not implemented.");
@@ -271,7 +283,8 @@ auto search_kv_ir_stream(
                 decompressor,
                 command_line_arguments,
                 std::move(query),
-                reducer_socket_fd
+                reducer_socket_fd,
+                output_mutex
         ));
         decompressor.close();
     } catch (clp::TraceableException const& ex) {
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <mutex>
 
 #include <ystdlib/error_handling/ErrorCode.hpp>
 #include <ystdlib/error_handling/Result.hpp>
@@ -29,6 +30,8 @@ using KvIrSearchError = ystdlib::error_handling::ErrorCode<KvIrSearchErrorEnum>;
  * @param command_line_arguments
  * @param query
  * @param reducer_socket_fd
+ * @param output_mutex The mutex guarding the output shared with concurrent searches, or nullptr if
+ * there are none. It's only held while writing each result.
  * @return A void result on success, or an error code indicating the failure:
  * - KvIrSearchErrorEnum::ClpLegacyError if a `clp::TraceableException` is caught.
  * - KvIrSearchErrorEnum::CountSupportNotImplemented if count-related features are enabled.
@@ -41,7 +44,8 @@ using KvIrSearchError = ystdlib::error_handling::ErrorCode<KvIrSearchErrorEnum>;
         Path const& stream_path,
         CommandLineArguments const& command_line_arguments,
         std::shared_ptr<search::ast::Expression> query,
-        int reducer_socket_fd
+        int reducer_socket_fd,
+        std::mutex* output_mutex = nullptr
 ) -> ystdlib::error_handling::Result<void>;
 }  // namespace clp_s
 
@@ -0,0 +1,154 @@
+#include "EvaluateDictionarySummary.hpp"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../../clp/Defs.h"
+#include "../../clp/EncodedVariableInterpreter.hpp"
+#include "../DictionaryEntry.hpp"
+#include "ast/AndExpr.hpp"
+#include "ast/Expression.hpp"
+#include "ast/FilterExpr.hpp"
+#include "ast/FilterOperation.hpp"
+#include "ast/Literal.hpp"
+#include "ast/OrExpr.hpp"
+#include "ast/SearchUtils.hpp"
+
+using clp_s::search::ast::AndExpr;
+using clp_s::search::ast::Expression;
+using clp_s::search::ast::FilterExpr;
+using clp_s::search::ast::FilterOperation;
+using clp_s::search::ast::literal_type_bitmask_t;
+using clp_s::search::ast::LiteralType;
+using clp_s::search::ast::OrExpr;
+
+namespace clp_s::search {
+namespace {
+constexpr literal_type_bitmask_t cDictionaryStringTypes
+        = LiteralType::ClpStringT | LiteralType::VarStringT;
+
+/**
+ * Variable dictionary stand-in that records the dictionary variables of an encoded string instead
+ * of adding them to a dictionary.
+ */
+class DictionaryVariableCollector {
+public:
+    void add_entry(std::string_view value, clp::variable_dictionary_id_t& id) {
+        m_values.emplace_back(value);
+        id = 0;
+    }
+
+    std::vector<std::string> const& get_values() const { return m_values; }
+
+private:
+    std::vector<std::string> m_values;
+};
+
+/**
+ * Removes the escape characters from a search string without wildcards
+ * @param value
+ * @return The unescaped string
+ */
+auto unescape(std::string_view value) -> std::string;
+
+auto unescape(std::string_view value) -> std::string {
+    std::string unescaped;
+    unescaped.reserve(value.size());
+    bool escape{false};
+    for (char const c : value) {
+        if (escape) {
+            unescaped.push_back(c);
+            escape = false;
+        } else if ('\\' == c) {
+            escape = true;
+        } else {
+            unescaped.push_back(c);
+        }
+    }
+    return unescaped;
+}
+}  // namespace
+
+EvaluatedValue EvaluateDictionarySummary::run(std::shared_ptr<Expression> const& expr) {
+    // Inverted expressions can only be proven false by proving their operands true, which the
+    // summary can't do
+    if (expr->is_inverted()) {
+        return EvaluatedValue::Unknown;
+    }
+
+    if (std::dynamic_pointer_cast<OrExpr>(expr)) {
+        for (auto it = expr->op_begin(); it != expr->op_end(); it++) {
+            auto sub_expr = std::static_pointer_cast<Expression>(*it);
+            if (EvaluatedValue::False != run(sub_expr)) {
+                return EvaluatedValue::Unknown;
+            }
+        }
+        return EvaluatedValue::False;
+    } else if (std::dynamic_pointer_cast<AndExpr>(expr)) {
+        for (auto it = expr->op_begin(); it != expr->op_end(); it++) {
+            auto sub_expr = std::static_pointer_cast<Expression>(*it);
+            if (EvaluatedValue::False == run(sub_expr)) {
+                return EvaluatedValue::False;
+            }
+        }
+        return EvaluatedValue::Unknown;
+    } else if (auto filter = std::dynamic_pointer_cast<FilterExpr>(expr)) {
+        auto column = filter->get_column();
+        auto const op = filter->get_operation();
+        // The summary is case-sensitive, and other types of columns may contain the value
+        if (m_ignore_case || FilterOperation::EQ != op
+            || column->matches_any(~cDictionaryStringTypes))
+        {
+            return EvaluatedValue::Unknown;
+        }
+
+        std::string value;
+        if (column->matches_type(LiteralType::ClpStringT)
+            && (false == filter->get_operand()->as_clp_string(value, op)
+                || ast::has_unescaped_wildcards(value) || may_contain_clp_string(unescape(value))))
+        {
+            return EvaluatedValue::Unknown;
+        }
+        if (column->matches_type(LiteralType::VarStringT)
+            && (false == filter->get_operand()->as_var_string(value, op)
+                || ast::has_unescaped_wildcards(value) || may_contain_var_string(unescape(value))))
+        {
+            return EvaluatedValue::Unknown;
+        }
+        return column->matches_any(cDictionaryStringTypes) ? EvaluatedValue::False
+                                                           : EvaluatedValue::Unknown;
+    }
+    return EvaluatedValue::Unknown;
+}
+
+bool EvaluateDictionarySummary::may_contain_var_string(std::string_view value) const {
+    return m_dictionary_summary.variable_values.possibly_contains(value);
+}
+
+bool EvaluateDictionarySummary::may_contain_clp_string(std::string_view value) const {
+    // Encode the value the same way it would have been encoded during compression
+    LogTypeDictionaryEntry logtype_entry;
+    DictionaryVariableCollector dictionary_variables;
+    std::vector<clp::encoded_variable_t> encoded_vars;
+    std::vector<clp::variable_dictionary_id_t> var_ids;
+    clp::EncodedVariableInterpreter::encode_and_add_to_dictionary(
+            value,
+            logtype_entry,
+            dictionary_variables,
+            encoded_vars,
+            var_ids
+    );
+
+    if (false == m_dictionary_summary.logtype_values.possibly_contains(logtype_entry.get_value())) {
+        return false;
+    }
+    for (auto const& dictionary_variable : dictionary_variables.get_values()) {
+        if (false == may_contain_var_string(dictionary_variable)) {
+            return false;
+        }
+    }
+    return true;
+}
+}  // namespace clp_s::search
@@ -0,0 +1,56 @@
+#ifndef CLP_S_SEARCH_EVALUATEDICTIONARYSUMMARY_HPP
+#define CLP_S_SEARCH_EVALUATEDICTIONARYSUMMARY_HPP
+
+#include <memory>
+#include <string_view>
+
+#include "../ArchiveReaderAdaptor.hpp"
+#include "../Utils.hpp"
+#include "ast/Expression.hpp"
+
+namespace clp_s::search {
+/**
+ * Class that evaluates an expression against an archive's dictionary summary, so that an archive
+ * that can't contain the strings searched for by exact-match string filters is skipped before its
+ * dictionaries are read.
+ */
+class EvaluateDictionarySummary {
+public:
+    // Constructors
+    EvaluateDictionarySummary(DictionarySummary const& dictionary_summary, bool ignore_case)
+            : m_dictionary_summary(dictionary_summary),
+              m_ignore_case(ignore_case) {}
+
+    /**
+     * Takes an expression and attempts to prove that it can't match any message in the archive
+     * based on the dictionary summary. Only exact-match string filters are evaluated, and only
+     * non-inverted expressions are considered, so the expression is never proven to be true.
+     *
+     * Should only be run after type narrowing.
+     *
+     * @param expr the expression to evaluate against the dictionary summary
+     * @return EvaluatedValue::False if the expression can't match any message in the archive,
+     * EvaluatedValue::Unknown otherwise
+     */
+    EvaluatedValue run(std::shared_ptr<ast::Expression> const& expr);
+
+private:
+    /**
+     * @param value
+     * @return Whether the variable dictionary may contain the given value
+     */
+    bool may_contain_var_string(std::string_view value) const;
+
+    /**
+     * @param value
+     * @return Whether the logtype and variable dictionaries may contain the logtype and dictionary
+     * variables that the given value would be encoded as
+     */
+    bool may_contain_clp_string(std::string_view value) const;
+
+    DictionarySummary const& m_dictionary_summary;
+    bool m_ignore_case;
+};
+}  // namespace clp_s::search
+
+#endif  // CLP_S_SEARCH_EVALUATEDICTIONARYSUMMARY_HPP
@@ -1,11 +1,25 @@
 #include "Output.hpp"
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include <spdlog/spdlog.h>
 
 #include "../../clp/type_utils.hpp"
+#include "../PackedStreamReader.hpp"
+#include "../SchemaReader.hpp"
 #include "../SchemaTree.hpp"
 #include "../Utils.hpp"
 #include "ast/AndExpr.hpp"
@@ -15,6 +29,7 @@
 #include "ast/FilterOperation.hpp"
 #include "ast/Literal.hpp"
 #include "ast/OrExpr.hpp"
+#include "EvaluateDictionarySummary.hpp"
 #include "EvaluateTimestampIndex.hpp"
 
 using clp_s::search::ast::AndExpr;
@@ -32,11 +47,72 @@ using clp_s::search::ast::OrExpr;
 #define eval(op, a, b) (((op) == FilterOperation::EQ) ? ((a) == (b)) : ((a) != (b)))
 
 namespace clp_s::search {
+namespace {
+/**
+ * Filter that accepts every message without requiring any column. It holds no state, so one
+ * instance can be shared by every thread.
+ */
+class AcceptAllFilter : public FilterClass {
+public:
+    // Methods inherited from FilterClass
+    void
+    init(SchemaReader* reader, std::vector<BaseColumnReader*> const& column_readers) override {}
+
+    auto filter(uint64_t cur_message) -> bool override { return true; }
+
+    void filter_batch(uint64_t begin_message, size_t num_messages, Selection& selection) override {
+        selection.fill(0);
+        size_t const num_full_words{num_messages / cBitsPerSelectionWord};
+        std::fill_n(selection.begin(), num_full_words, ~0ULL);
+        if (size_t const num_remaining{num_messages % cBitsPerSelectionWord}; num_remaining > 0) {
+            selection[num_full_words] = (1ULL << num_remaining) - 1;
+        }
+    }
+
+    auto requires_column(int32_t column_id) -> bool override { return false; }
+};
+
+/**
+ * @param metadata
+ * @return The latest timestamp reported for the table's messages, or `cEpochTimeMax` if the
+ * archive doesn't record it
+ */
+auto get_max_timestamp(SchemaReader::SchemaMetadata const& metadata) -> epochtime_t {
+    if (metadata.timestamp_range.has_value()) {
+        return metadata.timestamp_range->second;
+    }
+    return cEpochTimeMax;
+}
+}  // namespace
+
 bool Output::filter() {
     std::vector<int32_t> matched_schemas;
     bool has_array = false;
     bool has_array_search = false;
 
+    // Skip the archive before reading any of its tables or dictionaries if it can't contain a
+    // string that the query requires
+    if (auto const& dictionary_summary = m_archive_reader->get_dictionary_summary();
+        dictionary_summary.has_value())
+    {
+        EvaluateDictionarySummary summary_pass{dictionary_summary.value(), m_ignore_case};
+        if (EvaluatedValue::False == summary_pass.run(m_expr)) {
+            return true;
+        }
+    }
+
+    // Skip the archive before reading any of its tables if it can't contain any of the latest
+    // results found in other archives
+    if (auto const* top_k_timestamps = m_output_handler->get_top_k_timestamps();
+        nullptr != top_k_timestamps)
+    {
+        auto const max_timestamp
+                = m_archive_reader->get_timestamp_dictionary()->get_max_reported_timestamp();
+        if (false == top_k_timestamps->can_contain_latest(max_timestamp)) {
+            return true;
+        }
+    }
+
     m_archive_reader->read_metadata();
     for (auto schema_id : m_archive_reader->get_schema_ids()) {
         if (m_match->schema_matched(schema_id)) {
@@ -65,6 +141,15 @@ bool Output::filter() {
         return true;
     }
 
+    // Skip decompressing the rest of the archive if none of the matched tables can contain any of
+    // the latest results
+    if (std::ranges::none_of(matched_schemas, [&](int32_t schema_id) {
+            return can_contain_latest_results(schema_id);
+        }))
+    {
+        return true;
+    }
+
     m_archive_reader->read_variable_dictionary();
     m_archive_reader->read_log_type_dictionary();
 
@@ -79,28 +164,116 @@ bool Output::filter() {
     m_query_runner.global_init();
     m_archive_reader->open_packed_streams();
 
+    bool const succeeded = m_num_threads > 1 ? filter_tables_concurrently(matched_schemas)
+                                             : filter_tables(matched_schemas);
+    if (false == succeeded) {
+        return false;
+    }
+    auto ecode = m_output_handler->finish();
+    if (ErrorCode::ErrorCodeSuccess != ecode) {
+        SPDLOG_ERROR(
+                "Failed to flush output handler, error={}.",
+                clp::enum_to_underlying_type(ecode)
+        );
+        return false;
+    }
+    return true;
+}
+
+auto Output::filter_tables(std::vector<int32_t> const& matched_schemas) -> bool {
     std::string message;
     auto const archive_id = m_archive_reader->get_archive_id();
-    for (int32_t schema_id : matched_schemas) {
-        if (EvaluatedValue::False == m_query_runner.schema_init(schema_id)) {
+    auto const aggregation = m_output_handler->get_pushdown_aggregation();
+    auto const* top_k_timestamps = m_output_handler->get_top_k_timestamps();
+
+    std::vector<int32_t> schemas_to_search{matched_schemas};
+    // The value of the query for each table in `schemas_to_search`, if it was evaluated before the
+    // tables are searched
+    std::vector<EvaluatedValue> table_values;
+    if (nullptr != top_k_timestamps) {
+        // Search the tables with the latest timestamps first, so that the remaining tables can be
+        // skipped as soon as enough later results have been found. Since the tables are then no
+        // longer searched in stream order, their streams aren't prefetched.
+        std::ranges::stable_sort(schemas_to_search, std::greater{}, [&](int32_t schema_id) {
+            return get_max_timestamp(m_archive_reader->get_schema_metadata(schema_id));
+        });
+    } else {
+        // Read ahead and decompress the streams of the tables that will be searched in the
+        // background, so that reading and decompressing upcoming tables overlaps with filtering
+        // the current one.
+        std::vector<size_t> stream_ids;
+        table_values.reserve(schemas_to_search.size());
+        for (int32_t schema_id : schemas_to_search) {
+            auto const table_value = m_query_runner.schema_init(schema_id);
+            table_values.push_back(table_value);
+            if (EvaluatedValue::False == table_value
+                || is_counted_from_metadata(aggregation, table_value))
+            {
+                continue;
+            }
+            auto const table_stream_ids = m_archive_reader->get_schema_table_stream_ids(
+                    schema_id,
+                    m_output_handler->should_output_metadata(),
+                    m_should_marshal_records,
+                    get_table_filter(aggregation, table_value, m_query_runner)
+            );
+            for (auto const stream_id : table_stream_ids) {
+                // Small tables share a stream, so consecutive tables may have the same stream.
+                if (stream_ids.empty() || stream_ids.back() < stream_id) {
+                    stream_ids.push_back(stream_id);
+                }
+            }
+        }
+        m_archive_reader->prefetch_streams(std::move(stream_ids));
+    }
+
+    for (size_t i{0}; i < schemas_to_search.size(); ++i) {
+        auto const schema_id = schemas_to_search[i];
+        if (false == can_contain_latest_results(schema_id)) {
+            // The remaining tables have no later timestamps
+            break;
+        }
+
+        auto const table_value = table_values.empty() ? m_query_runner.schema_init(schema_id)
+                                                      : table_values[i];
+        if (EvaluatedValue::False == table_value) {
+            continue;
+        }
+        if (is_counted_from_metadata(aggregation, table_value)) {
+            auto const& metadata = m_archive_reader->get_schema_metadata(schema_id);
+            m_output_handler->add_count(metadata.num_messages);
             continue;
         }
+        if (false == table_values.empty()) {
+            // The query runner only holds the state of the last table it was initialized for, so
+            // it has to be initialized again for each table that's searched.
+            m_query_runner.schema_init(schema_id);
+        }
 
+        auto* filter = get_table_filter(aggregation, table_value, m_query_runner);
         auto& reader = m_archive_reader->read_schema_table(
                 schema_id,
                 m_output_handler->should_output_metadata(),
-                m_should_marshal_records
+                m_should_marshal_records,
+                filter
         );
-        reader.initialize_filter(&m_query_runner);
+        reader.initialize_filter(filter);
 
-        if (m_output_handler->should_output_metadata()) {
+        if (OutputHandler::PushdownAggregation::Count == aggregation) {
+            m_output_handler->add_count(reader.count_filtered_messages(filter));
+        } else if (OutputHandler::PushdownAggregation::CountByTime == aggregation) {
+            reader.for_each_filtered_timestamp(filter, [&](epochtime_t timestamp) {
+                m_output_handler->add_count_by_time(timestamp, 1);
+            });
+        } else if (m_output_handler->should_output_metadata()) {
             epochtime_t timestamp{};
             int64_t log_event_idx{};
             while (reader.get_next_message_with_metadata(
                     message,
                     timestamp,
                     log_event_idx,
-                    &m_query_runner
+                    &m_query_runner,
+                    top_k_timestamps
             ))
             {
                 m_output_handler->write(message, timestamp, archive_id, log_event_idx);
@@ -119,13 +292,341 @@ bool Output::filter() {
             return false;
         }
     }
-    auto ecode = m_output_handler->finish();
-    if (ErrorCode::ErrorCodeSuccess != ecode) {
-        SPDLOG_ERROR(
-                "Failed to flush output handler, error={}.",
-                clp::enum_to_underlying_type(ecode)
+    return true;
+}
+
+auto Output::filter_tables_concurrently(std::vector<int32_t> const& matched_schemas) -> bool {
+    // Limit the number of groups that have been read but not yet written so that memory use stays
+    // bounded while keeping every worker busy.
+    size_t const max_num_in_flight_groups{2 * m_num_threads};
+    bool const should_output_metadata = m_output_handler->should_output_metadata();
+    bool const should_preserve_table_order = m_output_handler->should_preserve_table_order();
+    auto const aggregation = m_output_handler->get_pushdown_aggregation();
+    // Only read by the workers, which is thread-safe
+    auto const* top_k_timestamps = m_output_handler->get_top_k_timestamps();
+    auto const archive_id = m_archive_reader->get_archive_id();
+
+    std::vector<std::unique_ptr<QueryRunner>> query_runners;
+    query_runners.reserve(m_num_threads);
+    for (size_t i{0}; i < m_num_threads; ++i) {
+        query_runners.emplace_back(
+                std::make_unique<QueryRunner>(m_match, m_expr, m_archive_reader, m_ignore_case)
         );
-        return false;
+    }
+
+    std::mutex mutex;
+    std::condition_variable group_available;
+    std::condition_variable group_done;
+    std::deque<TableGroup*> pending_groups;
+    bool is_stopping{false};
+    std::deque<std::unique_ptr<TableGroup>> in_flight_groups;
+    std::vector<std::thread> workers;
+
+    auto run_worker = [&](QueryRunner& query_runner) {
+        bool is_query_runner_initialized{false};
+        while (true) {
+            TableGroup* group{nullptr};
+            {
+                std::unique_lock lock{mutex};
+                group_available.wait(lock, [&]() {
+                    return is_stopping || false == pending_groups.empty();
+                });
+                if (pending_groups.empty()) {
+                    return;
+                }
+                group = pending_groups.front();
+                pending_groups.pop_front();
+            }
+
+            try {
+                if (false == is_query_runner_initialized) {
+                    query_runner.global_init();
+                    is_query_runner_initialized = true;
+                }
+                search_table_group(
+                        query_runner,
+                        *group,
+                        should_output_metadata,
+                        aggregation,
+                        top_k_timestamps
+                );
+            } catch (...) {
+                group->exception = std::current_exception();
+            }
+
+            {
+                std::lock_guard const lock{mutex};
+                group->is_done = true;
+            }
+            group_done.notify_all();
+        }
+    };
+
+    auto stop_workers = [&]() {
+        {
+            std::lock_guard const lock{mutex};
+            is_stopping = true;
+            pending_groups.clear();
+        }
+        group_available.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+    };
+
+    // Waits for a group to finish (the oldest one if table order must be preserved) and writes its
+    // results.
+    auto write_next_finished_group = [&]() -> bool {
+        std::unique_ptr<TableGroup> group;
+        {
+            std::unique_lock lock{mutex};
+            auto it = in_flight_groups.begin();
+            group_done.wait(lock, [&]() {
+                if (should_preserve_table_order) {
+                    it = in_flight_groups.begin();
+                    return (*it)->is_done;
+                }
+                it = std::ranges::find_if(in_flight_groups, [](auto const& in_flight_group) {
+                    return in_flight_group->is_done;
+                });
+                return in_flight_groups.end() != it;
+            });
+            group = std::move(*it);
+            in_flight_groups.erase(it);
+        }
+        if (nullptr != group->exception) {
+            std::rethrow_exception(group->exception);
+        }
+        return write_results(*group, archive_id);
+    };
+
+    bool succeeded{true};
+    try {
+        for (auto& query_runner : query_runners) {
+            workers.emplace_back(run_worker, std::ref(*query_runner));
+        }
+
+        size_t next_schema_idx{0};
+        while (auto group = read_next_table_group(matched_schemas, next_schema_idx)) {
+            {
+                std::lock_guard const lock{mutex};
+                pending_groups.push_back(group.get());
+                in_flight_groups.push_back(std::move(group));
+            }
+            group_available.notify_one();
+
+            if (in_flight_groups.size() >= max_num_in_flight_groups
+                && false == write_next_finished_group())
+            {
+                succeeded = false;
+                break;
+            }
+        }
+
+        while (succeeded && false == in_flight_groups.empty()) {
+            succeeded = write_next_finished_group();
+        }
+    } catch (...) {
+        stop_workers();
+        throw;
+    }
+    stop_workers();
+    return succeeded;
+}
+
+auto Output::read_next_table_group(std::vector<int32_t> const& matched_schemas, size_t& schema_idx)
+        -> std::unique_ptr<TableGroup> {
+    auto const aggregation = m_output_handler->get_pushdown_aggregation();
+    std::unique_ptr<TableGroup> group;
+    for (; schema_idx < matched_schemas.size(); ++schema_idx) {
+        auto const schema_id = matched_schemas[schema_idx];
+        auto const& metadata = m_archive_reader->get_schema_metadata(schema_id);
+        bool const is_stored_as_separate_columns = 0 != metadata.num_column_streams;
+        if (nullptr != group
+            && (is_stored_as_separate_columns || 0 != group->metadata.front().num_column_streams
+                || metadata.stream_id != group->metadata.front().stream_id))
+        {
+            break;
+        }
+
+        if (false == can_contain_latest_results(schema_id)) {
+            continue;
+        }
+        auto const table_value = m_query_runner.schema_init(schema_id);
+        if (EvaluatedValue::False == table_value) {
+            continue;
+        }
+        if (is_counted_from_metadata(aggregation, table_value)) {
+            m_output_handler->add_count(metadata.num_messages);
+            continue;
+        }
+
+        if (nullptr == group) {
+            group = std::make_unique<TableGroup>();
+        }
+        auto reader = m_archive_reader->create_schema_reader(
+                schema_id,
+                m_output_handler->should_output_metadata(),
+                m_should_marshal_records
+        );
+        if (is_stored_as_separate_columns) {
+            // Only the columns needed to filter and marshal the records are read
+            auto* filter = get_table_filter(aggregation, table_value, m_query_runner);
+            for (size_t column_idx{0}; column_idx < metadata.num_column_streams; ++column_idx) {
+                if (false == reader->is_column_required(column_idx, filter)) {
+                    continue;
+                }
+                auto const stream_id = metadata.stream_id + column_idx;
+                auto& stream = group->compressed_streams.emplace_back();
+                stream.data = m_archive_reader->read_compressed_stream(stream_id, stream.buffer);
+                stream.uncompressed_size
+                        = m_archive_reader->get_uncompressed_stream_size(stream_id);
+                stream.column_idx = column_idx;
+            }
+        } else if (group->compressed_streams.empty()) {
+            auto& stream = group->compressed_streams.emplace_back();
+            stream.data
+                    = m_archive_reader->read_compressed_stream(metadata.stream_id, stream.buffer);
+            stream.uncompressed_size
+                    = m_archive_reader->get_uncompressed_stream_size(metadata.stream_id);
+        }
+        group->readers.emplace_back(std::move(reader));
+        group->metadata.emplace_back(metadata);
+    }
+
+    if (nullptr != group) {
+        group->results.resize(group->readers.size());
+        group->result_counts.resize(group->readers.size());
+    }
+    return group;
+}
+
+void Output::search_table_group(
+        QueryRunner& query_runner,
+        TableGroup& group,
+        bool should_output_metadata,
+        OutputHandler::PushdownAggregation aggregation,
+        TopKTimestamps const* top_k_timestamps
+) {
+    std::shared_ptr<char[]> packed_stream;
+    std::string message;
+    for (size_t i{0}; i < group.readers.size(); ++i) {
+        auto& reader = *group.readers[i];
+        auto const& metadata = group.metadata[i];
+        auto& results = group.results[i];
+
+        // The table was only added to the group if this can't evaluate to false
+        auto const table_value = query_runner.schema_init(reader.get_schema_id());
+        if (0 != metadata.num_column_streams) {
+            if (reader.get_column_size() != metadata.num_column_streams) {
+                throw SchemaReader::OperationFailed(ErrorCodeCorrupt, __FILENAME__, __LINE__);
+            }
+            for (auto const& stream : group.compressed_streams) {
+                reader.load_column(
+                        stream.column_idx,
+                        PackedStreamReader::decompress_stream(
+                                stream.data,
+                                stream.uncompressed_size
+                        ),
+                        stream.uncompressed_size
+                );
+            }
+        } else {
+            if (nullptr == packed_stream) {
+                auto const& stream = group.compressed_streams.front();
+                packed_stream = PackedStreamReader::decompress_stream(
+                        stream.data,
+                        stream.uncompressed_size
+                );
+            }
+            reader.load(packed_stream, metadata.stream_offset, metadata.uncompressed_size);
+        }
+        auto* filter = get_table_filter(aggregation, table_value, query_runner);
+        reader.initialize_filter(filter);
+
+        if (OutputHandler::PushdownAggregation::Count == aggregation) {
+            group.result_counts[i] = reader.count_filtered_messages(filter);
+        } else if (OutputHandler::PushdownAggregation::CountByTime == aggregation) {
+            reader.for_each_filtered_timestamp(filter, [&](epochtime_t timestamp) {
+                results.push_back({{}, timestamp});
+            });
+        } else if (should_output_metadata) {
+            epochtime_t timestamp{};
+            int64_t log_event_idx{};
+            while (reader.get_next_message_with_metadata(
+                    message,
+                    timestamp,
+                    log_event_idx,
+                    &query_runner,
+                    top_k_timestamps
+            ))
+            {
+                results.push_back({message, timestamp, log_event_idx});
+            }
+        } else {
+            while (reader.get_next_message(message, &query_runner)) {
+                results.push_back({message});
+            }
+        }
+
+        // Release the decompressed table as soon as it has been searched
+        group.readers[i].reset();
+    }
+    group.compressed_streams.clear();
+}
+
+auto Output::can_contain_latest_results(int32_t schema_id) const -> bool {
+    auto const* top_k_timestamps = m_output_handler->get_top_k_timestamps();
+    return nullptr == top_k_timestamps
+           || top_k_timestamps->can_contain_latest(
+                   get_max_timestamp(m_archive_reader->get_schema_metadata(schema_id))
+           );
+}
+
+auto Output::get_table_filter(
+        OutputHandler::PushdownAggregation aggregation,
+        EvaluatedValue table_value,
+        QueryRunner& query_runner
+) -> FilterClass* {
+    static AcceptAllFilter accept_all_filter;
+    if (OutputHandler::PushdownAggregation::None != aggregation
+        && EvaluatedValue::True == table_value)
+    {
+        return &accept_all_filter;
+    }
+    return &query_runner;
+}
+
+auto Output::write_results(TableGroup const& group, std::string_view archive_id) -> bool {
+    bool const should_output_metadata = m_output_handler->should_output_metadata();
+    auto const aggregation = m_output_handler->get_pushdown_aggregation();
+    for (size_t i{0}; i < group.results.size(); ++i) {
+        if (OutputHandler::PushdownAggregation::Count == aggregation) {
+            m_output_handler->add_count(group.result_counts[i]);
+        }
+        for (auto const& result : group.results[i]) {
+            if (OutputHandler::PushdownAggregation::CountByTime == aggregation) {
+                m_output_handler->add_count_by_time(result.timestamp, 1);
+            } else if (should_output_metadata) {
+                m_output_handler->write(
+                        result.message,
+                        result.timestamp,
+                        archive_id,
+                        result.log_event_idx
+                );
+            } else {
+                m_output_handler->write(result.message);
+            }
+        }
+        auto ecode = m_output_handler->flush();
+        if (ErrorCode::ErrorCodeSuccess != ecode) {
+            SPDLOG_ERROR(
+                    "Failed to flush output handler, error={}.",
+                    clp::enum_to_underlying_type(ecode)
+            );
+            return false;
+        }
     }
     return true;
 }
@@ -1,13 +1,20 @@
 #ifndef CLP_S_SEARCH_OUTPUT_HPP
 #define CLP_S_SEARCH_OUTPUT_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <map>
+#include <memory>
 #include <set>
+#include <span>
 #include <stack>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "../ArchiveReader.hpp"
 #include "../SchemaReader.hpp"
@@ -17,12 +24,25 @@
 #include "OutputHandler.hpp"
 #include "QueryRunner.hpp"
 #include "SchemaMatch.hpp"
+#include "TopKTimestamps.hpp"
 
 namespace clp_s::search {
 /**
  * This class orchestrates the process of searching through a CLP archive,
  * filtering log messages according to a specified query, and then outputting the
  * matching messages using a provided `OutputHandler`.
+ *
+ * When more than one thread is requested, the tables in the archive are decompressed and filtered
+ * concurrently by a pool of workers, each with its own `QueryRunner`. The calling thread reads the
+ * compressed tables from the archive and writes the results of each table to the `OutputHandler`.
+ *
+ * When the `OutputHandler` only counts results, the count is pushed down into the search: tables
+ * that fully match the query are counted from their metadata (or, for count-by-time, from their
+ * timestamp column alone), and the matches in other tables are counted without marshalling them.
+ *
+ * When the `OutputHandler` only keeps the latest results, archives, tables, and results whose
+ * timestamps can't be among the latest results found so far are skipped, and tables are searched in
+ * order of their latest timestamp when searching on the calling thread.
  */
 class Output {
 public:
@@ -30,13 +50,16 @@ public:
            std::shared_ptr<ast::Expression> const& expr,
            std::shared_ptr<ArchiveReader> const& archive_reader,
            std::unique_ptr<OutputHandler> output_handler,
-           bool ignore_case)
+           bool ignore_case,
+           size_t num_threads = 1)
             : m_query_runner(match, expr, archive_reader, ignore_case),
               m_archive_reader(archive_reader),
               m_expr(expr),
               m_match(match),
               m_output_handler(std::move(output_handler)),
-              m_should_marshal_records(m_output_handler->should_marshal_records()) {}
+              m_should_marshal_records(m_output_handler->should_marshal_records()),
+              m_ignore_case(ignore_case),
+              m_num_threads(num_threads) {}
 
     /**
      * Filters messages within the archive and outputs the filtered messages to the configured
@@ -47,12 +70,136 @@ public:
     auto filter() -> bool;
 
 private:
+    // Types
+    /**
+     * A search result buffered until it can be written to the output handler.
+     */
+    struct BufferedResult {
+        std::string message;
+        epochtime_t timestamp{};
+        int64_t log_event_idx{};
+    };
+
+    /**
+     * A stream read from the archive without being decompressed.
+     */
+    struct CompressedStream {
+        // Holds the stream unless it's read directly from a memory mapped archive
+        std::vector<char> buffer;
+        std::span<char const> data;
+        size_t uncompressed_size{};
+        // For tables stored as separate columns, the index of the column held by the stream
+        size_t column_idx{};
+    };
+
+    /**
+     * The unit of work when searching tables concurrently: either the matched tables stored in
+     * one packed stream, or a single table stored as separate columns.
+     */
+    struct TableGroup {
+        std::vector<std::unique_ptr<SchemaReader>> readers;
+        std::vector<SchemaReader::SchemaMetadata> metadata;
+        std::vector<CompressedStream> compressed_streams;
+        std::vector<std::vector<BufferedResult>> results;
+        // For count aggregations, the number of results in each table
+        std::vector<uint64_t> result_counts;
+        std::exception_ptr exception;
+        bool is_done{false};
+    };
+
+    // Methods
+    /**
+     * Searches the matched tables one at a time on the calling thread.
+     * @param matched_schemas
+     * @return true if the results of every table were written successfully; false otherwise.
+     */
+    auto filter_tables(std::vector<int32_t> const& matched_schemas) -> bool;
+
+    /**
+     * Searches the matched tables concurrently using `m_num_threads` workers.
+     * @param matched_schemas
+     * @return true if the results of every table were written successfully; false otherwise.
+     */
+    auto filter_tables_concurrently(std::vector<int32_t> const& matched_schemas) -> bool;
+
+    /**
+     * Reads the compressed streams for the next group of matched tables that can't be skipped.
+     * @param matched_schemas
+     * @param schema_idx The index in `matched_schemas` to start from. Returns the index of the
+     * first table that wasn't considered.
+     * @return The group of tables, or nullptr if there are no more tables to search
+     */
+    auto read_next_table_group(std::vector<int32_t> const& matched_schemas, size_t& schema_idx)
+            -> std::unique_ptr<TableGroup>;
+
+    /**
+     * Decompresses and filters a group of tables, buffering the results in the group.
+     * @param query_runner A query runner owned by the calling thread
+     * @param group
+     * @param should_output_metadata
+     * @param aggregation
+     * @param top_k_timestamps The latest timestamps tracked by the output handler, if any
+     */
+    static void search_table_group(
+            QueryRunner& query_runner,
+            TableGroup& group,
+            bool should_output_metadata,
+            OutputHandler::PushdownAggregation aggregation,
+            TopKTimestamps const* top_k_timestamps
+    );
+
+    /**
+     * @param schema_id
+     * @return Whether the table can contain any of the latest results, when the output handler
+     * only keeps the latest results, or true otherwise
+     */
+    [[nodiscard]] auto can_contain_latest_results(int32_t schema_id) const -> bool;
+
+    /**
+     * @param aggregation
+     * @param table_value The value of the query after constant propagation for a table
+     * @return Whether the table's results can be counted from its metadata alone
+     */
+    [[nodiscard]] static auto is_counted_from_metadata(
+            OutputHandler::PushdownAggregation aggregation,
+            EvaluatedValue table_value
+    ) -> bool {
+        return OutputHandler::PushdownAggregation::Count == aggregation
+               && EvaluatedValue::True == table_value;
+    }
+
+    /**
+     * Gets the filter to search a table with. When aggregating over a table whose query is always
+     * true, the returned filter accepts every message without requiring any column.
+     * @param aggregation
+     * @param table_value The value of the query after constant propagation for the table
+     * @param query_runner
+     * @return The filter
+     */
+    [[nodiscard]] static auto get_table_filter(
+            OutputHandler::PushdownAggregation aggregation,
+            EvaluatedValue table_value,
+            QueryRunner& query_runner
+    ) -> FilterClass*;
+
+    /**
+     * Writes the buffered results of a group of tables to the output handler, flushing the output
+     * handler after each table.
+     * @param group
+     * @param archive_id
+     * @return true if the output handler was flushed successfully; false otherwise.
+     */
+    auto write_results(TableGroup const& group, std::string_view archive_id) -> bool;
+
+    // Variables
     QueryRunner m_query_runner;
     std::shared_ptr<ArchiveReader> m_archive_reader;
     std::shared_ptr<ast::Expression> m_expr;
     std::shared_ptr<SchemaMatch> m_match;
     std::unique_ptr<OutputHandler> m_output_handler;
     bool m_should_marshal_records{true};
+    bool m_ignore_case{false};
+    size_t m_num_threads{1};
 };
 }  // namespace clp_s::search
 
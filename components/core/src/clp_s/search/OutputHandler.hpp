@@ -1,11 +1,13 @@
 #ifndef CLP_S_SEARCH_OUTPUTHANDLER_HPP
 #define CLP_S_SEARCH_OUTPUTHANDLER_HPP
 
+#include <cstdint>
 #include <string_view>
 #include <vector>
 
 #include "../Defs.hpp"
 #include "../ErrorCode.hpp"
+#include "TopKTimestamps.hpp"
 
 namespace clp_s::search {
 /**
@@ -13,6 +15,18 @@ namespace clp_s::search {
  */
 class OutputHandler {
 public:
+    // Types
+    /**
+     * Aggregations that an output handler can compute from the number of results (and their
+     * timestamps) alone. Searches push these aggregations down into the tables being searched,
+     * counting the results rather than writing each of them.
+     */
+    enum class PushdownAggregation : uint8_t {
+        None,
+        Count,
+        CountByTime
+    };
+
     // Constructors
     explicit OutputHandler(bool should_output_metadata, bool should_marshal_records)
             : m_should_output_metadata(should_output_metadata),
@@ -42,6 +56,22 @@ public:
      */
     virtual void write(std::string_view message) = 0;
 
+    /**
+     * Adds a number of results to a count aggregation. Only called if `get_pushdown_aggregation`
+     * returns `PushdownAggregation::Count`, in which case it replaces calls to `write`.
+     * @param count
+     */
+    virtual void add_count(uint64_t count) {}
+
+    /**
+     * Adds a number of results with the given timestamp to a count-by-time aggregation. Only
+     * called if `get_pushdown_aggregation` returns `PushdownAggregation::CountByTime`, in which
+     * case it replaces calls to `write`.
+     * @param timestamp
+     * @param count
+     */
+    virtual void add_count_by_time(epochtime_t timestamp, uint64_t count) {}
+
     /**
      * Flushes the output handler after each table that gets searched.
      * @return ErrorCodeSuccess on success or relevant error code on error
@@ -54,6 +84,32 @@ public:
      */
     [[nodiscard]] virtual auto finish() -> ErrorCode { return ErrorCode::ErrorCodeSuccess; }
 
+    /**
+     * When tables are searched concurrently, the results of each table are always written
+     * together. This method controls whether the tables are also written in the order they would
+     * be searched sequentially, or in whatever order they finish being searched.
+     * @return Whether tables should be written in the order they appear in the archive
+     */
+    [[nodiscard]] virtual auto should_preserve_table_order() const -> bool { return true; }
+
+    /**
+     * @return The aggregation that searches should push down into the tables being searched
+     */
+    [[nodiscard]] virtual auto get_pushdown_aggregation() const -> PushdownAggregation {
+        return PushdownAggregation::None;
+    }
+
+    /**
+     * For output handlers that only keep the K results with the latest timestamps, searches use
+     * the K latest timestamps kept so far to search the tables most likely to contain the latest
+     * results first, and to skip any table or result that can't be among them.
+     * @return The K latest timestamps kept so far, or nullptr if the output handler keeps results
+     * regardless of their timestamp
+     */
+    [[nodiscard]] virtual auto get_top_k_timestamps() const -> TopKTimestamps const* {
+        return nullptr;
+    }
+
     [[nodiscard]] auto should_output_metadata() const -> bool { return m_should_output_metadata; }
 
     [[nodiscard]] auto should_marshal_records() const -> bool { return m_should_marshal_records; }
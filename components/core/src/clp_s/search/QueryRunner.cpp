@@ -1,6 +1,13 @@
 #include "QueryRunner.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <unordered_set>
+#include <utility>
+#include <variant>
 #include <vector>
 
 #include <log_surgeon/Lexer.hpp>
@@ -36,6 +43,169 @@ using clp_s::search::ast::OrExpr;
 #define eval(op, a, b) (((op) == FilterOperation::EQ) ? ((a) == (b)) : ((a) != (b)))
 
 namespace clp_s::search {
+namespace {
+using Selection = FilterClass::Selection;
+
+constexpr size_t cBitsPerWord{FilterClass::cBitsPerSelectionWord};
+
+/**
+ * @param num_messages
+ * @return A selection containing the first `num_messages` messages of a batch
+ */
+auto select_first(size_t num_messages) -> Selection;
+
+/**
+ * @param selection
+ * @return Whether no message is selected
+ */
+auto is_empty(Selection const& selection) -> bool;
+
+/**
+ * Adds every message `i` in `[0, num_messages)` for which `predicate(value_at(i))` is true to
+ * `result`. The messages are evaluated a word of the selection at a time without branching so that
+ * the compiler can vectorize the loop when `value_at` reads directly from a column.
+ * @param num_messages
+ * @param value_at
+ * @param predicate
+ * @param result
+ */
+template <typename ValueAt, typename Predicate>
+void select_matching(size_t num_messages, ValueAt value_at, Predicate predicate, Selection& result);
+
+/**
+ * Adds every message `i` in `[0, num_messages)` for which `value_at(i) op operand` is true to
+ * `result`.
+ * @param op
+ * @param operand
+ * @param num_messages
+ * @param value_at
+ * @param result
+ */
+template <typename T, typename ValueAt>
+void select_comparison_matches(
+        FilterOperation op,
+        T operand,
+        size_t num_messages,
+        ValueAt value_at,
+        Selection& result
+);
+
+/**
+ * Evaluates `value op operand` for every value in `[min_value, max_value]` at once.
+ * @param op
+ * @param min_value
+ * @param max_value
+ * @param operand
+ * @return EvaluatedValue::True if the comparison holds for every value in the range,
+ * EvaluatedValue::False if it holds for none of them, EvaluatedValue::Unknown otherwise
+ */
+template <typename T>
+auto evaluate_range_comparison(FilterOperation op, T min_value, T max_value, T operand)
+        -> EvaluatedValue;
+
+auto select_first(size_t num_messages) -> Selection {
+    Selection selection{};
+    size_t const num_full_words = num_messages / cBitsPerWord;
+    std::fill_n(selection.begin(), num_full_words, ~0ULL);
+    if (size_t const remainder = num_messages % cBitsPerWord; 0 != remainder) {
+        selection[num_full_words] = (1ULL << remainder) - 1;
+    }
+    return selection;
+}
+
+auto is_empty(Selection const& selection) -> bool {
+    return std::ranges::all_of(selection, [](uint64_t word) { return 0 == word; });
+}
+
+template <typename ValueAt, typename Predicate>
+void
+select_matching(size_t num_messages, ValueAt value_at, Predicate predicate, Selection& result) {
+    for (size_t word_begin{0}; word_begin < num_messages; word_begin += cBitsPerWord) {
+        size_t const word_size = std::min(cBitsPerWord, num_messages - word_begin);
+        uint64_t word{0};
+        for (size_t i{0}; i < word_size; ++i) {
+            word |= static_cast<uint64_t>(predicate(value_at(word_begin + i))) << i;
+        }
+        result[word_begin / cBitsPerWord] |= word;
+    }
+}
+
+template <typename T, typename ValueAt>
+void select_comparison_matches(
+        FilterOperation op,
+        T operand,
+        size_t num_messages,
+        ValueAt value_at,
+        Selection& result
+) {
+    switch (op) {
+        case FilterOperation::EQ:
+            select_matching(num_messages, value_at, [=](T v) { return v == operand; }, result);
+            break;
+        case FilterOperation::NEQ:
+            select_matching(num_messages, value_at, [=](T v) { return v != operand; }, result);
+            break;
+        case FilterOperation::LT:
+            select_matching(num_messages, value_at, [=](T v) { return v < operand; }, result);
+            break;
+        case FilterOperation::GT:
+            select_matching(num_messages, value_at, [=](T v) { return v > operand; }, result);
+            break;
+        case FilterOperation::LTE:
+            select_matching(num_messages, value_at, [=](T v) { return v <= operand; }, result);
+            break;
+        case FilterOperation::GTE:
+            select_matching(num_messages, value_at, [=](T v) { return v >= operand; }, result);
+            break;
+        default:
+            break;
+    }
+}
+
+template <typename T>
+auto evaluate_range_comparison(FilterOperation op, T min_value, T max_value, T operand)
+        -> EvaluatedValue {
+    bool always_true{false};
+    bool always_false{false};
+    switch (op) {
+        case FilterOperation::EQ:
+            always_true = min_value == operand && max_value == operand;
+            always_false = operand < min_value || operand > max_value;
+            break;
+        case FilterOperation::NEQ:
+            always_true = operand < min_value || operand > max_value;
+            always_false = min_value == operand && max_value == operand;
+            break;
+        case FilterOperation::LT:
+            always_true = max_value < operand;
+            always_false = min_value >= operand;
+            break;
+        case FilterOperation::LTE:
+            always_true = max_value <= operand;
+            always_false = min_value > operand;
+            break;
+        case FilterOperation::GT:
+            always_true = min_value > operand;
+            always_false = max_value <= operand;
+            break;
+        case FilterOperation::GTE:
+            always_true = min_value >= operand;
+            always_false = max_value < operand;
+            break;
+        default:
+            break;
+    }
+
+    if (always_true) {
+        return EvaluatedValue::True;
+    }
+    if (always_false) {
+        return EvaluatedValue::False;
+    }
+    return EvaluatedValue::Unknown;
+}
+}  // namespace
+
 void QueryRunner::global_init() {
     populate_internal_columns();
     populate_string_queries(m_expr);
@@ -66,12 +236,15 @@ void QueryRunner::clear_readers() {
     m_basic_readers.clear();
 }
 
+auto QueryRunner::requires_column(int32_t column_id) -> bool {
+    return (0
+            != (m_wildcard_type_mask
+                & node_to_literal_type(m_schema_tree->get_node(column_id).get_type())))
+           || m_match->schema_searches_against_column(m_schema, column_id);
+}
+
 void QueryRunner::initialize_reader(int32_t column_id, BaseColumnReader* column_reader) {
-    if ((0
-         != (m_wildcard_type_mask
-             & node_to_literal_type(m_schema_tree->get_node(column_id).get_type())))
-        || m_match->schema_searches_against_column(m_schema, column_id))
-    {
+    if (requires_column(column_id)) {
         auto* clp_reader = dynamic_cast<ClpStringColumnReader*>(column_reader);
         auto* var_reader = dynamic_cast<VariableStringColumnReader*>(column_reader);
         auto* date_reader = dynamic_cast<DateStringColumnReader*>(column_reader);
@@ -120,6 +293,341 @@ bool QueryRunner::filter(uint64_t cur_message) {
     return evaluate(m_expr.get(), m_schema);
 }
 
+void QueryRunner::filter_batch(uint64_t begin_message, size_t num_messages, Selection& selection) {
+    auto const candidates = select_first(num_messages);
+    if (m_expression_value == EvaluatedValue::True) {
+        selection = candidates;
+        return;
+    }
+
+    m_batch_begin = begin_message;
+    m_batch_size = num_messages;
+    m_extracted_unstructured_arrays.clear();
+    evaluate_batch(m_expr.get(), candidates, selection);
+}
+
+void QueryRunner::evaluate_batch(
+        Expression* expr,
+        Selection const& candidates,
+        Selection& result
+) {
+    if (auto* filter_expr = dynamic_cast<FilterExpr*>(expr); nullptr != filter_expr) {
+        evaluate_filter_batch(filter_expr, candidates, result);
+    } else if (dynamic_cast<AndExpr*>(expr)) {
+        // Each operand only needs to be evaluated on the messages accepted by all previous operands
+        result = candidates;
+        Selection operand_result;
+        for (auto const& op : expr->get_op_list()) {
+            if (is_empty(result)) {
+                break;
+            }
+            evaluate_batch(static_cast<Expression*>(op.get()), result, operand_result);
+            result = operand_result;
+        }
+    } else {
+        // Must be an OR-expr. Each operand only needs to be evaluated on the messages rejected by
+        // all previous operands
+        result.fill(0);
+        Selection remaining{candidates};
+        Selection operand_result;
+        for (auto const& op : expr->get_op_list()) {
+            if (is_empty(remaining)) {
+                break;
+            }
+            evaluate_batch(static_cast<Expression*>(op.get()), remaining, operand_result);
+            for (size_t i{0}; i < result.size(); ++i) {
+                result[i] |= operand_result[i];
+                remaining[i] &= ~operand_result[i];
+            }
+        }
+    }
+
+    if (expr->is_inverted()) {
+        for (size_t i{0}; i < result.size(); ++i) {
+            result[i] = candidates[i] & ~result[i];
+        }
+    }
+}
+
+void QueryRunner::evaluate_filter_batch(
+        FilterExpr* expr,
+        Selection const& candidates,
+        Selection& result
+) {
+    bool const is_wildcard_filter = expr->get_column()->is_pure_wildcard();
+    if (false == is_wildcard_filter && evaluate_filter_batch_columnar(expr, result)) {
+        for (size_t i{0}; i < result.size(); ++i) {
+            result[i] &= candidates[i];
+        }
+        return;
+    }
+
+    result.fill(0);
+    for (size_t word_idx{0}; word_idx < candidates.size(); ++word_idx) {
+        for (uint64_t word = candidates[word_idx]; 0 != word; word &= word - 1) {
+            auto const bit = static_cast<size_t>(std::countr_zero(word));
+            uint64_t const cur_message = m_batch_begin + word_idx * cBitsPerWord + bit;
+            if (cur_message != m_cur_message) {
+                m_cur_message = cur_message;
+                m_extracted_unstructured_arrays.clear();
+            }
+            bool const matched = is_wildcard_filter ? evaluate_wildcard_filter(expr, m_schema)
+                                                    : evaluate_filter(expr, m_schema);
+            if (matched) {
+                result[word_idx] |= 1ULL << bit;
+            }
+        }
+    }
+}
+
+auto QueryRunner::evaluate_filter_batch_columnar(FilterExpr* expr, Selection& result) -> bool {
+    auto* column = expr->get_column().get();
+    int32_t column_id = column->get_column_id();
+    auto literal = expr->get_operand();
+    auto const op = expr->get_operation();
+    clp::Query* q = nullptr;
+    switch (column->get_literal_type()) {
+        case LiteralType::IntegerT:
+            evaluate_int_filter_batch(op, column_id, literal, result);
+            return true;
+        case LiteralType::FloatT:
+            evaluate_float_filter_batch(op, column_id, literal, result);
+            return true;
+        case LiteralType::BooleanT:
+            evaluate_bool_filter_batch(op, column_id, literal, result);
+            return true;
+        case LiteralType::VarStringT:
+            evaluate_var_string_filter_batch(
+                    op,
+                    m_var_string_readers[column_id],
+                    m_expr_var_match_map.at(expr),
+                    result
+            );
+            return true;
+        case LiteralType::EpochDateT:
+            evaluate_epoch_date_filter_batch(op, m_datestring_readers[column_id], literal, result);
+            return true;
+        case LiteralType::ClpStringT:
+            // Only the cases that don't depend on the encoded messages are handled here; matching
+            // the encoded messages against the subqueries is done one message at a time.
+            q = m_expr_clp_query.at(expr);
+            if (FilterOperation::EXISTS == op || FilterOperation::NEXISTS == op) {
+                result = select_first(m_batch_size);
+            } else if (FilterOperation::EQ != op && FilterOperation::NEQ != op) {
+                result.fill(0);
+            } else if (nullptr == q) {
+                result = FilterOperation::NEQ == op ? select_first(m_batch_size) : Selection{};
+            } else if (q->search_string_matches_all()) {
+                result = FilterOperation::EQ == op ? select_first(m_batch_size) : Selection{};
+            } else {
+                return false;
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+void QueryRunner::evaluate_int_filter_batch(
+        FilterOperation op,
+        int32_t column_id,
+        std::shared_ptr<Literal> const& operand,
+        Selection& result
+) {
+    if (FilterOperation::EXISTS == op || FilterOperation::NEXISTS == op) {
+        result = select_first(m_batch_size);
+        return;
+    }
+
+    result.fill(0);
+    int64_t op_value;
+    if (false == operand->as_int(op_value, op)) {
+        return;
+    }
+
+    for (BaseColumnReader* reader : m_basic_readers[column_id]) {
+        if (auto* int_reader = dynamic_cast<Int64ColumnReader*>(reader); nullptr != int_reader) {
+            auto const values = int_reader->get_values().sub_span(m_batch_begin, m_batch_size);
+            select_comparison_matches(
+                    op,
+                    op_value,
+                    m_batch_size,
+                    [&](size_t i) -> int64_t { return values[i]; },
+                    result
+            );
+        } else {
+            select_comparison_matches(
+                    op,
+                    op_value,
+                    m_batch_size,
+                    [&](size_t i) -> int64_t {
+                        return std::get<int64_t>(reader->extract_value(m_batch_begin + i));
+                    },
+                    result
+            );
+        }
+    }
+}
+
+void QueryRunner::evaluate_float_filter_batch(
+        FilterOperation op,
+        int32_t column_id,
+        std::shared_ptr<Literal> const& operand,
+        Selection& result
+) {
+    if (FilterOperation::EXISTS == op || FilterOperation::NEXISTS == op) {
+        result = select_first(m_batch_size);
+        return;
+    }
+
+    result.fill(0);
+    double op_value;
+    if (false == operand->as_float(op_value, op)) {
+        return;
+    }
+
+    for (BaseColumnReader* reader : m_basic_readers[column_id]) {
+        if (auto* float_reader = dynamic_cast<FloatColumnReader*>(reader); nullptr != float_reader)
+        {
+            auto const values = float_reader->get_values().sub_span(m_batch_begin, m_batch_size);
+            select_comparison_matches(
+                    op,
+                    op_value,
+                    m_batch_size,
+                    [&](size_t i) -> double { return values[i]; },
+                    result
+            );
+        } else {
+            select_comparison_matches(
+                    op,
+                    op_value,
+                    m_batch_size,
+                    [&](size_t i) -> double {
+                        return std::get<double>(reader->extract_value(m_batch_begin + i));
+                    },
+                    result
+            );
+        }
+    }
+}
+
+void QueryRunner::evaluate_bool_filter_batch(
+        FilterOperation op,
+        int32_t column_id,
+        std::shared_ptr<Literal> const& operand,
+        Selection& result
+) {
+    if (FilterOperation::EXISTS == op || FilterOperation::NEXISTS == op) {
+        result = select_first(m_batch_size);
+        return;
+    }
+
+    result.fill(0);
+    bool op_value;
+    if (false == operand->as_bool(op_value, op)) {
+        return;
+    }
+    if (FilterOperation::EQ != op && FilterOperation::NEQ != op) {
+        return;
+    }
+
+    // The comparison against `op_value` folds into the value that is compared against
+    bool const matching_value = (FilterOperation::EQ == op) == op_value;
+    for (BaseColumnReader* reader : m_basic_readers[column_id]) {
+        if (auto* bool_reader = dynamic_cast<BooleanColumnReader*>(reader); nullptr != bool_reader)
+        {
+            auto const values = bool_reader->get_values().sub_span(m_batch_begin, m_batch_size);
+            select_matching(
+                    m_batch_size,
+                    [&](size_t i) -> bool { return 0 != values[i]; },
+                    [=](bool v) { return v == matching_value; },
+                    result
+            );
+        } else {
+            select_matching(
+                    m_batch_size,
+                    [&](size_t i) -> bool {
+                        return 0 != std::get<uint8_t>(reader->extract_value(m_batch_begin + i));
+                    },
+                    [=](bool v) { return v == matching_value; },
+                    result
+            );
+        }
+    }
+}
+
+void QueryRunner::evaluate_var_string_filter_batch(
+        FilterOperation op,
+        std::vector<VariableStringColumnReader*> const& readers,
+        std::unordered_set<int64_t> const* matching_vars,
+        Selection& result
+) const {
+    if (FilterOperation::EXISTS == op || FilterOperation::NEXISTS == op) {
+        result = select_first(m_batch_size);
+        return;
+    }
+
+    result.fill(0);
+    if (FilterOperation::EQ != op && FilterOperation::NEQ != op) {
+        return;
+    }
+
+    bool const is_eq = FilterOperation::EQ == op;
+    for (VariableStringColumnReader* reader : readers) {
+        auto const ids = reader->get_variable_ids().sub_span(m_batch_begin, m_batch_size);
+        auto const id_at = [&](size_t i) -> int64_t { return static_cast<int64_t>(ids[i]); };
+        if (matching_vars->empty()) {
+            if (false == is_eq) {
+                result = select_first(m_batch_size);
+                return;
+            }
+        } else if (1 == matching_vars->size()) {
+            // The common case of an exact match against a single dictionary entry reduces to an
+            // integer comparison
+            select_comparison_matches(
+                    is_eq ? FilterOperation::EQ : FilterOperation::NEQ,
+                    *matching_vars->begin(),
+                    m_batch_size,
+                    id_at,
+                    result
+            );
+        } else {
+            select_matching(
+                    m_batch_size,
+                    id_at,
+                    [&](int64_t id) { return matching_vars->contains(id) == is_eq; },
+                    result
+            );
+        }
+    }
+}
+
+void QueryRunner::evaluate_epoch_date_filter_batch(
+        FilterOperation op,
+        DateStringColumnReader* reader,
+        std::shared_ptr<Literal> const& operand,
+        Selection& result
+) const {
+    if (FilterOperation::EXISTS == op || FilterOperation::NEXISTS == op) {
+        result = select_first(m_batch_size);
+        return;
+    }
+
+    result.fill(0);
+    int64_t op_value;
+    if (false == operand->as_int(op_value, op)) {
+        return;
+    }
+
+    select_comparison_matches(
+            op,
+            op_value,
+            m_batch_size,
+            [&](size_t i) -> int64_t { return reader->get_encoded_time(m_batch_begin + i); },
+            result
+    );
+}
+
 bool QueryRunner::evaluate(Expression* expr, int32_t schema) {
     if (m_expression_value == EvaluatedValue::True) {
         return true;
@@ -1129,7 +1637,20 @@ EvaluatedValue QueryRunner::constant_propagate(std::shared_ptr<Expression> const
             auto& query_processing_result = m_string_query_map.at(filter_string);
             if (query_processing_result.has_value()) {
                 m_expr_clp_query[expr.get()] = &(query_processing_result.value());
-                return EvaluatedValue::Unknown;
+                auto const& query = query_processing_result.value();
+                if (query.search_string_matches_all() || false == query.contains_sub_queries()) {
+                    return EvaluatedValue::Unknown;
+                }
+                std::vector<uint64_t> logtype_ids;
+                for (auto const& subquery : query.get_sub_queries()) {
+                    auto const& possible_logtypes = subquery.get_possible_logtypes();
+                    logtype_ids.insert(
+                            logtype_ids.end(),
+                            possible_logtypes.cbegin(),
+                            possible_logtypes.cend()
+                    );
+                }
+                return evaluate_filter_against_dictionary_ids(filter.get(), logtype_ids);
             } else {
                 m_expr_clp_query[expr.get()] = nullptr;
                 // If filter can not match then return it's guaranteed value based on
@@ -1161,10 +1682,11 @@ EvaluatedValue QueryRunner::constant_propagate(std::shared_ptr<Expression> const
                 // FIXME: throw
                 return EvaluatedValue::False;
             } else {
-                return EvaluatedValue::Unknown;
+                auto const* matching_vars = m_expr_var_match_map.at(expr.get());
+                return evaluate_filter_against_dictionary_ids(filter.get(), *matching_vars);
             }
         } else {
-            return EvaluatedValue::Unknown;
+            return evaluate_filter_against_value_range(filter.get());
         }
     }
 
@@ -1187,4 +1709,80 @@ bool QueryRunner::evaluate_epoch_date_filter(
 
     return evaluate_int_filter_core(op, reader->get_encoded_time(m_cur_message), op_value);
 }
+
+auto QueryRunner::evaluate_filter_against_value_range(FilterExpr* expr) -> EvaluatedValue {
+    auto* column = expr->get_column().get();
+    if (column->is_pure_wildcard() || column->has_unresolved_tokens()) {
+        return EvaluatedValue::Unknown;
+    }
+
+    auto const& column_value_ranges
+            = m_archive_reader->get_schema_metadata(m_schema).column_value_ranges;
+    auto const it = column_value_ranges.find(column->get_column_id());
+    if (column_value_ranges.end() == it) {
+        return EvaluatedValue::Unknown;
+    }
+
+    auto const op = expr->get_operation();
+    auto literal = expr->get_operand();
+    auto value = EvaluatedValue::Unknown;
+    switch (column->get_literal_type()) {
+        case LiteralType::IntegerT:
+        case LiteralType::EpochDateT: {
+            auto const* range = std::get_if<std::pair<int64_t, int64_t>>(&it->second);
+            int64_t op_value;
+            if (nullptr != range && literal->as_int(op_value, op)) {
+                value = evaluate_range_comparison(op, range->first, range->second, op_value);
+            }
+            break;
+        }
+        case LiteralType::FloatT: {
+            auto const* range = std::get_if<std::pair<double, double>>(&it->second);
+            double op_value;
+            if (nullptr != range && literal->as_float(op_value, op)) {
+                value = evaluate_range_comparison(op, range->first, range->second, op_value);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    if (EvaluatedValue::Unknown == value || false == expr->is_inverted()) {
+        return value;
+    }
+    return EvaluatedValue::True == value ? EvaluatedValue::False : EvaluatedValue::True;
+}
+
+template <typename DictionaryIds>
+auto QueryRunner::evaluate_filter_against_dictionary_ids(
+        FilterExpr* expr,
+        DictionaryIds const& matching_ids
+) -> EvaluatedValue {
+    auto* column = expr->get_column().get();
+    auto const op = expr->get_operation();
+    if (column->is_pure_wildcard() || column->has_unresolved_tokens()
+        || (FilterOperation::EQ != op && FilterOperation::NEQ != op)
+        || matching_ids.size() > cMaxDictionaryIdsToProbe)
+    {
+        return EvaluatedValue::Unknown;
+    }
+
+    auto const& dictionary_id_filters
+            = m_archive_reader->get_schema_metadata(m_schema).dictionary_id_filters;
+    auto const it = dictionary_id_filters.find(column->get_column_id());
+    if (dictionary_id_filters.end() == it) {
+        return EvaluatedValue::Unknown;
+    }
+
+    for (auto const id : matching_ids) {
+        if (it->second.possibly_contains(id)) {
+            return EvaluatedValue::Unknown;
+        }
+    }
+
+    // None of the matching IDs appear in the table's column
+    bool const matches = FilterOperation::NEQ == op;
+    return matches != expr->is_inverted() ? EvaluatedValue::True : EvaluatedValue::False;
+}
 }  // namespace clp_s::search
@@ -92,6 +92,10 @@ protected:
     // Methods inherited from FilterClass
     auto filter(uint64_t cur_message) -> bool override;
 
+    void filter_batch(uint64_t begin_message, size_t num_messages, Selection& selection) override;
+
+    auto requires_column(int32_t column_id) -> bool override;
+
     /**
      * Clears all column readers.
      */
@@ -106,6 +110,10 @@ protected:
     void initialize_reader(int32_t column_id, BaseColumnReader* column_reader);
 
 private:
+    // Constants
+    // Beyond this many IDs, a table's dictionary ID filter is likely to report one of them anyway
+    static constexpr size_t cMaxDictionaryIdsToProbe{1024};
+
     enum class ExpressionType : uint8_t {
         And,
         Or,
@@ -139,6 +147,8 @@ private:
     std::unordered_map<int32_t, std::vector<BaseColumnReader*>> m_basic_readers;
     std::unordered_map<int32_t, std::string> m_extracted_unstructured_arrays;
     uint64_t m_cur_message{0};
+    uint64_t m_batch_begin{0};
+    size_t m_batch_size{0};
     EvaluatedValue m_expression_value{EvaluatedValue::Unknown};
 
     std::vector<ast::ColumnDescriptor*> m_wildcard_columns;
@@ -172,6 +182,36 @@ private:
      */
     auto evaluate(ast::Expression* expr, int32_t schema) -> bool;
 
+    /**
+     * Evaluates an expression on the messages of the current batch that are selected in
+     * `candidates`. Sub-expressions of an AND or OR are only evaluated on the messages whose
+     * result hasn't yet been decided by the preceding sub-expressions.
+     * @param expr
+     * @param candidates
+     * @param result Returns the candidates for which the expression evaluates to true
+     */
+    void evaluate_batch(ast::Expression* expr, Selection const& candidates, Selection& result);
+
+    /**
+     * Evaluates a filter expression on the messages of the current batch that are selected in
+     * `candidates`.
+     * @param expr
+     * @param candidates
+     * @param result Returns the candidates for which the filter evaluates to true
+     */
+    void
+    evaluate_filter_batch(ast::FilterExpr* expr, Selection const& candidates, Selection& result);
+
+    /**
+     * Evaluates a filter expression on every message of the current batch by operating directly on
+     * the encoded column values, for the filters where this is possible.
+     * @param expr
+     * @param result Returns the messages for which the filter evaluates to true
+     * @return true if the filter was evaluated, false if it must be evaluated one message at a
+     * time
+     */
+    auto evaluate_filter_batch_columnar(ast::FilterExpr* expr, Selection& result) -> bool;
+
     /**
      * Evaluates a filter expression
      * @param expr
@@ -224,6 +264,76 @@ private:
             std::shared_ptr<ast::Literal> const& operand
     ) -> bool;
 
+    /**
+     * Evaluates an int filter expression on every message of the current batch
+     * @param op
+     * @param column_id
+     * @param operand
+     * @param result Returns the messages for which the filter evaluates to true
+     */
+    void evaluate_int_filter_batch(
+            ast::FilterOperation op,
+            int32_t column_id,
+            std::shared_ptr<ast::Literal> const& operand,
+            Selection& result
+    );
+
+    /**
+     * Evaluates a float filter expression on every message of the current batch
+     * @param op
+     * @param column_id
+     * @param operand
+     * @param result Returns the messages for which the filter evaluates to true
+     */
+    void evaluate_float_filter_batch(
+            ast::FilterOperation op,
+            int32_t column_id,
+            std::shared_ptr<ast::Literal> const& operand,
+            Selection& result
+    );
+
+    /**
+     * Evaluates a bool filter expression on every message of the current batch
+     * @param op
+     * @param column_id
+     * @param operand
+     * @param result Returns the messages for which the filter evaluates to true
+     */
+    void evaluate_bool_filter_batch(
+            ast::FilterOperation op,
+            int32_t column_id,
+            std::shared_ptr<ast::Literal> const& operand,
+            Selection& result
+    );
+
+    /**
+     * Evaluates a var string filter expression on every message of the current batch
+     * @param op
+     * @param readers
+     * @param matching_vars
+     * @param result Returns the messages for which the filter evaluates to true
+     */
+    void evaluate_var_string_filter_batch(
+            ast::FilterOperation op,
+            std::vector<VariableStringColumnReader*> const& readers,
+            std::unordered_set<int64_t> const* matching_vars,
+            Selection& result
+    ) const;
+
+    /**
+     * Evaluates a epoch date string filter expression on every message of the current batch
+     * @param op
+     * @param reader
+     * @param operand
+     * @param result Returns the messages for which the filter evaluates to true
+     */
+    void evaluate_epoch_date_filter_batch(
+            ast::FilterOperation op,
+            DateStringColumnReader* reader,
+            std::shared_ptr<ast::Literal> const& operand,
+            Selection& result
+    ) const;
+
     /**
      * Evaluates the core of a float filter expression
      * @param op
@@ -410,6 +520,32 @@ private:
      */
     auto constant_propagate(std::shared_ptr<ast::Expression> const& expr) -> EvaluatedValue;
 
+    /**
+     * Evaluates a filter on a numeric or date column against the range of the column's values in
+     * the current schema table, as recorded in the archive's metadata
+     * @param expr
+     * @return EvaluatedValue::True if the filter holds for every value in the range,
+     * EvaluatedValue::False if it holds for none of them, EvaluatedValue::Unknown otherwise
+     */
+    auto evaluate_filter_against_value_range(ast::FilterExpr* expr) -> EvaluatedValue;
+
+    /**
+     * Evaluates an equality filter on a dictionary-encoded column against the filter over the
+     * dictionary IDs in the current schema table's column, as recorded in the archive's metadata.
+     * Filters matching more than `cMaxDictionaryIdsToProbe` IDs aren't evaluated since the table
+     * is unlikely to be ruled out.
+     * @tparam DictionaryIds A container of dictionary IDs
+     * @param expr
+     * @param matching_ids The dictionary IDs of the values that match the filter's operand
+     * @return EvaluatedValue::True or EvaluatedValue::False if none of the matching IDs can appear
+     * in the column, EvaluatedValue::Unknown otherwise
+     */
+    template <typename DictionaryIds>
+    auto evaluate_filter_against_dictionary_ids(
+            ast::FilterExpr* expr,
+            DictionaryIds const& matching_ids
+    ) -> EvaluatedValue;
+
     /**
      * Populates searched wildcard columns
      * @param expr
@@ -0,0 +1,81 @@
+#ifndef CLP_S_SEARCH_TOPKTIMESTAMPS_HPP
+#define CLP_S_SEARCH_TOPKTIMESTAMPS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <vector>
+
+#include "../Defs.hpp"
+
+namespace clp_s::search {
+/**
+ * Class that tracks the K latest timestamps of the results kept by a search for the latest K
+ * results. Once K results have been kept, any result, table, or archive whose timestamp can't
+ * exceed the K-th latest timestamp can be skipped.
+ *
+ * The class is thread-safe so that it can be shared by the searches of several archives. Reading
+ * the threshold doesn't take the lock, so it's cheap enough to check for every result.
+ */
+class TopKTimestamps {
+public:
+    // Constructors
+    explicit TopKTimestamps(uint64_t k) : m_k{k} {}
+
+    // Methods
+    /**
+     * Adds the timestamp of a result if it's among the K latest timestamps added so far.
+     * @param timestamp
+     * @return Whether the timestamp was added
+     */
+    auto add(epochtime_t timestamp) -> bool {
+        std::lock_guard const lock{m_mutex};
+        if (m_timestamps.size() < m_k) {
+            m_timestamps.push(timestamp);
+        } else if (m_k > 0 && m_timestamps.top() < timestamp) {
+            m_timestamps.pop();
+            m_timestamps.push(timestamp);
+        } else {
+            return false;
+        }
+
+        if (m_timestamps.size() == m_k) {
+            m_threshold.store(m_timestamps.top(), std::memory_order_relaxed);
+            m_is_full.store(true, std::memory_order_release);
+        }
+        return true;
+    }
+
+    /**
+     * @return The timestamp that a result must exceed to be among the K latest timestamps, or
+     * std::nullopt if fewer than K timestamps have been added
+     */
+    [[nodiscard]] auto get_threshold() const -> std::optional<epochtime_t> {
+        if (false == m_is_full.load(std::memory_order_acquire)) {
+            return std::nullopt;
+        }
+        return m_threshold.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @param max_timestamp The maximum timestamp of a set of results
+     * @return Whether any of the results could be among the K latest
+     */
+    [[nodiscard]] auto can_contain_latest(epochtime_t max_timestamp) const -> bool {
+        auto const threshold = get_threshold();
+        return false == threshold.has_value() || max_timestamp > threshold.value();
+    }
+
+private:
+    uint64_t m_k;
+    std::mutex m_mutex;
+    std::priority_queue<epochtime_t, std::vector<epochtime_t>, std::greater<>> m_timestamps;
+    std::atomic<epochtime_t> m_threshold{cEpochTimeMin};
+    std::atomic_bool m_is_full{false};
+};
+}  // namespace clp_s::search
+
+#endif  // CLP_S_SEARCH_TOPKTIMESTAMPS_HPP
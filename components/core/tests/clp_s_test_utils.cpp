@@ -1,5 +1,6 @@
 #include "clp_s_test_utils.hpp"
 
+#include <cstddef>
 #include <filesystem>
 #include <string>
 #include <vector>
@@ -15,7 +16,9 @@ auto compress_archive(
         std::string const& archive_directory,
         bool single_file_archive,
         bool structurize_arrays,
-        clp_s::FileType file_type
+        clp_s::FileType file_type,
+        size_t separate_columns_table_size,
+        std::string const& timestamp_key
 ) -> std::vector<clp_s::ArchiveStats> {
     constexpr auto cDefaultTargetEncodedSize{8ULL * 1024 * 1024 * 1024};  // 8 GiB
     constexpr auto cDefaultMaxDocumentSize{512ULL * 1024 * 1024};  // 512 MiB
@@ -39,6 +42,8 @@ auto compress_archive(
     parser_option.structurize_arrays = structurize_arrays;
     parser_option.single_file_archive = single_file_archive;
     parser_option.input_file_type = file_type;
+    parser_option.separate_columns_table_size = separate_columns_table_size;
+    parser_option.timestamp_key = timestamp_key;
 
     clp_s::JsonParser parser{parser_option};
     std::vector<clp_s::ArchiveStats> archive_stats;
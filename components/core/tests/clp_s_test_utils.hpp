@@ -1,6 +1,7 @@
 #ifndef CLP_S_TEST_UTILS_HPP
 #define CLP_S_TEST_UTILS_HPP
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -17,6 +18,9 @@
  * @param single_file_archive
  * @param structurize_arrays
  * @param file_type
+ * @param separate_columns_table_size Minimum size of tables stored as separate columns, or 0 to
+ * pack every table.
+ * @param timestamp_key Key of the field to use as each record's timestamp, or empty for none.
  * @return Statistics for every compressed archive.
  */
 [[nodiscard]] auto compress_archive(
@@ -24,6 +28,8 @@
         std::string const& archive_directory,
         bool single_file_archive,
         bool structurize_arrays,
-        clp_s::FileType file_type
+        clp_s::FileType file_type,
+        size_t separate_columns_table_size = 0,
+        std::string const& timestamp_key = {}
 ) -> std::vector<clp_s::ArchiveStats>;
 #endif  // CLP_S_TEST_UTILS_HPP
@@ -1,5 +1,8 @@
 #include <unistd.h>
 
+#include <string_view>
+#include <unordered_set>
+
 #include <catch2/catch.hpp>
 
 #include "../src/clp/EncodedVariableInterpreter.hpp"
@@ -412,9 +415,51 @@ TEST_CASE("EncodedVariableInterpreter", "[EncodedVariableInterpreter]") {
         var_dict_reader.open(std::string{cVarDictPath}, std::string{cVarSegmentIndexPath});
         var_dict_reader.read_new_entries();
 
+        REQUIRE(0 == var_dict_reader.get_value_index_memory_usage());
         REQUIRE(var_dict_reader.get_entry_matching_value(var_strs.at(0), true).size()
                 == var_strs.size());
         REQUIRE(var_dict_reader.get_entry_matching_value(var_strs.at(0), false).size() == 1);
+        REQUIRE(var_dict_reader.get_value_index_memory_usage() > 0);
+        for (auto const& var_str : var_strs) {
+            auto const entries = var_dict_reader.get_entry_matching_value(var_str, false);
+            REQUIRE(entries.size() == 1);
+            REQUIRE(entries.at(0)->get_value() == var_str);
+        }
+        REQUIRE(var_dict_reader.get_entry_matching_value("python2.7.4", false).empty());
+        REQUIRE(var_dict_reader.get_entry_matching_value("python2.7.4", true).empty());
+
+        // The first wildcard search scans every entry while later ones use the n-gram index, so
+        // repeat each search to check that both agree
+        auto const memory_usage_without_ngram_index
+                = var_dict_reader.get_value_index_memory_usage();
+        auto const get_wildcard_matches = [&](std::string_view wildcard_string, bool ignore_case) {
+            std::unordered_set<clp::VariableDictionaryEntry const*> entries;
+            var_dict_reader.get_entries_matching_wildcard_string(
+                    wildcard_string,
+                    ignore_case,
+                    entries
+            );
+            return entries;
+        };
+        for (int i = 0; i < 3; ++i) {
+            auto wildcard_matches = get_wildcard_matches("*thon2.7*", true);
+            REQUIRE(wildcard_matches.size() == var_strs.size());
+
+            wildcard_matches = get_wildcard_matches("*thon2.7*", false);
+            REQUIRE(wildcard_matches.size() == 1);
+            REQUIRE((*wildcard_matches.begin())->get_value() == var_strs.at(0));
+
+            wildcard_matches = get_wildcard_matches("P?THON*", false);
+            REQUIRE(wildcard_matches.size() == 1);
+            REQUIRE((*wildcard_matches.begin())->get_value() == var_strs.at(3));
+
+            wildcard_matches = get_wildcard_matches("*2\\?7*", true);
+            REQUIRE(wildcard_matches.empty());
+
+            wildcard_matches = get_wildcard_matches("*3.7*", true);
+            REQUIRE(wildcard_matches.empty());
+        }
+        REQUIRE(var_dict_reader.get_value_index_memory_usage() > memory_usage_without_ngram_index);
 
         var_dict_reader.close();
 
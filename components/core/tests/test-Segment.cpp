@@ -1,10 +1,19 @@
 #include <unistd.h>
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
 #include <boost/filesystem.hpp>
 #include <catch2/catch.hpp>
 
+#include "../src/clp/FileWriter.hpp"
+#include "../src/clp/streaming_archive/Constants.hpp"
 #include "../src/clp/streaming_archive/reader/Segment.hpp"
 #include "../src/clp/streaming_archive/writer/Segment.hpp"
+#include "../src/clp/streaming_compression/zstd/Compressor.hpp"
 #include "../src/clp/Utils.hpp"
 
 using clp::ErrorCode_Success;
@@ -63,3 +72,82 @@ TEST_CASE("Test writing and reading a segment", "[Segment]") {
     boost::filesystem::remove_all(segments_dir_path, boost_error_code);
     REQUIRE(!boost_error_code);
 }
+
+TEST_CASE("Test reading regions of a segment", "[Segment]") {
+    constexpr size_t cNumBuffers{5};
+    constexpr size_t cBufferSize{clp::streaming_archive::cSeekableSegment::MaxFrameSize / 3 * 2};
+    string const segments_dir_path = "unit-test-segment/";
+    REQUIRE(ErrorCode_Success == clp::create_directory_structure(segments_dir_path, 0700));
+
+    // Buffers span frame boundaries since they're smaller than a frame but not a divisor of it
+    std::vector<char> uncompressed_data(cNumBuffers * cBufferSize);
+    for (size_t i = 0; i < uncompressed_data.size(); ++i) {
+        uncompressed_data[i] = static_cast<char>('a' + ((i * 7 + i / 4096) % 26));
+    }
+
+    clp::segment_id_t const seekable_segment_id{0};
+    clp::streaming_archive::writer::Segment writer_segment;
+    writer_segment.open(segments_dir_path, seekable_segment_id, 3);
+    std::vector<uint64_t> buffer_offsets;
+    for (size_t i = 0; i < cNumBuffers; ++i) {
+        uint64_t offset{};
+        writer_segment.append(uncompressed_data.data() + i * cBufferSize, cBufferSize, offset);
+        buffer_offsets.push_back(offset);
+    }
+    writer_segment.close();
+
+    // Write a segment as a single zstd stream without a seek table, as older versions did
+    clp::segment_id_t const unseekable_segment_id{1};
+    {
+        clp::FileWriter file_writer;
+        file_writer.open(
+                segments_dir_path + std::to_string(unseekable_segment_id),
+                clp::FileWriter::OpenMode::CREATE_FOR_WRITING
+        );
+        clp::streaming_compression::zstd::Compressor compressor;
+        compressor.open(file_writer, 3);
+        compressor.write(uncompressed_data.data(), uncompressed_data.size());
+        compressor.close();
+        file_writer.close();
+    }
+
+    auto const segment_id = GENERATE_COPY(seekable_segment_id, unseekable_segment_id);
+    clp::streaming_archive::reader::Segment reader_segment;
+    REQUIRE(ErrorCode_Success == reader_segment.try_open(segments_dir_path, segment_id));
+    REQUIRE((seekable_segment_id == segment_id) == reader_segment.is_seekable());
+
+    // Read each appended buffer, back to front
+    std::vector<char> decompressed_data(uncompressed_data.size());
+    for (size_t i = cNumBuffers; i > 0; --i) {
+        auto const offset = buffer_offsets[i - 1];
+        REQUIRE(ErrorCode_Success
+                == reader_segment.try_read(offset, decompressed_data.data(), cBufferSize));
+        REQUIRE(0
+                == std::memcmp(
+                        uncompressed_data.data() + offset,
+                        decompressed_data.data(),
+                        cBufferSize
+                ));
+    }
+
+    // Read small regions, including ones spanning a frame boundary
+    auto const frame_size = clp::streaming_archive::cSeekableSegment::MaxFrameSize;
+    for (uint64_t const offset : {frame_size - 10, uint64_t{5}, frame_size * 2 + 1, frame_size - 5})
+    {
+        REQUIRE(ErrorCode_Success == reader_segment.try_read(offset, decompressed_data.data(), 20));
+        REQUIRE(0 == std::memcmp(uncompressed_data.data() + offset, decompressed_data.data(), 20));
+    }
+
+    // Read the whole segment
+    REQUIRE(ErrorCode_Success
+            == reader_segment.try_read(0, decompressed_data.data(), decompressed_data.size()));
+    REQUIRE(uncompressed_data == decompressed_data);
+
+    REQUIRE(ErrorCode_Success
+            != reader_segment.try_read(uncompressed_data.size() - 1, decompressed_data.data(), 2));
+    reader_segment.close();
+
+    boost::system::error_code boost_error_code;
+    boost::filesystem::remove_all(segments_dir_path, boost_error_code);
+    REQUIRE(!boost_error_code);
+}
@@ -0,0 +1,111 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+
+#include "../src/clp_s/BloomFilter.hpp"
+#include "../src/clp_s/ErrorCode.hpp"
+#include "../src/clp_s/ZstdCompressor.hpp"
+#include "../src/clp_s/ZstdDecompressor.hpp"
+
+namespace {
+constexpr uint64_t cNumValues{10'000};
+// Values that weren't added to the filters, used to measure their false positive rate
+constexpr uint64_t cNumAbsentValues{100'000};
+// The filters are sized for a false positive rate of about 1%
+constexpr double cMaxFalsePositiveRate{0.02};
+
+/**
+ * Creates a filter containing the IDs in [0, cNumValues), like the dictionary IDs of a column.
+ * @return The filter
+ */
+auto create_id_filter() -> clp_s::BloomFilter;
+
+/**
+ * @param filter A filter created by `create_id_filter`
+ * @return The fraction of the IDs in [cNumValues, cNumValues + cNumAbsentValues) that the filter
+ * possibly contains
+ */
+auto get_id_false_positive_rate(clp_s::BloomFilter const& filter) -> double;
+
+auto create_id_filter() -> clp_s::BloomFilter {
+    clp_s::BloomFilter filter{cNumValues};
+    for (uint64_t id{0}; id < cNumValues; ++id) {
+        filter.add(id);
+    }
+    return filter;
+}
+
+auto get_id_false_positive_rate(clp_s::BloomFilter const& filter) -> double {
+    uint64_t num_false_positives{0};
+    for (uint64_t id{cNumValues}; id < cNumValues + cNumAbsentValues; ++id) {
+        if (filter.possibly_contains(id)) {
+            ++num_false_positives;
+        }
+    }
+    return static_cast<double>(num_false_positives) / static_cast<double>(cNumAbsentValues);
+}
+}  // namespace
+
+TEST_CASE("clp-s-bloom-filter-ids", "[clp-s][bloom-filter]") {
+    auto const filter = create_id_filter();
+    for (uint64_t id{0}; id < cNumValues; ++id) {
+        REQUIRE(filter.possibly_contains(id));
+    }
+    REQUIRE(get_id_false_positive_rate(filter) < cMaxFalsePositiveRate);
+}
+
+TEST_CASE("clp-s-bloom-filter-strings", "[clp-s][bloom-filter]") {
+    clp_s::BloomFilter filter{cNumValues};
+    for (uint64_t i{0}; i < cNumValues; ++i) {
+        filter.add(fmt::format("value-{}", i));
+    }
+
+    for (uint64_t i{0}; i < cNumValues; ++i) {
+        REQUIRE(filter.possibly_contains(fmt::format("value-{}", i)));
+    }
+    uint64_t num_false_positives{0};
+    for (uint64_t i{cNumValues}; i < cNumValues + cNumAbsentValues; ++i) {
+        if (filter.possibly_contains(fmt::format("value-{}", i))) {
+            ++num_false_positives;
+        }
+    }
+    REQUIRE(static_cast<double>(num_false_positives) / static_cast<double>(cNumAbsentValues)
+            < cMaxFalsePositiveRate);
+}
+
+TEST_CASE("clp-s-bloom-filter-empty", "[clp-s][bloom-filter]") {
+    clp_s::BloomFilter const default_filter;
+    REQUIRE(false == default_filter.possibly_contains(uint64_t{0}));
+    REQUIRE(false == default_filter.possibly_contains(std::string{}));
+
+    clp_s::BloomFilter const empty_filter{0};
+    REQUIRE(false == empty_filter.possibly_contains(uint64_t{0}));
+    REQUIRE(false == empty_filter.possibly_contains(std::string{}));
+}
+
+TEST_CASE("clp-s-bloom-filter-serialization", "[clp-s][bloom-filter]") {
+    auto const filter = create_id_filter();
+
+    std::vector<char> buffer;
+    clp_s::ZstdCompressor compressor;
+    compressor.open(buffer);
+    filter.write_to_file(compressor);
+    compressor.close();
+
+    clp_s::BloomFilter read_filter;
+    clp_s::ZstdDecompressor decompressor;
+    decompressor.open(buffer.data(), buffer.size());
+    REQUIRE(clp_s::ErrorCodeSuccess == read_filter.try_read_from_file(decompressor));
+    decompressor.close();
+
+    REQUIRE(filter.get_serialized_size() == read_filter.get_serialized_size());
+    for (uint64_t id{0}; id < cNumValues; ++id) {
+        REQUIRE(read_filter.possibly_contains(id));
+    }
+    // The read filter must have the same bits, so it must have the same false positives
+    REQUIRE(get_id_false_positive_rate(filter) == get_id_false_positive_rate(read_filter));
+}
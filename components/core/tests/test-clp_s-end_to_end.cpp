@@ -1,10 +1,15 @@
 #include <sys/wait.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>
+#include <fstream>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include <catch2/catch.hpp>
 #include <fmt/format.h>
@@ -12,6 +17,8 @@
 #include "../src/clp_s/CommandLineArguments.hpp"
 #include "../src/clp_s/InputConfig.hpp"
 #include "../src/clp_s/JsonConstructor.hpp"
+#include "../src/clp_s/JsonParser.hpp"
+#include "../src/clp_s/ParallelJsonParser.hpp"
 #include "clp_s_test_utils.hpp"
 #include "TestOutputCleaner.hpp"
 
@@ -20,12 +27,37 @@ constexpr std::string_view cTestEndToEndOutputDirectory{"test-end-to-end-out"};
 constexpr std::string_view cTestEndToEndOutputSortedJson{"test-end-to-end_sorted.jsonl"};
 constexpr std::string_view cTestEndToEndInputFileDirectory{"test_log_files"};
 constexpr std::string_view cTestEndToEndInputFile{"test_no_floats_sorted.jsonl"};
+constexpr std::string_view cTestEndToEndSplitInputDirectory{"test-end-to-end-split-input"};
 
 namespace {
 auto get_test_input_path_relative_to_tests_dir() -> std::filesystem::path;
 auto get_test_input_local_path() -> std::string;
-auto extract() -> std::filesystem::path;
+auto split_test_input(size_t num_files) -> std::vector<clp_s::Path>;
+/**
+ * Extracts every archive in the archive directory.
+ * @param num_threads The number of threads used to extract each archive
+ * @param parallelism The number of archives extracted concurrently
+ * @return The path of the extracted file
+ */
+auto extract(size_t num_threads, size_t parallelism) -> std::filesystem::path;
+/**
+ * Extracts the records of the single archive in the archive directory in log order.
+ * @param max_ordered_memory_usage
+ * @param num_threads
+ * @param target_ordered_chunk_size
+ * @return The paths of the extracted chunks, in log order
+ */
+auto extract_in_order(
+        size_t max_ordered_memory_usage,
+        size_t num_threads,
+        size_t target_ordered_chunk_size
+) -> std::vector<std::filesystem::path>;
 void compare(std::filesystem::path const& extracted_json_path);
+/**
+ * Checks that the extracted records are the records of the test input, in the same order.
+ * @param extracted_json_paths
+ */
+void compare_in_order(std::vector<std::filesystem::path> const& extracted_json_paths);
 
 auto get_test_input_path_relative_to_tests_dir() -> std::filesystem::path {
     return std::filesystem::path{cTestEndToEndInputFileDirectory} / cTestEndToEndInputFile;
@@ -37,7 +69,38 @@ auto get_test_input_local_path() -> std::string {
     return (tests_dir / get_test_input_path_relative_to_tests_dir()).string();
 }
 
-auto extract() -> std::filesystem::path {
+/**
+ * Splits the test input into `num_files` files, distributing its lines round-robin.
+ * @param num_files
+ * @return The paths of the new input files
+ */
+auto split_test_input(size_t num_files) -> std::vector<clp_s::Path> {
+    std::filesystem::create_directory(cTestEndToEndSplitInputDirectory);
+    REQUIRE(std::filesystem::is_directory(cTestEndToEndSplitInputDirectory));
+
+    std::vector<clp_s::Path> split_paths;
+    std::vector<std::ofstream> split_files;
+    for (size_t i{0}; i < num_files; ++i) {
+        auto const split_path{
+                std::filesystem::path{cTestEndToEndSplitInputDirectory} / fmt::format("{}.jsonl", i)
+        };
+        split_paths.emplace_back(
+                clp_s::Path{.source{clp_s::InputSource::Filesystem}, .path{split_path.string()}}
+        );
+        split_files.emplace_back(split_path);
+        REQUIRE(split_files.back().is_open());
+    }
+
+    std::ifstream input{get_test_input_local_path()};
+    REQUIRE(input.is_open());
+    std::string line;
+    for (size_t line_idx{0}; std::getline(input, line); ++line_idx) {
+        split_files[line_idx % num_files] << line << '\n';
+    }
+    return split_paths;
+}
+
+auto extract(size_t num_threads, size_t parallelism) -> std::filesystem::path {
     constexpr auto cDefaultOrdered = false;
     constexpr auto cDefaultTargetOrderedChunkSize = 0;
 
@@ -48,13 +111,26 @@ auto extract() -> std::filesystem::path {
     constructor_option.output_dir = cTestEndToEndOutputDirectory;
     constructor_option.ordered = cDefaultOrdered;
     constructor_option.target_ordered_chunk_size = cDefaultTargetOrderedChunkSize;
+    constructor_option.num_threads = num_threads;
+    std::vector<clp_s::Path> archive_paths;
     for (auto const& entry : std::filesystem::directory_iterator(cTestEndToEndArchiveDirectory)) {
-        constructor_option.archive_path = clp_s::Path{
-                .source{clp_s::InputSource::Filesystem},
-                .path{entry.path().string()}
-        };
-        clp_s::JsonConstructor constructor{constructor_option};
-        constructor.store();
+        archive_paths.emplace_back(
+                clp_s::Path{.source{clp_s::InputSource::Filesystem}, .path{entry.path().string()}}
+        );
+    }
+
+    if (1 == parallelism) {
+        for (auto const& archive_path : archive_paths) {
+            constructor_option.archive_path = archive_path;
+            clp_s::JsonConstructor constructor{constructor_option};
+            constructor.store();
+        }
+    } else {
+        REQUIRE(clp_s::decompress_archives_concurrently(
+                archive_paths,
+                constructor_option,
+                parallelism
+        ));
     }
     std::filesystem::path extracted_json_path{cTestEndToEndOutputDirectory};
     extracted_json_path /= "original";
@@ -63,6 +139,58 @@ auto extract() -> std::filesystem::path {
     return extracted_json_path;
 }
 
+auto extract_in_order(
+        size_t max_ordered_memory_usage,
+        size_t num_threads,
+        size_t target_ordered_chunk_size
+) -> std::vector<std::filesystem::path> {
+    std::filesystem::create_directory(cTestEndToEndOutputDirectory);
+    REQUIRE(std::filesystem::is_directory(cTestEndToEndOutputDirectory));
+
+    std::vector<std::filesystem::path> archive_paths;
+    for (auto const& entry : std::filesystem::directory_iterator(cTestEndToEndArchiveDirectory)) {
+        archive_paths.push_back(entry.path());
+    }
+    REQUIRE((1 == archive_paths.size()));
+
+    clp_s::JsonConstructorOption constructor_option{};
+    constructor_option.archive_path = clp_s::Path{
+            .source{clp_s::InputSource::Filesystem},
+            .path{archive_paths.front().string()}
+    };
+    constructor_option.output_dir = cTestEndToEndOutputDirectory;
+    constructor_option.ordered = true;
+    constructor_option.max_ordered_memory_usage = max_ordered_memory_usage;
+    constructor_option.num_threads = num_threads;
+    constructor_option.target_ordered_chunk_size = target_ordered_chunk_size;
+    clp_s::JsonConstructor constructor{constructor_option};
+    constructor.store();
+
+    // Chunks are named `<archive-id>_<begin-log-event-idx>_<end-log-event-idx>.jsonl`
+    std::vector<std::pair<int64_t, std::filesystem::path>> extracted_chunks;
+    for (auto const& entry : std::filesystem::directory_iterator(cTestEndToEndOutputDirectory)) {
+        auto const stem{entry.path().stem().string()};
+        auto const end_idx_pos{stem.rfind('_')};
+        REQUIRE((std::string::npos != end_idx_pos));
+        auto const begin_idx_pos{stem.rfind('_', end_idx_pos - 1)};
+        REQUIRE((std::string::npos != begin_idx_pos));
+        extracted_chunks.emplace_back(
+                std::stoll(stem.substr(begin_idx_pos + 1, end_idx_pos - begin_idx_pos - 1)),
+                entry.path()
+        );
+    }
+    std::sort(extracted_chunks.begin(), extracted_chunks.end());
+    if (0 == target_ordered_chunk_size) {
+        REQUIRE((1 == extracted_chunks.size()));
+    }
+
+    std::vector<std::filesystem::path> extracted_json_paths;
+    for (auto const& [begin_idx, path] : extracted_chunks) {
+        extracted_json_paths.push_back(path);
+    }
+    return extracted_json_paths;
+}
+
 // Silence the checks below since our use of `std::system` is safe in the context of testing.
 // NOLINTBEGIN(cert-env33-c,concurrency-mt-unsafe)
 void compare(std::filesystem::path const& extracted_json_path) {
@@ -90,12 +218,44 @@ void compare(std::filesystem::path const& extracted_json_path) {
     REQUIRE((0 == WEXITSTATUS(result)));
 }
 
+void compare_in_order(std::vector<std::filesystem::path> const& extracted_json_paths) {
+    int result{std::system("command -v jq >/dev/null 2>&1")};
+    REQUIRE((0 == result));
+    std::string extracted_json_path_list;
+    for (auto const& path : extracted_json_paths) {
+        extracted_json_path_list += fmt::format(" {}", path.string());
+    }
+    auto command = fmt::format(
+            "cat{} | jq --sort-keys --compact-output '.' > {}",
+            extracted_json_path_list,
+            cTestEndToEndOutputSortedJson
+    );
+    result = std::system(command.c_str());
+    REQUIRE((0 == result));
+
+    REQUIRE((false == std::filesystem::is_empty(cTestEndToEndOutputSortedJson)));
+
+    result = std::system("command -v diff >/dev/null 2>&1");
+    REQUIRE((0 == result));
+    command = fmt::format(
+            "diff --unified {} {}  > /dev/null",
+            cTestEndToEndOutputSortedJson,
+            get_test_input_local_path()
+    );
+    result = std::system(command.c_str());
+    REQUIRE((true == WIFEXITED(result)));
+    REQUIRE((0 == WEXITSTATUS(result)));
+}
+
 // NOLINTEND(cert-env33-c,concurrency-mt-unsafe)
 }  // namespace
 
 TEST_CASE("clp-s-compress-extract-no-floats", "[clp-s][end-to-end]") {
+    // A separate columns table size of 1 B stores every table as separate columns.
+    auto separate_columns_table_size = GENERATE(0ULL, 1ULL);
     auto structurize_arrays = GENERATE(true, false);
     auto single_file_archive = GENERATE(true, false);
+    auto num_threads = GENERATE(1ULL, 4ULL);
 
     TestOutputCleaner const test_cleanup{
             {std::string{cTestEndToEndArchiveDirectory},
@@ -109,11 +269,136 @@ TEST_CASE("clp-s-compress-extract-no-floats", "[clp-s][end-to-end]") {
                     std::string{cTestEndToEndArchiveDirectory},
                     single_file_archive,
                     structurize_arrays,
-                    clp_s::FileType::Json
+                    clp_s::FileType::Json,
+                    separate_columns_table_size
             )
     );
 
-    auto extracted_json_path = extract();
+    auto extracted_json_path = extract(num_threads, 1);
+
+    compare(extracted_json_path);
+}
+
+TEST_CASE("clp-s-compress-extract-no-floats-multithreaded", "[clp-s][end-to-end]") {
+    constexpr size_t cNumInputFiles{4};
+    constexpr auto cDefaultTargetEncodedSize{8ULL * 1024 * 1024 * 1024};  // 8 GiB
+    constexpr auto cDefaultMaxDocumentSize{512ULL * 1024 * 1024};  // 512 MiB
+    constexpr auto cDefaultMinTableSize{1ULL * 1024 * 1024};  // 1 MiB
+    // Forces every table into its own packed stream so that streams are compressed concurrently.
+    constexpr auto cMinTableSizeForStreamPerTable{1ULL};
+    constexpr auto cDefaultCompressionLevel{3};
+    auto num_threads = GENERATE(2ULL, 3ULL, 8ULL);
+    auto min_table_size = GENERATE_COPY(cDefaultMinTableSize, cMinTableSizeForStreamPerTable);
+    auto single_file_archive = GENERATE(true, false);
+    auto archive_per_thread = GENERATE(true, false);
+
+    TestOutputCleaner const test_cleanup{
+            {std::string{cTestEndToEndArchiveDirectory},
+             std::string{cTestEndToEndOutputDirectory},
+             std::string{cTestEndToEndOutputSortedJson},
+             std::string{cTestEndToEndSplitInputDirectory}}
+    };
+
+    std::filesystem::create_directory(cTestEndToEndArchiveDirectory);
+    REQUIRE(std::filesystem::is_directory(cTestEndToEndArchiveDirectory));
+
+    clp_s::JsonParserOption parser_option{};
+    parser_option.input_paths = split_test_input(cNumInputFiles);
+    parser_option.archives_dir = cTestEndToEndArchiveDirectory;
+    parser_option.target_encoded_size = cDefaultTargetEncodedSize;
+    parser_option.max_document_size = cDefaultMaxDocumentSize;
+    parser_option.min_table_size = min_table_size;
+    parser_option.compression_level = cDefaultCompressionLevel;
+    parser_option.single_file_archive = single_file_archive;
+    parser_option.num_threads = num_threads;
+
+    if (archive_per_thread) {
+        clp_s::ParallelJsonParser parser{parser_option};
+        REQUIRE((std::min<size_t>(num_threads, cNumInputFiles) == parser.get_num_workers()));
+        REQUIRE(parser.parse());
+        auto const archive_stats = parser.store();
+        REQUIRE((parser.get_num_workers() == archive_stats.size()));
+    } else {
+        // Without an archive per thread, the threads only compress the tables of a single archive
+        clp_s::JsonParser parser{parser_option};
+        REQUIRE(parser.parse());
+        auto const archive_stats = parser.store();
+        REQUIRE((1 == archive_stats.size()));
+    }
+
+    auto extracted_json_path = extract(1, 1);
+
+    compare(extracted_json_path);
+}
+
+TEST_CASE("clp-s-compress-extract-no-floats-concurrent", "[clp-s][end-to-end]") {
+    constexpr size_t cNumArchives{4};
+    constexpr auto cDefaultTargetEncodedSize{8ULL * 1024 * 1024 * 1024};  // 8 GiB
+    constexpr auto cDefaultMaxDocumentSize{512ULL * 1024 * 1024};  // 512 MiB
+    constexpr auto cDefaultMinTableSize{1ULL * 1024 * 1024};  // 1 MiB
+    constexpr auto cDefaultCompressionLevel{3};
+    auto parallelism = GENERATE_COPY(2ULL, cNumArchives, 8ULL);
+    auto num_threads = GENERATE(1ULL, 4ULL);
+    auto single_file_archive = GENERATE(true, false);
+
+    TestOutputCleaner const test_cleanup{
+            {std::string{cTestEndToEndArchiveDirectory},
+             std::string{cTestEndToEndOutputDirectory},
+             std::string{cTestEndToEndOutputSortedJson},
+             std::string{cTestEndToEndSplitInputDirectory}}
+    };
+
+    std::filesystem::create_directory(cTestEndToEndArchiveDirectory);
+    REQUIRE(std::filesystem::is_directory(cTestEndToEndArchiveDirectory));
+
+    clp_s::JsonParserOption parser_option{};
+    parser_option.input_paths = split_test_input(cNumArchives);
+    parser_option.archives_dir = cTestEndToEndArchiveDirectory;
+    parser_option.target_encoded_size = cDefaultTargetEncodedSize;
+    parser_option.max_document_size = cDefaultMaxDocumentSize;
+    parser_option.min_table_size = cDefaultMinTableSize;
+    parser_option.compression_level = cDefaultCompressionLevel;
+    parser_option.single_file_archive = single_file_archive;
+    parser_option.num_threads = cNumArchives;
+    clp_s::ParallelJsonParser parser{parser_option};
+    REQUIRE(parser.parse());
+    REQUIRE((cNumArchives == parser.store().size()));
+
+    // The archives are extracted concurrently into the same file
+    auto extracted_json_path = extract(num_threads, parallelism);
 
     compare(extracted_json_path);
 }
+
+TEST_CASE("clp-s-compress-extract-no-floats-ordered", "[clp-s][end-to-end]") {
+    // A limit of 1 B releases every other table whenever a table is decompressed, while a limit of
+    // 0 never releases tables before they're drained.
+    auto max_ordered_memory_usage = GENERATE(0ULL, 1ULL);
+    // A target chunk size of 1 B extracts every record into its own chunk
+    auto target_ordered_chunk_size = GENERATE(0ULL, 1ULL);
+    auto num_threads = GENERATE(1ULL, 4ULL);
+    auto separate_columns_table_size = GENERATE(0ULL, 1ULL);
+    auto single_file_archive = GENERATE(true, false);
+
+    TestOutputCleaner const test_cleanup{
+            {std::string{cTestEndToEndArchiveDirectory},
+             std::string{cTestEndToEndOutputDirectory},
+             std::string{cTestEndToEndOutputSortedJson}}
+    };
+
+    REQUIRE_NOTHROW(
+            std::ignore = compress_archive(
+                    get_test_input_local_path(),
+                    std::string{cTestEndToEndArchiveDirectory},
+                    single_file_archive,
+                    false,
+                    clp_s::FileType::Json,
+                    separate_columns_table_size
+            )
+    );
+
+    auto extracted_json_paths
+            = extract_in_order(max_ordered_memory_usage, num_threads, target_ordered_chunk_size);
+
+    compare_in_order(extracted_json_paths);
+}
@@ -0,0 +1,80 @@
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "../src/clp_s/BufferViewReader.hpp"
+#include "../src/clp_s/FloatEncoding.hpp"
+
+namespace {
+/**
+ * Encodes values, checks that they're encoded with the expected encoding, and then checks that
+ * they decode back to the same bits without leaving any bytes unread.
+ * @param values
+ * @param expected_encoding
+ */
+void check_round_trip(std::vector<double> const& values, clp_s::FloatEncoding expected_encoding);
+
+void check_round_trip(std::vector<double> const& values, clp_s::FloatEncoding expected_encoding) {
+    std::vector<char> buffer;
+    clp_s::encode_floats(values, buffer);
+    REQUIRE(false == buffer.empty());
+    REQUIRE(expected_encoding == static_cast<clp_s::FloatEncoding>(buffer.front()));
+
+    std::vector<double> decoded_values(values.size());
+    clp_s::BufferViewReader reader{buffer.data(), buffer.size()};
+    clp_s::decode_floats(reader, decoded_values);
+    REQUIRE(0 == reader.get_remaining_size());
+    for (size_t i{0}; i < values.size(); ++i) {
+        REQUIRE(std::bit_cast<uint64_t>(values[i]) == std::bit_cast<uint64_t>(decoded_values[i]));
+    }
+}
+}  // namespace
+
+TEST_CASE("clp-s-float-encoding", "[clp-s][float-encoding]") {
+    SECTION("Empty") {
+        check_round_trip({}, clp_s::FloatEncoding::Plain);
+    }
+
+    SECTION("Two decimal places") {
+        std::vector<double> values;
+        for (int i{0}; i < 1000; ++i) {
+            values.push_back(static_cast<double>((i * 7919) % 100'000) / 100);
+        }
+        check_round_trip(values, clp_s::FloatEncoding::Decimal);
+    }
+
+    SECTION("Whole numbers") {
+        std::vector<double> values;
+        for (int i{0}; i < 1000; ++i) {
+            values.push_back(-500.0 + i);
+        }
+        check_round_trip(values, clp_s::FloatEncoding::Decimal);
+    }
+
+    SECTION("Exceptions") {
+        std::vector<double> values;
+        for (int i{0}; i < 1000; ++i) {
+            values.push_back(static_cast<double>(i % 250) / 10);
+        }
+        values[0] = std::numeric_limits<double>::quiet_NaN();
+        values[1] = -0.0;
+        values[500] = std::numeric_limits<double>::infinity();
+        values[501] = -std::numeric_limits<double>::infinity();
+        values[502] = 1.0 / 3;
+        values[999] = std::numeric_limits<double>::max();
+        check_round_trip(values, clp_s::FloatEncoding::Decimal);
+    }
+
+    SECTION("Full precision") {
+        std::vector<double> values;
+        for (int i{1}; i <= 1000; ++i) {
+            values.push_back(std::sqrt(static_cast<double>(i)));
+        }
+        check_round_trip(values, clp_s::FloatEncoding::Plain);
+    }
+}
@@ -0,0 +1,125 @@
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "../src/clp_s/BufferViewReader.hpp"
+#include "../src/clp_s/IntegerEncoding.hpp"
+
+namespace {
+/**
+ * Encodes values, checks that they're encoded with the expected encoding, and then checks that
+ * they decode back to the same values without leaving any bytes unread.
+ * @param values
+ * @param expected_encoding
+ */
+void check_round_trip(std::vector<int64_t> const& values, clp_s::IntegerEncoding expected_encoding);
+
+void
+check_round_trip(std::vector<int64_t> const& values, clp_s::IntegerEncoding expected_encoding) {
+    std::vector<char> buffer;
+    clp_s::encode_integers(values, buffer);
+    REQUIRE(false == buffer.empty());
+    REQUIRE(expected_encoding == static_cast<clp_s::IntegerEncoding>(buffer.front()));
+
+    std::vector<int64_t> decoded_values(values.size());
+    clp_s::BufferViewReader reader{buffer.data(), buffer.size()};
+    clp_s::decode_integers(reader, decoded_values);
+    REQUIRE(0 == reader.get_remaining_size());
+    REQUIRE(values == decoded_values);
+}
+}  // namespace
+
+TEST_CASE("clp-s-integer-encoding", "[clp-s][integer-encoding]") {
+    constexpr auto cMin{std::numeric_limits<int64_t>::min()};
+    constexpr auto cMax{std::numeric_limits<int64_t>::max()};
+
+    SECTION("Empty") {
+        check_round_trip({}, clp_s::IntegerEncoding::Plain);
+    }
+
+    SECTION("Constant") {
+        check_round_trip(std::vector<int64_t>(1000, -7), clp_s::IntegerEncoding::BitPacked);
+    }
+
+    SECTION("Small range") {
+        std::vector<int64_t> values;
+        for (int64_t i{0}; i < 1000; ++i) {
+            values.push_back(200 + (i * 37) % 400);
+        }
+        check_round_trip(values, clp_s::IntegerEncoding::BitPacked);
+    }
+
+    SECTION("Bit widths that straddle words") {
+        std::vector<int64_t> const ranges{1, 2, 5, 100, 1'000'000, int64_t{1} << 40};
+        for (auto const range : ranges) {
+            std::vector<int64_t> values;
+            for (int64_t i{0}; i < 129; ++i) {
+                values.push_back(-range / 2 + (i * 7919) % (range + 1));
+            }
+            values.push_back(-range / 2);
+            values.push_back(-range / 2 + range);
+            check_round_trip(values, clp_s::IntegerEncoding::BitPacked);
+        }
+    }
+
+    SECTION("Long runs") {
+        std::vector<int64_t> values;
+        for (int64_t value : {cMin, int64_t{0}, cMax, int64_t{42}}) {
+            values.insert(values.end(), 500, value);
+        }
+        check_round_trip(values, clp_s::IntegerEncoding::RunLength);
+    }
+
+    SECTION("Full range") {
+        std::vector<int64_t> values{cMin, cMax, 0, -1, 1, cMin + 1, cMax - 1};
+        check_round_trip(values, clp_s::IntegerEncoding::Plain);
+    }
+
+    SECTION("Delta of delta") {
+        std::vector<int64_t> timestamps;
+        int64_t timestamp{1'700'000'000'000};
+        for (int64_t i{0}; i < 1000; ++i) {
+            timestamp += 1000 + (i * 7919) % 13 - 6;
+            timestamps.push_back(timestamp);
+        }
+        std::vector<std::vector<int64_t>> const values_list{
+                {},
+                {cMin},
+                {cMax, cMin},
+                {cMin, cMax, cMin, 0, cMax},
+                timestamps
+        };
+        for (auto const& values : values_list) {
+            std::vector<char> buffer;
+            clp_s::encode_delta_of_delta_integers(values, buffer);
+
+            std::vector<int64_t> decoded_values(values.size());
+            clp_s::BufferViewReader reader{buffer.data(), buffer.size()};
+            clp_s::decode_delta_of_delta_integers(reader, decoded_values);
+            REQUIRE(0 == reader.get_remaining_size());
+            REQUIRE(values == decoded_values);
+        }
+
+        // The timestamps' deltas of deltas fit in a few bits
+        std::vector<char> buffer;
+        clp_s::encode_delta_of_delta_integers(timestamps, buffer);
+        REQUIRE(buffer.size() < timestamps.size());
+    }
+
+    SECTION("Truncated") {
+        std::vector<int64_t> const values(100, 3);
+        std::vector<char> buffer;
+        clp_s::encode_integers(values, buffer);
+        buffer.pop_back();
+
+        std::vector<int64_t> decoded_values(values.size());
+        clp_s::BufferViewReader reader{buffer.data(), buffer.size()};
+        REQUIRE_THROWS_AS(
+                clp_s::decode_integers(reader, decoded_values),
+                clp_s::BufferViewReader::OperationFailed
+        );
+    }
+}
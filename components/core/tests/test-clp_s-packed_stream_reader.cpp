@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "../src/clp_s/archive_constants.hpp"
+#include "../src/clp_s/ArchiveReaderAdaptor.hpp"
+#include "../src/clp_s/ErrorCode.hpp"
+#include "../src/clp_s/InputConfig.hpp"
+#include "../src/clp_s/PackedStreamReader.hpp"
+#include "../src/clp_s/ZstdDecompressor.hpp"
+#include "clp_s_test_utils.hpp"
+#include "TestOutputCleaner.hpp"
+
+constexpr std::string_view cTestPackedStreamReaderArchiveDirectory{
+        "test-clp-s-packed-stream-reader-archive"
+};
+constexpr std::string_view cTestInputFileDirectory{"test_log_files"};
+constexpr std::string_view cTestInputFile{"test_search.jsonl"};
+
+namespace {
+auto get_test_input_local_path() -> std::string;
+
+/**
+ * Compresses the test input file into a multi-file archive that stores every table as separate
+ * columns, so that the archive has a stream per column.
+ * @return The path of the archive
+ */
+auto compress_test_archive() -> std::string;
+
+/**
+ * Reads the stream metadata of an archive and opens its packed streams.
+ * @param archive_path
+ * @param reader
+ */
+void open_packed_streams(std::string const& archive_path, clp_s::PackedStreamReader& reader);
+
+/**
+ * Reads every stream of an archive in order without prefetching.
+ * @param archive_path
+ * @return The contents of each stream
+ */
+auto read_streams(std::string const& archive_path) -> std::vector<std::vector<char>>;
+
+/**
+ * @param num_streams
+ * @return The IDs of every stream in an archive with `num_streams` streams
+ */
+auto get_stream_ids(size_t num_streams) -> std::vector<size_t>;
+
+/**
+ * Reads a stream and checks that it has the expected contents.
+ * @param reader
+ * @param stream_id
+ * @param expected_streams The contents of each stream
+ */
+void check_stream(
+        clp_s::PackedStreamReader& reader,
+        size_t stream_id,
+        std::vector<std::vector<char>> const& expected_streams
+);
+
+auto get_test_input_local_path() -> std::string {
+    std::filesystem::path const current_file_path{__FILE__};
+    auto const tests_dir{current_file_path.parent_path()};
+    return (tests_dir / cTestInputFileDirectory / cTestInputFile).string();
+}
+
+auto compress_test_archive() -> std::string {
+    // A separate columns table size of 1 B stores every table as separate columns.
+    auto const archive_stats = compress_archive(
+            get_test_input_local_path(),
+            std::string{cTestPackedStreamReaderArchiveDirectory},
+            false,
+            false,
+            clp_s::FileType::Json,
+            1
+    );
+    REQUIRE(1 == archive_stats.size());
+    return (std::filesystem::path{cTestPackedStreamReaderArchiveDirectory}
+            / archive_stats.front().get_id())
+            .string();
+}
+
+void open_packed_streams(std::string const& archive_path, clp_s::PackedStreamReader& reader) {
+    constexpr size_t cDecompressorFileReadBufferCapacity = 64 * 1024;  // 64 KB
+    auto adaptor = std::make_shared<clp_s::ArchiveReaderAdaptor>(
+            clp_s::Path{.source{clp_s::InputSource::Filesystem}, .path{archive_path}},
+            clp_s::NetworkAuthOption{}
+    );
+    REQUIRE(clp_s::ErrorCodeSuccess == adaptor->load_archive_metadata());
+
+    auto table_metadata_reader
+            = adaptor->checkout_reader_for_section(clp_s::constants::cArchiveTableMetadataFile);
+    clp_s::ZstdDecompressor decompressor;
+    decompressor.open(*table_metadata_reader, cDecompressorFileReadBufferCapacity);
+    reader.read_metadata(decompressor);
+    decompressor.close();
+    adaptor->checkin_reader_for_section(clp_s::constants::cArchiveTableMetadataFile);
+
+    reader.open_packed_streams(adaptor);
+}
+
+auto read_streams(std::string const& archive_path) -> std::vector<std::vector<char>> {
+    clp_s::PackedStreamReader reader;
+    open_packed_streams(archive_path, reader);
+
+    std::vector<std::vector<char>> streams;
+    std::shared_ptr<char[]> buf;
+    size_t buf_size{0};
+    for (size_t stream_id{0}; stream_id < reader.get_num_streams(); ++stream_id) {
+        reader.read_stream(stream_id, buf, buf_size);
+        streams.emplace_back(buf.get(), buf.get() + reader.get_uncompressed_stream_size(stream_id));
+    }
+    reader.close();
+    return streams;
+}
+
+auto get_stream_ids(size_t num_streams) -> std::vector<size_t> {
+    std::vector<size_t> stream_ids(num_streams);
+    std::iota(stream_ids.begin(), stream_ids.end(), 0);
+    return stream_ids;
+}
+
+void check_stream(
+        clp_s::PackedStreamReader& reader,
+        size_t stream_id,
+        std::vector<std::vector<char>> const& expected_streams
+) {
+    std::shared_ptr<char[]> buf;
+    size_t buf_size{0};
+    REQUIRE_NOTHROW(reader.read_stream(stream_id, buf, buf_size));
+    auto const& expected_stream = expected_streams.at(stream_id);
+    REQUIRE(expected_stream.size() == buf_size);
+    REQUIRE(std::equal(expected_stream.begin(), expected_stream.end(), buf.get()));
+}
+}  // namespace
+
+TEST_CASE("clp-s-packed-stream-reader-prefetching", "[clp-s][packed-stream-reader]") {
+    TestOutputCleaner const test_cleanup{{std::string{cTestPackedStreamReaderArchiveDirectory}}};
+    std::string archive_path;
+    REQUIRE_NOTHROW(archive_path = compress_test_archive());
+
+    // Prefetched streams must match the streams read without prefetching
+    std::vector<std::vector<char>> expected_streams;
+    REQUIRE_NOTHROW(expected_streams = read_streams(archive_path));
+    REQUIRE(expected_streams.size() > 4);
+    auto const stream_ids = get_stream_ids(expected_streams.size());
+
+    SECTION("Read every stream") {
+        std::vector<std::pair<size_t, size_t>> const prefetching_options{
+                {1, 1},
+                {2, 1},
+                {4, 2},
+                {4, expected_streams.size()}
+        };
+        for (auto const& [num_threads, max_num_prefetched_streams] : prefetching_options) {
+            CAPTURE(num_threads, max_num_prefetched_streams);
+            clp_s::PackedStreamReader reader;
+            open_packed_streams(archive_path, reader);
+            reader.enable_prefetching(stream_ids, num_threads, max_num_prefetched_streams);
+            for (auto const stream_id : stream_ids) {
+                check_stream(reader, stream_id, expected_streams);
+            }
+            reader.close();
+        }
+    }
+
+    SECTION("Skip streams") {
+        std::vector<size_t> every_other_stream_id;
+        for (size_t stream_id{0}; stream_id < stream_ids.size(); stream_id += 2) {
+            every_other_stream_id.push_back(stream_id);
+        }
+        std::vector<std::vector<size_t>> const stream_ids_to_read{
+                every_other_stream_id,
+                {0, stream_ids.back()},
+                {stream_ids.back()}
+        };
+        for (auto const max_num_prefetched_streams : {size_t{1}, size_t{4}}) {
+            for (auto const& ids_to_read : stream_ids_to_read) {
+                CAPTURE(max_num_prefetched_streams, ids_to_read);
+                clp_s::PackedStreamReader reader;
+                open_packed_streams(archive_path, reader);
+                reader.enable_prefetching(stream_ids, 4, max_num_prefetched_streams);
+                // Streams are read as soon as prefetching starts, so the streams they skip are
+                // usually still being decompressed when they're skipped. This can't be guaranteed
+                // without a hook into the prefetching threads, so both cases are exercised.
+                for (auto const stream_id : ids_to_read) {
+                    check_stream(reader, stream_id, expected_streams);
+                }
+                reader.close();
+            }
+        }
+    }
+
+    SECTION("Read error") {
+        // Overwrite the zstd magic number at the beginning of the first stream
+        {
+            std::fstream tables_file{
+                    archive_path + clp_s::constants::cArchiveTablesFile,
+                    std::ios::in | std::ios::out | std::ios::binary
+            };
+            REQUIRE(tables_file.is_open());
+            std::string const corrupt_bytes(4, '\0');
+            tables_file.write(
+                    corrupt_bytes.data(),
+                    static_cast<std::streamsize>(corrupt_bytes.size())
+            );
+            REQUIRE(tables_file.good());
+        }
+
+        // The error must only be thrown when reading the corrupt stream, and must not affect any
+        // other stream
+        for (auto const read_corrupt_stream : {true, false}) {
+            CAPTURE(read_corrupt_stream);
+            clp_s::PackedStreamReader reader;
+            open_packed_streams(archive_path, reader);
+            reader.enable_prefetching(stream_ids, 2, 2);
+            if (read_corrupt_stream) {
+                std::shared_ptr<char[]> buf;
+                size_t buf_size{0};
+                REQUIRE_THROWS_AS(
+                        reader.read_stream(0, buf, buf_size),
+                        clp_s::PackedStreamReader::OperationFailed
+                );
+            }
+            for (size_t stream_id{1}; stream_id < stream_ids.size(); ++stream_id) {
+                check_stream(reader, stream_id, expected_streams);
+            }
+            reader.close();
+        }
+    }
+
+    SECTION("Close while prefetching threads are waiting") {
+        // With room for a single prefetched stream that's never read, every prefetching thread
+        // ends up waiting for a stream to be read
+        constexpr auto cPrefetchWaitTime{std::chrono::milliseconds{50}};
+        clp_s::PackedStreamReader reader;
+        open_packed_streams(archive_path, reader);
+        reader.enable_prefetching(stream_ids, 4, 1);
+        std::this_thread::sleep_for(cPrefetchWaitTime);
+        REQUIRE_NOTHROW(reader.close());
+
+        // The reader must be reusable after closing
+        open_packed_streams(archive_path, reader);
+        reader.enable_prefetching(stream_ids, 4, 1);
+        for (auto const stream_id : stream_ids) {
+            check_stream(reader, stream_id, expected_streams);
+        }
+        reader.close();
+    }
+}
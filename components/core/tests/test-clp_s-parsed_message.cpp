@@ -0,0 +1,83 @@
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "../src/clp_s/ParsedMessage.hpp"
+
+TEST_CASE("clp-s-parsed-message", "[clp-s][parsed-message]") {
+    clp_s::ParsedMessage message;
+
+    SECTION("String values stay valid as blocks are added and reused") {
+        // Each record's values fill several blocks, and the second record reuses the first
+        // record's blocks
+        constexpr size_t cValueSize{1000};
+        constexpr size_t cNumValues{3 * clp_s::ParsedMessage::cStringBlockSize / cValueSize};
+        for (char const fill : {'a', 'b'}) {
+            CAPTURE(fill);
+            std::vector<std::string> values;
+            for (size_t i{0}; i < cNumValues; ++i) {
+                values.emplace_back(std::to_string(i) + std::string(cValueSize, fill));
+                message.add_value(static_cast<int32_t>(i), std::string_view{values.back()});
+                message.add_unordered_value(std::string_view{values.back()});
+            }
+
+            auto const& content = message.get_content();
+            auto const& unordered_content = message.get_unordered_content();
+            REQUIRE(cNumValues == content.size());
+            REQUIRE(cNumValues == unordered_content.size());
+            for (size_t i{0}; i < cNumValues; ++i) {
+                REQUIRE(static_cast<int32_t>(i) == content[i].first);
+                REQUIRE(values[i] == std::get<std::string_view>(content[i].second));
+                REQUIRE(values[i] == std::get<std::string_view>(unordered_content[i]));
+            }
+            message.clear();
+        }
+    }
+
+    SECTION("String values larger than a block") {
+        std::string const small_value{"small"};
+        std::string const large_value(2 * clp_s::ParsedMessage::cStringBlockSize + 1, 'x');
+        message.add_value(0, std::string_view{small_value});
+        message.add_value(1, std::string_view{large_value});
+        message.add_value(2, std::string_view{small_value});
+        message.add_unordered_value(std::string_view{large_value});
+
+        auto const& content = message.get_content();
+        REQUIRE(3 == content.size());
+        REQUIRE(small_value == std::get<std::string_view>(content[0].second));
+        REQUIRE(large_value == std::get<std::string_view>(content[1].second));
+        REQUIRE(small_value == std::get<std::string_view>(content[2].second));
+        REQUIRE(1 == message.get_unordered_content().size());
+        REQUIRE(large_value
+                == std::get<std::string_view>(message.get_unordered_content().front()));
+    }
+
+    SECTION("Values are sorted by node ID and the first value for a node ID is kept") {
+        message.add_value(3, int64_t{1});
+        message.add_value(1, std::string_view{"first"});
+        message.add_value(3, int64_t{2});
+        message.add_value(2, true);
+        message.add_value(1, std::string_view{"second"});
+
+        auto const& content = message.get_content();
+        REQUIRE(3 == content.size());
+        REQUIRE(1 == content[0].first);
+        REQUIRE("first" == std::get<std::string_view>(content[0].second));
+        REQUIRE(2 == content[1].first);
+        REQUIRE(std::get<bool>(content[1].second));
+        REQUIRE(3 == content[2].first);
+        REQUIRE(1 == std::get<int64_t>(content[2].second));
+
+        // A value for a node that's already in the message is ignored even if it arrives in order
+        message.clear();
+        message.add_value(1, int64_t{1});
+        message.add_value(1, int64_t{2});
+        REQUIRE(1 == message.get_content().size());
+        REQUIRE(1 == std::get<int64_t>(message.get_content().front().second));
+    }
+}
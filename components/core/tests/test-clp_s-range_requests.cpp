@@ -0,0 +1,291 @@
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+#include <fmt/format.h>
+
+#include "../src/clp_s/ArchiveReader.hpp"
+#include "../src/clp_s/InputConfig.hpp"
+#include "../src/clp_s/NetworkRangeFetcher.hpp"
+#include "clp_s_test_utils.hpp"
+#include "TestOutputCleaner.hpp"
+
+constexpr std::string_view cTestRangeRequestsArchiveDirectory{"test-range-requests-archive"};
+constexpr std::string_view cTestRangeRequestsInputFileDirectory{"test_log_files"};
+constexpr std::string_view cTestRangeRequestsInputFile{"test_search.jsonl"};
+
+namespace {
+/**
+ * A minimal HTTP server serving a single file from memory on the loopback interface, which
+ * supports single range requests and records how many requests it served and how many bytes it
+ * sent.
+ */
+class LocalHttpServer {
+public:
+    // Constructors
+    explicit LocalHttpServer(std::string contents);
+
+    // Disable copy/move constructors/assignment operators
+    LocalHttpServer(LocalHttpServer const&) = delete;
+    LocalHttpServer(LocalHttpServer&&) = delete;
+    auto operator=(LocalHttpServer const&) -> LocalHttpServer& = delete;
+    auto operator=(LocalHttpServer&&) -> LocalHttpServer& = delete;
+
+    // Destructor
+    ~LocalHttpServer();
+
+    // Methods
+    [[nodiscard]] auto get_url(std::string_view file_name) const -> std::string {
+        return fmt::format("http://127.0.0.1:{}/{}", m_port, file_name);
+    }
+
+    [[nodiscard]] auto get_num_requests() const -> size_t { return m_num_requests; }
+
+    [[nodiscard]] auto get_num_bytes_sent() const -> size_t { return m_num_bytes_sent; }
+
+private:
+    void serve();
+
+    void handle_connection(int connection_fd);
+
+    std::string m_contents;
+    int m_listen_fd{-1};
+    uint16_t m_port{0};
+    std::atomic_size_t m_num_requests{0};
+    std::atomic_size_t m_num_bytes_sent{0};
+    std::thread m_thread;
+};
+
+auto get_test_input_local_path() -> std::string;
+auto read_file(std::string const& path) -> std::string;
+auto read_all_messages(clp_s::Path const& archive_path) -> std::vector<std::string>;
+
+LocalHttpServer::LocalHttpServer(std::string contents) : m_contents{std::move(contents)} {
+    m_listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(-1 != m_listen_fd);
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    REQUIRE(0 == bind(m_listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)));
+    REQUIRE(0 == listen(m_listen_fd, SOMAXCONN));
+
+    socklen_t address_size{sizeof(address)};
+    REQUIRE(0 == getsockname(m_listen_fd, reinterpret_cast<sockaddr*>(&address), &address_size));
+    m_port = ntohs(address.sin_port);
+
+    m_thread = std::thread{[this]() { serve(); }};
+}
+
+LocalHttpServer::~LocalHttpServer() {
+    // Shutting down the socket makes the blocked `accept` call fail
+    shutdown(m_listen_fd, SHUT_RDWR);
+    m_thread.join();
+    close(m_listen_fd);
+}
+
+void LocalHttpServer::serve() {
+    while (true) {
+        auto const connection_fd{accept(m_listen_fd, nullptr, nullptr)};
+        if (-1 == connection_fd) {
+            return;
+        }
+        handle_connection(connection_fd);
+        close(connection_fd);
+    }
+}
+
+void LocalHttpServer::handle_connection(int connection_fd) {
+    std::string request;
+    char buf[4096];
+    while (std::string::npos == request.find("\r\n\r\n")) {
+        auto const num_bytes_received{recv(connection_fd, buf, sizeof(buf), 0)};
+        if (num_bytes_received <= 0) {
+            return;
+        }
+        request.append(buf, num_bytes_received);
+    }
+    ++m_num_requests;
+
+    std::transform(request.begin(), request.end(), request.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    std::string header;
+    std::string_view body{m_contents};
+    constexpr std::string_view cRangeHeaderPrefix{"range: bytes="};
+    if (auto const pos{request.find(cRangeHeaderPrefix)}; std::string::npos != pos) {
+        auto const range_begin{pos + cRangeHeaderPrefix.size()};
+        auto const range_separator{request.find('-', range_begin)};
+        auto const range_end{request.find("\r\n", range_separator)};
+        size_t const begin{std::stoull(request.substr(range_begin, range_separator - range_begin))};
+        size_t last{m_contents.size() - 1};
+        if (range_separator + 1 != range_end) {
+            auto const last_str{
+                    request.substr(range_separator + 1, range_end - range_separator - 1)
+            };
+            last = std::min<size_t>(last, std::stoull(last_str));
+        }
+        if (begin >= m_contents.size() || begin > last) {
+            header = "HTTP/1.1 416 Range Not Satisfiable\r\nContent-Length: 0\r\n";
+            body = {};
+        } else {
+            body = body.substr(begin, last - begin + 1);
+            header = fmt::format(
+                    "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes {}-{}/{}\r\n"
+                    "Content-Length: {}\r\n",
+                    begin,
+                    last,
+                    m_contents.size(),
+                    body.size()
+            );
+        }
+    } else {
+        header = fmt::format("HTTP/1.1 200 OK\r\nContent-Length: {}\r\n", body.size());
+    }
+    header += "Connection: close\r\n\r\n";
+
+    auto const response{header + std::string{body}};
+    size_t num_bytes_sent{0};
+    while (num_bytes_sent < response.size()) {
+        auto const rc{send(
+                connection_fd,
+                response.data() + num_bytes_sent,
+                response.size() - num_bytes_sent,
+                MSG_NOSIGNAL
+        )};
+        if (rc <= 0) {
+            break;
+        }
+        num_bytes_sent += static_cast<size_t>(rc);
+    }
+    m_num_bytes_sent += body.size();
+}
+
+auto get_test_input_local_path() -> std::string {
+    std::filesystem::path const current_file_path{__FILE__};
+    auto const tests_dir{current_file_path.parent_path()};
+    return (tests_dir / cTestRangeRequestsInputFileDirectory / cTestRangeRequestsInputFile)
+            .string();
+}
+
+auto read_file(std::string const& path) -> std::string {
+    std::ifstream file{path, std::ios::binary};
+    REQUIRE(file.is_open());
+    return {std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+}
+
+auto read_all_messages(clp_s::Path const& archive_path) -> std::vector<std::string> {
+    clp_s::ArchiveReader archive_reader;
+    archive_reader.open(archive_path, clp_s::NetworkAuthOption{});
+    archive_reader.read_dictionaries_and_metadata();
+    archive_reader.open_packed_streams();
+
+    std::vector<std::string> messages;
+    std::string message;
+    for (auto const& table : archive_reader.read_all_tables()) {
+        while (table->get_next_message(message)) {
+            messages.push_back(message);
+        }
+    }
+    archive_reader.close();
+
+    std::sort(messages.begin(), messages.end());
+    return messages;
+}
+}  // namespace
+
+TEST_CASE("clp-s-network-range-fetcher", "[clp-s][range-requests]") {
+    constexpr size_t cContentsSize{1024ULL * 1024};
+    std::string contents(cContentsSize, '\0');
+    for (size_t i{0}; i < contents.size(); ++i) {
+        contents[i] = static_cast<char>('a' + i % 26 + i / 26 % 7);
+    }
+    LocalHttpServer server{contents};
+
+    clp_s::NetworkRangeFetcher const fetcher{server.get_url("file"), 4, 0};
+    std::vector<clp_s::NetworkRangeFetcher::ByteRange> const ranges{
+            {100, 200},
+            {10, 20},
+            {20, 30},
+            {5000, 5000},
+            {900'000, cContentsSize}
+    };
+    std::vector<std::vector<char>> fetched_ranges;
+    REQUIRE_NOTHROW(fetched_ranges = fetcher.fetch(ranges));
+    REQUIRE(fetched_ranges.size() == ranges.size());
+    for (size_t i{0}; i < ranges.size(); ++i) {
+        auto const& range{ranges[i]};
+        REQUIRE(std::string_view{fetched_ranges[i].data(), fetched_ranges[i].size()}
+                == std::string_view{contents}.substr(range.begin, range.end - range.begin));
+    }
+    // The adjacent ranges are coalesced and the empty range isn't requested
+    REQUIRE(3 == server.get_num_requests());
+
+    // Ranges separated by a small gap are coalesced
+    clp_s::NetworkRangeFetcher const coalescing_fetcher{server.get_url("file"), 4, 1000};
+    REQUIRE_NOTHROW(std::ignore = coalescing_fetcher.fetch({{0, 10}, {500, 600}, {1200, 1300}}));
+    REQUIRE(4 == server.get_num_requests());
+
+    REQUIRE_THROWS(std::ignore = fetcher.fetch({{20, 10}}));
+    REQUIRE_THROWS(std::ignore = fetcher.fetch({{cContentsSize - 10, cContentsSize + 10}}));
+}
+
+TEST_CASE("clp-s-remote-archive", "[clp-s][range-requests]") {
+    TestOutputCleaner const test_cleanup{{std::string{cTestRangeRequestsArchiveDirectory}}};
+    REQUIRE_NOTHROW(
+            std::ignore = compress_archive(
+                    get_test_input_local_path(),
+                    std::string{cTestRangeRequestsArchiveDirectory},
+                    true,
+                    false,
+                    clp_s::FileType::Json
+            )
+    );
+
+    std::vector<std::filesystem::path> archive_paths;
+    for (auto const& entry :
+         std::filesystem::directory_iterator{cTestRangeRequestsArchiveDirectory})
+    {
+        archive_paths.push_back(entry.path());
+    }
+    REQUIRE(1 == archive_paths.size());
+    auto const& archive_path{archive_paths.front()};
+    auto const archive_contents{read_file(archive_path.string())};
+    LocalHttpServer server{archive_contents};
+    clp_s::Path const remote_archive_path{
+            .source{clp_s::InputSource::Network},
+            .path{server.get_url(archive_path.filename().string())}
+    };
+
+    // Reading the whole archive over the network must give the same records as reading it locally
+    clp_s::Path const local_archive_path{
+            .source{clp_s::InputSource::Filesystem},
+            .path{archive_path.string()}
+    };
+    REQUIRE(read_all_messages(remote_archive_path) == read_all_messages(local_archive_path));
+
+    // Opening the archive and reading its table metadata mustn't fetch the tables
+    auto const num_bytes_sent_before_open{server.get_num_bytes_sent()};
+    clp_s::ArchiveReader archive_reader;
+    REQUIRE_NOTHROW(archive_reader.open(remote_archive_path, clp_s::NetworkAuthOption{}));
+    REQUIRE_NOTHROW(archive_reader.read_metadata());
+    archive_reader.close();
+    REQUIRE(server.get_num_bytes_sent() - num_bytes_sent_before_open < archive_contents.size());
+}
@@ -1,11 +1,22 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -14,9 +25,11 @@
 #include <nlohmann/json.hpp>
 
 #include "../src/clp_s/archive_constants.hpp"
+#include "../src/clp_s/ArchiveMetadataCache.hpp"
 #include "../src/clp_s/ArchiveReader.hpp"
 #include "../src/clp_s/InputConfig.hpp"
 #include "../src/clp_s/OutputHandlerImpl.hpp"
+#include "../src/clp_s/SchemaReader.hpp"
 #include "../src/clp_s/search/ast/ColumnDescriptor.hpp"
 #include "../src/clp_s/search/ast/ConvertToExists.hpp"
 #include "../src/clp_s/search/ast/EmptyExpr.hpp"
@@ -30,8 +43,10 @@
 #include "../src/clp_s/search/EvaluateTimestampIndex.hpp"
 #include "../src/clp_s/search/kql/kql.hpp"
 #include "../src/clp_s/search/Output.hpp"
+#include "../src/clp_s/search/OutputHandler.hpp"
 #include "../src/clp_s/search/Projection.hpp"
 #include "../src/clp_s/search/SchemaMatch.hpp"
+#include "../src/clp_s/search/TopKTimestamps.hpp"
 #include "../src/clp_s/Utils.hpp"
 #include "clp_s_test_utils.hpp"
 #include "TestOutputCleaner.hpp"
@@ -40,23 +55,300 @@ constexpr std::string_view cTestSearchArchiveDirectory{"test-clp-s-search-archiv
 constexpr std::string_view cTestInputFileDirectory{"test_log_files"};
 constexpr std::string_view cTestSearchInputFile{"test_search.jsonl"};
 constexpr std::string_view cTestIdxKey{"idx"};
+constexpr std::string_view cTestTopKInputFile{"test-clp-s-search-top-k.jsonl"};
+constexpr std::string_view cTestParallelismInputFile{"test-clp-s-search-parallelism.jsonl"};
+constexpr std::string_view cTestLargeTableInputFile{"test-clp-s-search-large-table.jsonl"};
+constexpr std::string_view cTestValueRangeInputFile{"test-clp-s-search-value-range.jsonl"};
+constexpr std::string_view cTestDictionaryIdFiltersInputFile{
+        "test-clp-s-search-dictionary-id-filters.jsonl"
+};
+constexpr size_t cTestMetadataCacheSize{64ULL * 1024 * 1024};  // 64 MiB
 
 namespace {
+/**
+ * Output handler that counts results, letting the search push the count down into the tables.
+ */
+class PushdownCountOutputHandler : public clp_s::search::OutputHandler {
+public:
+    // Constructors
+    explicit PushdownCountOutputHandler(uint64_t& count)
+            : clp_s::search::OutputHandler{false, false},
+              m_count{count} {}
+
+    // Methods inherited from OutputHandler
+    void write(
+            std::string_view message,
+            clp_s::epochtime_t timestamp,
+            std::string_view archive_id,
+            int64_t log_event_idx
+    ) override {
+        ++m_count;
+    }
+
+    void write(std::string_view message) override { ++m_count; }
+
+    void add_count(uint64_t count) override { m_count += count; }
+
+    [[nodiscard]] auto get_pushdown_aggregation() const -> PushdownAggregation override {
+        return PushdownAggregation::Count;
+    }
+
+private:
+    uint64_t& m_count;
+};
+
+/**
+ * Output handler that counts results by timestamp, letting the search push the count down into the
+ * tables.
+ */
+class PushdownCountByTimeOutputHandler : public clp_s::search::OutputHandler {
+public:
+    // Constructors
+    explicit PushdownCountByTimeOutputHandler(std::map<clp_s::epochtime_t, uint64_t>& counts)
+            : clp_s::search::OutputHandler{true, false},
+              m_counts{counts} {}
+
+    // Methods inherited from OutputHandler
+    void write(
+            std::string_view message,
+            clp_s::epochtime_t timestamp,
+            std::string_view archive_id,
+            int64_t log_event_idx
+    ) override {
+        ++m_counts[timestamp];
+    }
+
+    void write(std::string_view message) override {}
+
+    void add_count_by_time(clp_s::epochtime_t timestamp, uint64_t count) override {
+        m_counts[timestamp] += count;
+    }
+
+    [[nodiscard]] auto get_pushdown_aggregation() const -> PushdownAggregation override {
+        return PushdownAggregation::CountByTime;
+    }
+
+private:
+    std::map<clp_s::epochtime_t, uint64_t>& m_counts;
+};
+
+/**
+ * Output handler that keeps the results with the K latest timestamps, letting the search skip
+ * archives, tables, and results that can't have a later timestamp.
+ */
+class TopKOutputHandler : public clp_s::search::OutputHandler {
+public:
+    // Types
+    struct Stats {
+        std::multiset<clp_s::epochtime_t> kept_timestamps;
+        size_t num_writes{0};
+        size_t num_flushes{0};
+    };
+
+    // Constructors
+    TopKOutputHandler(
+            std::shared_ptr<clp_s::search::TopKTimestamps> top_k_timestamps,
+            size_t k,
+            Stats& stats
+    )
+            : clp_s::search::OutputHandler{true, true},
+              m_top_k_timestamps{std::move(top_k_timestamps)},
+              m_k{k},
+              m_stats{stats} {}
+
+    // Methods inherited from OutputHandler
+    void write(
+            std::string_view message,
+            clp_s::epochtime_t timestamp,
+            std::string_view archive_id,
+            int64_t log_event_idx
+    ) override {
+        ++m_stats.num_writes;
+        if (false == m_top_k_timestamps->add(timestamp)) {
+            return;
+        }
+        m_stats.kept_timestamps.insert(timestamp);
+        if (m_stats.kept_timestamps.size() > m_k) {
+            m_stats.kept_timestamps.erase(m_stats.kept_timestamps.begin());
+        }
+    }
+
+    void write(std::string_view message) override { ++m_stats.num_writes; }
+
+    [[nodiscard]] auto flush() -> clp_s::ErrorCode override {
+        ++m_stats.num_flushes;
+        return clp_s::ErrorCode::ErrorCodeSuccess;
+    }
+
+    [[nodiscard]] auto should_preserve_table_order() const -> bool override { return false; }
+
+    [[nodiscard]] auto get_top_k_timestamps() const
+            -> clp_s::search::TopKTimestamps const* override {
+        return m_top_k_timestamps.get();
+    }
+
+private:
+    std::shared_ptr<clp_s::search::TopKTimestamps> m_top_k_timestamps;
+    size_t m_k;
+    Stats& m_stats;
+};
+
+/**
+ * Output handler that counts results and the tables they were searched for. Tables are counted
+ * when they're flushed, which happens once for each table that's searched.
+ */
+class TableCountingOutputHandler : public clp_s::search::OutputHandler {
+public:
+    // Types
+    struct Stats {
+        uint64_t num_results{0};
+        size_t num_tables_searched{0};
+    };
+
+    // Constructors
+    explicit TableCountingOutputHandler(Stats& stats)
+            : clp_s::search::OutputHandler{false, true},
+              m_stats{stats} {}
+
+    // Methods inherited from OutputHandler
+    void write(
+            std::string_view message,
+            clp_s::epochtime_t timestamp,
+            std::string_view archive_id,
+            int64_t log_event_idx
+    ) override {
+        ++m_stats.num_results;
+    }
+
+    void write(std::string_view message) override { ++m_stats.num_results; }
+
+    [[nodiscard]] auto flush() -> clp_s::ErrorCode override {
+        ++m_stats.num_tables_searched;
+        return clp_s::ErrorCode::ErrorCodeSuccess;
+    }
+
+private:
+    Stats& m_stats;
+};
+
+/**
+ * Options for searching archives that don't affect the search results.
+ */
+struct SearchOptions {
+    size_t num_threads{1};
+    bool memory_map{false};
+    std::shared_ptr<clp_s::ArchiveMetadataCache> metadata_cache;
+    // The number of archives searched concurrently
+    size_t parallelism{1};
+};
+
+using OutputHandlerFactory = std::function<std::unique_ptr<clp_s::search::OutputHandler>()>;
+
 auto get_test_input_path_relative_to_tests_dir() -> std::filesystem::path;
 auto get_test_input_local_path() -> std::string;
 auto create_first_record_match_metadata_query() -> std::shared_ptr<clp_s::search::ast::Expression>;
-void
-search(std::string const& query, bool ignore_case, std::vector<int64_t> const& expected_results);
-void search(
+
+/**
+ * @param query
+ * @return The parsed KQL query
+ */
+auto parse_query(std::string const& query) -> std::shared_ptr<clp_s::search::ast::Expression>;
+
+/**
+ * @return Each query for the test input file and the indices of the records it matches
+ */
+auto get_queries_and_results() -> std::vector<std::pair<std::string, std::vector<int64_t>>>;
+
+/**
+ * @return The paths of the archives in the test archive directory
+ */
+auto get_archive_paths() -> std::vector<clp_s::Path>;
+
+/**
+ * Searches an archive the same way as `clp-s s`. Since Catch2 assertions aren't thread-safe, this
+ * throws rather than asserting, so that archives can be searched concurrently.
+ * @param expr The search AST, which is copied before being modified
+ * @param ignore_case
+ * @param archive_path
+ * @param create_output_handler
+ * @param options
+ * @return Whether the archive's tables' metadata was read, i.e., whether the archive wasn't skipped
+ * before its tables were considered
+ * @throw std::runtime_error if a search pass fails
+ */
+auto search_archive(
+        std::shared_ptr<clp_s::search::ast::Expression> const& expr,
+        bool ignore_case,
+        clp_s::Path const& archive_path,
+        OutputHandlerFactory const& create_output_handler,
+        SearchOptions const& options
+) -> bool;
+
+/**
+ * Searches archives the same way as `clp-s s`, writing each archive's results to a new output
+ * handler. Like `clp-s s --parallelism`, archives searched concurrently wrap their output handlers
+ * in SynchronizedOutputHandlers that share a mutex.
+ * @param expr
+ * @param ignore_case
+ * @param archive_paths
+ * @param create_output_handler
+ * @param options
+ * @return The number of archives whose tables' metadata was read, i.e., that weren't skipped
+ * before their tables were considered
+ */
+auto search_archives(
         std::shared_ptr<clp_s::search::ast::Expression> expr,
         bool ignore_case,
-        std::vector<int64_t> const& expected_results
-);
+        std::vector<clp_s::Path> const& archive_paths,
+        OutputHandlerFactory const& create_output_handler,
+        SearchOptions const& options
+) -> size_t;
+
+/**
+ * Searches the archives in the test archive directory and validates the results.
+ * @param query
+ * @param ignore_case
+ * @param expected_results
+ * @param options
+ * @return The results in the order they were written
+ */
+auto search(
+        std::string const& query,
+        bool ignore_case,
+        std::vector<int64_t> const& expected_results,
+        SearchOptions const& options = {}
+) -> std::vector<clp_s::VectorOutputHandler::QueryResult>;
+
+/**
+ * Searches the archives in the test archive directory and validates the results.
+ * @param expr
+ * @param ignore_case
+ * @param expected_results
+ * @param options
+ * @return The results in the order they were written
+ */
+auto search(
+        std::shared_ptr<clp_s::search::ast::Expression> expr,
+        bool ignore_case,
+        std::vector<int64_t> const& expected_results,
+        SearchOptions const& options = {}
+) -> std::vector<clp_s::VectorOutputHandler::QueryResult>;
+
 void validate_results(
         std::vector<clp_s::VectorOutputHandler::QueryResult> const& results,
         std::vector<int64_t> const& expected_results
 );
 
+/**
+ * Opens an archive with a metadata cache and reads its dictionaries and metadata.
+ * @param archive_path
+ * @param metadata_cache
+ */
+void open_archive(
+        clp_s::Path const& archive_path,
+        std::shared_ptr<clp_s::ArchiveMetadataCache> const& metadata_cache
+);
+
 auto get_test_input_path_relative_to_tests_dir() -> std::filesystem::path {
     return std::filesystem::path{cTestInputFileDirectory} / cTestSearchInputFile;
 }
@@ -101,6 +393,55 @@ auto create_first_record_match_metadata_query() -> std::shared_ptr<clp_s::search
     return expr;
 }
 
+auto get_queries_and_results() -> std::vector<std::pair<std::string, std::vector<int64_t>>> {
+    return {
+            {R"aa(NOT a: b)aa", {0}},
+            {R"aa(msg: "Msg 1: \"Abc123\"")aa", {1}},
+            {R"aa(msg: "Msg 2: 'Abc123'")aa", {2}},
+            {R"aa(msg: "Msg 3: \nAbc123")aa", {3}},
+            // CLP incorrectly generates no subqueries in Grep::process_raw_query for the following
+            // query, so we skip it for now.
+            //{R"aa(msg: "Msg 4: \\Abc123")aa", {4}}
+            {R"aa(msg: "Msg 5: \rAbc123")aa", {5}},
+            {R"aa(msg: "Msg 6: \tAbc123")aa", {6}},
+            {R"aa(msg: "*Abc123*")aa", {1, 2, 3, 5, 6}},
+            {R"aa(arr.b > 1000)aa", {7, 8}},
+            {R"aa(var_string: *)aa", {9}},
+            {R"aa(clp_string: *)aa", {9}},
+            {fmt::format(
+                     R"aa($_filename: "{}" AND $_file_split_number: 0 AND )aa"
+                     R"aa($_archive_creator_id: * AND idx: 0)aa",
+                     get_test_input_local_path()
+             ),
+             {0}},
+            {R"aa(idx: 0 AND NOT $_filename: "clp string")aa", {0}},
+            {R"aa(idx: 0 AND NOT $*._filename.*: "clp string")aa", {0}},
+            {R"aa(($_filename: file OR $_file_split_number: 1 OR $_archive_creator_id > 0) AND )aa"
+             R"aa(idx: 0 OR idx: 1)aa",
+             {1}},
+            {R"aa(ambiguous_varstring: "a*e")aa", {10, 11, 12}},
+            {R"aa(ambiguous_varstring: "a\*e")aa", {12}},
+            {R"aa(idx >= 10 AND idx < 12)aa", {10, 11}},
+            {R"aa(idx > 100 OR idx < 1)aa", {0}},
+            {R"aa(ambiguous_varstring: "a" OR idx: 10)aa", {10}}
+    };
+}
+
+auto parse_query(std::string const& query) -> std::shared_ptr<clp_s::search::ast::Expression> {
+    auto query_stream = std::istringstream{query};
+    return clp_s::search::kql::parse_kql_expression(query_stream);
+}
+
+auto get_archive_paths() -> std::vector<clp_s::Path> {
+    std::vector<clp_s::Path> archive_paths;
+    for (auto const& entry : std::filesystem::directory_iterator(cTestSearchArchiveDirectory)) {
+        archive_paths.push_back(
+                clp_s::Path{.source{clp_s::InputSource::Filesystem}, .path{entry.path().string()}}
+        );
+    }
+    return archive_paths;
+}
+
 void validate_results(
         std::vector<clp_s::VectorOutputHandler::QueryResult> const& results,
         std::vector<int64_t> const& expected_results
@@ -121,19 +462,24 @@ void validate_results(
     REQUIRE(results.size() == expected_results.size());
 }
 
-void
-search(std::string const& query, bool ignore_case, std::vector<int64_t> const& expected_results) {
-    REQUIRE(expected_results.size() > 0);
-    auto query_stream = std::istringstream{query};
-    auto expr = clp_s::search::kql::parse_kql_expression(query_stream);
-    search(expr, ignore_case, expected_results);
+void open_archive(
+        clp_s::Path const& archive_path,
+        std::shared_ptr<clp_s::ArchiveMetadataCache> const& metadata_cache
+) {
+    clp_s::ArchiveReader archive_reader;
+    archive_reader.set_metadata_cache(metadata_cache);
+    archive_reader.open(archive_path, clp_s::NetworkAuthOption{});
+    archive_reader.read_dictionaries_and_metadata();
+    archive_reader.close();
 }
 
-void search(
+auto search_archives(
         std::shared_ptr<clp_s::search::ast::Expression> expr,
         bool ignore_case,
-        std::vector<int64_t> const& expected_results
-) {
+        std::vector<clp_s::Path> const& archive_paths,
+        OutputHandlerFactory const& create_output_handler,
+        SearchOptions const& options
+) -> size_t {
     REQUIRE(nullptr != expr);
     REQUIRE(nullptr == std::dynamic_pointer_cast<clp_s::search::ast::EmptyExpr>(expr));
 
@@ -149,82 +495,498 @@ void search(
     expr = convert_pass.run(expr);
     REQUIRE(nullptr != expr);
 
-    std::vector<clp_s::VectorOutputHandler::QueryResult> results;
-    for (auto const& entry : std::filesystem::directory_iterator(cTestSearchArchiveDirectory)) {
-        auto archive_reader = std::make_shared<clp_s::ArchiveReader>();
-        auto archive_path = clp_s::Path{
-                .source{clp_s::InputSource::Filesystem},
-                .path{entry.path().string()}
-        };
-        archive_reader->open(archive_path, clp_s::NetworkAuthOption{});
-
-        auto archive_expr = expr->copy();
-
-        clp_s::search::EvaluateRangeIndexFilters metadata_filter_pass{
-                archive_reader->get_range_index(),
-                false == ignore_case
-        };
-        archive_expr = metadata_filter_pass.run(archive_expr);
-        REQUIRE(nullptr != archive_expr);
-        REQUIRE(nullptr == std::dynamic_pointer_cast<clp_s::search::ast::EmptyExpr>(archive_expr));
-
-        auto timestamp_dict = archive_reader->get_timestamp_dictionary();
-        clp_s::search::EvaluateTimestampIndex timestamp_index_pass(timestamp_dict);
-        REQUIRE(clp_s::EvaluatedValue::False != timestamp_index_pass.run(archive_expr));
-
-        auto match_pass = std::make_shared<clp_s::search::SchemaMatch>(
-                archive_reader->get_schema_tree(),
-                archive_reader->get_schema_map()
-        );
-        archive_expr = match_pass->run(archive_expr);
-        REQUIRE(nullptr != archive_expr);
-
-        auto output_handler = std::make_unique<clp_s::VectorOutputHandler>(results);
-        clp_s::search::Output output_pass(
-                match_pass,
-                archive_expr,
-                archive_reader,
+    if (options.parallelism <= 1) {
+        size_t num_archives_read{0};
+        for (auto const& archive_path : archive_paths) {
+            if (search_archive(expr, ignore_case, archive_path, create_output_handler, options)) {
+                ++num_archives_read;
+            }
+        }
+        return num_archives_read;
+    }
+
+    std::mutex output_mutex;
+    OutputHandlerFactory const create_synchronized_output_handler = [&]() {
+        std::unique_ptr<clp_s::search::OutputHandler> output_handler;
+        {
+            // The output handlers may share state with each other
+            std::lock_guard const lock{output_mutex};
+            output_handler = create_output_handler();
+        }
+        return std::make_unique<clp_s::SynchronizedOutputHandler>(
                 std::move(output_handler),
-                ignore_case
+                output_mutex
         );
-        output_pass.filter();
+    };
+    std::atomic_size_t next_archive_idx{0};
+    std::atomic_size_t num_archives_read{0};
+    std::vector<std::exception_ptr> exceptions(archive_paths.size());
+    std::vector<std::thread> workers;
+    for (size_t i{0}; i < std::min(options.parallelism, archive_paths.size()); ++i) {
+        workers.emplace_back([&]() {
+            for (auto archive_idx = next_archive_idx++; archive_idx < archive_paths.size();
+                 archive_idx = next_archive_idx++)
+            {
+                try {
+                    if (search_archive(
+                                expr,
+                                ignore_case,
+                                archive_paths[archive_idx],
+                                create_synchronized_output_handler,
+                                options
+                        ))
+                    {
+                        ++num_archives_read;
+                    }
+                } catch (...) {
+                    exceptions[archive_idx] = std::current_exception();
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (auto const& exception : exceptions) {
+        if (nullptr != exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+    return num_archives_read;
+}
+
+auto search_archive(
+        std::shared_ptr<clp_s::search::ast::Expression> const& expr,
+        bool ignore_case,
+        clp_s::Path const& archive_path,
+        OutputHandlerFactory const& create_output_handler,
+        SearchOptions const& options
+) -> bool {
+    auto archive_reader = std::make_shared<clp_s::ArchiveReader>();
+    archive_reader->set_metadata_cache(options.metadata_cache);
+    archive_reader->open(archive_path, clp_s::NetworkAuthOption{}, options.memory_map);
+
+    auto archive_expr = expr->copy();
+
+    clp_s::search::EvaluateRangeIndexFilters metadata_filter_pass{
+            archive_reader->get_range_index(),
+            false == ignore_case
+    };
+    archive_expr = metadata_filter_pass.run(archive_expr);
+    if (nullptr == archive_expr) {
+        throw std::runtime_error{"The range index pass failed."};
+    }
+    if (nullptr != std::dynamic_pointer_cast<clp_s::search::ast::EmptyExpr>(archive_expr)) {
+        archive_reader->close();
+        return false;
+    }
+
+    auto timestamp_dict = archive_reader->get_timestamp_dictionary();
+    clp_s::search::EvaluateTimestampIndex timestamp_index_pass(timestamp_dict);
+    if (clp_s::EvaluatedValue::False == timestamp_index_pass.run(archive_expr)) {
         archive_reader->close();
+        return false;
+    }
+
+    auto match_pass = std::make_shared<clp_s::search::SchemaMatch>(
+            archive_reader->get_schema_tree(),
+            archive_reader->get_schema_map()
+    );
+    archive_expr = match_pass->run(archive_expr);
+    if (nullptr == archive_expr) {
+        throw std::runtime_error{"The schema matching pass failed."};
     }
 
+    clp_s::search::Output output_pass(
+            match_pass,
+            archive_expr,
+            archive_reader,
+            create_output_handler(),
+            ignore_case,
+            options.num_threads
+    );
+    output_pass.filter();
+    bool const is_archive_read{false == archive_reader->get_schema_ids().empty()};
+    archive_reader->close();
+    return is_archive_read;
+}
+
+auto search(
+        std::string const& query,
+        bool ignore_case,
+        std::vector<int64_t> const& expected_results,
+        SearchOptions const& options
+) -> std::vector<clp_s::VectorOutputHandler::QueryResult> {
+    return search(parse_query(query), ignore_case, expected_results, options);
+}
+
+auto search(
+        std::shared_ptr<clp_s::search::ast::Expression> expr,
+        bool ignore_case,
+        std::vector<int64_t> const& expected_results,
+        SearchOptions const& options
+) -> std::vector<clp_s::VectorOutputHandler::QueryResult> {
+    auto const archive_paths = get_archive_paths();
+
+    std::vector<clp_s::VectorOutputHandler::QueryResult> results;
+    std::ignore = search_archives(
+            expr,
+            ignore_case,
+            archive_paths,
+            [&]() { return std::make_unique<clp_s::VectorOutputHandler>(results); },
+            options
+    );
     validate_results(results, expected_results);
+    return results;
 }
 }  // namespace
 
 TEST_CASE("clp-s-search", "[clp-s][search]") {
-    std::vector<std::pair<std::string, std::vector<int64_t>>> queries_and_results{
-            {R"aa(NOT a: b)aa", {0}},
-            {R"aa(msg: "Msg 1: \"Abc123\"")aa", {1}},
-            {R"aa(msg: "Msg 2: 'Abc123'")aa", {2}},
-            {R"aa(msg: "Msg 3: \nAbc123")aa", {3}},
-            // CLP incorrectly generates no subqueries in Grep::process_raw_query for the following
-            // query, so we skip it for now.
-            //{R"aa(msg: "Msg 4: \\Abc123")aa", {4}}
-            {R"aa(msg: "Msg 5: \rAbc123")aa", {5}},
-            {R"aa(msg: "Msg 6: \tAbc123")aa", {6}},
+    // A separate columns table size of 1 B stores every table as separate columns.
+    auto separate_columns_table_size = GENERATE(0ULL, 1ULL);
+    auto structurize_arrays = GENERATE(true, false);
+    auto single_file_archive = GENERATE(true, false);
+
+    TestOutputCleaner const test_cleanup{{std::string{cTestSearchArchiveDirectory}}};
+
+    REQUIRE_NOTHROW(
+            std::ignore = compress_archive(
+                    get_test_input_local_path(),
+                    std::string{cTestSearchArchiveDirectory},
+                    single_file_archive,
+                    structurize_arrays,
+                    clp_s::FileType::Json,
+                    separate_columns_table_size
+            )
+    );
+
+    for (auto const& [query, expected_results] : get_queries_and_results()) {
+        CAPTURE(query);
+        REQUIRE_NOTHROW(std::ignore = search(query, false, expected_results));
+    }
+
+    std::shared_ptr<clp_s::search::ast::Expression> expr{nullptr};
+    REQUIRE_NOTHROW(expr = create_first_record_match_metadata_query());
+    REQUIRE_NOTHROW(std::ignore = search(expr, false, {0}));
+}
+
+TEST_CASE("clp-s-search-num-threads", "[clp-s][search]") {
+    // A separate columns table size of 1 B stores every table in its own group of streams, so each
+    // table can be read and searched by a different thread.
+    auto separate_columns_table_size = GENERATE(0ULL, 1ULL);
+
+    TestOutputCleaner const test_cleanup{{std::string{cTestSearchArchiveDirectory}}};
+
+    REQUIRE_NOTHROW(
+            std::ignore = compress_archive(
+                    get_test_input_local_path(),
+                    std::string{cTestSearchArchiveDirectory},
+                    false,
+                    false,
+                    clp_s::FileType::Json,
+                    separate_columns_table_size
+            )
+    );
+
+    // Searching tables concurrently must write the same results in the same order as searching
+    // them sequentially.
+    for (auto const& [query, expected_results] : get_queries_and_results()) {
+        CAPTURE(query);
+        std::vector<clp_s::VectorOutputHandler::QueryResult> sequential_results;
+        std::vector<clp_s::VectorOutputHandler::QueryResult> concurrent_results;
+        REQUIRE_NOTHROW(sequential_results = search(query, false, expected_results));
+        REQUIRE_NOTHROW(
+                concurrent_results = search(query, false, expected_results, {.num_threads = 4})
+        );
+        REQUIRE(sequential_results.size() == concurrent_results.size());
+        for (size_t i{0}; i < sequential_results.size(); ++i) {
+            REQUIRE(sequential_results[i].message == concurrent_results[i].message);
+        }
+    }
+}
+
+TEST_CASE("clp-s-search-count-pushdown", "[clp-s][search]") {
+    std::vector<std::pair<std::string, std::vector<int64_t>>> const queries_and_results{
             {R"aa(msg: "*Abc123*")aa", {1, 2, 3, 5, 6}},
             {R"aa(arr.b > 1000)aa", {7, 8}},
-            {R"aa(var_string: *)aa", {9}},
-            {R"aa(clp_string: *)aa", {9}},
-            {fmt::format(
-                     R"aa($_filename: "{}" AND $_file_split_number: 0 AND )aa"
-                     R"aa($_archive_creator_id: * AND idx: 0)aa",
-                     get_test_input_local_path()
-             ),
-             {0}},
-            {R"aa(idx: 0 AND NOT $_filename: "clp string")aa", {0}},
-            {R"aa(idx: 0 AND NOT $*._filename.*: "clp string")aa", {0}},
-            {R"aa(($_filename: file OR $_file_split_number: 1 OR $_archive_creator_id > 0) AND )aa"
-             R"aa(idx: 0 OR idx: 1)aa",
-             {1}},
-            {R"aa(ambiguous_varstring: "a*e")aa", {10, 11, 12}},
-            {R"aa(ambiguous_varstring: "a\*e")aa", {12}}
+            {R"aa(idx >= 10 AND idx < 12)aa", {10, 11}},
+            // Every table matches every record, so each table is counted from its metadata
+            {R"aa(idx: *)aa", {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12}},
+            {R"aa(msg: "No such message")aa", {}}
+    };
+    // A separate columns table size of 1 B stores every table as separate columns.
+    auto separate_columns_table_size = GENERATE(0ULL, 1ULL);
+
+    TestOutputCleaner const test_cleanup{{std::string{cTestSearchArchiveDirectory}}};
+
+    // Each record's timestamp is its index, so the counts by time identify the counted records
+    REQUIRE_NOTHROW(
+            std::ignore = compress_archive(
+                    get_test_input_local_path(),
+                    std::string{cTestSearchArchiveDirectory},
+                    false,
+                    false,
+                    clp_s::FileType::Json,
+                    separate_columns_table_size,
+                    std::string{cTestIdxKey}
+            )
+    );
+    auto const archive_paths = get_archive_paths();
+
+    for (size_t const num_threads : {1, 4}) {
+        for (auto const& [query, expected_results] : queries_and_results) {
+            CAPTURE(num_threads, query);
+            SearchOptions const options{.num_threads = num_threads};
+
+            uint64_t count{0};
+            REQUIRE_NOTHROW(std::ignore = search_archives(
+                    parse_query(query),
+                    false,
+                    archive_paths,
+                    [&]() { return std::make_unique<PushdownCountOutputHandler>(count); },
+                    options
+            ));
+            REQUIRE(expected_results.size() == count);
+
+            std::map<clp_s::epochtime_t, uint64_t> counts_by_time;
+            REQUIRE_NOTHROW(std::ignore = search_archives(
+                    parse_query(query),
+                    false,
+                    archive_paths,
+                    [&]() {
+                        return std::make_unique<PushdownCountByTimeOutputHandler>(counts_by_time);
+                    },
+                    options
+            ));
+            std::map<clp_s::epochtime_t, uint64_t> expected_counts_by_time;
+            for (auto const idx : expected_results) {
+                expected_counts_by_time.emplace(idx, 1);
+            }
+            REQUIRE(expected_counts_by_time == counts_by_time);
+        }
+    }
+}
+
+TEST_CASE("clp-s-search-top-k", "[clp-s][search]") {
+    constexpr size_t cK{3};
+    constexpr std::string_view cTimestampKey{"ts"};
+    auto get_descending_timestamps = [](int64_t max, int64_t min) {
+        std::vector<int64_t> timestamps;
+        for (auto timestamp{max}; timestamp >= min; --timestamp) {
+            timestamps.push_back(timestamp);
+        }
+        return timestamps;
+    };
+    // The tables of each archive, each given as a key unique to the table and the timestamps of
+    // its records, in the order they're written
+    std::vector<std::vector<std::pair<std::string, std::vector<int64_t>>>> const archives{
+            {{"a", get_descending_timestamps(109, 100)},
+             {"b", get_descending_timestamps(1009, 1000)},
+             {"c", get_descending_timestamps(509, 500)}},
+            {{"a", get_descending_timestamps(99, 90)}, {"d", get_descending_timestamps(49, 40)}},
+            {{"e", {2000}}, {"a", get_descending_timestamps(19, 10)}}
+    };
+
+    TestOutputCleaner const test_cleanup{
+            {std::string{cTestSearchArchiveDirectory}, std::string{cTestTopKInputFile}}
+    };
+
+    // Compress each archive separately so that they're searched in order
+    std::vector<clp_s::Path> archive_paths;
+    for (auto const& tables : archives) {
+        {
+            std::ofstream input_file{std::string{cTestTopKInputFile}};
+            for (auto const& [key, timestamps] : tables) {
+                for (auto const timestamp : timestamps) {
+                    input_file << fmt::format(
+                            R"({{"{}": {}, "{}": 0}})",
+                            cTimestampKey,
+                            timestamp,
+                            key
+                    ) << '\n';
+                }
+            }
+        }
+        std::vector<clp_s::ArchiveStats> archive_stats;
+        REQUIRE_NOTHROW(
+                archive_stats = compress_archive(
+                        std::string{cTestTopKInputFile},
+                        std::string{cTestSearchArchiveDirectory},
+                        false,
+                        false,
+                        clp_s::FileType::Json,
+                        0,
+                        std::string{cTimestampKey}
+                )
+        );
+        REQUIRE(1 == archive_stats.size());
+        archive_paths.push_back(clp_s::Path{
+                .source{clp_s::InputSource::Filesystem},
+                .path{(std::filesystem::path{cTestSearchArchiveDirectory}
+                       / archive_stats.front().get_id())
+                              .string()}
+        });
+    }
+
+    for (size_t const num_threads : {1, 4}) {
+        CAPTURE(num_threads);
+        auto const top_k_timestamps = std::make_shared<clp_s::search::TopKTimestamps>(cK);
+        TopKOutputHandler::Stats stats;
+        size_t num_archives_read{0};
+        REQUIRE_NOTHROW(
+                num_archives_read = search_archives(
+                        parse_query(fmt::format("{} >= 0", cTimestampKey)),
+                        false,
+                        archive_paths,
+                        [&]() {
+                            return std::make_unique<TopKOutputHandler>(top_k_timestamps, cK, stats);
+                        },
+                        {.num_threads = num_threads}
+                )
+        );
+        REQUIRE(std::multiset<clp_s::epochtime_t>{2000, 1009, 1008} == stats.kept_timestamps);
+
+        // The second archive's timestamps are all earlier than the latest results of the first
+        // archive, so its tables are never considered
+        REQUIRE(2 == num_archives_read);
+
+        if (1 == num_threads) {
+            // Only the first K results of table "b" in the first archive and the result in table
+            // "e" in the third archive are searched; every other table and result in those
+            // archives is skipped.
+            REQUIRE(cK + 1 == stats.num_writes);
+            REQUIRE(2 == stats.num_flushes);
+        }
+    }
+}
+
+TEST_CASE("clp-s-search-parallelism", "[clp-s][search]") {
+    constexpr size_t cNumArchives{4};
+    constexpr int64_t cNumRecordsPerArchive{50};
+    constexpr int64_t cNumRecords{cNumArchives * cNumRecordsPerArchive};
+    constexpr size_t cK{5};
+    constexpr std::string_view cTimestampKey{"ts"};
+    // Each query and the records it matches, given by their indices
+    std::vector<std::pair<std::string, std::function<bool(int64_t)>>> const queries{
+            {R"aa(idx < 10 OR idx >= 190)aa", [](int64_t idx) { return idx < 10 || idx >= 190; }},
+            {R"aa(idx >= 45 AND idx < 155)aa", [](int64_t idx) { return idx >= 45 && idx < 155; }},
+            {R"aa(idx: *)aa", [](int64_t) { return true; }},
+            {R"aa(idx < 0)aa", [](int64_t) { return false; }}
+    };
+    auto parallelism = GENERATE_COPY(2ULL, cNumArchives, 8ULL);
+    auto num_threads = GENERATE(1ULL, 4ULL);
+    CAPTURE(parallelism, num_threads);
+    SearchOptions const options{.num_threads = num_threads, .parallelism = parallelism};
+
+    TestOutputCleaner const test_cleanup{
+            {std::string{cTestSearchArchiveDirectory}, std::string{cTestParallelismInputFile}}
+    };
+
+    // Each archive holds a contiguous range of records whose timestamps are their indices
+    std::vector<clp_s::Path> archive_paths;
+    for (int64_t archive_idx{0}; std::cmp_less(archive_idx, cNumArchives); ++archive_idx) {
+        {
+            std::ofstream input_file{std::string{cTestParallelismInputFile}};
+            for (int64_t i{0}; i < cNumRecordsPerArchive; ++i) {
+                auto const idx{archive_idx * cNumRecordsPerArchive + i};
+                input_file << fmt::format(R"({{"idx": {}, "{}": {}}})", idx, cTimestampKey, idx)
+                           << '\n';
+            }
+        }
+        std::vector<clp_s::ArchiveStats> archive_stats;
+        REQUIRE_NOTHROW(
+                archive_stats = compress_archive(
+                        std::string{cTestParallelismInputFile},
+                        std::string{cTestSearchArchiveDirectory},
+                        false,
+                        false,
+                        clp_s::FileType::Json,
+                        0,
+                        std::string{cTimestampKey}
+                )
+        );
+        REQUIRE(1 == archive_stats.size());
+        archive_paths.push_back(clp_s::Path{
+                .source{clp_s::InputSource::Filesystem},
+                .path{(std::filesystem::path{cTestSearchArchiveDirectory}
+                       / archive_stats.front().get_id())
+                              .string()}
+        });
+    }
+
+    for (auto const& [query, matches] : queries) {
+        CAPTURE(query);
+        std::vector<int64_t> expected_results;
+        for (int64_t idx{0}; idx < cNumRecords; ++idx) {
+            if (matches(idx)) {
+                expected_results.push_back(idx);
+            }
+        }
+
+        // The results of every archive must be combined without any being lost or duplicated
+        std::vector<clp_s::VectorOutputHandler::QueryResult> results;
+        REQUIRE_NOTHROW(
+                std::ignore = search_archives(
+                        parse_query(query),
+                        false,
+                        archive_paths,
+                        [&]() { return std::make_unique<clp_s::VectorOutputHandler>(results); },
+                        options
+                )
+        );
+        validate_results(results, expected_results);
+
+        uint64_t count{0};
+        REQUIRE_NOTHROW(
+                std::ignore = search_archives(
+                        parse_query(query),
+                        false,
+                        archive_paths,
+                        [&]() { return std::make_unique<PushdownCountOutputHandler>(count); },
+                        options
+                )
+        );
+        REQUIRE(expected_results.size() == count);
+    }
+
+    // Which archives and tables are skipped depends on the order that the archives are searched
+    // in, but the latest timestamps kept must not
+    auto const top_k_timestamps = std::make_shared<clp_s::search::TopKTimestamps>(cK);
+    TopKOutputHandler::Stats stats;
+    REQUIRE_NOTHROW(
+            std::ignore = search_archives(
+                    parse_query(fmt::format("{} >= 0", cTimestampKey)),
+                    false,
+                    archive_paths,
+                    [&]() {
+                        return std::make_unique<TopKOutputHandler>(top_k_timestamps, cK, stats);
+                    },
+                    options
+            )
+    );
+    std::multiset<clp_s::epochtime_t> expected_kept_timestamps;
+    for (auto timestamp{cNumRecords - 1}; std::cmp_less(cNumRecords - 1 - timestamp, cK);
+         --timestamp)
+    {
+        expected_kept_timestamps.insert(timestamp);
+    }
+    REQUIRE(expected_kept_timestamps == stats.kept_timestamps);
+}
+
+TEST_CASE("clp-s-search-dictionary-summary", "[clp-s][search]") {
+    // Each query, whether it ignores case, the indices of the records it matches, and whether the
+    // archive must be searched
+    std::vector<std::tuple<std::string, bool, std::vector<int64_t>, bool>> const queries{
+            {R"aa(var_string: "zzz")aa", false, {}, false},
+            {R"aa(msg: "No such message")aa", false, {}, false},
+            // The logtype is in the archive but the dictionary variable isn't
+            {R"aa(msg: "Msg 1: \"Zzz999\"")aa", false, {}, false},
+            {R"aa(var_string: "a")aa", false, {9}, true},
+            {R"aa(msg: "Msg 1: \"Abc123\"")aa", false, {1}, true},
+            // Case-insensitive filters can't be evaluated against the summary
+            {R"aa(var_string: "A")aa", true, {9}, true},
+            {R"aa(var_string: "zzz")aa", true, {}, true}
     };
-    auto structurize_arrays = GENERATE(true, false);
     auto single_file_archive = GENERATE(true, false);
 
     TestOutputCleaner const test_cleanup{{std::string{cTestSearchArchiveDirectory}}};
@@ -234,17 +996,467 @@ TEST_CASE("clp-s-search", "[clp-s][search]") {
                     get_test_input_local_path(),
                     std::string{cTestSearchArchiveDirectory},
                     single_file_archive,
-                    structurize_arrays,
+                    false,
                     clp_s::FileType::Json
             )
     );
+    auto const archive_paths = get_archive_paths();
+    REQUIRE(1 == archive_paths.size());
 
-    for (auto const& [query, expected_results] : queries_and_results) {
+    for (auto const& [query, ignore_case, expected_results, must_search_archive] : queries) {
+        CAPTURE(query, ignore_case);
+        std::vector<clp_s::VectorOutputHandler::QueryResult> results;
+        size_t num_archives_read{0};
+        REQUIRE_NOTHROW(
+                num_archives_read = search_archives(
+                        parse_query(query),
+                        ignore_case,
+                        archive_paths,
+                        [&]() { return std::make_unique<clp_s::VectorOutputHandler>(results); },
+                        {}
+                )
+        );
+        validate_results(results, expected_results);
+        // Skipped archives are skipped before their tables' metadata is read
+        REQUIRE((must_search_archive ? 1 : 0) == num_archives_read);
+    }
+}
+
+TEST_CASE("clp-s-search-dictionary-id-filters", "[clp-s][search]") {
+    constexpr int64_t cNumRecordsPerTable{100};
+    // Each table has its own schema, its own variable strings, and its own logtype.
+    std::array<std::string_view, 3> const table_names{"a", "b", "c"};
+    // Each query, the number of tables whose dictionary ID filters it can match, and the indices
+    // of the tables and records it matches
+    std::vector<std::tuple<std::string, size_t, std::function<bool(int64_t, int64_t)>>> const
+            queries{
+                    {R"aa(var: "a1")aa",
+                     1,
+                     [](int64_t table_idx, int64_t i) { return 0 == table_idx && 1 == i; }},
+                    {R"aa(var: "b5" OR var: "c99")aa",
+                     2,
+                     [](int64_t table_idx, int64_t i) {
+                         return (1 == table_idx && 5 == i) || (2 == table_idx && 99 == i);
+                     }},
+                    {R"aa(var: "b*")aa",
+                     1,
+                     [](int64_t table_idx, int64_t) { return 1 == table_idx; }},
+                    {R"aa(msg: "Table b started")aa",
+                     1,
+                     [](int64_t table_idx, int64_t) { return 1 == table_idx; }},
+                    // Every value is in the archive, but no table contains both
+                    {R"aa(msg: "Table c started" AND var: "a1")aa",
+                     0,
+                     [](int64_t, int64_t) { return false; }},
+                    // The filters can only rule out that a table contains a value, so every table
+                    // may contain a value other than "b5"
+                    {R"aa(NOT var: "b5")aa",
+                     3,
+                     [](int64_t table_idx, int64_t i) { return 1 != table_idx || 5 != i; }}
+            };
+    auto single_file_archive = GENERATE(true, false);
+
+    TestOutputCleaner const test_cleanup{
+            {std::string{cTestSearchArchiveDirectory},
+             std::string{cTestDictionaryIdFiltersInputFile}}
+    };
+
+    {
+        std::ofstream input_file{std::string{cTestDictionaryIdFiltersInputFile}};
+        for (int64_t table_idx{0}; std::cmp_less(table_idx, table_names.size()); ++table_idx) {
+            auto const table_name = table_names.at(table_idx);
+            for (int64_t i{0}; i < cNumRecordsPerTable; ++i) {
+                input_file << fmt::format(
+                        R"({{"idx": {}, "var": "{}{}", "msg": "Table {} started", "{}": 0}})",
+                        table_idx * cNumRecordsPerTable + i,
+                        table_name,
+                        i,
+                        table_name,
+                        table_name
+                ) << '\n';
+            }
+        }
+    }
+    REQUIRE_NOTHROW(
+            std::ignore = compress_archive(
+                    std::string{cTestDictionaryIdFiltersInputFile},
+                    std::string{cTestSearchArchiveDirectory},
+                    single_file_archive,
+                    false,
+                    clp_s::FileType::Json
+            )
+    );
+    auto const archive_paths = get_archive_paths();
+
+    for (auto const& [query, expected_num_tables_searched, matches] : queries) {
         CAPTURE(query);
-        REQUIRE_NOTHROW(search(query, false, expected_results));
+        std::vector<int64_t> expected_results;
+        for (int64_t table_idx{0}; std::cmp_less(table_idx, table_names.size()); ++table_idx) {
+            for (int64_t i{0}; i < cNumRecordsPerTable; ++i) {
+                if (matches(table_idx, i)) {
+                    expected_results.push_back(table_idx * cNumRecordsPerTable + i);
+                }
+            }
+        }
+
+        std::vector<clp_s::VectorOutputHandler::QueryResult> results;
+        size_t num_archives_read{0};
+        REQUIRE_NOTHROW(
+                num_archives_read = search_archives(
+                        parse_query(query),
+                        false,
+                        archive_paths,
+                        [&]() { return std::make_unique<clp_s::VectorOutputHandler>(results); },
+                        {}
+                )
+        );
+        validate_results(results, expected_results);
+        // Every value is in the archive's dictionaries, so only tables can be skipped
+        REQUIRE(1 == num_archives_read);
+
+        TableCountingOutputHandler::Stats stats;
+        REQUIRE_NOTHROW(
+                std::ignore = search_archives(
+                        parse_query(query),
+                        false,
+                        archive_paths,
+                        [&]() { return std::make_unique<TableCountingOutputHandler>(stats); },
+                        {}
+                )
+        );
+        REQUIRE(expected_results.size() == stats.num_results);
+        REQUIRE(expected_num_tables_searched == stats.num_tables_searched);
     }
+}
+
+TEST_CASE("clp-s-search-memory-map", "[clp-s][search]") {
+    // Memory mapped archives are read differently depending on whether they're single-file
+    // archives, and whether their tables are searched concurrently. A separate columns table size
+    // of 1 B stores every table as separate columns, so each column stream is read from the mapping
+    // on its own.
+    auto single_file_archive = GENERATE(true, false);
+
+    TestOutputCleaner const test_cleanup{{std::string{cTestSearchArchiveDirectory}}};
+
+    REQUIRE_NOTHROW(
+            std::ignore = compress_archive(
+                    get_test_input_local_path(),
+                    std::string{cTestSearchArchiveDirectory},
+                    single_file_archive,
+                    false,
+                    clp_s::FileType::Json,
+                    1
+            )
+    );
+
+    for (size_t const num_threads : {1, 4}) {
+        CAPTURE(num_threads);
+        SearchOptions const options{.num_threads = num_threads, .memory_map = true};
+        for (auto const& [query, expected_results] : get_queries_and_results()) {
+            CAPTURE(query);
+            REQUIRE_NOTHROW(std::ignore = search(query, false, expected_results, options));
+        }
+    }
+}
+
+TEST_CASE("clp-s-search-metadata-cache", "[clp-s][search]") {
+    auto single_file_archive = GENERATE(true, false);
+
+    TestOutputCleaner const test_cleanup{{std::string{cTestSearchArchiveDirectory}}};
+
+    REQUIRE_NOTHROW(
+            std::ignore = compress_archive(
+                    get_test_input_local_path(),
+                    std::string{cTestSearchArchiveDirectory},
+                    single_file_archive,
+                    false,
+                    clp_s::FileType::Json
+            )
+    );
+    auto const metadata_cache
+            = std::make_shared<clp_s::ArchiveMetadataCache>(cTestMetadataCacheSize);
+    SearchOptions const options{.metadata_cache = metadata_cache};
+
+    // An archive that's skipped before its metadata is read isn't cached
+    REQUIRE_NOTHROW(std::ignore = search(R"aa(var_string: "zzz")aa", false, {}, options));
+    REQUIRE(1 == metadata_cache->get_stats().num_misses);
+    REQUIRE(0 == metadata_cache->get_stats().num_archives);
 
+    // Every search after the first one that reads the archive's metadata must reuse the cached
+    // metadata, and get the same results as searches without a cache
+    auto const queries_and_results = get_queries_and_results();
+    for (auto const& [query, expected_results] : queries_and_results) {
+        CAPTURE(query);
+        REQUIRE_NOTHROW(std::ignore = search(query, false, expected_results, options));
+    }
     std::shared_ptr<clp_s::search::ast::Expression> expr{nullptr};
     REQUIRE_NOTHROW(expr = create_first_record_match_metadata_query());
-    REQUIRE_NOTHROW(search(expr, false, {0}));
+    REQUIRE_NOTHROW(std::ignore = search(expr, false, {0}, options));
+
+    auto const stats = metadata_cache->get_stats();
+    REQUIRE(2 == stats.num_misses);
+    REQUIRE(queries_and_results.size() == stats.num_hits);
+    REQUIRE(0 == stats.num_evictions);
+    REQUIRE(1 == stats.num_archives);
+}
+
+TEST_CASE("clp-s-search-value-range", "[clp-s][search]") {
+    constexpr int64_t cNumRecordsPerTable{100};
+    // Each table has its own schema and its own range of values: [0, 100), [1000, 1100), and
+    // [2000, 2100).
+    constexpr int64_t cNumTables{3};
+    constexpr int64_t cTableValueOffset{1000};
+    // Each query, the number of tables whose value ranges it can match, and the values it matches
+    std::vector<std::tuple<std::string, size_t, std::function<bool(int64_t)>>> const queries{
+            {R"aa(value > 5000)aa", 0, [](int64_t) { return false; }},
+            {R"aa(value < 0 OR value: 500)aa", 0, [](int64_t) { return false; }},
+            {R"aa(float_value > 2100)aa", 0, [](int64_t) { return false; }},
+            {R"aa(value >= 1000 AND value < 1050)aa",
+             1,
+             [](int64_t value) { return value >= 1000 && value < 1050; }},
+            {R"aa(float_value < 50)aa", 1, [](int64_t value) { return value < 50; }},
+            {R"aa(value < 1000 OR value >= 2090)aa",
+             2,
+             [](int64_t value) { return value < 1000 || value >= 2090; }},
+            {R"aa(value >= 0)aa", 3, [](int64_t) { return true; }}
+    };
+    // A separate columns table size of 1 B stores every table as separate columns.
+    auto separate_columns_table_size = GENERATE(0ULL, 1ULL);
+
+    TestOutputCleaner const test_cleanup{
+            {std::string{cTestSearchArchiveDirectory}, std::string{cTestValueRangeInputFile}}
+    };
+
+    std::vector<int64_t> values;
+    {
+        std::array<std::string_view, cNumTables> const table_keys{"a", "b", "c"};
+        std::ofstream input_file{std::string{cTestValueRangeInputFile}};
+        for (int64_t table_idx{0}; table_idx < cNumTables; ++table_idx) {
+            for (int64_t i{0}; i < cNumRecordsPerTable; ++i) {
+                auto const value = table_idx * cTableValueOffset + i;
+                input_file << fmt::format(
+                        R"({{"idx": {}, "value": {}, "float_value": {:.1f}, "{}": 0}})",
+                        values.size(),
+                        value,
+                        static_cast<double>(value) + 0.5,
+                        table_keys.at(table_idx)
+                ) << '\n';
+                values.push_back(value);
+            }
+        }
+    }
+    REQUIRE_NOTHROW(
+            std::ignore = compress_archive(
+                    std::string{cTestValueRangeInputFile},
+                    std::string{cTestSearchArchiveDirectory},
+                    false,
+                    false,
+                    clp_s::FileType::Json,
+                    separate_columns_table_size
+            )
+    );
+    auto const archive_paths = get_archive_paths();
+
+    for (auto const& [query, expected_num_tables_searched, matches] : queries) {
+        CAPTURE(query);
+        std::vector<int64_t> expected_results;
+        for (size_t idx{0}; idx < values.size(); ++idx) {
+            if (matches(values[idx])) {
+                expected_results.push_back(static_cast<int64_t>(idx));
+            }
+        }
+
+        std::vector<clp_s::VectorOutputHandler::QueryResult> results;
+        REQUIRE_NOTHROW(
+                std::ignore = search_archives(
+                        parse_query(query),
+                        false,
+                        archive_paths,
+                        [&]() { return std::make_unique<clp_s::VectorOutputHandler>(results); },
+                        {}
+                )
+        );
+        validate_results(results, expected_results);
+
+        // Tables whose value ranges can't match the query are skipped without being searched
+        TableCountingOutputHandler::Stats stats;
+        REQUIRE_NOTHROW(
+                std::ignore = search_archives(
+                        parse_query(query),
+                        false,
+                        archive_paths,
+                        [&]() { return std::make_unique<TableCountingOutputHandler>(stats); },
+                        {}
+                )
+        );
+        REQUIRE(expected_results.size() == stats.num_results);
+        REQUIRE(expected_num_tables_searched == stats.num_tables_searched);
+    }
+}
+
+TEST_CASE("clp-s-search-large-table", "[clp-s][search]") {
+    // The queries' matches begin and end on either side of the boundaries between the words and
+    // batches of the selection bitmaps that filters are evaluated into
+    static_assert(1024 == clp_s::FilterClass::cBatchSize);
+    static_assert(64 == clp_s::FilterClass::cBitsPerSelectionWord);
+    // The last batch and its last word are partial
+    constexpr int64_t cNumRecords{2 * 1024 + 7 * 64 + 4};
+    std::vector<std::pair<std::string, std::function<bool(int64_t)>>> const queries_and_matches{
+            {R"aa(idx >= 60 AND idx < 70)aa", [](int64_t i) { return i >= 60 && i < 70; }},
+            {R"aa(idx >= 1020 AND idx < 1030)aa", [](int64_t i) { return i >= 1020 && i < 1030; }},
+            {R"aa(idx < 3 OR idx > 2490)aa", [](int64_t i) { return i < 3 || i > 2490; }},
+            {R"aa(idx: 2499)aa", [](int64_t i) { return 2499 == i; }},
+            {R"aa(idx > 5000)aa", [](int64_t) { return false; }},
+            {R"aa(NOT idx: 1023)aa", [](int64_t i) { return 1023 != i; }},
+            {R"aa(bool: true AND NOT idx < 1024)aa",
+             [](int64_t i) { return 63 == i % 64 && i >= 1024; }},
+            {R"aa(int: 63 OR str: "s3")aa", [](int64_t i) { return 63 == i % 100 || 3 == i % 7; }},
+            {R"aa(float >= 255.75 AND float < 257)aa",
+             [](int64_t i) { return i >= 1023 && i < 1028; }},
+            {R"aa(msg: "Request 2 *" AND idx >= 1000 AND idx < 1100)aa",
+             [](int64_t i) { return 2 == i % 5 && i >= 1000 && i < 1100; }}
+    };
+    // A separate columns table size of 1 B stores every table as separate columns.
+    auto separate_columns_table_size = GENERATE(0ULL, 1ULL);
+
+    TestOutputCleaner const test_cleanup{
+            {std::string{cTestSearchArchiveDirectory}, std::string{cTestLargeTableInputFile}}
+    };
+
+    // Every record has the same schema, so they're all stored in one table
+    {
+        std::ofstream input_file{std::string{cTestLargeTableInputFile}};
+        for (int64_t i{0}; i < cNumRecords; ++i) {
+            input_file << fmt::format(
+                    R"({{"idx": {}, "int": {}, "float": {:.2f}, "bool": {}, "str": "s{}", )"
+                    R"("msg": "Request {} took {} ms"}})",
+                    i,
+                    i % 100,
+                    static_cast<double>(i) / 4,
+                    63 == i % 64,
+                    i % 7,
+                    i % 5,
+                    i
+            ) << '\n';
+        }
+    }
+    REQUIRE_NOTHROW(
+            std::ignore = compress_archive(
+                    std::string{cTestLargeTableInputFile},
+                    std::string{cTestSearchArchiveDirectory},
+                    false,
+                    false,
+                    clp_s::FileType::Json,
+                    separate_columns_table_size
+            )
+    );
+    auto const archive_paths = get_archive_paths();
+
+    for (auto const& [query, matches] : queries_and_matches) {
+        CAPTURE(query);
+        std::vector<int64_t> expected_results;
+        for (int64_t i{0}; i < cNumRecords; ++i) {
+            if (matches(i)) {
+                expected_results.push_back(i);
+            }
+        }
+
+        std::vector<clp_s::VectorOutputHandler::QueryResult> results;
+        REQUIRE_NOTHROW(
+                std::ignore = search_archives(
+                        parse_query(query),
+                        false,
+                        archive_paths,
+                        [&]() { return std::make_unique<clp_s::VectorOutputHandler>(results); },
+                        {}
+                )
+        );
+        validate_results(results, expected_results);
+
+        uint64_t count{0};
+        REQUIRE_NOTHROW(
+                std::ignore = search_archives(
+                        parse_query(query),
+                        false,
+                        archive_paths,
+                        [&]() { return std::make_unique<PushdownCountOutputHandler>(count); },
+                        {}
+                )
+        );
+        REQUIRE(expected_results.size() == count);
+    }
+}
+
+TEST_CASE("clp-s-archive-metadata-cache", "[clp-s][search]") {
+    auto single_file_archive = GENERATE(true, false);
+
+    TestOutputCleaner const test_cleanup{{std::string{cTestSearchArchiveDirectory}}};
+    for (size_t i{0}; i < 2; ++i) {
+        REQUIRE_NOTHROW(
+                std::ignore = compress_archive(
+                        get_test_input_local_path(),
+                        std::string{cTestSearchArchiveDirectory},
+                        single_file_archive,
+                        false,
+                        clp_s::FileType::Json
+                )
+        );
+    }
+    auto const archive_paths = get_archive_paths();
+    REQUIRE(2 == archive_paths.size());
+
+    // Metadata larger than the cache isn't cached
+    auto metadata_cache = std::make_shared<clp_s::ArchiveMetadataCache>(1);
+    REQUIRE_NOTHROW(open_archive(archive_paths[0], metadata_cache));
+    REQUIRE(0 == metadata_cache->get_stats().num_archives);
+    REQUIRE(0 == metadata_cache->get_stats().memory_usage);
+
+    metadata_cache = std::make_shared<clp_s::ArchiveMetadataCache>(cTestMetadataCacheSize);
+    REQUIRE_NOTHROW(open_archive(archive_paths[0], metadata_cache));
+    auto const archive_memory_usage = metadata_cache->get_stats().memory_usage;
+    REQUIRE(archive_memory_usage > 0);
+
+    // The archives have the same contents, so the cache can only hold one of them
+    metadata_cache
+            = std::make_shared<clp_s::ArchiveMetadataCache>(archive_memory_usage * 3 / 2);
+    REQUIRE_NOTHROW(open_archive(archive_paths[0], metadata_cache));
+    REQUIRE_NOTHROW(open_archive(archive_paths[0], metadata_cache));
+    REQUIRE_NOTHROW(open_archive(archive_paths[1], metadata_cache));
+    REQUIRE_NOTHROW(open_archive(archive_paths[1], metadata_cache));
+    REQUIRE_NOTHROW(open_archive(archive_paths[0], metadata_cache));
+    auto const stats = metadata_cache->get_stats();
+    REQUIRE(2 == stats.num_hits);
+    REQUIRE(3 == stats.num_misses);
+    REQUIRE(2 == stats.num_evictions);
+    REQUIRE(1 == stats.num_archives);
+
+    // The value indexes that searches build lazily are counted once each search's reader is closed
+    for (auto const cache_size : {cTestMetadataCacheSize, archive_memory_usage}) {
+        CAPTURE(cache_size);
+        metadata_cache = std::make_shared<clp_s::ArchiveMetadataCache>(cache_size);
+        REQUIRE_NOTHROW(open_archive(archive_paths[0], metadata_cache));
+        REQUIRE(archive_memory_usage == metadata_cache->get_stats().memory_usage);
+
+        std::vector<clp_s::VectorOutputHandler::QueryResult> results;
+        REQUIRE_NOTHROW(
+                std::ignore = search_archives(
+                        parse_query(R"aa(var_string: "a")aa"),
+                        false,
+                        {archive_paths[0]},
+                        [&]() { return std::make_unique<clp_s::VectorOutputHandler>(results); },
+                        {.metadata_cache = metadata_cache}
+                )
+        );
+        validate_results(results, {9});
+        auto const stats_after_search = metadata_cache->get_stats();
+        if (cTestMetadataCacheSize == cache_size) {
+            REQUIRE(1 == stats_after_search.num_archives);
+            REQUIRE(stats_after_search.memory_usage > archive_memory_usage);
+        } else {
+            // The archive no longer fits in the cache once its value indexes are counted
+            REQUIRE(0 == stats_after_search.num_archives);
+            REQUIRE(0 == stats_after_search.memory_usage);
+            REQUIRE(1 == stats_after_search.num_evictions);
+        }
+    }
 }
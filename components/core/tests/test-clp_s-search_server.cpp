@@ -0,0 +1,192 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include <catch2/catch.hpp>
+#include <nlohmann/json.hpp>
+
+#include "../src/clp/ErrorCode.hpp"
+#include "../src/clp/networking/socket_utils.hpp"
+#include "../src/clp_s/ArchiveMetadataCache.hpp"
+#include "../src/clp_s/SearchServer.hpp"
+#include "LogSuppressor.hpp"
+#include "TestOutputCleaner.hpp"
+
+constexpr std::string_view cTestSocketPath{"test-clp-s-search-server.sock"};
+constexpr size_t cTestMetadataCacheSize{1024ULL * 1024};  // 1 MiB
+
+namespace {
+/**
+ * Stand-in for clp-s's search that writes each argument to the client as a line. The search fails
+ * if an argument is "fail", and throws if an argument is "throw".
+ * @param args
+ * @param metadata_cache
+ * @param client_socket_fd
+ * @return Whether the search succeeded
+ * @throw std::runtime_error if an argument is "throw"
+ */
+auto echo_search(
+        std::vector<std::string> const& args,
+        std::shared_ptr<clp_s::ArchiveMetadataCache> const& metadata_cache,
+        int client_socket_fd
+) -> bool;
+
+/**
+ * Connects to the server, sends it a request in chunks of the given size, and receives its
+ * response.
+ * @param request
+ * @param chunk_size
+ * @return Each line of the response
+ */
+auto send_request(std::string_view request, size_t chunk_size) -> std::vector<std::string>;
+
+auto echo_search(
+        std::vector<std::string> const& args,
+        std::shared_ptr<clp_s::ArchiveMetadataCache> const& metadata_cache,
+        int client_socket_fd
+) -> bool {
+    if (nullptr == metadata_cache) {
+        return false;
+    }
+    bool succeeded{true};
+    for (auto const& arg : args) {
+        if ("throw" == arg) {
+            throw std::runtime_error{"Search failed."};
+        }
+        if ("fail" == arg) {
+            succeeded = false;
+        }
+        auto const line = arg + "\n";
+        clp::networking::send(client_socket_fd, line.data(), line.size());
+    }
+    return succeeded;
+}
+
+auto send_request(std::string_view request, size_t chunk_size) -> std::vector<std::string> {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    cTestSocketPath.copy(address.sun_path, cTestSocketPath.size());
+
+    auto const socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(-1 != socket_fd);
+    REQUIRE(0 == connect(socket_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)));
+
+    for (size_t pos{0}; pos < request.size(); pos += chunk_size) {
+        auto const chunk = request.substr(pos, chunk_size);
+        REQUIRE(clp::ErrorCode_Success
+                == clp::networking::try_send(socket_fd, chunk.data(), chunk.size()));
+    }
+    REQUIRE(0 == shutdown(socket_fd, SHUT_WR));
+
+    // The server closes the connection once it has responded
+    std::string response;
+    std::array<char, 4096> buf{};
+    while (true) {
+        size_t num_bytes_received{0};
+        auto const rc = clp::networking::try_receive(
+                socket_fd,
+                buf.data(),
+                buf.size(),
+                num_bytes_received
+        );
+        if (clp::ErrorCode_EndOfFile == rc) {
+            break;
+        }
+        REQUIRE(clp::ErrorCode_Success == rc);
+        response.append(buf.data(), num_bytes_received);
+    }
+    close(socket_fd);
+
+    std::vector<std::string> lines;
+    std::istringstream response_stream{response};
+    for (std::string line; std::getline(response_stream, line);) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+}  // namespace
+
+TEST_CASE("clp-s-search-server", "[clp-s][search]") {
+    TestOutputCleaner const test_cleanup{{std::string{cTestSocketPath}}};
+    LogSuppressor const log_suppressor;
+
+    clp_s::SearchServer server{std::string{cTestSocketPath}, cTestMetadataCacheSize, echo_search};
+    REQUIRE(server.listen());
+    auto serve_result = std::async(std::launch::async, [&]() { return server.serve(); });
+
+    // Each search's arguments, the results it writes, and whether it succeeds. The results are
+    // followed by a line with the search's success.
+    std::vector<std::tuple<std::vector<std::string>, std::vector<std::string>, bool>> const
+            searches{
+                    {{}, {}, true},
+                    {{"--tge", "0", "archives", "msg: *"},
+                     {"--tge", "0", "archives", "msg: *"},
+                     true},
+                    {{"a", "fail"}, {"a", "fail"}, false},
+                    {{"a", "throw", "b"}, {"a"}, false}
+            };
+    for (auto const chunk_size : {size_t{1}, size_t{4096}}) {
+        for (auto const& [args, results, success] : searches) {
+            CAPTURE(chunk_size, args);
+            nlohmann::json const request{{"command", "search"}, {"args", args}};
+            auto expected_lines = results;
+            expected_lines.push_back(nlohmann::json{{"success", success}}.dump());
+            REQUIRE(expected_lines == send_request(request.dump() + "\n", chunk_size));
+        }
+    }
+
+    // Anything after the end of the request's line is ignored
+    auto lines = send_request(R"({"command": "stats"})" "\n" R"({"command": "search"})", 4096);
+    REQUIRE(1 == lines.size());
+    auto const stats = nlohmann::json::parse(lines.front());
+    REQUIRE(0 == stats.at("num_hits").get<size_t>());
+    REQUIRE(0 == stats.at("num_misses").get<size_t>());
+    REQUIRE(0 == stats.at("num_evictions").get<size_t>());
+    REQUIRE(0 == stats.at("num_archives").get<size_t>());
+    REQUIRE(0 == stats.at("memory_usage").get<size_t>());
+
+    // A request without a trailing newline ends when the client stops sending
+    lines = send_request(R"({"command": "unknown"})", 4096);
+    REQUIRE(std::vector<std::string>{R"({"success":false})"} == lines);
+
+    // Malformed requests are dropped without a response, and don't stop the server
+    REQUIRE(send_request("{\n", 4096).empty());
+    REQUIRE(send_request(R"({"args": []})" "\n", 4096).empty());
+    lines = send_request(R"({"command": "search", "args": ["a"]})" "\n", 4096);
+    REQUIRE(std::vector<std::string>{"a", R"({"success":true})"} == lines);
+
+    server.stop();
+    REQUIRE(serve_result.get());
+
+    // A new server replaces the socket left behind by the previous one
+    clp_s::SearchServer restarted_server{
+            std::string{cTestSocketPath},
+            cTestMetadataCacheSize,
+            echo_search
+    };
+    REQUIRE(restarted_server.listen());
+    serve_result = std::async(std::launch::async, [&]() { return restarted_server.serve(); });
+    lines = send_request(R"({"command": "search", "args": ["b"]})" "\n", 4096);
+    REQUIRE(std::vector<std::string>{"b", R"({"success":true})"} == lines);
+    restarted_server.stop();
+    REQUIRE(serve_result.get());
+
+    // Socket paths must fit in a Unix domain socket address
+    clp_s::SearchServer long_path_server{
+            std::string(sizeof(sockaddr_un::sun_path), 'a'),
+            cTestMetadataCacheSize,
+            echo_search
+    };
+    REQUIRE_FALSE(long_path_server.listen());
+}